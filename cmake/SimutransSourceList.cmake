@@ -11,6 +11,7 @@ target_sources(simutrans PRIVATE
 		src/simutrans/dataobj/environment.cc
 		src/simutrans/dataobj/freelist.cc
 		src/simutrans/dataobj/gameinfo.cc
+		src/simutrans/dataobj/goods_storage.cc
 		src/simutrans/dataobj/height_map_loader.cc
 		src/simutrans/dataobj/koord.cc
 		src/simutrans/dataobj/koord3d.cc
@@ -67,6 +68,8 @@ target_sources(simutrans PRIVATE
 		src/simutrans/descriptor/vehicle_desc.cc
 		src/simutrans/descriptor/way_desc.cc
 		src/simutrans/display/font.cc
+		src/simutrans/display/blitter.cc
+		src/simutrans/display/image_arena.cc
 		src/simutrans/display/simview.cc
 		src/simutrans/display/simgraph.cc
 		src/simutrans/display/viewport.cc
@@ -202,7 +205,9 @@ target_sources(simutrans PRIVATE
 		src/simutrans/io/raw_image_ppm.cc
 		src/simutrans/io/rdwr/adler32_stream.cc
 		src/simutrans/io/rdwr/bzip2_file_rdwr_stream.cc
+		src/simutrans/io/rdwr/chunked_file_rdwr_stream.cc
 		src/simutrans/io/rdwr/compare_file_rd_stream.cc
+		src/simutrans/io/rdwr/memory_rdwr_stream.cc
 		src/simutrans/io/rdwr/raw_file_rdwr_stream.cc
 		src/simutrans/io/rdwr/rdwr_stream.cc
 		src/simutrans/io/rdwr/zlib_file_rdwr_stream.cc
@@ -214,6 +219,7 @@ target_sources(simutrans PRIVATE
 		src/simutrans/network/network_cmd_ingame.cc
 		src/simutrans/network/network_cmd_scenario.cc
 		src/simutrans/network/network_cmp_pakset.cc
+		src/simutrans/network/network_delta.cc
 		src/simutrans/network/network_file_transfer.cc
 		src/simutrans/network/network_packet.cc
 		src/simutrans/network/network_socket_list.cc
@@ -328,8 +334,10 @@ target_sources(simutrans PRIVATE
 		src/simutrans/vehicle/water_vehicle.cc
 		src/simutrans/world/placefinder.cc
 		src/simutrans/world/simcity.cc
+		src/simutrans/world/city_index.cc
 		src/simutrans/world/simplan.cc
 		src/simutrans/world/simworld.cc
+		src/simutrans/world/step_profiler.cc
 		src/simutrans/world/surface.cc
 		src/simutrans/world/terraformer.cc
 		src/squirrel/sq_extensions.cc
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <chrono>
 
 // Needed for interaction with console
 // <windows.h> also needed, but this is included by networking code
@@ -395,6 +396,82 @@ int lock_company(SOCKET socket, uint32, int argc, char **argv)
 	return 0;
 }
 
+// server the stress test opens its connections to
+static const char *stress_server_address = NULL;
+
+static sint64 stress_time_ms()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// login request with an empty password, the server replies to it even if not authenticated
+static void stress_send_request(SOCKET socket, uint32 command_id)
+{
+	nwc_service_t nwcs;
+	nwcs.flag = command_id;
+	nwcs.text = strdup("");
+	nwcs.send_queued(socket);
+}
+
+// Opens many connections to the server, each one sends a new request as soon as the reply to the last one arrived
+int stress(SOCKET, uint32 command_id, int argc, char **argv)
+{
+	const int clients = atoi(argv[0]);
+	const int seconds = argc > 1 ? atoi(argv[1]) : 10;
+	if (clients <= 0  ||  seconds <= 0) {
+		return 3;
+	}
+	// the connection opened by main() is the first client
+	for (int i = 1; i < clients; i++) {
+		const char *error = NULL;
+		SOCKET const s = network_open_address(stress_server_address, error);
+		if (error) {
+			fprintf(stderr, "Could only open %d of %d connections: %s\n", i, clients, error);
+			return 1;
+		}
+		socket_list_t::add_client(s);
+	}
+
+	// time the pending request was sent, indexed by client id
+	const uint32 count = socket_list_t::get_count();
+	vector_tpl<sint64> sent_at(count);
+	const sint64 start = stress_time_ms();
+	for (uint32 i = 0; i < count; i++) {
+		stress_send_request(socket_list_t::get_socket(i), command_id);
+		sent_at.append(start);
+	}
+
+	uint32 replies = 0;
+	sint64 latency_sum = 0, latency_max = 0;
+	sint64 now = start;
+	while (now < start + seconds * 1000) {
+		network_process_send_queues(0);
+		network_command_t *nwc = network_check_activity(100);
+		now = stress_time_ms();
+		while (nwc) {
+			const uint32 id = socket_list_t::get_client_id(nwc->get_sender());
+			if (nwc->get_id() == NWC_SERVICE  &&  ((nwc_service_t *)nwc)->flag == command_id  &&  id < count) {
+				const sint64 latency = now - sent_at[id];
+				latency_sum += latency;
+				if (latency > latency_max) {
+					latency_max = latency;
+				}
+				replies++;
+				stress_send_request(nwc->get_sender(), command_id);
+				sent_at[id] = now;
+			}
+			delete nwc;
+			nwc = network_get_received_command();
+		}
+	}
+
+	const double elapsed = (now - start) / 1000.0;
+	printf("%d clients, %u replies in %.1f s (%.0f/s)\n", clients, replies, elapsed, replies / elapsed);
+	printf("latency: average %.1f ms, maximum %d ms\n", replies ? (double)latency_sum / replies : 0.0, (int)latency_max);
+	printf("connections still open: %u\n", socket_list_t::get_connected_clients());
+	return socket_list_t::get_connected_clients() == (uint32)clients ? 0 : 3;
+}
+
 // Print usage and exit
 void usage()
 {
@@ -454,6 +531,10 @@ void usage()
 		"      force-sync\n"
 		"        Force server to send sync command in order to save & reload the game\n"
 		"\n"
+		"      stress <clients> [seconds]\n"
+		"        Load test: open that many connections, each sending requests as fast\n"
+		"        as the server replies, for 10 seconds if not specified\n"
+		"\n"
 		"    Return codes:\n"
 		"      0 .. success\n"
 		"      1 .. server not reachable\n"
@@ -558,7 +639,8 @@ int main(int argc, char* argv[]) {
 		{"info-company",   true,  nwc_service_t::SRVC_GET_COMPANY_INFO, 1, &simple_gettext_command},
 		{"unlock-company", true,  nwc_service_t::SRVC_UNLOCK_COMPANY,   1, &simple_command},
 		{"remove-company", true,  nwc_service_t::SRVC_REMOVE_COMPANY,   1, &simple_command},
-		{"lock-company",   true,  nwc_service_t::SRVC_LOCK_COMPANY,     2, &lock_company}
+		{"lock-company",   true,  nwc_service_t::SRVC_LOCK_COMPANY,     2, &lock_company},
+		{"stress",         false, nwc_service_t::SRVC_LOGIN_ADMIN,      1, &stress}
 	};
 	int numcommands = lengthof(commands);
 
@@ -607,6 +689,7 @@ int main(int argc, char* argv[]) {
 	}
 	// now we are connected
 	socket_list_t::add_client(socket);
+	stress_server_address = server_address;
 
 	// If authentication required, perform authentication
 	if(  commands[cmdindex].needs_auth  ) {
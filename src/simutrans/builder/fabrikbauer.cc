@@ -457,27 +457,6 @@ void factory_builder_t::distribute_attractions(int max_number)
 	minimap_t::get_instance()->calc_map_size();
 }
 
-/**
- * Compares cities by their distance to an origin.
- */
-class RelativeDistanceOrdering
-{
-private:
-	const koord m_origin;
-
-public:
-	RelativeDistanceOrdering(const koord& origin)
-		: m_origin(origin)
-	{ /* nothing */ }
-
-	/// @returns true if @p a is closer to the origin than @p b, otherwise false.
-	bool operator()(const stadt_t *a, const stadt_t *b) const
-	{
-		return koord_distance(m_origin, a->get_pos()) < koord_distance(m_origin, b->get_pos());
-	}
-};
-
-
 /*
  * Builds a single new factory.
  */
@@ -546,13 +525,10 @@ fabrik_t* factory_builder_t::build_factory(koord3d* parent, const factory_desc_t
 
 	// add passenger to pax>0, (so no suicide diver at the fish swarm)
 	if(info->get_pax_level()>0) {
-		const weighted_vector_tpl<stadt_t*>& staedte = welt->get_cities();
-		vector_tpl<stadt_t *>distance_stadt( staedte.get_count() );
-
-		for(stadt_t* const i : staedte) {
-			distance_stadt.insert_ordered(i, RelativeDistanceOrdering(fab->get_pos().get_2d()));
-		}
 		settings_t const& s = welt->get_settings();
+		// no city further away than the maximum number of towns can become a target
+		vector_tpl<stadt_t *>distance_stadt( s.get_factory_worker_maximum_towns() );
+		welt->find_nearest_cities( fab->get_pos().get_2d(), s.get_factory_worker_maximum_towns(), distance_stadt );
 		for(stadt_t* const i : distance_stadt) {
 			uint32 const ntgt = fab->get_target_cities().get_count();
 			if (ntgt >= s.get_factory_worker_maximum_towns()) break;
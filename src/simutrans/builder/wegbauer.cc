@@ -66,9 +66,7 @@
 #include "../gui/tool_selector.h"
 #include "../gui/messagebox.h"
 
-#ifdef DEBUG_ROUTES
 #include "../sys/simsys.h"
-#endif
 
 
 // #define AUTOMATIC_BRIDGES // build bridges automatically
@@ -1309,6 +1307,10 @@ way_builder_t::way_builder_t(player_t* player)
 	, keep_existing_faster_ways(false)
 	, keep_existing_city_roads(false)
 	, prefer_parallel(false)
+	, bidirectional(false)
+	, corridor(-1)
+	, coarse_heuristic(false)
+	, search_nodes(0)
 	, build_sidewalk(false)
 {
 	maximum = welt->get_settings().way_count_maximum; // building cost, (curves etc.)
@@ -1385,65 +1387,211 @@ static void get_mini_maxi( const vector_tpl<koord3d> &ziel, koord3d &mini, koord
 
 
 /**
- * this routine uses A* to calculate the best route
- * beware: change the cost and you will mess up the system!
- * (but you can try, look at simuconf.tab)
+ * Estimate of the cost from any tile to the targets, calculated on a grid of cells of 16x16 tiles.
+ * Neighbouring cells are connected with the cost of a straight way plus, like in calc_distance(),
+ * the slopes needed at least to get over the gap between their height ranges. This guides the
+ * search around mountains, where the plain distance would lead it straight into them.
+ * The height ranges include all grounds of every tile, so existing bridges, tunnels and elevated
+ * ways are accounted for. If new bridges or tunnels may be built or the terrain changed, any gap can be crossed and only
+ * the distance is left.
  */
-sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const vector_tpl<koord3d> &ziel)
+class coarse_heuristic_t
 {
-	assert((get_random_mode() & SYNC_STEP_RANDOM) == 0);
+	enum { cell_shift = 4 };
 
-	// we clear it here probably twice: does not hurt ...
-	route.clear();
-	terraform_index.clear();
+	koord origin;
+	sint16 size_x, size_y;
+	uint32 *dist;
 
-	// check for existing koordinates
-	bool has_target_ground = false;
-	for(koord3d const& i : ziel) {
-		has_target_ground |= welt->lookup(i) != 0;
+	/// cost of crossing a cell on flat land
+	uint32 cell_cost;
+
+	struct node_t
+	{
+		uint32 f;
+		uint32 cell;
+
+		inline bool operator <= (const node_t &k) const { return f <= k.f; }
+	};
+
+public:
+	/// @param with_climb false, if new bridges or tunnels may be built or the terrain may be changed
+	coarse_heuristic_t(karte_t *welt, koord mini, koord maxi, const vector_tpl<koord3d> &ziel, bool with_climb);
+
+	~coarse_heuristic_t() { delete [] dist; }
+
+	uint32 get(koord k) const
+	{
+		const sint16 x = (k.x - origin.x) >> cell_shift;
+		const sint16 y = (k.y - origin.y) >> cell_shift;
+		if(  k.x < origin.x  ||  k.y < origin.y  ||  x >= size_x  ||  y >= size_y  ) {
+			return 0;
+		}
+		// the tile may be anywhere in its cell
+		const uint32 d = dist[y*size_x + x];
+		return d > cell_cost ? d - cell_cost : 0;
 	}
-	if( !has_target_ground ) {
-		return -1;
+};
+
+
+coarse_heuristic_t::coarse_heuristic_t(karte_t *welt, koord mini, koord maxi, const vector_tpl<koord3d> &ziel, bool with_climb)
+{
+	settings_t const& s = welt->get_settings();
+	origin = mini;
+	size_x = ((maxi.x - mini.x) >> cell_shift) + 1;
+	size_y = ((maxi.y - mini.y) >> cell_shift) + 1;
+	cell_cost = s.way_count_straight << cell_shift;
+
+	const uint32 cells = size_x*size_y;
+	dist = new uint32[cells];
+
+	// height range of all grounds in each cell (over water the way is at least on water level)
+	sint8 *lo = new sint8[cells];
+	sint8 *hi = new sint8[cells];
+	for(  sint16 cy=0;  cy<size_y;  cy++  ) {
+		for(  sint16 cx=0;  cx<size_x;  cx++  ) {
+			const uint32 c = cy*size_x + cx;
+			lo[c] = 127;
+			hi[c] = -128;
+			dist[c] = 0xFFFFFFFFu;
+			if(  !with_climb  ) {
+				continue;
+			}
+			const sint16 x0 = origin.x + (cx << cell_shift), y0 = origin.y + (cy << cell_shift);
+			for(  sint16 y = y0;  y < y0+(1 << cell_shift)  &&  y <= maxi.y;  y++  ) {
+				for(  sint16 x = x0;  x < x0+(1 << cell_shift)  &&  x <= maxi.x;  x++  ) {
+					const planquadrat_t *plan = welt->access(x, y);
+					for(  uint32 i = 0;  i < plan->get_boden_count();  i++  ) {
+						const grund_t *gr = plan->get_boden_bei(i);
+						const sint8 h = gr->ist_karten_boden() ? std::max( gr->get_hoehe(), welt->get_water_hgt(koord(x, y)) ) : gr->get_hoehe();
+						lo[c] = std::min( lo[c], h );
+						hi[c] = std::max( hi[c], h );
+					}
+				}
+			}
+		}
 	}
-	// check scenario conditions for start and endpoint
-	for (koord3d const& pos : start) {
-		if (welt->get_scenario()->is_work_allowed_here(player_builder, TOOL_BUILD_WAY | GENERAL_TOOL, bautyp & bautyp_mask, desc->get_name(), pos) != NULL) {
-			return -1;
+
+	// Dijkstra from the cells with targets; every edge is used at most once
+	node_t *nodes = new node_t[4*cells + ziel.get_count()];
+	uint32 used = 0;
+	binary_heap_tpl<node_t *> queue;
+	for(koord3d const& pos : ziel) {
+		const koord k = pos.get_2d();
+		if(  k.x >= origin.x  &&  k.y >= origin.y  &&  k.x <= maxi.x  &&  k.y <= maxi.y  ) {
+			const uint32 c = ((k.y - origin.y) >> cell_shift)*size_x + ((k.x - origin.x) >> cell_shift);
+			if(  dist[c] != 0  ) {
+				dist[c] = 0;
+				nodes[used].f = 0;
+				nodes[used].cell = c;
+				queue.insert( nodes + used++ );
+			}
 		}
 	}
-	for (koord3d const& pos : ziel) {
-		if (welt->get_scenario()->is_work_allowed_here(player_builder, TOOL_BUILD_WAY | GENERAL_TOOL, bautyp & bautyp_mask, desc->get_name(), pos) != NULL) {
-			return -1;
+	while(  !queue.empty()  ) {
+		const node_t *n = queue.pop();
+		if(  n->f > dist[n->cell]  ) {
+			// already reached cheaper
+			continue;
+		}
+		const sint16 cx = n->cell % size_x, cy = n->cell / size_x;
+		for(  int r=0;  r<4;  r++  ) {
+			const sint16 nx = cx + koord::nesw[r].x, ny = cy + koord::nesw[r].y;
+			if(  nx < 0  ||  ny < 0  ||  nx >= size_x  ||  ny >= size_y  ) {
+				continue;
+			}
+			const uint32 c = ny*size_x + nx;
+			uint32 climb = 0;
+			if(  !with_climb  ) {
+				// bridges and tunnels may cross anything
+			}
+			else if(  hi[n->cell] < lo[c]  ) {
+				climb = lo[c] - hi[n->cell];
+			}
+			else if(  hi[c] < lo[n->cell]  ) {
+				climb = lo[n->cell] - hi[c];
+			}
+			const uint32 f = n->f + cell_cost + climb*s.way_count_slope;
+			if(  f < dist[c]  ) {
+				dist[c] = f;
+				nodes[used].f = f;
+				nodes[used].cell = c;
+				queue.insert( nodes + used++ );
+			}
 		}
 	}
+	delete [] nodes;
+	delete [] lo;
+	delete [] hi;
+}
 
-	// calculate the minimal cuboid containing 'ziel'
+
+struct way_builder_t::search_t
+{
+	route_t::node_pool_t *pool;
+	const vector_tpl<koord3d> *ziel;
+
+	/// minimal cuboid containing ziel
 	koord3d mini, maxi;
-	get_mini_maxi( ziel, mini, maxi );
 
-	// memory in static list ...
-	if(route_t::nodes==NULL) {
-		route_t::MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		route_t::nodes = new route_t::ANode[route_t::MAX_STEP+4+1];
+	/// NULL: estimate only from the distance to the cuboid
+	const coarse_heuristic_t *coarse;
+
+	/// tiles outside are not visited
+	koord corridor_min, corridor_max;
+
+	/// number of nodes used
+	uint32 step;
+
+	/// to speed up search, but may not find all shortest ways
+	uint32 min_dist;
+
+	/// last visited node
+	route_t::ANode *tmp;
+
+	enum { searching, found, too_expensive } state;
+
+	search_t(const vector_tpl<koord3d> &ziel_, const coarse_heuristic_t *coarse_, koord corridor_min_, koord corridor_max_) :
+		pool(NULL),
+		ziel(&ziel_),
+		coarse(coarse_),
+		corridor_min(corridor_min_),
+		corridor_max(corridor_max_),
+		step(0),
+		min_dist(99999999),
+		tmp(NULL),
+		state(searching)
+	{
+		get_mini_maxi( ziel_, mini, maxi );
 	}
 
-	static binary_heap_tpl <route_t::ANode *> queue;
+	~search_t()
+	{
+		if(  pool  ) {
+			route_t::release_node_pool(pool);
+		}
+	}
 
-	// initialize marker field
-	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y);
+	bool in_corridor(const koord3d &pos) const
+	{
+		return pos.x >= corridor_min.x  &&  pos.y >= corridor_min.y  &&  pos.x <= corridor_max.x  &&  pos.y <= corridor_max.y;
+	}
 
-	// clear the queue (should be empty anyhow)
-	queue.clear();
+	/// @p dist is the distance to the target cuboid
+	uint32 estimate(uint32 dist, const koord3d &pos) const
+	{
+		return coarse ? std::max( dist, coarse->get(pos.get_2d()) ) : dist;
+	}
+};
 
-	// some thing for the search
-	grund_t *to;
-	koord3d gr_pos; // just the last valid pos ...
-	route_t::ANode *tmp=NULL;
-	uint32 step = 0;
-	const grund_t* gr=NULL;
+
+bool way_builder_t::init_search(search_t &s, const vector_tpl<koord3d> &start)
+{
+	// nodes, queue and marker field for this search
+	s.pool = route_t::get_node_pool(welt);
 
 	for(koord3d const& i : start) {
-		gr = welt->lookup(i);
+		const grund_t *gr = welt->lookup(i);
 
 		// is valid ground?
 		sint32 dummy;
@@ -1451,231 +1599,329 @@ sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const
 			// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
 			continue;
 		}
-		tmp = &(route_t::nodes[step]);
-		step ++;
+		route_t::ANode *tmp = s.pool->get(s.step);
+		s.step ++;
 
 		tmp->parent = NULL;
 		tmp->gr = gr;
-		tmp->f = calc_distance(i, mini, maxi);
+		tmp->f = s.estimate( calc_distance(i, s.mini, s.maxi), i );
 		tmp->g = 0;
 		tmp->dir = 0;
 		tmp->count = 0;
 
-		queue.insert(tmp);
-	}
-
-	if( queue.empty() ) {
-		// no valid ground to start.
-		return -1;
+		s.pool->queue.insert(tmp);
 	}
+	// no valid ground to start?
+	return !s.pool->queue.empty();
+}
 
-	INT_CHECK("wegbauer 347");
-
-	// get exclusively the tile list
-	route_t::GET_NODE();
-
-	// to speed up search, but may not find all shortest ways
-	uint32 min_dist = 99999999;
 
-//DBG_MESSAGE("route_t::itern_calc_route()","calc route from %d,%d,%d to %d,%d,%d",ziel.x, ziel.y, ziel.z, start.x, start.y, start.z);
-	do {
-		route_t::ANode *test_tmp = queue.pop();
+bool way_builder_t::search_step(search_t &s)
+{
+	const vector_tpl<koord3d> &ziel = *s.ziel;
+	marker_t &marker = s.pool->marker;
+	route_t::ANode *tmp = s.pool->queue.pop();
 
-		if(marker.test_and_mark(test_tmp->gr)) {
-			// we were already here on a faster route, thus ignore this branch
-			// (trading speed against memory consumption)
-			continue;
-		}
+	if(marker.test_and_mark(tmp->gr)) {
+		// we were already here on a faster route, thus ignore this branch
+		// (trading speed against memory consumption)
+		return false;
+	}
 
-		tmp = test_tmp;
-		gr = tmp->gr;
-		gr_pos = gr->get_pos();
+	s.tmp = tmp;
+	const grund_t *gr = tmp->gr;
+	grund_t *to;
 
 #ifdef DEBUG_ROUTES
 DBG_DEBUG("insert to close","(%i,%i,%i)  f=%i",gr->get_pos().x,gr->get_pos().y,gr->get_pos().z,tmp->f);
 #endif
 
-		// already there?
-		if (ziel.is_contained(gr_pos)) {
-			// we added a target to the closed list: we are finished
-			warn_fail = NULL;
-			break;
-		}
-		// route costs too high => abort
-		if (tmp->g > maximum) {
-			warn_fail = "Route cost exceeded max_route_steps";
-			break;
-		}
+	// already there?
+	if (ziel.is_contained(gr->get_pos())) {
+		// we added a target to the closed list: we are finished
+		warn_fail = NULL;
+		s.state = search_t::found;
+		return true;
+	}
+	// route costs too high => abort
+	if (tmp->g > maximum) {
+		warn_fail = "Route cost exceeded max_route_steps";
+		s.state = search_t::too_expensive;
+		return true;
+	}
 
-		// the four possible directions plus any additional stuff due to already existing brides plus new ones ...
-		next_gr.clear();
+	// the four possible directions plus any additional stuff due to already existing brides plus new ones ...
+	next_gr.clear();
 
-		// only one direction allowed ...
-		const ribi_t::ribi straight_dir = tmp->parent!=NULL ? ribi_type(gr->get_pos() - tmp->parent->gr->get_pos()) : (ribi_t::ribi)ribi_t::all;
+	// only one direction allowed ...
+	const ribi_t::ribi straight_dir = tmp->parent!=NULL ? ribi_type(gr->get_pos() - tmp->parent->gr->get_pos()) : (ribi_t::ribi)ribi_t::all;
 
-		// test directions
-		// .. use only those that are allowed by current slope
-		// .. do not go backward
-		const ribi_t::ribi slope_dir = (slope_t::is_way_ns(gr->get_weg_hang()) ? ribi_t::northsouth : ribi_t::none) | (slope_t::is_way_ew(gr->get_weg_hang()) ? ribi_t::eastwest : ribi_t::none);
-		const ribi_t::ribi test_dir = (tmp->count & build_straight)==0  ?  slope_dir  & ~ribi_t::backward(straight_dir)
-		                                                                :  straight_dir;
+	// test directions
+	// .. use only those that are allowed by current slope
+	// .. do not go backward
+	const ribi_t::ribi slope_dir = (slope_t::is_way_ns(gr->get_weg_hang()) ? ribi_t::northsouth : ribi_t::none) | (slope_t::is_way_ew(gr->get_weg_hang()) ? ribi_t::eastwest : ribi_t::none);
+	const ribi_t::ribi test_dir = (tmp->count & build_straight)==0  ?  slope_dir  & ~ribi_t::backward(straight_dir)
+	                                                                :  straight_dir;
 
-		// testing all four possible directions
-		for(ribi_t::ribi r=1; (r&16)==0; r<<=1) {
-			if((r & test_dir)==0) {
-				// not allowed to go this direction
+	// testing all four possible directions
+	for(ribi_t::ribi r=1; (r&16)==0; r<<=1) {
+		if((r & test_dir)==0) {
+			// not allowed to go this direction
+			continue;
+		}
+
+		bool do_terraform = false;
+		const koord zv(r);
+		if(!gr->get_neighbour(to,invalid_wt,r)  ||  !check_slope(gr, to)) {
+			// slopes do not match
+			// terraforming enabled?
+			if (bautyp==river  ||  (bautyp & terraform_flag) == 0) {
 				continue;
 			}
-
-			bool do_terraform = false;
-			const koord zv(r);
-			if(!gr->get_neighbour(to,invalid_wt,r)  ||  !check_slope(gr, to)) {
-				// slopes do not match
-				// terraforming enabled?
-				if (bautyp==river  ||  (bautyp & terraform_flag) == 0) {
+			// check terraforming (but not in curves)
+			if (gr->get_grund_hang()==0  ||  (tmp->parent!=NULL  &&  tmp->parent->parent!=NULL  &&  r==straight_dir)) {
+				to = welt->lookup_kartenboden(gr->get_pos().get_2d() + zv);
+				if (to==NULL  ||  (check_slope(gr, to)  &&  gr->get_vmove(r)!=to->get_vmove(ribi_t::backward(r)))) {
 					continue;
 				}
-				// check terraforming (but not in curves)
-				if (gr->get_grund_hang()==0  ||  (tmp->parent!=NULL  &&  tmp->parent->parent!=NULL  &&  r==straight_dir)) {
-					to = welt->lookup_kartenboden(gr->get_pos().get_2d() + zv);
-					if (to==NULL  ||  (check_slope(gr, to)  &&  gr->get_vmove(r)!=to->get_vmove(ribi_t::backward(r)))) {
-						continue;
-					}
-					else {
-						do_terraform = true;
-					}
-				}
 				else {
-					continue;
+					do_terraform = true;
 				}
 			}
-
-			// something valid?
-			if(marker.is_marked(to)) {
+			else {
 				continue;
 			}
+		}
+
+		// something valid?
+		if(marker.is_marked(to)  ||  !s.in_corridor(to->get_pos())) {
+			continue;
+		}
 
-			sint32 new_cost = 0;
-			bool is_ok = is_allowed_step(gr,to,&new_cost);
+		sint32 new_cost = 0;
+		bool is_ok = is_allowed_step(gr,to,&new_cost);
 
-			if(is_ok) {
-				// now add it to the array ...
-				next_gr.append(next_gr_t(to, new_cost, do_terraform ? build_straight | terraform : 0));
-			}
-			else if(tmp->parent!=NULL  &&  r==straight_dir  &&  (tmp->count & build_tunnel_bridge)==0) {
-				// try to build a bridge or tunnel here, since we cannot go here ...
-				check_for_bridge(tmp->parent->gr,gr,ziel);
-			}
+		if(is_ok) {
+			// now add it to the array ...
+			next_gr.append(next_gr_t(to, new_cost, do_terraform ? build_straight | terraform : 0));
 		}
+		else if(tmp->parent!=NULL  &&  r==straight_dir  &&  (tmp->count & build_tunnel_bridge)==0) {
+			// try to build a bridge or tunnel here, since we cannot go here ...
+			check_for_bridge(tmp->parent->gr,gr,ziel);
+		}
+	}
 
-		// now check all valid ones ...
-		for(next_gr_t const& r : next_gr) {
-			to = r.gr;
+	// now check all valid ones ...
+	for(next_gr_t const& r : next_gr) {
+		to = r.gr;
 
-			if(  to==NULL) {
-				continue;
-			}
+		if(  to==NULL  ||  !s.in_corridor(to->get_pos())  ) {
+			continue;
+		}
 
-			// new values for cost g
-			uint32 new_g = tmp->g + r.cost;
+		// new values for cost g
+		uint32 new_g = tmp->g + r.cost;
 
-			settings_t const& s = welt->get_settings();
-			// check for curves (usually, one would need the lastlast and the last;
-			// if not there, then we could just take the last
-			uint8 current_dir;
-			if(tmp->parent!=NULL) {
-				current_dir = ribi_type( tmp->parent->gr->get_pos(), to->get_pos() );
-				if(tmp->dir!=current_dir) {
-					new_g += s.way_count_curve;
-					if(tmp->parent->dir!=tmp->dir) {
-						// discourage double turns
-						new_g += s.way_count_double_curve;
-					}
-					else if(ribi_t::is_perpendicular(tmp->dir,current_dir)) {
-						// discourage v turns heavily
-						new_g += s.way_count_90_curve;
-					}
+		settings_t const& st = welt->get_settings();
+		// check for curves (usually, one would need the lastlast and the last;
+		// if not there, then we could just take the last
+		uint8 current_dir;
+		if(tmp->parent!=NULL) {
+			current_dir = ribi_type( tmp->parent->gr->get_pos(), to->get_pos() );
+			if(tmp->dir!=current_dir) {
+				new_g += st.way_count_curve;
+				if(tmp->parent->dir!=tmp->dir) {
+					// discourage double turns
+					new_g += st.way_count_double_curve;
 				}
-				else if(bautyp==leitung  &&  ribi_t::is_bend(current_dir)) {
-					new_g += s.way_count_double_curve;
-				}
-				// extra malus leave an existing road after only one tile
-				waytype_t const wt = desc->get_wtyp();
-				if (tmp->parent->gr->hat_weg(wt) && !gr->hat_weg(wt) && to->hat_weg(wt)) {
-					// but only if not straight track
-					if(!ribi_t::is_straight(tmp->dir)) {
-						new_g += s.way_count_leaving_way;
-					}
+				else if(ribi_t::is_perpendicular(tmp->dir,current_dir)) {
+					// discourage v turns heavily
+					new_g += st.way_count_90_curve;
 				}
 			}
-			else {
-				 current_dir = ribi_type( gr->get_pos(), to->get_pos() );
+			else if(bautyp==leitung  &&  ribi_t::is_bend(current_dir)) {
+				new_g += st.way_count_double_curve;
 			}
-
-			const uint32 new_dist = calc_distance( to->get_pos(), mini, maxi );
-
-			// special check for kinks at the end
-			if(new_dist==0  &&  current_dir!=tmp->dir) {
-				// discourage turn on last tile
-				new_g += s.way_count_double_curve;
+			// extra malus leave an existing road after only one tile
+			waytype_t const wt = desc->get_wtyp();
+			if (tmp->parent->gr->hat_weg(wt) && !gr->hat_weg(wt) && to->hat_weg(wt)) {
+				// but only if not straight track
+				if(!ribi_t::is_straight(tmp->dir)) {
+					new_g += st.way_count_leaving_way;
+				}
 			}
+		}
+		else {
+			 current_dir = ribi_type( gr->get_pos(), to->get_pos() );
+		}
 
-			if (new_dist == 0 && r.flag & terraform) {
-				// no terraforming near target
-				continue;
-			}
-			if(new_dist<min_dist) {
-				min_dist = new_dist;
-			}
-			else if(new_dist>min_dist+50) {
-				// skip, if too far from current minimum tile
-				// will not find some ways, but will be much faster ...
-				// also it will avoid too big detours, which is probably also not the way, the builder intended
-				continue;
-			}
+		const uint32 new_dist = calc_distance( to->get_pos(), s.mini, s.maxi );
 
+		// special check for kinks at the end
+		if(new_dist==0  &&  current_dir!=tmp->dir) {
+			// discourage turn on last tile
+			new_g += st.way_count_double_curve;
+		}
 
-			const uint32 new_f = new_g+new_dist;
+		if (new_dist == 0 && r.flag & terraform) {
+			// no terraforming near target
+			continue;
+		}
+		if(new_dist<s.min_dist) {
+			s.min_dist = new_dist;
+		}
+		else if(new_dist>s.min_dist+50) {
+			// skip, if too far from current minimum tile
+			// will not find some ways, but will be much faster ...
+			// also it will avoid too big detours, which is probably also not the way, the builder intended
+			continue;
+		}
 
-			if((step&0x03)==0) {
-				INT_CHECK( "wegbauer 1347" );
+		const uint32 new_f = new_g + s.estimate( new_dist, to->get_pos() );
+
+		if((s.step&0x03)==0) {
+			INT_CHECK( "wegbauer 1347" );
 #ifdef DEBUG_ROUTES
-				if((step&1023)==0) {minimap_t::get_instance()->calc_map();}
+			if((s.step&1023)==0) {minimap_t::get_instance()->calc_map();}
 #endif
-			}
+		}
 
-			// not in there or taken out => add new
-			route_t::ANode *k=&(route_t::nodes[step]);
-			step++;
+		// not in there or taken out => add new
+		route_t::ANode *k=s.pool->get(s.step);
+		s.step++;
 
-			k->parent = tmp;
-			k->gr = to;
-			k->g = new_g;
-			k->f = new_f;
-			k->dir = current_dir;
-			// count is unused here, use it as flag-variable instead
-			k->count = r.flag;
+		k->parent = tmp;
+		k->gr = to;
+		k->g = new_g;
+		k->f = new_f;
+		k->dir = current_dir;
+		// count is unused here, use it as flag-variable instead
+		k->count = r.flag;
 
-			queue.insert( k );
+		s.pool->queue.insert( k );
 
 #ifdef DEBUG_ROUTES
 DBG_DEBUG("insert to open","(%i,%i,%i)  f=%i",to->get_pos().x,to->get_pos().y,to->get_pos().z,k->f);
 #endif
+	}
+	return true;
+}
+
+
+sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const vector_tpl<koord3d> &ziel)
+{
+	sint32 cost = intern_calc_route_limited( start, ziel );
+	if(  cost < 0  &&  (bidirectional  ||  corridor >= 0)  ) {
+		// the route may leave the corridor, or the bidirectional search found none or a too expensive one
+		const bool old_bidirectional = bidirectional;
+		const sint16 old_corridor = corridor;
+		const uint32 old_nodes = search_nodes;
+		bidirectional = false;
+		corridor = -1;
+		cost = intern_calc_route_limited( start, ziel );
+		search_nodes += old_nodes;
+		bidirectional = old_bidirectional;
+		corridor = old_corridor;
+	}
+	return cost;
+}
+
+
+/**
+ * this routine uses A* to calculate the best route
+ * beware: change the cost and you will mess up the system!
+ * (but you can try, look at simuconf.tab)
+ */
+sint32 way_builder_t::intern_calc_route_limited(const vector_tpl<koord3d> &start, const vector_tpl<koord3d> &ziel)
+{
+	assert((get_random_mode() & SYNC_STEP_RANDOM) == 0);
+
+	// we clear it here probably twice: does not hurt ...
+	route.clear();
+	terraform_index.clear();
+	search_nodes = 0;
+
+	// check for existing koordinates
+	bool has_target_ground = false;
+	for(koord3d const& i : ziel) {
+		has_target_ground |= welt->lookup(i) != 0;
+	}
+	if( !has_target_ground ) {
+		return -1;
+	}
+	// check scenario conditions for start and endpoint
+	for (koord3d const& pos : start) {
+		if (welt->get_scenario()->is_work_allowed_here(player_builder, TOOL_BUILD_WAY | GENERAL_TOOL, bautyp & bautyp_mask, desc->get_name(), pos) != NULL) {
+			return -1;
 		}
+	}
+	for (koord3d const& pos : ziel) {
+		if (welt->get_scenario()->is_work_allowed_here(player_builder, TOOL_BUILD_WAY | GENERAL_TOOL, bautyp & bautyp_mask, desc->get_name(), pos) != NULL) {
+			return -1;
+		}
+	}
 
-	} while (!queue.empty() && step < route_t::MAX_STEP);
+	// the area to search in
+	koord corridor_min(0, 0), corridor_max(welt->get_size().x-1, welt->get_size().y-1);
+	if(  corridor >= 0  ) {
+		koord3d mini, maxi, mini2, maxi2;
+		get_mini_maxi( start, mini, maxi );
+		get_mini_maxi( ziel, mini2, maxi2 );
+		corridor_min.x = std::max<sint32>( corridor_min.x, std::min(mini.x, mini2.x) - corridor );
+		corridor_min.y = std::max<sint32>( corridor_min.y, std::min(mini.y, mini2.y) - corridor );
+		corridor_max.x = std::min<sint32>( corridor_max.x, std::max(maxi.x, maxi2.x) + corridor );
+		corridor_max.y = std::min<sint32>( corridor_max.y, std::max(maxi.y, maxi2.y) + corridor );
+	}
+
+	coarse_heuristic_t *coarse_to_ziel = coarse_heuristic ? new coarse_heuristic_t( welt, corridor_min, corridor_max, ziel, bridge_desc == NULL  &&  tunnel_desc == NULL  &&  (bautyp & terraform_flag) == 0 ) : NULL;
+
+	if(  bidirectional  &&  (bautyp & terraform_flag) == 0  &&  bautyp != river  ) {
+		coarse_heuristic_t *coarse_to_start = coarse_heuristic ? new coarse_heuristic_t( welt, corridor_min, corridor_max, start, bridge_desc == NULL  &&  tunnel_desc == NULL  &&  (bautyp & terraform_flag) == 0 ) : NULL;
+		sint32 cost = -2;
+		{
+			search_t forward( ziel, coarse_to_ziel, corridor_min, corridor_max );
+			search_t backward( start, coarse_to_start, corridor_min, corridor_max );
+			if(  init_search( forward, start )  &&  init_search( backward, ziel )  ) {
+				cost = intern_calc_route_bidirectional( forward, backward );
+			}
+			search_nodes = forward.step + backward.step;
+		}
+		delete coarse_to_start;
+		if(  cost != -2  ) {
+			delete coarse_to_ziel;
+			return cost;
+		}
+		// both halves do not fit together or a target is not valid as start: do it the usual way
+		route.clear();
+	}
+
+	search_t s( ziel, coarse_to_ziel, corridor_min, corridor_max );
+	if(  !init_search( s, start )  ) {
+		// no valid ground to start.
+		delete coarse_to_ziel;
+		return -1;
+	}
+
+	INT_CHECK("wegbauer 347");
+
+//DBG_MESSAGE("route_t::itern_calc_route()","calc route from %d,%d,%d to %d,%d,%d",ziel.x, ziel.y, ziel.z, start.x, start.y, start.z);
+	do {
+		search_step(s);
+	} while (s.state == search_t::searching  &&  !s.pool->queue.empty()  &&  s.step < route_t::MAX_STEP);
+
+	route_t::ANode *tmp = s.tmp;
+	search_nodes += s.step;
+	delete coarse_to_ziel;
 
 #ifdef DEBUG_ROUTES
-DBG_DEBUG("way_builder_t::intern_calc_route()","steps=%i  (max %i) in route, open %i, cost %u",step,route_t::MAX_STEP,queue.get_count(),tmp->g);
+DBG_DEBUG("way_builder_t::intern_calc_route()","steps=%i  (max %i) in route, open %i, cost %u",s.step,route_t::MAX_STEP,s.pool->queue.get_count(),tmp->g);
 #endif
 	INT_CHECK("wegbauer 194");
 
-	route_t::RELEASE_NODE();
-
 	// target reached?
-	if(  !ziel.is_contained(gr->get_pos())  ||  step>=route_t::MAX_STEP  ||  tmp->parent==NULL  ||  tmp->g > maximum  ) {
-		if (step>=route_t::MAX_STEP) {
-			dbg->warning("way_builder_t::intern_calc_route()","Too many steps (%i>=max %i) in route (too long/complex)",step,route_t::MAX_STEP);
+	if(  s.state != search_t::found  ||  s.step>=route_t::MAX_STEP  ||  tmp->parent==NULL  ||  tmp->g > maximum  ) {
+		if (s.step>=route_t::MAX_STEP) {
+			dbg->warning("way_builder_t::intern_calc_route()","Too many steps (%i>=max %i) in route (too long/complex)",s.step,route_t::MAX_STEP);
 		}
 		return -1;
 	}
@@ -1694,6 +1940,140 @@ DBG_DEBUG("way_builder_t::intern_calc_route()","steps=%i  (max %i) in route, ope
 }
 
 
+/**
+ * Alternately extends the search with the shorter queue, until one reaches its targets
+ * or a tile is visited by both. Then the route is combined from the two halves.
+ * @returns costs of the route, -1 if there is none, -2 if the halves do not fit together
+ */
+sint32 way_builder_t::intern_calc_route_bidirectional(search_t &forward, search_t &backward)
+{
+	route_t::ANode *meet_forward = NULL, *meet_backward = NULL;
+
+	while(  forward.state == search_t::searching  &&  backward.state == search_t::searching  &&  forward.step + backward.step < route_t::MAX_STEP  ) {
+		if(  forward.pool->queue.empty()  ||  backward.pool->queue.empty()  ) {
+			// one end is enclosed
+			return -1;
+		}
+		search_t &s = forward.pool->queue.get_count() <= backward.pool->queue.get_count() ? forward : backward;
+		search_t &other = &s == &forward ? backward : forward;
+		if(  !search_step(s)  ) {
+			continue;
+		}
+		if(  s.state == search_t::found  ) {
+			// the targets of one search are the start of the other
+			if(  &s == &forward  ) {
+				meet_forward = s.tmp;
+			}
+			else {
+				meet_backward = s.tmp;
+			}
+			break;
+		}
+		if(  s.state == search_t::searching  &&  other.pool->marker.is_marked(s.tmp->gr)  ) {
+			// the cheapest node of this tile is the one which was visited
+			route_t::ANode *best = NULL;
+			for(  uint32 i=0;  i<other.step;  i++  ) {
+				route_t::ANode *n = other.pool->get(i);
+				if(  n->gr == s.tmp->gr  &&  (best == NULL  ||  n->g < best->g)  ) {
+					best = n;
+				}
+			}
+			meet_forward = &s == &forward ? s.tmp : best;
+			meet_backward = &s == &forward ? best : s.tmp;
+			break;
+		}
+	}
+
+	if(  meet_forward == NULL  &&  meet_backward == NULL  ) {
+		if(  forward.step + backward.step >= route_t::MAX_STEP  ) {
+			dbg->warning("way_builder_t::intern_calc_route_bidirectional()","Too many steps (%i>=max %i) in route (too long/complex)",forward.step + backward.step,route_t::MAX_STEP);
+		}
+		return -1;
+	}
+
+	const sint32 cost = (meet_forward ? meet_forward->g : 0) + (meet_backward ? meet_backward->g : 0);
+	if(  cost > maximum  ) {
+		warn_fail = "Route cost exceeded max_route_steps";
+		return -1;
+	}
+
+	// the route runs from the target to the start: first the backward half reversed ...
+	for(  route_t::ANode *n = meet_backward;  n != NULL;  n = n->parent  ) {
+		route.append(n->gr->get_pos());
+	}
+	for(  uint32 i=0;  2*i+1 < route.get_count();  i++  ) {
+		const koord3d pos = route[i];
+		route[i] = route[route.get_count()-1-i];
+		route[route.get_count()-1-i] = pos;
+	}
+	const uint32 meeting = route.get_count();
+	// ... then the forward half
+	for(  route_t::ANode *n = meet_backward ? (meet_forward ? meet_forward->parent : NULL) : meet_forward;  n != NULL;  n = n->parent  ) {
+		route.append(n->gr->get_pos());
+	}
+	warn_fail = NULL;
+
+	if(  meeting > 0  ) {
+		// the backward half was tested in the other direction
+		if(  !check_route_steps(0, meeting-1, *forward.ziel)  ) {
+			return -2;
+		}
+		// after bridges and tunnels the route must go on straight
+		if(  meet_forward  &&  meet_forward->parent  &&  meet_backward->parent  &&  ((meet_forward->count | meet_backward->count) & build_straight)  ) {
+			if(  ribi_type( meet_forward->parent->gr->get_pos(), meet_forward->gr->get_pos() ) != ribi_type( meet_backward->gr->get_pos(), meet_backward->parent->gr->get_pos() )  ) {
+				return -2;
+			}
+		}
+	}
+	return route.get_count() > 1 ? cost : -2;
+}
+
+
+bool way_builder_t::check_route_steps(uint32 first, uint32 last, const vector_tpl<koord3d> &ziel)
+{
+	for(  uint32 i=first;  i<last;  i++  ) {
+		if(  koord_distance(route[i], route[i+1]) > 1  ) {
+			// bridge or tunnel: must be found from its start like in search_step(), i.e. after a normal step straight ahead
+			if(  i+2 >= route.get_count()  ||  koord_distance(route[i+1], route[i+2]) > 1  ) {
+				return false;
+			}
+			const grund_t *parent_from = welt->lookup(route[i+2]);
+			const grund_t *from = welt->lookup(route[i+1]);
+			const grund_t *to = welt->lookup(route[i]);
+			if(  parent_from == NULL  ||  from == NULL  ||  to == NULL  ) {
+				return false;
+			}
+			next_gr.clear();
+			check_for_bridge( parent_from, from, ziel );
+			bool found = false;
+			for(next_gr_t const& n : next_gr) {
+				found |= n.gr == to;
+			}
+			next_gr.clear();
+			if(  !found  ) {
+				return false;
+			}
+			// and the route goes on straight
+			if(  i > 0  &&  ribi_type(route[i], route[i-1]) != ribi_type(route[i+1], route[i])  ) {
+				return false;
+			}
+			continue;
+		}
+		const grund_t *from = welt->lookup(route[i+1]);
+		const grund_t *to = welt->lookup(route[i]);
+		grund_t *neighbour;
+		sint32 dummy = 0;
+		if(  from == NULL  ||  to == NULL  ||  !from->get_neighbour(neighbour, invalid_wt, ribi_type(route[i+1], route[i]))  ||  neighbour != to  ) {
+			return false;
+		}
+		if(  !check_slope(from, to)  ||  !is_allowed_step(from, to, &dummy)  ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
 
 void way_builder_t::intern_calc_straight_route(const koord3d start, const koord3d ziel)
 {
@@ -1898,20 +2278,11 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 		return -1;
 	}
 
-	// memory in static list ...
-	if(route_t::nodes==NULL) {
-		route_t::MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		route_t::nodes = new route_t::ANode[route_t::MAX_STEP+4+1];
-	}
-
-	static binary_heap_tpl <route_t::ANode *> queue;
-
-	// initialize marker field
-	marker_t& markerbelow = marker_t::instance(welt->get_size().x, welt->get_size().y);
-	marker_t& markerabove = marker_t::instance_second(welt->get_size().x, welt->get_size().y);
-
-	// clear the queue (should be empty anyhow)
-	queue.clear();
+	// nodes, queue and marker fields for this search
+	route_t::node_pool_t *pool = route_t::get_node_pool(welt);
+	binary_heap_tpl <route_t::ANode *> &queue = pool->queue;
+	marker_t& markerbelow = pool->marker;
+	marker_t& markerabove = pool->marker_second;
 
 	// some thing for the search
 	grund_t *to;
@@ -1925,7 +2296,7 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 	sint32 dummy;
 	if( gr && is_allowed_step(gr,gr,&dummy) ) {
 		// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
-		tmp = &(route_t::nodes[step]);
+		tmp = pool->get(step);
 		step ++;
 		tmp->parent = NULL;
 		tmp->gr = gr;
@@ -1941,7 +2312,7 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 	gu = welt->lookup(start + koord3d(0, 0, get_way_height_offset(gr)));
 	if( gu && is_allowed_step(gu,gu,&dummy, true) ) {
 		// DBG_MESSAGE("way_builder_t::intern_calc_route()","cannot start on (%i,%i,%i)",start.x,start.y,start.z);
-		tmp = &(route_t::nodes[step]);
+		tmp = pool->get(step);
 		step ++;
 		tmp->parent = NULL;
 		tmp->gr = gu;
@@ -1957,14 +2328,12 @@ sint32 way_builder_t::intern_calc_route_elevated(const koord3d start, const koor
 
 	if( queue.empty() ) {
 		// no valid ground to start.
+		route_t::release_node_pool(pool);
 		return -1;
 	}
 
 	INT_CHECK("wegbauer 347");
 
-	// get exclusively the tile list
-	route_t::GET_NODE();
-
 	// to speed up search, but may not find all shortest ways
 	uint32 min_dist = 99999999;
 
@@ -2158,7 +2527,7 @@ DBG_DEBUG("insert to close","(%i,%i,%i)  f=%i",gr->get_pos().x,gr->get_pos().y,g
 			}
 
 			// not in there or taken out => add new
-			route_t::ANode *k=&(route_t::nodes[step]);
+			route_t::ANode *k=pool->get(step);
 			step++;
 
 			k->parent = tmp;
@@ -2182,7 +2551,7 @@ DBG_DEBUG("way_builder_t::intern_calc_route()","steps=%i  (max %i) in route, ope
 #endif
 	INT_CHECK("wegbauer 194");
 
-	route_t::RELEASE_NODE();
+	route_t::release_node_pool(pool);
 
 	// target reached?
 	if(  !(ziel == gr_pos)  ||  step>=route_t::MAX_STEP  ||  tmp->parent==NULL  ||  tmp->g > maximum  ) {
@@ -2395,6 +2764,88 @@ DBG_MESSAGE("calc_route::calc_route", "took %u ms", dr_time() - ms );
 }
 
 
+/// land tile near @p k, or koord3d::invalid
+static koord3d find_land_near(karte_t *welt, koord k)
+{
+	for(  sint16 d=0;  d<16;  d++  ) {
+		for(  int r=0;  r<4;  r++  ) {
+			const grund_t *gr = welt->lookup_kartenboden( k + koord::nesw[r]*d );
+			if(  gr  &&  !gr->is_water()  ) {
+				return gr->get_pos();
+			}
+		}
+	}
+	return koord3d::invalid;
+}
+
+
+void way_builder_t::benchmark_routes(player_t *player)
+{
+	const uint16 time = welt->get_timeline_year_month();
+	const way_desc_t *way = weg_search( track_wt, 120, time, type_flat );
+	if(  way == NULL  ) {
+		dbg->error( "way_builder_t::benchmark_routes()", "No track available" );
+		return;
+	}
+	const tunnel_desc_t *tunnel = tunnel_builder_t::get_tunnel_desc( track_wt, way->get_topspeed(), time );
+	const bridge_desc_t *bridge = bridge_builder_t::find_bridge( track_wt, way->get_topspeed(), time );
+
+	// start and end in 1/16 of the map size
+	static const sint16 points[][4] = {
+		{  2,  2, 14, 14 },
+		{  2, 14, 14,  2 },
+		{  8,  1,  8, 15 },
+		{  1,  8, 15,  8 },
+		{  4,  6, 12, 10 }
+	};
+	static const struct {
+		const char *name;
+		bool bidirectional;
+		sint16 corridor;
+		bool coarse_heuristic;
+	} modes[] = {
+		{ "plain",         false, -1, false },
+		{ "corridor",      false, 32, false },
+		{ "coarse",        false, -1, true  },
+		{ "bidirectional", true,  -1, false },
+		{ "all",           true,  32, true  }
+	};
+
+	const koord size = welt->get_size();
+	printf( "mode,start_x,start_y,end_x,end_y,ms,nodes,tiles,costs\n" );
+	for(  uint32 m=0;  m<lengthof(modes);  m++  ) {
+		uint64 total_us = 0;
+		uint32 found = 0;
+		for(  uint32 p=0;  p<lengthof(points);  p++  ) {
+			const koord3d start = find_land_near( welt, koord( size.x*points[p][0]/16, size.y*points[p][1]/16 ) );
+			const koord3d end = find_land_near( welt, koord( size.x*points[p][2]/16, size.y*points[p][3]/16 ) );
+			if(  start == koord3d::invalid  ||  end == koord3d::invalid  ) {
+				continue;
+			}
+
+			way_builder_t bauigel(player);
+			bauigel.init_builder( schiene|bot_flag, way, tunnel, bridge );
+			bauigel.set_keep_existing_ways(false);
+			// only the number of nodes shall limit the search
+			bauigel.set_maximum( 0x7FFFFFFF );
+			bauigel.set_bidirectional( modes[m].bidirectional );
+			bauigel.set_corridor( modes[m].corridor );
+			bauigel.set_coarse_heuristic( modes[m].coarse_heuristic );
+
+			const uint64 start_us = dr_time_us();
+			bauigel.calc_route( start, end );
+			const uint64 us = dr_time_us() - start_us;
+			total_us += us;
+
+			const sint64 costs = bauigel.get_count() > 1 ? bauigel.calc_costs() : 0;
+			found += bauigel.get_count() > 1;
+			printf( "%s,%d,%d,%d,%d,%.1f,%u,%u,%.2f\n", modes[m].name, start.x, start.y, end.x, end.y, us/1000.0, bauigel.search_nodes, bauigel.get_count(), costs/100.0 );
+		}
+		dbg->message( "way_builder_t::benchmark_routes()", "%s: %u routes found in %.1f ms", modes[m].name, found, total_us/1000.0 );
+	}
+}
+
+
 void way_builder_t::build_tunnel_and_bridges()
 {
 	if(bridge_desc==NULL  &&  tunnel_desc==NULL) {
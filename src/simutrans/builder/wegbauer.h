@@ -37,6 +37,12 @@ public:
 	// generates timeline message
 	static void new_month();
 
+	/**
+	 * Times calc_route() between fixed points of the current map with the
+	 * different search options and prints the results (CSV) to stdout.
+	 */
+	static void benchmark_routes(player_t *player);
+
 	/**
 	 * Finds a way with a given speed limit for a given waytype
 	 */
@@ -122,6 +128,18 @@ private:
 	// try to keep a way close to existing ways
 	bool prefer_parallel;
 
+	/// search from start and target at once (not with terraforming)
+	bool bidirectional;
+
+	/// search only this many tiles around start and target, -1: everywhere
+	sint16 corridor;
+
+	/// estimate remaining costs from the terrain heights on a coarse grid
+	bool coarse_heuristic;
+
+	/// number of nodes used by the last search
+	uint32 search_nodes;
+
 	bool build_sidewalk;
 
 	sint32 maximum;    // highest cost
@@ -165,7 +183,25 @@ private:
 	// may modify next_gr array!
 	void check_for_bridge(const grund_t* parent_from, const grund_t* from, const vector_tpl<koord3d> &ziel);
 
+	/// one direction of the search in intern_calc_route()
+	struct search_t;
+
+	/// starts the search @p s from @p start, false if there is no valid start
+	bool init_search(search_t &s, const vector_tpl<koord3d> &start);
+
+	/**
+	 * Takes the next node from the queue of @p s and adds its neighbours.
+	 * @returns false if the tile was already visited
+	 */
+	bool search_step(search_t &s);
+
+	/// checks the steps from index @p first to @p last of the route, when built from the start towards @p ziel
+	bool check_route_steps(uint32 first, uint32 last, const vector_tpl<koord3d> &ziel);
+
+	/// searches within the corridor and bidirectional if set; if that fails, everywhere and in one direction
 	sint32 intern_calc_route(const vector_tpl<koord3d> &start, const vector_tpl<koord3d> &ziel);
+	sint32 intern_calc_route_limited(const vector_tpl<koord3d> &start, const vector_tpl<koord3d> &ziel);
+	sint32 intern_calc_route_bidirectional(search_t &forward, search_t &backward);
 	void intern_calc_straight_route(const koord3d start, const koord3d ziel);
 
 	sint32 intern_calc_route_elevated(const koord3d start, const koord3d ziel);
@@ -221,6 +257,22 @@ public:
 	 */
 	void set_keep_city_roads(bool yesno) { keep_existing_city_roads = yesno; }
 
+	/**
+	 * Options for long routes, which otherwise easily exceed the node limit:
+	 * Search from both ends at once. This finds a route much faster, but not always the cheapest one.
+	 */
+	void set_bidirectional(bool yesno) { bidirectional = yesno; }
+
+	/**
+	 * Only search within @p margin tiles around the rectangle spanned by start and target (-1: everywhere)
+	 */
+	void set_corridor(sint16 margin) { corridor = margin; }
+
+	/**
+	 * Guide the search around mountains by an estimate from the heights on a coarse grid
+	 */
+	void set_coarse_heuristic(bool yesno) { coarse_heuristic = yesno; }
+
 	void set_build_sidewalk(bool yesno) { build_sidewalk = yesno; }
 
 	void init_builder(bautyp_t wt, const way_desc_t * desc, const tunnel_desc_t *tunnel_desc=NULL, const bridge_desc_t *bridge_desc=NULL);
@@ -94,6 +94,8 @@ sint32 env_t::additional_client_frames_behind = 4;
 sint32 env_t::network_frames_per_step = 4;
 uint32 env_t::server_sync_steps_between_checks = 24;
 bool env_t::pause_server_no_clients = false;
+bool env_t::server_join_sync_all = true;
+bool env_t::server_join_delta = true;
 
 std::string env_t::nickname = "";
 
@@ -166,10 +168,13 @@ sint32 env_t::intercity_road_length;
 plainstring env_t::river_type[10];
 uint8 env_t::river_types;
 sint32 env_t::autosave;
+bool env_t::background_autosave;
 uint32 env_t::fps;
 uint32 env_t::ff_fps;
 sint16 env_t::max_acceleration;
 uint8 env_t::num_threads;
+bool env_t::parallel_convoi_step;
+bool env_t::halt_route_cache;
 bool env_t::show_tooltips;
 rgb888_t env_t::tooltip_color_rgb;
 PIXVAL env_t::tooltip_color;
@@ -183,6 +188,8 @@ rgb888_t env_t::background_color_rgb;
 PIXVAL env_t::background_color;
 bool env_t::draw_earth_border;
 bool env_t::draw_outside_tile;
+bool env_t::world_layer_cache;
+uint32 env_t::image_cache_size;
 uint8 env_t::show_vehicle_states;
 bool env_t::visualize_schedule;
 sint8 env_t::daynight_level;
@@ -292,6 +299,7 @@ void env_t::init()
 
 	// autosave every x months (0=off)
 	autosave = 0;
+	background_autosave = true;
 
 	reload_and_save_on_quit = true;
 
@@ -307,6 +315,8 @@ void env_t::init()
 #else
 	num_threads = 1;
 #endif
+	parallel_convoi_step = false;
+	halt_route_cache = true;
 
 	sound_distance_scaling = 10;
 
@@ -322,6 +332,8 @@ void env_t::init()
 	background_color_rgb = { 0x40, 0x40, 0x40 }; // COL_GREY2
 	draw_earth_border = true;
 	draw_outside_tile = false;
+	world_layer_cache = true;
+	image_cache_size = 256;
 
 	show_vehicle_states = 1;
 
@@ -118,6 +118,7 @@ public:
 	/// if true save game under autosave-#paksetname#.sve and reload it upon startup
 	static bool reload_and_save_on_quit;
 
+	/// 0=off, 1=full game state hash, 2=full game state hash and rotating saves, 3=game state digest, 4=digest cross-checked with full hash
 	static uint8 network_heavy_mode;
 	/// @} end of Network-related settings
 
@@ -162,6 +163,12 @@ public:
 	/// pause server if no client connected
 	static bool pause_server_no_clients;
 
+	/// if false, only a joining client gets the game; the other clients continue without reloading
+	static bool server_join_sync_all;
+
+	/// send joining clients only the difference to a game they already got from us
+	static bool server_join_delta;
+
 	/// nickname of player
 	static std::string nickname;
 
@@ -365,6 +372,12 @@ public:
 	/// true if the outside tiles should be shown
 	static bool draw_outside_tile;
 
+	/// keep the rendered world between frames and redraw only its dirty parts
+	static bool world_layer_cache;
+
+	/// MB for images zoomed and recoloured ahead of time for other zoom levels and the next day/night level
+	static uint32 image_cache_size;
+
 	/**
 	 * Show labels (city and station names, ...)
 	 * and waiting indicator bar for stations
@@ -450,6 +463,12 @@ public:
 	/// number of threads to use (if MULTI_THREAD defined)
 	static uint8 num_threads;
 
+	/// search convoi routes in parallel before stepping them (same results as serial)
+	static bool parallel_convoi_step;
+
+	/// reuse results of halt route searches while the connections do not change (same results as without)
+	static bool halt_route_cache;
+
 	/// false to quit the programs
 	static bool quit_simutrans;
 
@@ -493,6 +512,9 @@ public:
 	/// do autosave every month?
 	static sint32 autosave;
 
+	/// compress and write autosaves in the background while the game continues
+	static bool background_autosave;
+
 
 	/**
 	 * @name Midi/sound options
@@ -0,0 +1,233 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "goods_storage.h"
+
+#include <algorithm>
+#include <functional>
+
+
+// below this many slots, scanning is faster than keeping an index up to date
+#define INDEX_MIN_SLOTS (128)
+
+const uint32 goods_storage_t::NO_SLOT;
+
+
+uint64 goods_storage_t::get_destination_key(const ware_t &ware)
+{
+	// the target halt varies most, so it goes into the lower bits used for hashing
+	uint64 key = ware.get_target_halt().get_id() | ((uint64)ware.get_index() << 16) | ((uint64)ware.to_factory << 24);
+	if(  ware.to_factory  ) {
+		const koord pos = ware.get_target_pos();
+		key |= ((uint64)(uint16)pos.x << 25) | ((uint64)(uint16)pos.y << 41);
+	}
+	return key;
+}
+
+
+// slot lists of the index are kept sorted, so their order does not depend on the order of changes
+static void insert_slot(vector_tpl<uint32> &list, uint32 slot)
+{
+	list.insert_at( std::lower_bound( list.begin(), list.end(), slot ) - list.begin(), slot );
+}
+
+
+static void remove_slot(vector_tpl<uint32> &list, uint32 slot)
+{
+	uint32 *pos = std::lower_bound( list.begin(), list.end(), slot );
+	assert( pos != list.end()  &&  *pos == slot );
+	list.remove_at( pos - list.begin() );
+}
+
+
+void goods_storage_t::add_to_index(uint32 slot)
+{
+	const ware_t &ware = packets[slot];
+
+	const uint64 key = get_destination_key(ware);
+	index->by_destination.put(key);
+	insert_slot( *index->by_destination.access(key), slot );
+
+	const uint16 via = ware.get_via_halt().get_id();
+	index->by_via.put(via);
+	insert_slot( *index->by_via.access(via), slot );
+}
+
+
+void goods_storage_t::remove_from_index(uint32 slot)
+{
+	const ware_t &ware = packets[slot];
+
+	const uint64 key = get_destination_key(ware);
+	vector_tpl<uint32> *same = index->by_destination.access(key);
+	remove_slot( *same, slot );
+	if(  same->empty()  ) {
+		index->by_destination.remove(key);
+	}
+
+	const uint16 via = ware.get_via_halt().get_id();
+	vector_tpl<uint32> *list = index->by_via.access(via);
+	remove_slot( *list, slot );
+	if(  list->empty()  ) {
+		index->by_via.remove(via);
+	}
+}
+
+
+void goods_storage_t::add_empty_slot(uint32 slot)
+{
+	// descending order
+	vector_tpl<uint32> &list = index->empty_slots;
+	list.insert_at( std::lower_bound( list.begin(), list.end(), slot, std::greater<uint32>() ) - list.begin(), slot );
+}
+
+
+void goods_storage_t::remove_empty_slot(uint32 slot)
+{
+	vector_tpl<uint32> &list = index->empty_slots;
+	uint32 *pos = std::lower_bound( list.begin(), list.end(), slot, std::greater<uint32>() );
+	assert( pos != list.end()  &&  *pos == slot );
+	list.remove_at( pos - list.begin() );
+}
+
+
+void goods_storage_t::rebuild_index()
+{
+	delete index;
+	index = new index_t();
+	// from the highest, so the empty slots are appended in descending order
+	for(  uint32 slot = packets.get_count();  slot-- > 0;  ) {
+		if(  packets[slot].amount > 0  ) {
+			add_to_index(slot);
+		}
+		else {
+			index->empty_slots.append(slot);
+		}
+	}
+}
+
+
+uint32 goods_storage_t::add(const ware_t &ware)
+{
+	if(  ware.amount == 0  ) {
+		return NO_SLOT;
+	}
+
+	uint32 slot = NO_SLOT;
+	if(  index  ) {
+		if(  !index->empty_slots.empty()  ) {
+			slot = index->empty_slots.pop_back();
+		}
+	}
+	else {
+		for(  uint32 i = 0;  i < packets.get_count();  i++  ) {
+			if(  packets[i].amount == 0  ) {
+				slot = i;
+				break;
+			}
+		}
+	}
+
+	if(  slot == NO_SLOT  ) {
+		slot = packets.get_count();
+		packets.append(ware);
+		if(  index == NULL  &&  packets.get_count() >= INDEX_MIN_SLOTS  ) {
+			rebuild_index();
+			return slot;
+		}
+	}
+	else {
+		packets[slot] = ware;
+	}
+
+	if(  index  ) {
+		add_to_index(slot);
+	}
+	return slot;
+}
+
+
+void goods_storage_t::append(const ware_t &ware)
+{
+	const uint32 slot = packets.get_count();
+	packets.append(ware);
+	if(  index  ) {
+		if(  ware.amount > 0  ) {
+			add_to_index(slot);
+		}
+		else {
+			add_empty_slot(slot);
+		}
+	}
+	else if(  packets.get_count() >= INDEX_MIN_SLOTS  ) {
+		rebuild_index();
+	}
+}
+
+
+void goods_storage_t::set(uint32 slot, const ware_t &ware)
+{
+	const bool was_empty = packets[slot].amount == 0;
+	if(  index  ) {
+		if(  !was_empty  ) {
+			remove_from_index(slot);
+		}
+		else if(  ware.amount > 0  ) {
+			remove_empty_slot(slot);
+		}
+	}
+
+	packets[slot] = ware;
+
+	if(  index  ) {
+		if(  ware.amount > 0  ) {
+			add_to_index(slot);
+		}
+		else if(  !was_empty  ) {
+			add_empty_slot(slot);
+		}
+	}
+}
+
+
+void goods_storage_t::set_amount(uint32 slot, ware_t::goods_amount_t amount)
+{
+	assert(packets[slot].amount > 0);
+	if(  amount == 0  &&  index  ) {
+		remove_from_index(slot);
+		add_empty_slot(slot);
+	}
+	packets[slot].amount = amount;
+}
+
+
+uint32 goods_storage_t::find_same_destination(const ware_t &ware) const
+{
+	if(  index  ) {
+		const vector_tpl<uint32> &same = index->by_destination.get(get_destination_key(ware));
+		return same.empty() ? NO_SLOT : same[0];
+	}
+	for(  uint32 slot = 0;  slot < packets.get_count();  slot++  ) {
+		if(  packets[slot].amount > 0  &&  ware.same_destination(packets[slot])  ) {
+			return slot;
+		}
+	}
+	return NO_SLOT;
+}
+
+
+const vector_tpl<uint32> &goods_storage_t::get_slots_via(halthandle_t via, vector_tpl<uint32> &buf) const
+{
+	if(  index  ) {
+		return index->by_via.get(via.get_id());
+	}
+	buf.clear();
+	for(  uint32 slot = 0;  slot < packets.get_count();  slot++  ) {
+		if(  packets[slot].amount > 0  &&  packets[slot].get_via_halt() == via  ) {
+			buf.append(slot);
+		}
+	}
+	return buf;
+}
@@ -0,0 +1,103 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_GOODS_STORAGE_H
+#define DATAOBJ_GOODS_STORAGE_H
+
+
+#include "../simware.h"
+#include "../tpl/vector_tpl.h"
+#include "../tpl/inthashtable_tpl.h"
+
+
+/**
+ * Goods of one category waiting at a halt.
+ * Packets keep their slot, emptied slots are reused by later packets.
+ * Once there are many packets, an index finds the packet an arriving one
+ * is joined with and the packets for a next stop without scanning all of them.
+ * All results only depend on the slots (empty ones included), not on the
+ * index or the order of changes, so a saved and loaded storage behaves the same.
+ */
+class goods_storage_t
+{
+public:
+	static const uint32 NO_SLOT = 0xFFFFFFFFu;
+
+private:
+	vector_tpl<ware_t> packets;
+
+	struct index_t
+	{
+		/// ascending slots of the non-empty packets for each destination (see ware_t::same_destination)
+		inthashtable_tpl<uint64, vector_tpl<uint32> > by_destination;
+
+		/// ascending slots of the non-empty packets by next stop (via halt), those without route under the unbound handle
+		inthashtable_tpl<uint16, vector_tpl<uint32> > by_via;
+
+		/// descending, so the lowest is taken first
+		vector_tpl<uint32> empty_slots;
+	};
+
+	/// only built for many packets, small storages are just scanned
+	index_t *index;
+
+	static uint64 get_destination_key(const ware_t &ware);
+
+	void add_to_index(uint32 slot);
+	void remove_from_index(uint32 slot);
+	void add_empty_slot(uint32 slot);
+	void remove_empty_slot(uint32 slot);
+	void rebuild_index();
+
+	goods_storage_t(const goods_storage_t &);
+	goods_storage_t &operator=(const goods_storage_t &);
+
+public:
+	goods_storage_t() : index(NULL) {}
+	~goods_storage_t() { delete index; }
+
+	/// @return number of slots, empty ones included
+	uint32 get_count() const { return packets.get_count(); }
+	bool empty() const { return packets.empty(); }
+
+	const ware_t &operator[](uint32 slot) const { return packets[slot]; }
+
+	vector_tpl<ware_t>::const_iterator begin() const { return packets.begin(); }
+	vector_tpl<ware_t>::const_iterator end() const { return packets.end(); }
+
+	const vector_tpl<ware_t> &get_packets() const { return packets; }
+
+	/**
+	 * Stores a packet in the lowest empty slot, empty packets are not stored
+	 * @return the slot or NO_SLOT
+	 */
+	uint32 add(const ware_t &ware);
+
+	/**
+	 * Stores a packet, also an empty one, after the last slot.
+	 * Used for loading, which keeps the slots as they were saved.
+	 */
+	void append(const ware_t &ware);
+
+	/// replaces the packet in slot, an empty packet frees it
+	void set(uint32 slot, const ware_t &ware);
+
+	/// changes only the amount of a non-empty packet, zero frees the slot
+	void set_amount(uint32 slot, ware_t::goods_amount_t amount);
+
+	/**
+	 * @return lowest slot of a non-empty packet ware can be joined with, NO_SLOT if none
+	 */
+	uint32 find_same_destination(const ware_t &ware) const;
+
+	/**
+	 * Ascending slots of the non-empty packets leaving at next stop via.
+	 * The result is only valid until the next change of the storage.
+	 * @param buf used for small storages, which have no index
+	 */
+	const vector_tpl<uint32> &get_slots_via(halthandle_t via, vector_tpl<uint32> &buf) const;
+};
+
+#endif
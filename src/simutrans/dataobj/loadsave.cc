@@ -10,6 +10,8 @@
 #include <assert.h>
 #include <errno.h>
 
+#include <algorithm>
+
 #include "../sys/simsys.h"
 #include "../simtypes.h"
 #include "../macros.h"
@@ -29,6 +31,7 @@
 #include "../io/rdwr/zstd_file_rdwr_stream.h"
 #endif
 #include "../io/rdwr/compare_file_rd_stream.h"
+#include "../io/rdwr/memory_rdwr_stream.h"
 
 #define INVALID_RDWR_ID (-1)
 
@@ -342,33 +345,34 @@ loadsave_t::file_status_t loadsave_t::rd_open(const char *filename_utf8)
 		// fallthrough
 	case file_info_t::TYPE_ZSTD:
 		mode |= zstd;
-#if USE_ZSTD
-		stream = new zstd_file_rdwr_stream_t(filename_utf8, false, 0); break;
-#else
+#if !USE_ZSTD
 		dbg->warning("loadsave_t::rd_open", "Cannot read from '%s': Unsupported save file compression 'zstd'", filename_utf8);
 		return FILE_STATUS_ERR_UNSUPPORTED_COMPRESSION;
 #endif
+		break;
 
 	case file_info_t::TYPE_XML_BZIP2:
 		mode = xml;
 		// fallthrough
 	case file_info_t::TYPE_BZIP2:
 		mode |= bzip2;
-		stream = new bzip2_file_rdwr_stream_t(filename_utf8, false); break;
+		break;
 
 	case file_info_t::TYPE_XML_ZIPPED:
 		mode = xml;
 		// fallthrough
 	case file_info_t::TYPE_ZIPPED:
 		mode |= zipped;
-		stream = new zlib_file_rdwr_stream_t(filename_utf8, false, 0); break;
+		break;
 
 	case file_info_t::TYPE_XML:
 		mode = xml;
-		// fallthrough
+		break;
+
 	default:
-		stream = new raw_file_rdwr_stream_t(filename_utf8, false); break;
+		break;
 	}
+	stream = create_read_stream( filename_utf8, finfo.file_type );
 
 	if (!stream || stream->get_status() != rdwr_stream_t::STATUS_OK) {
 		const char *errmsg = close();
@@ -400,7 +404,141 @@ loadsave_t::file_status_t loadsave_t::rd_open(const char *filename_utf8)
 }
 
 
+rdwr_stream_t *loadsave_t::create_read_stream(const char *filename, file_info_t::file_type_t file_type)
+{
+	switch (file_type & ~file_info_t::TYPE_XML) {
+#if USE_ZSTD
+	case file_info_t::TYPE_ZSTD:   return new zstd_file_rdwr_stream_t(filename, false, 0);
+#endif
+	case file_info_t::TYPE_BZIP2:  return new bzip2_file_rdwr_stream_t(filename, false);
+	case file_info_t::TYPE_ZIPPED: return new zlib_file_rdwr_stream_t(filename, false, 0);
+	case file_info_t::TYPE_RAW:    return new raw_file_rdwr_stream_t(filename, false);
+	default:                       return NULL;
+	}
+}
+
+
+rdwr_stream_t *loadsave_t::create_write_stream(const char *filename, int mode, int level)
+{
+	switch (mode & ~xml) {
+#if USE_ZSTD
+	case zstd:   return new zstd_file_rdwr_stream_t(filename, true, level);
+#endif
+	case bzip2:  return new bzip2_file_rdwr_stream_t(filename, true);
+	case zipped: return new zlib_file_rdwr_stream_t(filename, true, level);
+	case binary: return new raw_file_rdwr_stream_t(filename, true);
+	default:     return NULL;
+	}
+}
+
+
+/*
+ * Background saving: the game is serialized into memory chunks, which is fast.
+ * Compressing and writing to disk is done by this thread, while the game is
+ * serialized and afterwards while the game continues.
+ */
+struct background_save_t
+{
+	std::string filename;
+	std::string rename_to;
+	int mode;
+	int level;
+	memory_rdwr_stream_t *queue;
+	bool started;       ///< false if written by close() instead
+	const char *errmsg; ///< untranslated, reported by finish_background_save()
+};
+
+// serializing waits while this much is not yet compressed
+#define BACKGROUND_SAVE_MAX_QUEUED (256 << 20)
+
+static background_save_t *background_save = NULL;
+#ifdef MULTI_THREAD
+static pthread_t background_save_pthread;
+#endif
+
+
+void *background_save_thread(void *ptr)
+{
+	background_save_t *job = (background_save_t *)ptr;
+
+	rdwr_stream_t *s = loadsave_t::create_write_stream( job->filename.c_str(), job->mode, job->level );
+	if(  s == NULL  ) {
+		job->errmsg = "Unknown error";
+		job->queue->cancel();
+		return NULL;
+	}
+	size_t chunk_len;
+	while(  char *chunk = job->queue->pop_chunk( chunk_len )  ) {
+		// in pieces as large as the loadsave buffers, which every stream can take at once
+		for(  size_t pos = 0;  pos < chunk_len  &&  s->get_status() == rdwr_stream_t::STATUS_OK;  pos += LS_BUF_SIZE  ) {
+			s->write( chunk + pos, std::min<size_t>( chunk_len - pos, LS_BUF_SIZE ) );
+		}
+		free( chunk );
+		if(  s->get_status() != rdwr_stream_t::STATUS_OK  ) {
+			// the serializing must not wait for us any more
+			job->queue->cancel();
+			break;
+		}
+	}
+	job->errmsg = loadsave_t::get_status_message( s );
+	delete s;
+
+	if(  job->errmsg == NULL  &&  job->queue->is_cancelled()  ) {
+		// serializing failed, which is reported by close()
+		dr_remove( job->filename.c_str() );
+	}
+	else if(  job->errmsg == NULL  &&  !job->rename_to.empty()  ) {
+		dr_rename( job->filename.c_str(), job->rename_to.c_str() );
+	}
+	return NULL;
+}
+
+
 loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t m, int level, const char *pak_extension, const char *savegame_version )
+{
+	return open_for_writing( filename_utf8, m, level, pak_extension, savegame_version, false );
+}
+
+
+loadsave_t::file_status_t loadsave_t::wr_open_background( const char *filename_utf8, const char *rename_to, mode_t m, int level, const char *pak_extension, const char *savegame_version )
+{
+	// only one background save at a time
+	if(  const char *prev_errmsg = finish_background_save()  ) {
+		dbg->warning( "loadsave_t::wr_open_background()", "Previous background save failed: %s", prev_errmsg );
+	}
+
+	const file_status_t status = open_for_writing( filename_utf8, m, level, pak_extension, savegame_version, true );
+	if(  status == FILE_STATUS_OK  &&  dynamic_cast<memory_rdwr_stream_t *>(stream)  ) {
+		// the working directory may change until the thread opens the file
+		const bool absolute = filename_utf8[0] == '/'  ||  filename_utf8[0] == '\\'  ||  (filename_utf8[0]  &&  filename_utf8[1] == ':');
+		char cwd[PATH_MAX];
+		std::string path;
+		if(  !absolute  &&  dr_getcwd( cwd, lengthof(cwd) )  ) {
+			path = cwd;
+			path += PATH_SEPARATOR;
+		}
+
+		background_save = new background_save_t;
+		background_save->filename = path + filename_utf8;
+		background_save->rename_to = rename_to ? path + rename_to : std::string();
+		background_save->mode = mode;
+		background_save->level = level;
+		background_save->queue = (memory_rdwr_stream_t *)stream;
+		background_save->errmsg = NULL;
+		background_save->started = false;
+#ifdef MULTI_THREAD
+		background_save->started = pthread_create( &background_save_pthread, NULL, background_save_thread, background_save ) == 0;
+#endif
+		if(  background_save->started  ) {
+			// compressed meanwhile, so only a part of the game needs to be in memory
+			background_save->queue->set_max_queued( BACKGROUND_SAVE_MAX_QUEUED );
+		}
+	}
+	return status;
+}
+
+
+loadsave_t::file_status_t loadsave_t::open_for_writing( const char *filename_utf8, mode_t m, int level, const char *pak_extension, const char *savegame_version, bool in_memory )
 {
 	mode = m;
 	close();
@@ -415,14 +553,14 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 
 	assert(stream == NULL);
 
-	switch (mode & ~xml) {
-#if USE_ZSTD
-	case zstd: stream = new zstd_file_rdwr_stream_t(filename_utf8, true, level); break;
-#endif
-	case bzip2:  stream = new bzip2_file_rdwr_stream_t(filename_utf8, true);       break;
-	case zipped: stream = new zlib_file_rdwr_stream_t(filename_utf8, true, level); break;
-	case binary: stream = new raw_file_rdwr_stream_t(filename_utf8, true);         break;
-	default:
+	const int compression = mode & ~xml;
+	if(  in_memory  &&  (compression == binary  ||  compression == zipped  ||  compression == bzip2  ||  compression == zstd)  ) {
+		stream = new memory_rdwr_stream_t();
+	}
+	else {
+		stream = create_write_stream( filename_utf8, mode, level );
+	}
+	if(  stream == NULL  ) {
 		dbg->error("loadsave_t::wr_open", "Unsupported save file compression");
 		return FILE_STATUS_ERR_UNSUPPORTED_COMPRESSION;
 	}
@@ -475,6 +613,47 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 }
 
 
+const char *loadsave_t::get_status_message(const rdwr_stream_t *s)
+{
+	switch (s->get_status()) {
+		case rdwr_stream_t::STATUS_OK:
+		case rdwr_stream_t::STATUS_EOF:                   return NULL;
+
+		case rdwr_stream_t::STATUS_ERR_NOT_INITIALIZED:   return "Not initialized";
+		case rdwr_stream_t::STATUS_ERR_GENERIC_ERROR:     return "Unknown error";
+		case rdwr_stream_t::STATUS_ERR_FILE_INACCESSIBLE: return "Could not open file";
+		case rdwr_stream_t::STATUS_ERR_FULL:              return "Not enough empty space";
+		case rdwr_stream_t::STATUS_ERR_WRITEFAILURE:      return "Failed to write file";
+		case rdwr_stream_t::STATUS_ERR_NO_VERSION:        return "Unversioned save file";     // unused
+		case rdwr_stream_t::STATUS_ERR_FUTURE_VERSION:    return "Save file version too new"; // unused
+		case rdwr_stream_t::STATUS_ERR_OBSOLETE_VERSION:  return "Save file version too old"; // unused
+		case rdwr_stream_t::STATUS_ERR_CORRUPT:           return "Corrupt file";
+	}
+	return NULL;
+}
+
+
+const char *loadsave_t::finish_background_save()
+{
+	if(  background_save == NULL  ) {
+		return NULL;
+	}
+#ifdef MULTI_THREAD
+	if(  background_save->started  ) {
+		pthread_join( background_save_pthread, NULL );
+	}
+#endif
+	const char *errmsg = background_save->errmsg;
+	if(  errmsg  ) {
+		dbg->error( "loadsave_t::finish_background_save()", "Could not save '%s': %s", background_save->filename.c_str(), errmsg );
+	}
+	delete background_save->queue;
+	delete background_save;
+	background_save = NULL;
+	return errmsg ? translator::translate(errmsg) : NULL;
+}
+
+
 const char *loadsave_t::close()
 {
 	if (!stream) {
@@ -492,22 +671,24 @@ const char *loadsave_t::close()
 		set_buffered(false);
 	}
 
-	const char *errmsg = NULL;
+	const char *errmsg = get_status_message( stream );
 
-	switch (stream->get_status()) {
-		case rdwr_stream_t::STATUS_OK:
-		case rdwr_stream_t::STATUS_EOF:
-			errmsg = NULL; break;
-
-		case rdwr_stream_t::STATUS_ERR_NOT_INITIALIZED:   errmsg = "Not initialized";                                    break;
-		case rdwr_stream_t::STATUS_ERR_GENERIC_ERROR:     errmsg = "Unknown error";                                      break;
-		case rdwr_stream_t::STATUS_ERR_FILE_INACCESSIBLE: errmsg = "Could not open file";                                break;
-		case rdwr_stream_t::STATUS_ERR_FULL:              errmsg = "Not enough empty space";                             break;
-		case rdwr_stream_t::STATUS_ERR_WRITEFAILURE:      errmsg = "Failed to write file";                               break;
-		case rdwr_stream_t::STATUS_ERR_NO_VERSION:        errmsg = "Unversioned save file";                              break; // unused
-		case rdwr_stream_t::STATUS_ERR_FUTURE_VERSION:    errmsg = "Save file version too new";                          break; // unused
-		case rdwr_stream_t::STATUS_ERR_OBSOLETE_VERSION:  errmsg = "Save file version too old";                          break; // unused
-		case rdwr_stream_t::STATUS_ERR_CORRUPT:           errmsg = "Corrupt file";                                       break;
+	if(  background_save  &&  background_save->queue == stream  ) {
+		// the background save owns the stream now
+		if(  errmsg  ) {
+			background_save->queue->cancel();
+		}
+		background_save->queue->finish();
+		if(  !background_save->started  ) {
+			// no thread => write it now
+			background_save_thread( background_save );
+			if(  errmsg == NULL  ) {
+				errmsg = background_save->errmsg;
+				background_save->errmsg = NULL;
+			}
+			finish_background_save();
+		}
+		stream = NULL;
 	}
 
 	delete stream;
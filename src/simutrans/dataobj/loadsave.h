@@ -104,6 +104,16 @@ protected:
 
 	bool is_xml() const { return mode&xml; }
 
+	file_status_t open_for_writing(const char *filename, mode_t mode, int level, const char *pak_extension, const char *savegame_version, bool in_memory);
+
+	/// the stream for writing the actual file
+	static rdwr_stream_t *create_write_stream(const char *filename, int mode, int level);
+
+	/// error message (untranslated) for the status of @p s, NULL if ok
+	static const char *get_status_message(const rdwr_stream_t *s);
+
+	friend void *background_save_thread(void *ptr);
+
 public:
 	static mode_t save_mode;     ///< default to use for saving
 	static mode_t autosave_mode; ///< default to use for autosaves and network mode client temp saves
@@ -130,6 +140,20 @@ public:
 	/// Open save file for writing.
 	file_status_t wr_open(const char *filename, mode_t mode, int level, const char *pak_extension, const char *savegame_version );
 
+	/**
+	 * Like wr_open(), but the data is only collected in memory. close() then hands it
+	 * to a background thread, which compresses and writes it to @p filename and
+	 * afterwards renames the file to @p rename_to (unless NULL).
+	 * Only one background save runs at a time; a new one waits for the last.
+	 */
+	file_status_t wr_open_background(const char *filename, const char *rename_to, mode_t mode, int level, const char *pak_extension, const char *savegame_version );
+
+	/// Stream to read the uncompressed content of a file classified as @p file_type, NULL if not supported.
+	static rdwr_stream_t *create_read_stream(const char *filename, file_info_t::file_type_t file_type);
+
+	/// Waits until the last background save is written. Returns its error message or NULL.
+	static const char *finish_background_save();
+
 	/// Close an open save file. Returns an error message if saving was unsuccessful, the empty string otherwise.
 	const char *close();
 
@@ -6,6 +6,7 @@
 #include <string.h>
 #include "../simtypes.h"
 #include "../simdebug.h"
+#include "../simmem.h"
 #include "../ground/grund.h"
 #include "marker.h"
 
@@ -13,20 +14,41 @@ marker_t marker_t::the_instance;
 marker_t marker_t::second_instance;
 
 
+// initial size of the table for non-ground tiles
+#define UPPER_INITIAL_SIZE (64)
+
+
+marker_t::marker_t() :
+	bits(NULL),
+	block_generation(NULL),
+	blocks(0),
+	cached_size_x(0),
+	generation(1),
+	upper_mask(UPPER_INITIAL_SIZE-1),
+	upper_count(0)
+{
+	upper = MALLOCN(upper_t, UPPER_INITIAL_SIZE);
+	memset(upper, 0, sizeof(upper_t) * UPPER_INITIAL_SIZE);
+}
+
+
 void marker_t::init(int world_size_x, int world_size_y)
 {
 	// do not reallocate it, if same size ...
 	cached_size_x = world_size_x;
-	int new_bits_length = (world_size_x*world_size_y + bit_mask) / (bit_unit);
+	const uint32 new_blocks = ((uint32)world_size_x*world_size_y + block_mask) >> block_shift;
 
-	if( bits_length != new_bits_length  ) {
-		bits_length = new_bits_length;
-		delete [] bits;
-		if(bits_length) {
-			bits = new unsigned char[bits_length];
-		}
-		else {
-			bits = NULL;
+	if(  blocks != new_blocks  ) {
+		blocks = new_blocks;
+		free(bits);
+		free(block_generation);
+		bits = NULL;
+		block_generation = NULL;
+		if(  blocks  ) {
+			bits = MALLOCN(uint64, blocks);
+			block_generation = MALLOCN(uint16, blocks);
+			// no block is valid
+			memset(block_generation, 0, sizeof(uint16) * blocks);
 		}
 	}
 	unmark_all();
@@ -46,27 +68,83 @@ marker_t& marker_t::instance_second(int world_size_x, int world_size_y)
 
 marker_t::~marker_t()
 {
-	delete [] bits;
+	free(bits);
+	free(block_generation);
+	free(upper);
 }
 
 void marker_t::unmark_all()
 {
-	if(bits) {
-		MEMZERON(bits, bits_length);
+	generation++;
+	if(  generation == 0  ) {
+		// wrapped around: now old marks could become valid again
+		if(  block_generation  ) {
+			memset(block_generation, 0, sizeof(uint16) * blocks);
+		}
+		memset(upper, 0, sizeof(upper_t) * (upper_mask+1));
+		generation = 1;
+	}
+	upper_count = 0;
+}
+
+
+static inline uint32 upper_hash(const grund_t *gr)
+{
+	const uintptr_t p = (uintptr_t)gr;
+	const uint32 h = (uint32)(p >> 4) * 2654435761u;
+	return h ^ (h >> 16);
+}
+
+
+marker_t::upper_t *marker_t::find_upper(const grund_t *gr) const
+{
+	// the table is at most half full, so there is always a free entry to stop at
+	for(  uint32 i = upper_hash(gr) & upper_mask;  upper[i].generation == generation;  i = (i+1) & upper_mask  ) {
+		if(  upper[i].gr == gr  ) {
+			return upper+i;
+		}
+	}
+	return NULL;
+}
+
+
+void marker_t::insert_upper(const grund_t *gr)
+{
+	if(  2*(upper_count+1) > upper_mask+1  ) {
+		// double the size and keep only the entries of this generation
+		upper_t *old = upper;
+		const uint32 old_size = upper_mask+1;
+		upper_mask = 2*old_size - 1;
+		upper = MALLOCN(upper_t, upper_mask+1);
+		memset(upper, 0, sizeof(upper_t) * (upper_mask+1));
+		upper_count = 0;
+		for(  uint32 i = 0;  i < old_size;  i++  ) {
+			if(  old[i].generation == generation  &&  old[i].gr  ) {
+				insert_upper(old[i].gr);
+			}
+		}
+		free(old);
 	}
-	more.clear();
+	uint32 i = upper_hash(gr) & upper_mask;
+	while(  upper[i].generation == generation  ) {
+		i = (i+1) & upper_mask;
+	}
+	upper[i].gr = gr;
+	upper[i].generation = generation;
+	upper_count++;
 }
 
+
 void marker_t::mark(const grund_t *gr)
 {
 	if(gr != NULL) {
 		if(gr->ist_karten_boden()) {
 			// ground level
-			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			bits[bit/bit_unit] |= 1 << (bit & bit_mask);
+			const uint32 bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
+			get_block(bit) |= (uint64)1 << (bit & block_mask);
 		}
-		else {
-			more.set(gr, true);
+		else if(  find_upper(gr) == NULL  ) {
+			insert_upper(gr);
 		}
 	}
 }
@@ -76,11 +154,12 @@ void marker_t::unmark(const grund_t *gr)
 	if(gr != NULL) {
 		if(gr->ist_karten_boden()) {
 			// ground level
-			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			bits[bit/bit_unit] &= ~(1 << (bit & bit_mask));
+			const uint32 bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
+			get_block(bit) &= ~((uint64)1 << (bit & block_mask));
 		}
-		else {
-			more.remove(gr);
+		else if(  upper_t *u = find_upper(gr)  ) {
+			// keep the entry, it may be part of a probing sequence
+			u->gr = NULL;
 		}
 	}
 }
@@ -92,11 +171,12 @@ bool marker_t::is_marked(const grund_t *gr) const
 	}
 	if(gr->ist_karten_boden()) {
 		// ground level
-		const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-		return (bits[bit/bit_unit] & (1 << (bit & bit_mask))) != 0;
+		const uint32 bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
+		const uint32 b = bit >> block_shift;
+		return block_generation[b] == generation  &&  ((bits[b] >> (bit & block_mask)) & 1) != 0;
 	}
 	else {
-		return more.get(gr);
+		return find_upper(gr) != NULL;
 	}
 }
 
@@ -105,14 +185,19 @@ bool marker_t::test_and_mark(const grund_t *gr)
 	if(gr != NULL) {
 		if(gr->ist_karten_boden()) {
 			// ground level
-			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			if ((bits[bit/bit_unit] & (1 << (bit & bit_mask))) != 0) {
+			const uint32 bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
+			uint64 &block = get_block(bit);
+			const uint64 mask = (uint64)1 << (bit & block_mask);
+			if(  block & mask  ) {
 				return true;
 			}
-			bits[bit/bit_unit] |= 1 << (bit & bit_mask);
+			block |= mask;
 		}
 		else {
-			return more.set(gr, true);
+			if(  find_upper(gr)  ) {
+				return true;
+			}
+			insert_upper(gr);
 		}
 	}
 	return false;
@@ -7,48 +7,80 @@
 #define DATAOBJ_MARKER_H
 
 
-#include "../tpl/ptrhashtable_tpl.h"
+#include "../simtypes.h"
 
 class grund_t;
 
 /**
  * Class to mark tiles as visited during route search.
- * Singleton.
+ * There are two shared instances; searches running in parallel use their own one.
+ * Every search has its own generation: marks of older generations count as unmarked,
+ * so starting a new search does not need to clear anything.
  */
 class marker_t {
-	// added bit mask, because it allows a more efficient
-	// implementation (use & instead of %)
 	enum {
-		bit_unit = (8 * sizeof(unsigned char)),
-		bit_mask = (8 * sizeof(unsigned char))-1
+		block_shift = 6, ///< 64 ground tiles per block
+		block_mask  = 63
 	};
 
-	/// bit-field to mark ground tiles
-	unsigned char *bits;
+	/// bit-field to mark ground tiles; a block is only valid if its generation is the current one
+	uint64 *bits;
+	uint16 *block_generation;
 
-	/// length of field
-	int bits_length;
+	/// number of blocks
+	uint32 blocks;
 
 	/// bit-field is made for this x-size
 	int cached_size_x;
 
-	/// hashtable to mark non-ground tiles (bridges, tunnels)
-	ptrhashtable_tpl <const grund_t *, bool> more;
+	/// the current generation, never zero
+	uint16 generation;
 
-	marker_t() : bits(NULL) { init(0, 0); }
+	/// open addressing table of marked non-ground tiles (bridges, tunnels)
+	struct upper_t
+	{
+		const grund_t *gr;  ///< NULL if unmarked again
+		uint16 generation;  ///< entry is free if not the current generation
+	};
+	upper_t *upper;
+	uint32 upper_mask;  ///< size of the table minus one
+	uint32 upper_count; ///< entries of the current generation
+
+	/// the instance
+	static marker_t the_instance;
+	static marker_t second_instance;
+
+	inline uint64 &get_block(uint32 bit)
+	{
+		const uint32 b = bit >> block_shift;
+		if(  block_generation[b] != generation  ) {
+			block_generation[b] = generation;
+			bits[b] = 0;
+		}
+		return bits[b];
+	}
+
+	/// @returns the entry of @p gr, NULL if not marked
+	upper_t *find_upper(const grund_t *gr) const;
+
+	/// marks @p gr, which must not be marked already
+	void insert_upper(const grund_t *gr);
+
+	marker_t(const marker_t&);
+	marker_t& operator=(const marker_t&);
+
+public:
+	marker_t();
 	~marker_t();
 
 	/**
 	 * Initializes marker. Set all tiles to not marked.
+	 * Unless the size changes, this only starts a new generation.
 	 * @param world_size_x x-size of map
 	 * @param world_size_y y-size of map
 	 */
 	void init(int world_size_x, int world_size_y);
 
-	/// the instance
-	static marker_t the_instance;
-	static marker_t second_instance;
-public:
 	/**
 	 * Return handle to marker instance.
 	 * @param world_size_x x-size of map
@@ -88,7 +120,7 @@ public:
 	bool test_and_mark(const grund_t *gr);
 
 	/**
-	 * Marks all fields as not visited.
+	 * Marks all fields as not visited by starting a new generation.
 	 */
 	void unmark_all();
 };
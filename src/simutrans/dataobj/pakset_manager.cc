@@ -20,6 +20,42 @@
 #include "../gui/simwin.h"
 #include "../dataobj/environment.h"
 #include "../network/pakset_info.h"
+#include "../tpl/vector_tpl.h"
+#include "../simmem.h"
+
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+#endif
+
+
+/// A node read from a pak file, registered later
+struct pak_node_t
+{
+	obj_reader_t *reader;
+	obj_desc_t **data; ///< where the node is referenced, registering may change it
+	obj_desc_t *desc;
+	bool do_register;
+};
+
+
+/// A pak file which is read and decoded, but not yet registered
+struct pak_file_t
+{
+	std::string filename;
+	const char *end; ///< end of the file data while reading
+	obj_desc_t *root;
+	vector_tpl<pak_node_t> nodes; ///< in the order of registering, i.e. children before their parent
+	bool read; ///< read_pak_file() has finished
+	bool ok;
+
+	explicit pak_file_t(const std::string &name) :
+		filename(name),
+		end(NULL),
+		root(NULL),
+		read(false),
+		ok(false)
+	{}
+};
 
 
 pakset_manager_t::obj_map_t*                                  pakset_manager_t::registered_readers;
@@ -31,6 +67,15 @@ stringhashtable_tpl<missing_level_t>                          pakset_manager_t::
 std::string                                                   pakset_manager_t::overlaid_warning;
 
 
+#ifdef MULTI_THREAD
+// files for read_pak_files_thread(), next_pak_file is the next one to read
+static pthread_mutex_t pak_files_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pak_files_cond = PTHREAD_COND_INITIALIZER;
+static vector_tpl<pak_file_t *> *pak_files = NULL;
+static uint32 next_pak_file = 0;
+#endif
+
+
 static const char* missing_level_to_string[MISSING_WAY + 1] = {
 	"",
 	"factory",
@@ -159,77 +204,185 @@ bool pakset_manager_t::load_paks_from_directory(const std::string &path, bool lo
 
 DBG_MESSAGE("pakset_manager_t::load_paks_from_directory", "Reading from '%s'", path.c_str());
 
-	uint n = 0;
+	// the files are read and decoded by worker threads, but registered here in their order
+	vector_tpl<pak_file_t *> files( max );
 	for (char* const& pak_filename : find) {
-		if (!load_pak_file(pak_filename)) {
-			dbg->warning("pakset_manager_t::load_paks_from_directory", "Cannot load '%s', some objects might be unavailable!", pak_filename);
+		files.append( new pak_file_t(pak_filename) );
+	}
+
+#ifdef MULTI_THREAD
+	pthread_t thread[MAX_THREADS];
+	const int num_threads = env_t::num_threads > 1 ? min( env_t::num_threads, (int)files.get_count() ) : 0;
+	if(  num_threads > 0  ) {
+		pak_files = &files;
+		next_pak_file = 0;
+
+		pthread_attr_t attr;
+		pthread_attr_init( &attr );
+		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_JOINABLE );
+		for(  int t = 0;  t < num_threads;  t++  ) {
+			if(  pthread_create( &thread[t], &attr, read_pak_files_thread, NULL )  ) {
+				dbg->fatal( "pakset_manager_t::load_paks_from_directory", "cannot create thread" );
+			}
+		}
+		pthread_attr_destroy( &attr );
+	}
+#endif
+
+	uint n = 0;
+	for(  pak_file_t *file : files  ) {
+#ifdef MULTI_THREAD
+		if(  num_threads > 0  ) {
+			pthread_mutex_lock( &pak_files_mutex );
+			while(  !file->read  ) {
+				pthread_cond_wait( &pak_files_cond, &pak_files_mutex );
+			}
+			pthread_mutex_unlock( &pak_files_mutex );
+		}
+		else
+#endif
+		{
+			file->ok = read_pak_file( *file );
 		}
 
+		if (file->ok) {
+			register_pak_file( *file );
+		}
+		else {
+			dbg->warning("pakset_manager_t::load_paks_from_directory", "Cannot load '%s', some objects might be unavailable!", file->filename.c_str());
+		}
+		delete file;
+
 		if ((n++ & step) == 0 && drawing) {
 			ls.set_progress(n);
 		}
 	}
 
+#ifdef MULTI_THREAD
+	for(  int t = 0;  t < num_threads;  t++  ) {
+		pthread_join( thread[t], NULL );
+	}
+	pak_files = NULL;
+#endif
+
 	ls.set_progress(max);
 	return find.begin()!=find.end();
 }
 
 
 bool pakset_manager_t::load_pak_file(const std::string &filename)
+{
+	pak_file_t file(filename);
+	if (!read_pak_file(file)) {
+		return false;
+	}
+	register_pak_file(file);
+	return true;
+}
+
+
+bool pakset_manager_t::read_pak_file(pak_file_t &file)
 {
 	// added trace
-	PAKSET_INFO("loading", "name=%s", filename.c_str());
+	PAKSET_INFO("loading", "name=%s", file.filename.c_str());
 
-	FILE* const fp = dr_fopen(filename.c_str(), "rb");
+	FILE* const fp = dr_fopen(file.filename.c_str(), "rb");
 	if (!fp) {
-		dbg->error("pakset_manager_t::load_pak_file", "Reading '%s' failed!", filename.c_str());
+		dbg->error("pakset_manager_t::read_pak_file", "Reading '%s' failed!", file.filename.c_str());
 		return false;
 	}
 
-	// This is the normal header reading code
-	int c;
-	uint32 n = 0;
+	// read the whole file at once instead of each node on its own
+	long size = -1;
+	if (fseek(fp, 0, SEEK_END) == 0) {
+		size = ftell(fp);
+	}
+	if (size <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+		dbg->error("pakset_manager_t::read_pak_file", "Cannot get the size of '%s'!", file.filename.c_str());
+		fclose(fp);
+		return false;
+	}
 
-	do {
-		c = fgetc(fp);
-		n ++;
-	} while(c != EOF && c != 0x1a);
+	char *const buf = MALLOCN(char, size);
+	const bool complete = fread(buf, size, 1, fp) == 1;
+	fclose(fp);
+	if (!complete) {
+		dbg->error("pakset_manager_t::read_pak_file", "Reading '%s' failed!", file.filename.c_str());
+		free(buf);
+		return false;
+	}
 
-	if(c == EOF) {
-		dbg->error("pakset_manager_t::load_pak_file", "Unexpected end of file after %u bytes while reading '%s'!", n, filename.c_str());
-		fclose(fp);
+	// This is the normal header reading code
+	file.end = buf + size;
+	char *pos = (char *)memchr(buf, 0x1a, size);
+	if (pos == NULL) {
+		dbg->error("pakset_manager_t::read_pak_file", "Unexpected end of file after %ld bytes while reading '%s'!", size, file.filename.c_str());
+		free(buf);
 		return false;
 	}
+	pos++;
 
 	// Compiled Version
-	char dummy[4];
-	n = fread(dummy, 4, 1, fp);
-	if (n != 1) {
-		fclose(fp);
+	if (file.end - pos < 4) {
+		free(buf);
 		return false;
 	}
 
-	char *p = dummy;
-	const uint32 version = decode_uint32(p);
+	const uint32 version = decode_uint32(pos);
 
-	PAKSET_INFO("pakset_manager_t::load_pak_file", "%s, reading %u blocks, file version is %x", filename.c_str(), n, version);
+	PAKSET_INFO("pakset_manager_t::read_pak_file", "%s, file version is %x", file.filename.c_str(), version);
 
+	bool ok = false;
 	if(version <= COMPILER_VERSION_CODE) {
-		obj_desc_t *data = NULL;
-		if (!read_nodes(fp, data, 0, version)) {
-			fclose(fp);
-			return false;
-		}
+		ok = read_nodes(file, pos, file.root, 0, version);
 	}
 	else {
-		dbg->warning("pakset_manager_t::load_pak_file", "Version of '%s' is too old, %u instead of %u", filename.c_str(), version, COMPILER_VERSION_CODE );
-		fclose(fp);
-		return false;
+		dbg->warning("pakset_manager_t::read_pak_file", "Version of '%s' is too old, %u instead of %u", file.filename.c_str(), version, COMPILER_VERSION_CODE );
 	}
+	free(buf);
+	file.end = NULL;
 
-	fclose(fp);
-	return true;
+	if (!ok) {
+		// nothing of this file is registered
+		for(pak_node_t const& node : file.nodes) {
+			delete node.desc;
+		}
+		file.nodes.clear();
+	}
+	return ok;
+}
+
+
+void pakset_manager_t::register_pak_file(pak_file_t &file)
+{
+	for(pak_node_t const& node : file.nodes) {
+		if (node.do_register) {
+			node.reader->register_obj(*node.data);
+		}
+	}
+	file.nodes.clear();
+}
+
+
+#ifdef MULTI_THREAD
+void *pakset_manager_t::read_pak_files_thread(void *)
+{
+	pthread_mutex_lock( &pak_files_mutex );
+	while(  next_pak_file < pak_files->get_count()  ) {
+		pak_file_t &file = *(*pak_files)[next_pak_file++];
+		pthread_mutex_unlock( &pak_files_mutex );
+
+		const bool ok = read_pak_file( file );
+
+		pthread_mutex_lock( &pak_files_mutex );
+		file.ok = ok;
+		file.read = true;
+		pthread_cond_broadcast( &pak_files_cond );
+	}
+	pthread_mutex_unlock( &pak_files_mutex );
+	return NULL;
 }
+#endif
 
 
 /*
@@ -328,34 +481,51 @@ void pakset_manager_t::warn_if_paks_missing()
 }
 
 
-static bool read_node_info(obj_node_info_t& node, FILE* const f, uint32 const version)
+static bool read_node_info(obj_node_info_t& node, char *&pos, const char *end, uint32 const version)
 {
-	char data[EXT_OBJ_NODE_INFO_SIZE];
-	if (fread(data, OBJ_NODE_INFO_SIZE, 1, f) != 1) {
+	if (end - pos < OBJ_NODE_INFO_SIZE) {
 		return false;
 	}
 
-	char *p = data;
-	node.type      = decode_uint32(p);
-	node.nchildren = decode_uint16(p);
-	node.size      = decode_uint16(p);
+	node.type      = decode_uint32(pos);
+	node.nchildren = decode_uint16(pos);
+	node.size      = decode_uint16(pos);
 
 	// can have larger records
 	if (version != COMPILER_VERSION_CODE_11 && node.size == LARGE_RECORD_SIZE) {
-		if (fread(p, sizeof(data) - OBJ_NODE_INFO_SIZE, 1, f) != 1) {
+		if (end - pos < EXT_OBJ_NODE_INFO_SIZE - OBJ_NODE_INFO_SIZE) {
+			return false;
+		}
+		node.size = decode_uint32(pos);
+	}
+
+	// the node body must be in the file too
+	return (size_t)(end - pos) >= node.size;
+}
+
+
+static bool skip_nodes(char *&pos, const char *end, uint32 version)
+{
+	obj_node_info_t node;
+	if (!read_node_info(node, pos, end, version)) {
+		return false;
+	}
+	pos += node.size;
+
+	for(int i = 0; i < node.nchildren; i++) {
+		if (!skip_nodes(pos, end, version)) {
 			return false;
 		}
-		node.size = decode_uint32(p);
 	}
 
 	return true;
 }
 
 
-bool pakset_manager_t::read_nodes(FILE *fp, obj_desc_t *&data, int node_depth, uint32 version)
+bool pakset_manager_t::read_nodes(pak_file_t &file, char *&pos, obj_desc_t *&data, int node_depth, uint32 version)
 {
 	obj_node_info_t node;
-	if (!read_node_info(node, fp, version)) {
+	if (!read_node_info(node, pos, file.end, version)) {
 		return false;
 	}
 
@@ -363,7 +533,8 @@ bool pakset_manager_t::read_nodes(FILE *fp, obj_desc_t *&data, int node_depth, u
 
 	if(reader) {
 //		PAKSET_INFO("pakset_manager_t::read_nodes", "Reading %.4s-node of length %d with '%s'", reinterpret_cast<const char *>(&node.type), node.size, reader->get_type_name());
-		data = reader->read_node(fp, node);
+		data = reader->read_node(pos, node);
+		pos += node.size;
 
 		if (!data) {
 			return false;
@@ -373,8 +544,8 @@ bool pakset_manager_t::read_nodes(FILE *fp, obj_desc_t *&data, int node_depth, u
 			data->children = new obj_desc_t *[node.nchildren];
 
 			for (int i = 0; i < node.nchildren; i++) {
-				if (!read_nodes(fp, data->children[i], node_depth + 1, version)) {
-					// Note: cannot delete siblings of data->children[i], since equal images point to the same desc
+				if (!read_nodes(file, pos, data->children[i], node_depth + 1, version)) {
+					// Note: the children read so far are deleted with the other nodes of this file
 					delete data; // data->children is delete[]'d by the destructor
 					data = NULL;
 					return false;
@@ -382,21 +553,22 @@ bool pakset_manager_t::read_nodes(FILE *fp, obj_desc_t *&data, int node_depth, u
 			}
 		}
 
-//DBG_DEBUG("obj_reader_t","registering with '%s'", reader->get_type_name());
-		if(node_depth<2  ||  node.type!=obj_cursor) {
-			// since many buildings are with cursors that do not need registration
-			reader->register_obj(data);
-		}
+		// registered after the children, as when registering right away
+		pak_node_t registration;
+		registration.reader = reader;
+		registration.data = &data;
+		registration.desc = data;
+		// since many buildings are with cursors that do not need registration
+		registration.do_register = node_depth<2  ||  node.type!=obj_cursor;
+		file.nodes.append(registration);
 	}
 	else {
 		// no reader found ...
 		dbg->warning("pakset_manager_t::read_nodes", "Skipping unknown %.4s-node\n", reinterpret_cast<const char *>(&node.type));
-		if (fseek(fp, node.size, SEEK_CUR) != 0) {
-			return false;
-		}
+		pos += node.size;
 
 		for(int i = 0; i < node.nchildren; i++) {
-			if (!skip_nodes(fp,version)) {
+			if (!skip_nodes(pos, file.end, version)) {
 				return false;
 			}
 		}
@@ -408,27 +580,6 @@ bool pakset_manager_t::read_nodes(FILE *fp, obj_desc_t *&data, int node_depth, u
 }
 
 
-bool pakset_manager_t::skip_nodes(FILE *fp,uint32 version)
-{
-	obj_node_info_t node;
-	if (!read_node_info(node, fp, version)) {
-		return false;
-	}
-
-	if (fseek(fp, node.size, SEEK_CUR) != 0) {
-		return false;
-	}
-
-	for(int i = 0; i < node.nchildren; i++) {
-		if (!skip_nodes(fp,version)) {
-			return false;
-		}
-	}
-
-	return true;
-}
-
-
 void pakset_manager_t::resolve_xrefs()
 {
 	slist_tpl<obj_desc_t *> xref_nodes;
@@ -15,6 +15,7 @@
 
 class obj_desc_t;
 class obj_reader_t;
+struct pak_file_t;
 
 
 /// Missing things during loading:
@@ -48,13 +49,24 @@ class pakset_manager_t
 	static unresolved_map_t unresolved;
 	static ptrhashtable_tpl<obj_desc_t **, int> fatals;
 
-	/// Read a descriptor node.
-	/// @param fp File to read from
+	/// Read a descriptor node and its children, without registering them.
+	/// @param file The pak file, collects the nodes to register
+	/// @param[in,out] pos Start of the node in the file data, afterwards behind its last child
 	/// @param[out] data If reading is successful, contains descriptor for the object, else NULL.
-	/// @param register_nodes Nesting level for desc-nodes, should normally be 0
+	/// @param node_depth Nesting level for desc-nodes, should normally be 0
 	/// @param version File format version
-	static bool read_nodes(FILE *fp, obj_desc_t *&data, int register_nodes, uint32 version);
-	static bool skip_nodes(FILE *fp, uint32 version);
+	static bool read_nodes(pak_file_t &file, char *&pos, obj_desc_t *&data, int node_depth, uint32 version);
+
+	/// Reads the file @p file.filename and decodes its nodes. Safe to call from several threads at once.
+	static bool read_pak_file(pak_file_t &file);
+
+	/// Registers the nodes of a file read by read_pak_file() in the order they were read.
+	static void register_pak_file(pak_file_t &file);
+
+#ifdef MULTI_THREAD
+	/// Worker reading the pak files of load_paks_from_directory()
+	static void *read_pak_files_thread(void *);
+#endif
 
 	static std::string doublettes;
 	static std::string overlaid_warning;
@@ -37,6 +37,13 @@
 #include "../sys/simsys.h"
 #endif
 
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+
+// protects the list of unused node pools
+static pthread_mutex_t node_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 
 void route_t::append(const route_t *r)
 {
@@ -105,12 +112,63 @@ bool route_t::append_straight_route(karte_t *welt, koord3d dest )
 
 
 
-// node arrays
-route_t::ANode* route_t::nodes=NULL;
+// node pools
 uint32 route_t::MAX_STEP=0;
-#ifdef DEBUG
-bool route_t::node_in_use=false;
+
+// pools not used by a search at the moment
+static route_t::node_pool_t *free_node_pools = NULL;
+
+
+route_t::node_pool_t::~node_pool_t()
+{
+	for(ANode* block : blocks) {
+		delete [] block;
+	}
+}
+
+
+route_t::node_pool_t *route_t::get_node_pool(karte_t *welt)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &node_pool_mutex );
+#endif
+	MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
+	node_pool_t *pool = free_node_pools;
+	if(  pool  ) {
+		free_node_pools = pool->next_free;
+		pool->next_free = NULL;
+	}
+	else {
+		pool = new node_pool_t();
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &node_pool_mutex );
+#endif
+
+#ifdef USE_VALGRIND_MEMCHECK
+	for(ANode* block : pool->blocks) {
+		VALGRIND_MAKE_MEM_UNDEFINED(block, sizeof(ANode)*node_pool_t::block_size);
+	}
+#endif
+	// clear the queue (should be empty anyhow)
+	pool->queue.clear();
+	pool->marker.init(welt->get_size().x, welt->get_size().y);
+	pool->marker_second.init(welt->get_size().x, welt->get_size().y);
+	return pool;
+}
+
+
+void route_t::release_node_pool(node_pool_t *pool)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &node_pool_mutex );
+#endif
+	pool->next_free = free_node_pools;
+	free_node_pools = pool;
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &node_pool_mutex );
 #endif
+}
 
 /**
  * find the route to an unknown location
@@ -130,12 +188,6 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	// some thing for the search
 	const waytype_t wegtyp = tdriver->get_waytype();
 
-	// memory in static list ...
-	if(  nodes == NULL  ) {
-		MAX_STEP = welt->get_settings().get_max_route_steps();
-		nodes = new ANode[MAX_STEP];
-	}
-
 	INT_CHECK("route 347");
 
 	// we clear it here probably twice: does not hurt ...
@@ -146,16 +198,11 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 		return false;
 	}
 
-	static binary_heap_tpl <ANode *> queue;
-
-	GET_NODE();
-#ifdef USE_VALGRIND_MEMCHECK
-	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
-#endif
-
+	node_pool_t *pool = get_node_pool(welt);
+	binary_heap_tpl <ANode *> &queue = pool->queue;
 
 	uint32 step = 0;
-	ANode* tmp = &nodes[step++];
+	ANode* tmp = pool->get(step++);
 	tmp->parent = NULL;
 	tmp->gr = g;
 	tmp->count = 0;
@@ -170,9 +217,8 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	assert( (uint8)(~ribi_t::reverse_single(tmp->ribi_from)& 0xf)  == start_dir);
 
 	// nothing in lists
-	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y);
+	marker_t& marker = pool->marker;
 
-	queue.clear();
 	queue.insert(tmp);
 
 	bool target_reached = false;
@@ -232,10 +278,10 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 			    && gr->get_neighbour(to, wegtyp, ribi_t::nesw[r])  // is connected
 			    && !marker.is_marked(to) // not already tested
 			    && tdriver->check_next_tile(to) // can be driven on
-				&& step < MAX_STEP // do not overrun nodes[]
+				&& step < MAX_STEP // not too many nodes
 			) {
 				// not in there or taken out => add new
-				ANode* k = &nodes[step++];
+				ANode* k = pool->get(step++);
 
 				k->parent = tmp;
 				k->gr = to;
@@ -286,15 +332,14 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 		ok = !route.empty();
 	}
 
-	RELEASE_NODE();
+	release_node_pool(pool);
 	return ok;
 }
 
 
 
-ribi_t::ribi *get_next_dirs(const koord3d& gr_pos, const koord3d& ziel)
+static void get_next_dirs(const koord3d& gr_pos, const koord3d& ziel, ribi_t::ribi *next_ribi)
 {
-	static ribi_t::ribi next_ribi[4];
 	if( abs(gr_pos.x-ziel.x)>abs(gr_pos.y-ziel.y) ) {
 		next_ribi[0] = (ziel.x>gr_pos.x) ? ribi_t::east : ribi_t::west;
 		next_ribi[1] = (ziel.y>gr_pos.y) ? ribi_t::south : ribi_t::north;
@@ -305,7 +350,6 @@ ribi_t::ribi *get_next_dirs(const koord3d& gr_pos, const koord3d& ziel)
 	}
 	next_ribi[2] = ribi_t::reverse_single( next_ribi[1] );
 	next_ribi[3] = ribi_t::reverse_single( next_ribi[0] );
-	return next_ribi;
 }
 
 
@@ -353,23 +397,13 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 
 	bool ziel_erreicht=false;
 
-	// memory in static list ...
-	if(  nodes == NULL  ) {
-		MAX_STEP = welt->get_settings().get_max_route_steps(); // may need very much memory => configurable
-		nodes = new ANode[MAX_STEP + 4 + 2];
-	}
-
 	INT_CHECK("route 347");
 
-	static binary_heap_tpl <ANode *> queue;
-
-	GET_NODE();
-#ifdef USE_VALGRIND_MEMCHECK
-	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
-#endif
+	node_pool_t *pool = get_node_pool(welt);
+	binary_heap_tpl <ANode *> &queue = pool->queue;
 
 	uint32 step = 0;
-	ANode* tmp = &nodes[step];
+	ANode* tmp = pool->get(step);
 	step ++;
 
 	tmp->parent = NULL;
@@ -382,10 +416,8 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 	tmp->jps_ribi  = ribi_t::all;
 
 	// nothing in lists
-	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y);
+	marker_t& marker = pool->marker;
 
-	// clear the queue (should be empty anyhow)
-	queue.clear();
 	queue.insert(tmp);
 	ANode* new_top = NULL;
 
@@ -445,7 +477,8 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 		// mask direction we came from
 		const ribi_t::ribi ribi =  way_ribi  &  ( ~ribi_t::reverse_single(tmp->ribi_from) )  &  tmp->jps_ribi;
 
-		const ribi_t::ribi *next_ribi = get_next_dirs(gr->get_pos(), ziel);
+		ribi_t::ribi next_ribi[4];
+		get_next_dirs(gr->get_pos(), ziel, next_ribi);
 		for(int r=0; r<4; r++) {
 
 			// a way in our direction?
@@ -525,11 +558,11 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 				const uint32 new_f = new_g + dist + turns * 3 + costup;
 
 				if (step >= MAX_STEP) {
-					break; // Do not overrun nodes[]
+					break; // too many nodes
 				}
 
 				// add new
-				ANode* k = &nodes[step++];
+				ANode* k = pool->get(step++);
 
 				k->parent = tmp;
 				k->gr = to;
@@ -608,7 +641,7 @@ bool route_t::intern_calc_route(karte_t *welt, const koord3d ziel, const koord3d
 		ok = true;
 	}
 
-	RELEASE_NODE();
+	release_node_pool(pool);
 
 	return ok;
 }
@@ -734,7 +767,20 @@ route_t::route_result_t route_t::calc_route(karte_t *welt, const koord3d ziel, c
 	const uint32 ms = dr_time();
 #endif
 
-	bool ok = intern_calc_route(welt, start, ziel, tdriver, max_khm, INT32_MAX);
+	bool ok;
+	prepared_route_t *prepared = tdriver->get_prepared_route();
+	// parameters are named the other way round here (see prepare_route())
+	if(  prepared  &&  prepared->matches(ziel, start, max_khm, tdriver)  ) {
+		// already searched ahead of time
+		ok = prepared->found;
+		swap( route, prepared->route );
+		prepared->invalidate();
+		// like intern_calc_route(), so many prepared routes in a row do not block the screen
+		INT_CHECK("route 339");
+	}
+	else {
+		ok = intern_calc_route(welt, start, ziel, tdriver, max_khm, INT32_MAX);
+	}
 
 #ifdef DEBUG_ROUTES
 	if(tdriver->get_waytype()==water_wt) {
@@ -798,6 +844,27 @@ route_t::route_result_t route_t::calc_route(karte_t *welt, const koord3d ziel, c
 
 
 
+void route_t::prepare_route(karte_t *welt, const koord3d start, const koord3d ziel, test_driver_t *tdriver, const sint32 max_khm, prepared_route_t &prepared)
+{
+	route_t r;
+	// same order as calc_route() uses, since the search starts from the target
+	prepared.found = r.intern_calc_route(welt, ziel, start, tdriver, max_khm, INT32_MAX);
+	prepared.start = start;
+	prepared.ziel = ziel;
+	prepared.max_speed = max_khm;
+	prepared.driver = tdriver;
+	prepared.restrictions = tdriver->get_route_restrictions();
+	swap( prepared.route, r.route );
+	prepared.valid = true;
+}
+
+
+bool prepared_route_t::matches(koord3d s, koord3d z, sint32 kmh, const test_driver_t *tdriver) const
+{
+	return valid  &&  start==s  &&  ziel==z  &&  max_speed==kmh  &&  driver==tdriver  &&  restrictions==tdriver->get_route_restrictions();
+}
+
+
 void route_t::rdwr(loadsave_t *file)
 {
 	xml_tag_t r( file, "route_t" );
@@ -10,8 +10,10 @@
 #include "../simdebug.h"
 
 #include "../dataobj/koord3d.h"
+#include "../dataobj/marker.h"
 
 #include "../tpl/vector_tpl.h"
+#include "../tpl/binary_heap_tpl.h"
 
 
 class karte_t;
@@ -19,6 +21,34 @@ class test_driver_t;
 class grund_t;
 
 
+/**
+ * Result of a route search done ahead of time (i.e. in the parallel phase of karte_t::step()).
+ * route_t::calc_route() uses it instead of searching again, if start, target, speed and driver are the same.
+ */
+class prepared_route_t
+{
+	friend class route_t;
+
+	koord3d start;
+	koord3d ziel;
+	sint32 max_speed;
+	const test_driver_t *driver;
+	uint32 restrictions; ///< test_driver_t::get_route_restrictions() of driver
+	bool valid;
+	bool found;
+	koord3d_vector_t route;
+
+public:
+	prepared_route_t() : max_speed(0), driver(NULL), restrictions(0), valid(false), found(false) {}
+
+	bool is_valid() const { return valid; }
+
+	void invalidate() { valid = false; }
+
+	bool matches(koord3d s, koord3d z, sint32 kmh, const test_driver_t *tdriver) const;
+};
+
+
 /**
  * Route, e.g. for vehicles
  */
@@ -69,17 +99,57 @@ public:
 		inline bool operator <= (const ANode &k) const { return f==k.f ? g<=k.g : f<=k.f; }
 	};
 
-	static ANode *nodes;
+	/**
+	 * Everything a single search needs: the nodes, the open list and the closed list.
+	 * Every running search has its own pool, so searches from several threads do not disturb each other.
+	 * Nodes are allocated in blocks when the search gets that far, so small searches stay small.
+	 */
+	class node_pool_t {
+		friend class route_t;
+
+		enum { block_shift = 12, block_size = 1 << block_shift };
+
+		vector_tpl<ANode *> blocks;
+
+		/// next pool in the list of unused pools
+		node_pool_t *next_free;
+
+		node_pool_t() : next_free(NULL) {}
+		~node_pool_t();
+
+	public:
+		binary_heap_tpl<ANode *> queue;
+
+		/// closed list
+		marker_t marker;
+
+		/// second closed list (way builder: tiles above the ground)
+		marker_t marker_second;
+
+		/**
+		 * @returns node number @p i, a new block is allocated if needed.
+		 * Pointers stay valid until the pool is released.
+		 */
+		ANode *get(uint32 i)
+		{
+			const uint32 b = i >> block_shift;
+			while(  b >= blocks.get_count()  ) {
+				blocks.append( new ANode[block_size] );
+			}
+			return blocks[b] + (i & (block_size-1));
+		}
+	};
+
+	/// maximum number of nodes per search
 	static uint32 MAX_STEP;
-#ifdef DEBUG
-	// a semaphore, since we only have a single version of the array in memory
-	static bool node_in_use;
-	static void GET_NODE() {if(node_in_use){ dbg->fatal("GET_NODE","called while list in use");} node_in_use =1; }
-	static void RELEASE_NODE() {if(!node_in_use){ dbg->fatal("RELEASE_NODE","called while list free");} node_in_use =0; }
-#else
-	static void GET_NODE() {}
-	static void RELEASE_NODE() {}
-#endif
+
+	/**
+	 * Gets an unused node pool for a search, with empty queue and cleared markers.
+	 * Must be handed back with release_node_pool().
+	 */
+	static node_pool_t *get_node_pool(karte_t *welt);
+
+	static void release_node_pool(node_pool_t *pool);
 
 	const koord3d_vector_t &get_route() const { return route; }
 
@@ -152,6 +222,13 @@ public:
 	 */
 	route_result_t calc_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, sint32 max_tile_len );
 
+	/**
+	 * Does the search of calc_route() from @p start to @p target in advance and stores the result in @p prepared.
+	 * Only reads the world, so it may be called for many vehicles from several threads.
+	 * @p tdriver must answer the same as it will during the later calc_route().
+	 */
+	static void prepare_route(karte_t *welt, koord3d start, koord3d target, test_driver_t *tdriver, const sint32 max_speed_kmh, prepared_route_t &prepared );
+
 	/**
 	 * Load/Save of the route.
 	 */
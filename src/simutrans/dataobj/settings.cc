@@ -755,6 +755,13 @@ void settings_t::rdwr(loadsave_t *file)
 		else {
 			cst_kw_per_credit = 512;
 		}
+
+		if (file->is_version_atleast(124, 6)) {
+			file->rdwr_short(month_spread_steps);
+		}
+		else {
+			month_spread_steps = 0;
+		}
 	}
 
 	// sometimes broken savegames could have no legal direction for take off ...
@@ -837,6 +844,12 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	env_t::draw_earth_border = contents.get_int( "draw_earth_border", env_t::draw_earth_border ) != 0;
 	env_t::draw_outside_tile = contents.get_int( "draw_outside_tile", env_t::draw_outside_tile ) != 0;
 
+	// redraw only the changed parts of the world
+	env_t::world_layer_cache = contents.get_int( "world_layer_cache", env_t::world_layer_cache ) != 0;
+
+	// zoom and recolour images ahead of time
+	env_t::image_cache_size = contents.get_int_clamped( "image_cache_size", env_t::image_cache_size, 0, 65535 );
+
 	// display stuff
 	env_t::show_names                  = contents.get_int_clamped( "show_names",                     env_t::show_names,                0, 7 );
 	env_t::horizontal_stripe_owner     = contents.get_int("horizontal_stripe_owner",                 env_t::horizontal_stripe_owner) != 0;
@@ -851,6 +864,8 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 
 	env_t::simple_drawing_fast_forward = contents.get_int( "simple_drawing_fast_forward", env_t::simple_drawing_fast_forward ) != 0;
 	env_t::visualize_schedule          = contents.get_int( "visualize_schedule",          env_t::visualize_schedule ) != 0;
+	env_t::parallel_convoi_step        = contents.get_int( "parallel_convoi_step",        env_t::parallel_convoi_step ) != 0;
+	env_t::halt_route_cache            = contents.get_int( "halt_route_cache",            env_t::halt_route_cache ) != 0;
 
 	env_t::hide_rail_return_ticket  = contents.get_int( "hide_rail_return_ticket",   env_t::hide_rail_return_ticket ) != 0;
 	env_t::chat_window_transparency = contents.get_int_clamped( "chat_transparency", env_t::chat_window_transparency, 0, 100);
@@ -868,6 +883,8 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	env_t::server_sync_steps_between_checks = contents.get_int_clamped( "server_frames_between_checks",    env_t::server_sync_steps_between_checks, 1, INT_MAX );
 
 	env_t::pause_server_no_clients          = contents.get_int( "pause_server_no_clients",  env_t::pause_server_no_clients  ) != 0;
+	env_t::server_join_sync_all             = contents.get_int( "server_join_sync_all",     env_t::server_join_sync_all     ) != 0;
+	env_t::server_join_delta                = contents.get_int( "server_join_delta",        env_t::server_join_delta        ) != 0;
 	env_t::server_save_game_on_quit         = contents.get_int( "server_save_game_on_quit", env_t::server_save_game_on_quit ) != 0;
 	env_t::reload_and_save_on_quit          = contents.get_int( "reload_and_save_on_quit",  env_t::reload_and_save_on_quit  ) != 0;
 
@@ -1078,6 +1095,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	}
 
 	env_t::autosave = contents.get_int_clamped( "autosave", env_t::autosave, 0, INT_MAX );
+	env_t::background_autosave = contents.get_int( "background_autosave", env_t::background_autosave ) != 0;
 
 	// routing stuff
 	max_route_steps        = contents.get_int_clamped( "max_route_steps",        max_route_steps,        1, INT_MAX );
@@ -1261,6 +1279,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 
 	// time stuff
 	bits_per_month = contents.get_int_clamped( "bits_per_month", bits_per_month, 1, 31 );
+	month_spread_steps = contents.get_int_clamped( "month_spread_steps", month_spread_steps, 0, 1000 );
 	use_timeline   = contents.get_int_clamped( "use_timeline",   use_timeline,   0, 3 );
 	starting_year  = contents.get_int_clamped( "starting_year",  starting_year,  0, 0x7FFF);
 	starting_month = contents.get_int_clamped( "starting_month", starting_month+1, 1, 12 ) - 1;
@@ -181,6 +181,9 @@ private:
 	sint16 starting_month     =    0;
 	sint16 bits_per_month     =   20;
 
+	/// convois and halts do their monthly update during this many steps after the month changed, 0 = at once
+	uint16 month_spread_steps =    0;
+
 	std::string filename = "";
 
 	bool beginner_mode = false;
@@ -463,6 +466,8 @@ public:
 
 	sint16 get_bits_per_month() const {return bits_per_month;}
 
+	uint16 get_month_spread_steps() const {return month_spread_steps;}
+
 	void set_filename(const char *n) {filename=n;}
 	const char* get_filename() const { return filename.c_str(); }
 
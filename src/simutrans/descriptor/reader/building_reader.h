@@ -16,7 +16,7 @@ class tile_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -33,7 +33,7 @@ protected:
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
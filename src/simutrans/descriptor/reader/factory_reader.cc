@@ -12,9 +12,18 @@
 #include "../factory_desc.h"
 #include "../xref_desc.h"
 #include "../../network/pakset_info.h"
+#include "../../tpl/ptrhashtable_tpl.h"
 
 #include "factory_reader.h"
 
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+static pthread_mutex_t incomplete_field_class_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// field class descs under construction for old field groups, completed in register_obj()
+static ptrhashtable_tpl<field_group_desc_t *, field_class_desc_t *> incomplete_field_class_descs;
+
 
 // determine the combined probability of 256 rounds of chances
 uint16 rescale_probability(const uint16 p)
@@ -38,9 +47,9 @@ uint16 rescale_probability(const uint16 p)
 }
 
 
-obj_desc_t *factory_field_class_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_field_class_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	uint16 v = decode_uint16(p);
@@ -68,9 +77,9 @@ obj_desc_t *factory_field_class_reader_t::read_node(FILE *fp, obj_node_info_t &n
 }
 
 
-obj_desc_t *factory_field_group_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_field_group_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	uint16 v = decode_uint16(p);
@@ -107,10 +116,16 @@ obj_desc_t *factory_field_group_reader_t::read_node(FILE *fp, obj_node_info_t &n
 		field_class_desc->spawn_weight = 1000;
 
 		/*
-		 * store it in a static variable for further processing
-		 * later in factory_field_reader_t::register_obj()
+		 * store it for further processing
+		 * later in factory_field_group_reader_t::register_obj()
 		 */
-		incomplete_field_class_desc = field_class_desc;
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &incomplete_field_class_mutex );
+#endif
+		incomplete_field_class_descs.put( desc, field_class_desc );
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock( &incomplete_field_class_mutex );
+#endif
 
 		PAKSET_INFO("factory_field_group_reader_t::read_node()", "version=%i, probability=%i, fields: max=%i / min=%i / start=%i, field classes=%i, storage=%i, field_prod=%i, chance=%i, has_snow=%i",
 			v,
@@ -147,21 +162,27 @@ void factory_field_group_reader_t::register_obj(obj_desc_t *&data)
 	field_group_desc_t *const desc = static_cast<field_group_desc_t *>(data);
 
 	// check if we need to continue with the construction of field class desc
-	if (field_class_desc_t *const field_class_desc = incomplete_field_class_desc) {
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &incomplete_field_class_mutex );
+#endif
+	field_class_desc_t *const field_class_desc = incomplete_field_class_descs.remove( desc );
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &incomplete_field_class_mutex );
+#endif
+	if (field_class_desc) {
 		// we *must* transfer the obj_desc_t array and not just the desc object itself
 		// as xref reader has already logged the address of the array element for xref resolution
 		field_class_desc->children  = desc->children;
 		desc->children              = new obj_desc_t*[1];
 		desc->children[0]           = field_class_desc;
-		incomplete_field_class_desc = NULL;
 	}
 }
 
 
 
-obj_desc_t *factory_smoke_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_smoke_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	sint16 x = decode_sint16(p);
@@ -182,9 +203,9 @@ obj_desc_t *factory_smoke_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 }
 
 
-obj_desc_t *factory_supplier_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_supplier_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	// old versions of PAK files have no version stamp.
@@ -215,9 +236,9 @@ obj_desc_t *factory_supplier_reader_t::read_node(FILE *fp, obj_node_info_t &node
 }
 
 
-obj_desc_t *factory_product_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_product_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	// old versions of PAK files have no version stamp.
@@ -250,9 +271,9 @@ obj_desc_t *factory_product_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 }
 
 
-obj_desc_t *factory_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *factory_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	// old versions of PAK files have no version stamp.
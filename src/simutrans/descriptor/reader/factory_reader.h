@@ -22,7 +22,7 @@ class factory_field_class_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -30,16 +30,13 @@ class factory_field_group_reader_t : public obj_reader_t
 {
 	OBJ_READER_DEF(factory_field_group_reader_t, obj_ffield, "factory field");
 
-	// hold a field class desc under construction
-	static field_class_desc_t* incomplete_field_class_desc;
-
 protected:
 	/// @copydoc obj_reader_t::register_obj
 	void register_obj(obj_desc_t *&desc) OVERRIDE;
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -49,7 +46,7 @@ class factory_smoke_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t* read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t* read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -59,7 +56,7 @@ class factory_supplier_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -69,7 +66,7 @@ class factory_product_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -86,7 +83,7 @@ protected:
 
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -25,9 +25,9 @@
 #define skip_reading_pixels_if_no_graphics goto adjust_image
 #endif
 
-obj_desc_t *image_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *image_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	p.seek(6);
@@ -173,6 +173,14 @@ adjust_image:
 		}
 	}
 
+	return desc;
+}
+
+
+void image_reader_t::register_obj(obj_desc_t *&data)
+{
+	image_t *desc = static_cast<image_t *>(data);
+
 	if (desc->len != 0) {
 		// get the adler hash (since we have zlib on board anyway ... )
 		bool do_register_image = true;
@@ -205,11 +213,9 @@ adjust_image:
 		else {
 			// no need to load doubles ...
 			delete desc;
-			desc = same;
+			data = same;
 		}
 	}
-
-	return desc;
 }
 
 
@@ -17,9 +17,13 @@ class image_reader_t : public obj_reader_t
 {
 	OBJ_READER_DEF(image_reader_t, obj_image, "image");
 
+protected:
+	/// Registers the image with the graphics backend, identical images only once.
+	void register_obj(obj_desc_t *&desc) OVERRIDE;
+
 public:
 	/// @copydoc obj_reader_t::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 
 private:
 	bool image_has_valid_data(image_t *img) const;
@@ -16,7 +16,7 @@ class imagelist2d_reader_t : public obj_reader_t
 
 public:
 	/// @copydoc obj_reader::read_node
-	obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) OVERRIDE;
+	obj_desc_t *read_node(const char *body, obj_node_info_t &node) OVERRIDE;
 };
 
 
@@ -5,13 +5,13 @@
 
 #include "obj_reader.h"
 
-size_t node_body_t::buf_size = 0;
-uint8* node_body_t::buf = 0;
-uint8* node_body_t::ptr = 0;
-uint8* node_body_t::end = 0;
-const char* node_body_t::type_name_ = 0;
-
-#ifdef DEBUG
-uint8 node_body_t::usage = 0;
-#endif
 
+node_body_t::node_body_t(const char *data, size_t size, const char *type_name)
+{
+	type_name_ = type_name;
+	buf = ptr = (const uint8 *)data;
+	end = ptr + size;
+	if (size == 0) {
+		dbg->error("node_body_t()", "Node of size 0 requested for %s", type_name);
+	}
+}
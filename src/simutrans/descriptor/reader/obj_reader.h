@@ -97,46 +97,15 @@ inline uint64 decode_uint64(char *&data)
 		static classname the_instance
 
 
-/// Owns one pak node's bytes and a bounds-checked cursor over them.
+/// Bounds-checked cursor over the bytes of one pak node.
 /// decode_*(node_body_t&) overloads read through it.
 class node_body_t
 {
 public:
-	/// fread @p size bytes from @p fp; short read leaves a bool-false cursor.
-	node_body_t(FILE* fp, size_t size, const char* type_name)
-	{
-		type_name_ = type_name;
-		if (size > 0) {
-			if (size > buf_size) {
-				buf_size = size | 0x0FFF;
-				buf = (uint8*)realloc(buf,buf_size);
-			}
-			ptr = buf;
-			size_t n = fread(ptr, 1, size, fp);
-			if (n != size) {
-				dbg->fatal("node_body_t()", "Cannot read %lu (only %lu) for %s", size, n, type_name);
-			}
-			end = ptr + size;
-#ifdef DEBUG
-			usage++;
-#endif
-		}
-		else {
-			end = ptr = buf;
-			dbg->error("node_body_t()", "Node of size 0 requested for %s", type_name);
-		}
-	}
-
-#ifdef DEBUG
-	~node_body_t() {
-		usage--;
-		if (usage) {
-			dbg->fatal("node_body_t()", "is not reentrant for %s", type_name_);
-		}
-	}
-#endif
+	/// cursor over the @p size bytes at @p data, which must stay valid while reading
+	node_body_t(const char *data, size_t size, const char *type_name);
 
-	/// false on short fread.
+	/// false if there is no data
 	explicit operator bool() const { return ptr != NULL; }
 
 	/// Bounds-checked `p += n`.
@@ -154,10 +123,10 @@ public:
 	}
 
 	/// Bounds-checked: returns the cursor, then advances @p n bytes (tail reads).
-	char* read_bytes(size_t n)
+	const char* read_bytes(size_t n)
 	{
 		if (ptr + n <= end) {
-			char* p = (char *)ptr;
+			const char* p = (const char *)ptr;
 			ptr += n;
 			return p;
 		}
@@ -167,14 +136,14 @@ public:
 
 	void read_uint16_block(uint16 *dest, size_t n)
 	{
-		uint8* cpy_end = ptr + 2 * n;
+		const uint8* cpy_end = ptr + 2 * n;
 		// normal one
 		if (cpy_end <= end) {
 #ifndef SIM_BIG_ENDIAN
 			memcpy(dest, ptr, 2 * n);
 			ptr = cpy_end;
 #else
-			uint8* p = ptr;
+			const uint8* p = ptr;
 			while (p < cpy_end) {
 				uint16 v = *p++;
 				v |= (uint16)*p++ << 8;
@@ -244,14 +213,10 @@ private:
 		return 0;
 	}
 
-#ifdef DEBUG
-	static uint8 usage;
-#endif
-	static size_t buf_size;
-	static uint8* buf;
-	static uint8* ptr;
-	static uint8* end;
-	static const char* type_name_;
+	const uint8* buf;
+	const uint8* ptr;
+	const uint8* end;
+	const char* type_name_;
 };
 
 /// decode_*(node_body_t&) overloads, chosen over the char*& ones by
@@ -269,11 +234,15 @@ public:
 	virtual ~obj_reader_t() {}
 
 public:
-	/// Read a descriptor from @p fp. Does version check and compatibility transformations.
+	/// Read a descriptor from @p body, which holds the node.size bytes of the node.
+	/// Does version check and compatibility transformations.
+	/// Called from several threads at once while loading a pakset, so anything that
+	/// touches global state belongs into register_obj().
 	/// @returns The descriptor on success, or NULL on failure
-	virtual obj_desc_t *read_node(FILE *fp, obj_node_info_t &node) = 0;
+	virtual obj_desc_t *read_node(const char *body, obj_node_info_t &node) = 0;
 
 	/// Register descriptor so the object described by the descriptor can be built in-game.
+	/// Called in the order of the pak files, after the children were registered.
 	virtual void register_obj(obj_desc_t *&/*desc*/) {}
 
 	/// Does post-loading checks.
@@ -37,9 +37,9 @@ bool roadsign_reader_t::successfully_loaded() const
 }
 
 
-obj_desc_t *roadsign_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *roadsign_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	const uint16 v = decode_uint16(p);
@@ -4,6 +4,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "../sound_desc.h"
 #include "sound_reader.h"
@@ -11,20 +12,43 @@
 #include "../obj_node_info.h"
 
 #include "../../simdebug.h"
+#include "../../tpl/ptrhashtable_tpl.h"
+
+#include <string>
+
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+static pthread_mutex_t sound_files_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// sound files of version 2 nodes, loading them is left to register_obj()
+static ptrhashtable_tpl<sound_desc_t *, std::string> sound_files;
 
 
 void sound_reader_t::register_obj(obj_desc_t *&data)
 {
 	sound_desc_t *desc = static_cast<sound_desc_t *>(data);
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &sound_files_mutex );
+#endif
+	const std::string file_name = sound_files.remove( desc );
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &sound_files_mutex );
+#endif
+	if(  !file_name.empty()  ) {
+		desc->nr = sound_desc_t::get_sound_id( file_name.c_str() );
+	}
+
 	sound_desc_t::register_desc(desc);
 	PAKSET_INFO("sound_reader_t::read_node()","sound %s registered at %i",desc->get_name(),desc->sound_id);
 	delete desc;
 }
 
 
-obj_desc_t * sound_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * sound_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	const uint16 v = decode_uint16(p);
@@ -41,7 +65,14 @@ obj_desc_t * sound_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 		desc->nr = decode_uint16(p);
 		uint16 len = decode_uint16(p);
 		if(  len>0  ) {
-			desc->nr = desc->get_sound_id(p.read_bytes(len));
+			const char *file_name = p.read_bytes(len);
+#ifdef MULTI_THREAD
+			pthread_mutex_lock( &sound_files_mutex );
+#endif
+			sound_files.put( desc, std::string( file_name, strnlen( file_name, len ) ) );
+#ifdef MULTI_THREAD
+			pthread_mutex_unlock( &sound_files_mutex );
+#endif
 		}
 	}
 	else {
@@ -57,7 +57,7 @@ void tunnel_reader_t::convert_old_tunnel(tunnel_desc_t *desc)
 }
 
 
-obj_desc_t * tunnel_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * tunnel_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
 	tunnel_desc_t *desc = new tunnel_desc_t();
 	desc->topspeed = 0; // indicate, that we have to convert this to reasonable date, when read completely
@@ -66,7 +66,7 @@ obj_desc_t * tunnel_reader_t::read_node(FILE *fp, obj_node_info_t &node)
 		return desc;
 	}
 
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) {
 		delete desc;
 		return NULL;
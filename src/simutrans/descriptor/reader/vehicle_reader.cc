@@ -34,9 +34,9 @@ bool vehicle_reader_t::successfully_loaded() const
 }
 
 
-obj_desc_t *vehicle_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *vehicle_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	// old versions of PAK files have no version stamp.
@@ -12,13 +12,13 @@
 #include "../obj_node_info.h"
 
 
-obj_desc_t *xref_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *xref_reader_t::read_node(const char *body, obj_node_info_t &node)
 {
 	if (node.size < 5) {
 		dbg->error("xref_reader_t::read_node", "node.size %u < 5", node.size);
 		return NULL;
 	}
-	node_body_t p(fp, node.size, get_type_name());
+	node_body_t p(body, node.size, get_type_name());
 	if (!p) return NULL;
 
 	const uint32 name_len = node.size - 4 - 1;
@@ -0,0 +1,431 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "blitter.h"
+
+#include "../simconst.h"
+#include "../simdebug.h"
+
+
+#if defined(__GNUC__)  &&  (defined(__x86_64__)  ||  defined(__i386__))
+#define BLITTER_X86
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER)  &&  (defined(_M_X64)  ||  defined(_M_IX86))
+#define BLITTER_X86
+#define TARGET_SSE2
+#define TARGET_AVX2
+#include <intrin.h>
+#endif
+
+#ifdef BLITTER_X86
+#include <immintrin.h>
+#endif
+
+
+// same masks as in simgraph16.cc
+#ifdef RGB555
+#define ONE_OUT (0x3DEF) // mask out bits after applying >>1
+#define TWO_OUT (0x1CE7) // mask out bits after applying >>2
+#define GREEN_BITS (0x1F)
+#else
+#define ONE_OUT (0x7bef) // mask out bits after applying >>1
+#define TWO_OUT (0x39E7) // mask out bits after applying >>2
+#define GREEN_BITS (0x3F)
+#endif
+#define MASK_32 ((GREEN_BITS << 21) | 0xf81f) // mask out bits after transforming to 32bit
+
+
+/*
+ * The scalar pixel loops, these are the reference for all others
+ */
+
+static inline PIXVAL rgb_shr1(PIXVAL c) { return (c >> 1) & ONE_OUT; }
+static inline PIXVAL rgb_shr2(PIXVAL c) { return (c >> 2) & TWO_OUT; }
+
+// Q = 1, 2, 3: blend 25, 50, 75 percent of the foreground
+template<int Q> static inline PIXVAL blend_quarter(PIXVAL background, PIXVAL foreground)
+{
+	switch(  Q  ) {
+		case 1:  return 3 * rgb_shr2(background) + rgb_shr2(foreground);
+		case 2:  return rgb_shr1(background) + rgb_shr1(foreground);
+		default: return rgb_shr2(background) + 3 * rgb_shr2(foreground);
+	}
+}
+
+static inline PIXVAL blend_alpha32(PIXVAL background, PIXVAL foreground, int alpha)
+{
+	uint32 b = ((background << 16) | background) & MASK_32;
+	uint32 f = ((foreground << 16) | foreground) & MASK_32;
+	uint32 r = ((f * alpha + (32-alpha) * b) >> 5) & MASK_32;
+	return r | (r >> 16);
+}
+
+static inline void alpha_pixel(PIXVAL *dest, PIXVAL src, PIXVAL alphamap, PIXVAL alpha_mask)
+{
+	// read mask components - always 15bpp
+	uint16 masked = alphamap & alpha_mask;
+	uint16 alpha_value = (masked & 0x1f) + ((masked >> 5) & 0x1f) + ((masked >> 10) & 0x1f);
+
+	if(  alpha_value > 30  ) {
+		// opaque, just copy source
+		*dest = src;
+	}
+	else if(  alpha_value > 0  ) {
+		alpha_value = alpha_value > 15 ? alpha_value + 1 : alpha_value;
+		*dest = blend_alpha32(*dest, src, alpha_value);
+	}
+}
+
+
+static void copy_scalar(PIXVAL *dest, const PIXVAL *src, sint32 len)
+{
+	while(  len-- > 0  ) {
+		*dest++ = *src++;
+	}
+}
+
+static void recode_scalar(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, sint32 len)
+{
+	while(  len-- > 0  ) {
+		*dest++ = rgbmap[*src++];
+	}
+}
+
+template<int Q, bool RECODE> static void blend_scalar(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL, sint32 len)
+{
+	while(  len-- > 0  ) {
+		*dest = blend_quarter<Q>(*dest, RECODE ? rgbmap[*src] : *src);
+		dest++;
+		src++;
+	}
+}
+
+template<int Q> static void outline_scalar(PIXVAL *dest, const PIXVAL *, const PIXVAL *, PIXVAL colour, sint32 len)
+{
+	while(  len-- > 0  ) {
+		*dest = blend_quarter<Q>(*dest, colour);
+		dest++;
+	}
+}
+
+template<bool RECODE> static void alpha_scalar(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, const PIXVAL *alphamap, PIXVAL alpha_mask, sint32 len)
+{
+	while(  len-- > 0  ) {
+		alpha_pixel( dest++, RECODE ? rgbmap[*src] : *src, *alphamap++, alpha_mask );
+		src++;
+	}
+}
+
+
+static const blitter_t blitter_scalar = {
+	"scalar",
+	copy_scalar,
+	recode_scalar,
+	{ blend_scalar<1,false>, blend_scalar<2,false>, blend_scalar<3,false> },
+	{ blend_scalar<1,true>,  blend_scalar<2,true>,  blend_scalar<3,true> },
+	{ outline_scalar<1>,     outline_scalar<2>,     outline_scalar<3> },
+	alpha_scalar<false>,
+	alpha_scalar<true>
+};
+
+
+#ifdef BLITTER_X86
+/*
+ * SSE2: eight pixels at once
+ * There is no gather, so colour lookups stay scalar.
+ */
+
+TARGET_SSE2 static inline __m128i shr1_sse2(__m128i c) { return _mm_and_si128( _mm_srli_epi16( c, 1 ), _mm_set1_epi16( ONE_OUT ) ); }
+TARGET_SSE2 static inline __m128i shr2_sse2(__m128i c) { return _mm_and_si128( _mm_srli_epi16( c, 2 ), _mm_set1_epi16( TWO_OUT ) ); }
+
+template<int Q> TARGET_SSE2 static inline __m128i blend_quarter_sse2(__m128i background, __m128i foreground)
+{
+	switch(  Q  ) {
+		case 1: {
+			const __m128i b = shr2_sse2( background );
+			return _mm_add_epi16( _mm_add_epi16( b, _mm_add_epi16( b, b ) ), shr2_sse2( foreground ) );
+		}
+		case 2:
+			return _mm_add_epi16( shr1_sse2( background ), shr1_sse2( foreground ) );
+		default: {
+			const __m128i f = shr2_sse2( foreground );
+			return _mm_add_epi16( shr2_sse2( background ), _mm_add_epi16( f, _mm_add_epi16( f, f ) ) );
+		}
+	}
+}
+
+// same as alpha_pixel() for eight pixels, each channel is blended in its own 16 bit lane
+TARGET_SSE2 static inline __m128i alpha_sse2(__m128i background, __m128i foreground, __m128i alphamap, __m128i alpha_mask)
+{
+	const __m128i bits5 = _mm_set1_epi16( 0x1f );
+	const __m128i masked = _mm_and_si128( alphamap, alpha_mask );
+	const __m128i value = _mm_add_epi16( _mm_add_epi16( _mm_and_si128( masked, bits5 ), _mm_and_si128( _mm_srli_epi16( masked, 5 ), bits5 ) ), _mm_and_si128( _mm_srli_epi16( masked, 10 ), bits5 ) );
+
+	const __m128i opaque = _mm_cmpgt_epi16( value, _mm_set1_epi16( 30 ) );
+	const __m128i clear  = _mm_cmpeq_epi16( value, _mm_setzero_si128() );
+	const __m128i alpha  = _mm_sub_epi16( value, _mm_cmpgt_epi16( value, _mm_set1_epi16( 15 ) ) );
+	const __m128i rest   = _mm_sub_epi16( _mm_set1_epi16( 32 ), alpha );
+
+	const __m128i green = _mm_set1_epi16( GREEN_BITS );
+	const __m128i b = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( foreground, bits5 ), alpha ), _mm_mullo_epi16( _mm_and_si128( background, bits5 ), rest ) ), 5 );
+	const __m128i g = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi16( foreground, 5 ), green ), alpha ), _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi16( background, 5 ), green ), rest ) ), 5 );
+	const __m128i r = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_srli_epi16( foreground, 11 ), alpha ), _mm_mullo_epi16( _mm_srli_epi16( background, 11 ), rest ) ), 5 );
+	__m128i result = _mm_or_si128( _mm_or_si128( b, _mm_slli_epi16( g, 5 ) ), _mm_slli_epi16( r, 11 ) );
+
+	result = _mm_or_si128( _mm_andnot_si128( opaque, result ), _mm_and_si128( opaque, foreground ) );
+	return _mm_or_si128( _mm_andnot_si128( clear, result ), _mm_and_si128( clear, background ) );
+}
+
+TARGET_SSE2 static inline __m128i load_sse2(const PIXVAL *p) { return _mm_loadu_si128( reinterpret_cast<const __m128i *>(p) ); }
+TARGET_SSE2 static inline void store_sse2(PIXVAL *p, __m128i v) { _mm_storeu_si128( reinterpret_cast<__m128i *>(p), v ); }
+
+// without gather the lookup goes through a small buffer
+template<bool RECODE> TARGET_SSE2 static inline __m128i load_recode_sse2(const PIXVAL *src, const PIXVAL *rgbmap)
+{
+	if(  !RECODE  ) {
+		return load_sse2( src );
+	}
+	PIXVAL buf[8];
+	for(  int i = 0;  i < 8;  i++  ) {
+		buf[i] = rgbmap[src[i]];
+	}
+	return load_sse2( buf );
+}
+
+
+TARGET_SSE2 static void copy_sse2(PIXVAL *dest, const PIXVAL *src, sint32 len)
+{
+	for(  ;  len >= 8;  len -= 8, dest += 8, src += 8  ) {
+		store_sse2( dest, load_sse2( src ) );
+	}
+	copy_scalar( dest, src, len );
+}
+
+template<int Q, bool RECODE> TARGET_SSE2 static void blend_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL colour, sint32 len)
+{
+	for(  ;  len >= 8;  len -= 8, dest += 8, src += 8  ) {
+		store_sse2( dest, blend_quarter_sse2<Q>( load_sse2( dest ), load_recode_sse2<RECODE>( src, rgbmap ) ) );
+	}
+	blend_scalar<Q,RECODE>( dest, src, rgbmap, colour, len );
+}
+
+template<int Q> TARGET_SSE2 static void outline_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL colour, sint32 len)
+{
+	const __m128i c = _mm_set1_epi16( colour );
+	for(  ;  len >= 8;  len -= 8, dest += 8  ) {
+		store_sse2( dest, blend_quarter_sse2<Q>( load_sse2( dest ), c ) );
+	}
+	outline_scalar<Q>( dest, src, rgbmap, colour, len );
+}
+
+template<bool RECODE> TARGET_SSE2 static void alpha_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, const PIXVAL *alphamap, PIXVAL alpha_mask, sint32 len)
+{
+	const __m128i mask = _mm_set1_epi16( alpha_mask );
+	for(  ;  len >= 8;  len -= 8, dest += 8, src += 8, alphamap += 8  ) {
+		store_sse2( dest, alpha_sse2( load_sse2( dest ), load_recode_sse2<RECODE>( src, rgbmap ), load_sse2( alphamap ), mask ) );
+	}
+	alpha_scalar<RECODE>( dest, src, rgbmap, alphamap, alpha_mask, len );
+}
+
+
+static const blitter_t blitter_sse2 = {
+	"sse2",
+	copy_sse2,
+	recode_scalar,
+	{ blend_sse2<1,false>, blend_sse2<2,false>, blend_sse2<3,false> },
+	{ blend_sse2<1,true>,  blend_sse2<2,true>,  blend_sse2<3,true> },
+	{ outline_sse2<1>,     outline_sse2<2>,     outline_sse2<3> },
+	alpha_sse2<false>,
+	alpha_sse2<true>
+};
+
+
+/*
+ * AVX2: sixteen pixels at once, colour lookups by gather
+ */
+
+TARGET_AVX2 static inline __m256i shr1_avx2(__m256i c) { return _mm256_and_si256( _mm256_srli_epi16( c, 1 ), _mm256_set1_epi16( ONE_OUT ) ); }
+TARGET_AVX2 static inline __m256i shr2_avx2(__m256i c) { return _mm256_and_si256( _mm256_srli_epi16( c, 2 ), _mm256_set1_epi16( TWO_OUT ) ); }
+
+template<int Q> TARGET_AVX2 static inline __m256i blend_quarter_avx2(__m256i background, __m256i foreground)
+{
+	switch(  Q  ) {
+		case 1: {
+			const __m256i b = shr2_avx2( background );
+			return _mm256_add_epi16( _mm256_add_epi16( b, _mm256_add_epi16( b, b ) ), shr2_avx2( foreground ) );
+		}
+		case 2:
+			return _mm256_add_epi16( shr1_avx2( background ), shr1_avx2( foreground ) );
+		default: {
+			const __m256i f = shr2_avx2( foreground );
+			return _mm256_add_epi16( shr2_avx2( background ), _mm256_add_epi16( f, _mm256_add_epi16( f, f ) ) );
+		}
+	}
+}
+
+TARGET_AVX2 static inline __m256i alpha_avx2(__m256i background, __m256i foreground, __m256i alphamap, __m256i alpha_mask)
+{
+	const __m256i bits5 = _mm256_set1_epi16( 0x1f );
+	const __m256i masked = _mm256_and_si256( alphamap, alpha_mask );
+	const __m256i value = _mm256_add_epi16( _mm256_add_epi16( _mm256_and_si256( masked, bits5 ), _mm256_and_si256( _mm256_srli_epi16( masked, 5 ), bits5 ) ), _mm256_and_si256( _mm256_srli_epi16( masked, 10 ), bits5 ) );
+
+	const __m256i opaque = _mm256_cmpgt_epi16( value, _mm256_set1_epi16( 30 ) );
+	const __m256i clear  = _mm256_cmpeq_epi16( value, _mm256_setzero_si256() );
+	const __m256i alpha  = _mm256_sub_epi16( value, _mm256_cmpgt_epi16( value, _mm256_set1_epi16( 15 ) ) );
+	const __m256i rest   = _mm256_sub_epi16( _mm256_set1_epi16( 32 ), alpha );
+
+	const __m256i green = _mm256_set1_epi16( GREEN_BITS );
+	const __m256i b = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( foreground, bits5 ), alpha ), _mm256_mullo_epi16( _mm256_and_si256( background, bits5 ), rest ) ), 5 );
+	const __m256i g = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi16( foreground, 5 ), green ), alpha ), _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi16( background, 5 ), green ), rest ) ), 5 );
+	const __m256i r = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_srli_epi16( foreground, 11 ), alpha ), _mm256_mullo_epi16( _mm256_srli_epi16( background, 11 ), rest ) ), 5 );
+	__m256i result = _mm256_or_si256( _mm256_or_si256( b, _mm256_slli_epi16( g, 5 ) ), _mm256_slli_epi16( r, 11 ) );
+
+	result = _mm256_blendv_epi8( result, foreground, opaque );
+	return _mm256_blendv_epi8( result, background, clear );
+}
+
+TARGET_AVX2 static inline __m256i load_avx2(const PIXVAL *p) { return _mm256_loadu_si256( reinterpret_cast<const __m256i *>(p) ); }
+TARGET_AVX2 static inline void store_avx2(PIXVAL *p, __m256i v) { _mm256_storeu_si256( reinterpret_cast<__m256i *>(p), v ); }
+
+// looks up sixteen pixels in rgbmap, reading 32 bit at each (16 bit) entry
+TARGET_AVX2 static inline __m256i gather_avx2(const PIXVAL *src, const PIXVAL *rgbmap)
+{
+	const int *base = reinterpret_cast<const int *>(rgbmap);
+	const __m256i lo = _mm256_i32gather_epi32( base, _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>(src) ) ), 2 );
+	const __m256i hi = _mm256_i32gather_epi32( base, _mm256_cvtepu16_epi32( _mm_loadu_si128( reinterpret_cast<const __m128i *>(src + 8) ) ), 2 );
+	const __m256i low16 = _mm256_set1_epi32( 0xFFFF );
+	// packing works per 128 bit lane, so the quarters must be put in order again
+	return _mm256_permute4x64_epi64( _mm256_packus_epi32( _mm256_and_si256( lo, low16 ), _mm256_and_si256( hi, low16 ) ), 0xD8 );
+}
+
+template<bool RECODE> TARGET_AVX2 static inline __m256i load_recode_avx2(const PIXVAL *src, const PIXVAL *rgbmap)
+{
+	return RECODE ? gather_avx2( src, rgbmap ) : load_avx2( src );
+}
+
+
+TARGET_AVX2 static void copy_avx2(PIXVAL *dest, const PIXVAL *src, sint32 len)
+{
+	for(  ;  len >= 16;  len -= 16, dest += 16, src += 16  ) {
+		store_avx2( dest, load_avx2( src ) );
+	}
+	copy_scalar( dest, src, len );
+}
+
+TARGET_AVX2 static void recode_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, sint32 len)
+{
+	for(  ;  len >= 16;  len -= 16, dest += 16, src += 16  ) {
+		store_avx2( dest, gather_avx2( src, rgbmap ) );
+	}
+	recode_scalar( dest, src, rgbmap, len );
+}
+
+template<int Q, bool RECODE> TARGET_AVX2 static void blend_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL colour, sint32 len)
+{
+	for(  ;  len >= 16;  len -= 16, dest += 16, src += 16  ) {
+		store_avx2( dest, blend_quarter_avx2<Q>( load_avx2( dest ), load_recode_avx2<RECODE>( src, rgbmap ) ) );
+	}
+	blend_scalar<Q,RECODE>( dest, src, rgbmap, colour, len );
+}
+
+template<int Q> TARGET_AVX2 static void outline_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL colour, sint32 len)
+{
+	const __m256i c = _mm256_set1_epi16( colour );
+	for(  ;  len >= 16;  len -= 16, dest += 16  ) {
+		store_avx2( dest, blend_quarter_avx2<Q>( load_avx2( dest ), c ) );
+	}
+	outline_scalar<Q>( dest, src, rgbmap, colour, len );
+}
+
+template<bool RECODE> TARGET_AVX2 static void alpha_avx2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, const PIXVAL *alphamap, PIXVAL alpha_mask, sint32 len)
+{
+	const __m256i mask = _mm256_set1_epi16( alpha_mask );
+	for(  ;  len >= 16;  len -= 16, dest += 16, src += 16, alphamap += 16  ) {
+		store_avx2( dest, alpha_avx2( load_avx2( dest ), load_recode_avx2<RECODE>( src, rgbmap ), load_avx2( alphamap ), mask ) );
+	}
+	alpha_scalar<RECODE>( dest, src, rgbmap, alphamap, alpha_mask, len );
+}
+
+
+static const blitter_t blitter_avx2 = {
+	"avx2",
+	copy_avx2,
+	recode_avx2,
+	{ blend_avx2<1,false>, blend_avx2<2,false>, blend_avx2<3,false> },
+	{ blend_avx2<1,true>,  blend_avx2<2,true>,  blend_avx2<3,true> },
+	{ outline_avx2<1>,     outline_avx2<2>,     outline_avx2<3> },
+	alpha_avx2<false>,
+	alpha_avx2<true>
+};
+
+
+static bool cpu_has_sse2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid( info, 1 );
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports( "sse2" );
+#endif
+}
+
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid( info, 0 );
+	if(  info[0] < 7  ) {
+		return false;
+	}
+	__cpuid( info, 1 );
+	// the OS must save the AVX registers too
+	if(  (info[2] & (1 << 27)) == 0  ||  (_xgetbv( 0 ) & 6) != 6  ) {
+		return false;
+	}
+	__cpuidex( info, 7, 0 );
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports( "avx2" );
+#endif
+}
+#endif
+
+
+const blitter_t *blitter = &blitter_scalar;
+
+static const blitter_t *available_blitters[3] = { &blitter_scalar, NULL, NULL };
+static uint32 available_count = 1;
+
+
+void blitter_init()
+{
+	available_count = 1;
+#ifdef BLITTER_X86
+	if(  cpu_has_sse2()  ) {
+		available_blitters[available_count++] = &blitter_sse2;
+		if(  cpu_has_avx2()  ) {
+			available_blitters[available_count++] = &blitter_avx2;
+		}
+	}
+#endif
+	blitter = available_blitters[available_count - 1];
+	dbg->message( "blitter_init()", "Using %s pixel loops", blitter->name );
+}
+
+
+uint32 blitter_get_count()
+{
+	return available_count;
+}
+
+
+const blitter_t *blitter_get(uint32 i)
+{
+	return available_blitters[ i < available_count ? i : available_count - 1 ];
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DISPLAY_BLITTER_H
+#define DISPLAY_BLITTER_H
+
+
+#include "../simcolor.h"
+#include "../simtypes.h"
+
+
+/**
+ * The pixel loops of simgraph16 for one run of image pixels.
+ * @p rgbmap maps image colours (below 0x8020) to screen colours,
+ * recoding variants look up each source pixel in it first.
+ */
+typedef void (*blit_copy_proc)(PIXVAL *dest, const PIXVAL *src, sint32 len);
+typedef void (*blit_recode_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, sint32 len);
+/// blends @p src (or @p colour for outlines) over @p dest
+typedef void (*blit_blend_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, PIXVAL colour, sint32 len);
+/// blends @p src over @p dest with the alpha taken from the @p alpha_mask channels of @p alphamap (always 15 bpp)
+typedef void (*blit_alpha_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL *rgbmap, const PIXVAL *alphamap, PIXVAL alpha_mask, sint32 len);
+
+
+/**
+ * One set of pixel loops, all giving exactly the same result.
+ * Besides the scalar version there are SSE2 and AVX2 versions on x86 CPUs.
+ */
+struct blitter_t
+{
+	const char *name;
+
+	blit_copy_proc copy;
+	blit_recode_proc recode;
+
+	/// 25, 50 and 75 percent
+	blit_blend_proc blend[3];
+	blit_blend_proc blend_recode[3];
+	blit_blend_proc outline[3];
+
+	blit_alpha_proc alpha;
+	blit_alpha_proc alpha_recode;
+};
+
+
+/// the pixel loops to use, the fastest the CPU supports after blitter_init()
+extern const blitter_t *blitter;
+
+/// selects the fastest blitter for this CPU
+void blitter_init();
+
+/// number of blitters this CPU can run, for benchmarks
+uint32 blitter_get_count();
+
+/// @p i from 0 (scalar) to blitter_get_count()-1 (fastest)
+const blitter_t *blitter_get(uint32 i);
+
+
+#endif
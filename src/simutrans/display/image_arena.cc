@@ -0,0 +1,167 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "image_arena.h"
+
+#include "../simmem.h"
+#include "../tpl/vector_tpl.h"
+
+#include <stdlib.h>
+
+#ifdef MULTI_THREAD
+#include "../utils/simthread.h"
+static pthread_mutex_t arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+
+#define ARENA_BLOCK_SIZE (1u << 20)
+// larger buffers are allocated on their own
+#define ARENA_LARGE_SIZE (ARENA_BLOCK_SIZE / 8)
+// number of empty blocks kept for later use
+#define ARENA_SPARE_BLOCKS (4)
+// block number of buffers allocated on their own
+#define ARENA_NO_BLOCK (0xFFFFFFFFu)
+
+
+// in front of each buffer, keeps the pixels 8 byte aligned
+struct arena_header_t
+{
+	uint32 block;
+	uint32 size; // bytes including this header
+};
+
+struct arena_block_t
+{
+	uint8 *mem; // NULL if given back to the heap
+	uint32 top; // first unused byte
+	uint32 live; // buffers in use
+};
+
+
+static vector_tpl<arena_block_t> blocks;
+static vector_tpl<uint32> empty_blocks;
+static uint32 spare_blocks = 0; // empty blocks still holding their memory
+static uint32 current_block = ARENA_NO_BLOCK;
+static size_t used_bytes = 0;
+static size_t large_bytes = 0;
+
+
+static uint32 get_empty_block()
+{
+	if(  !empty_blocks.empty()  ) {
+		const uint32 b = empty_blocks.pop_back();
+		if(  blocks[b].mem  ) {
+			spare_blocks--;
+		}
+		else {
+			blocks[b].mem = MALLOCN( uint8, ARENA_BLOCK_SIZE );
+		}
+		return b;
+	}
+	arena_block_t block;
+	block.mem = MALLOCN( uint8, ARENA_BLOCK_SIZE );
+	block.top = 0;
+	block.live = 0;
+	blocks.append( block );
+	return blocks.get_count() - 1;
+}
+
+
+PIXVAL *image_arena_alloc(uint32 len)
+{
+	const uint32 size = (uint32)((sizeof(arena_header_t) + len * sizeof(PIXVAL) + 7) & ~(size_t)7);
+	arena_header_t *header;
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &arena_mutex );
+#endif
+	if(  size > ARENA_LARGE_SIZE  ) {
+		header = (arena_header_t *)MALLOCN( uint8, size );
+		header->block = ARENA_NO_BLOCK;
+		large_bytes += size;
+	}
+	else {
+		if(  current_block == ARENA_NO_BLOCK  ||  blocks[current_block].top + size > ARENA_BLOCK_SIZE  ) {
+			// the full block is freed once its last buffer is freed
+			current_block = get_empty_block();
+		}
+		arena_block_t &block = blocks[current_block];
+		header = (arena_header_t *)(block.mem + block.top);
+		header->block = current_block;
+		block.top += size;
+		block.live++;
+	}
+	header->size = size;
+	used_bytes += size;
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &arena_mutex );
+#endif
+
+	return (PIXVAL *)(header + 1);
+}
+
+
+void image_arena_free(PIXVAL *p)
+{
+	if(  p == NULL  ) {
+		return;
+	}
+	arena_header_t *header = ((arena_header_t *)p) - 1;
+
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &arena_mutex );
+#endif
+	used_bytes -= header->size;
+	if(  header->block == ARENA_NO_BLOCK  ) {
+		large_bytes -= header->size;
+		free( header );
+	}
+	else {
+		const uint32 b = header->block;
+		arena_block_t &block = blocks[b];
+		if(  --block.live == 0  ) {
+			block.top = 0;
+			if(  b != current_block  ) {
+				if(  spare_blocks < ARENA_SPARE_BLOCKS  ) {
+					spare_blocks++;
+				}
+				else {
+					// enough kept, back to the heap
+					free( block.mem );
+					block.mem = NULL;
+				}
+				empty_blocks.append( b );
+			}
+		}
+	}
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &arena_mutex );
+#endif
+}
+
+
+size_t image_arena_get_size(const PIXVAL *p)
+{
+	return p ? (((const arena_header_t *)p) - 1)->size : 0;
+}
+
+
+void image_arena_get_stats(size_t &used, size_t &reserved, uint32 &block_count)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &arena_mutex );
+#endif
+	used = used_bytes;
+	block_count = 0;
+	for(  arena_block_t const& block : blocks  ) {
+		if(  block.mem  ) {
+			block_count++;
+		}
+	}
+	reserved = large_bytes + (size_t)block_count * ARENA_BLOCK_SIZE;
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &arena_mutex );
+#endif
+}
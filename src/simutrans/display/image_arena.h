@@ -0,0 +1,41 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DISPLAY_IMAGE_ARENA_H
+#define DISPLAY_IMAGE_ARENA_H
+
+
+#include "../simcolor.h"
+#include "../simtypes.h"
+
+#include <stddef.h>
+
+
+/**
+ * Storage for the zoomed and recoloured pixel data of images.
+ * Buffers are cut from large blocks instead of one malloc each. A block is used again
+ * as soon as all buffers in it are freed, and since mostly all buffers of a zoom level
+ * are freed together, the blocks are freed as a whole and the heap does not fragment.
+ * Thread safe.
+ */
+
+/// buffer for @p len pixels
+PIXVAL *image_arena_alloc(uint32 len);
+
+/// frees a buffer from image_arena_alloc(), NULL is ignored
+void image_arena_free(PIXVAL *p);
+
+/// size of a buffer from image_arena_alloc() in bytes, including its bookkeeping
+size_t image_arena_get_size(const PIXVAL *p);
+
+/**
+ * @param used bytes of all buffers in use
+ * @param reserved bytes taken from the heap, i.e. used plus unused parts of blocks
+ * @param blocks number of blocks, which includes empty blocks kept for later
+ */
+void image_arena_get_stats(size_t &used, size_t &reserved, uint32 &blocks);
+
+
+#endif
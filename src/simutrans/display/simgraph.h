@@ -195,6 +195,16 @@ struct simgraph_t
 	/// Mark the whole screen dirty.
 	void (*mark_screen_dirty)();
 
+	/// True, if any part of the rectangle was marked dirty since the last flush or in the frame before.
+	bool (*is_rect_dirty)(scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
+
+	/// Redirects all drawing into the persistent world layer (or back to the framebuffer).
+	/// @returns false if the world layer was just (re)allocated and its content is invalid.
+	bool (*set_world_layer)(bool active);
+
+	/// Copies a rectangle of the world layer into the framebuffer.
+	void (*copy_world_layer)(scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
+
 	/// Returns the size of the drawable area.
 	/// @note The size of the underlying render target texture may be larger for alignment reasons.
 	scr_size (*get_screen_size)();
@@ -377,6 +387,12 @@ struct simgraph_t
 	/// @note For simgraph0 this will always fail (as there is no display)
 	bool (*take_screenshot)(const scr_rect &screen_area, const char *filename);
 
+	/// Draws the first images of the pakset with every blitter the CPU supports and prints the throughput.
+	void (*benchmark_blitters)();
+
+	/// Prints the memory used for images (pakset data, zoomed and recolored copies, caches) as CSV.
+	void (*print_image_memory)();
+
 	//
 	// Clipping
 	//
@@ -38,6 +38,9 @@ static void            simgraph0_mark_img_dirty             (image_id image, scr
 static void            simgraph0_mark_rect_dirty_wc         (scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2);
 static void            simgraph0_mark_rect_dirty_clip       (scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2  CLIP_NUM_DEF);
 static void            simgraph0_mark_screen_dirty          ();
+static bool            simgraph0_is_rect_dirty              (scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
+static bool            simgraph0_set_world_layer            (bool active);
+static void            simgraph0_copy_world_layer           (scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
 static scr_size        simgraph0_get_screen_size            ();
 static void            simgraph0_set_screen_actual_width    (scr_coord_val w);
 static void            simgraph0_set_screen_height          (scr_coord_val const h);
@@ -90,6 +93,8 @@ static void            simgraph0_draw_filled_circle         (scr_coord_val, scr_
 static void            simgraph0_draw_bezier                (scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, const PIXVAL, scr_coord_val, scr_coord_val);
 static void            simgraph0_draw_right_triangle        (scr_coord_val, scr_coord_val, scr_coord_val, const PIXVAL, const bool);
 static bool            simgraph0_take_screenshot            (const scr_rect &, const char *);
+static void            simgraph0_benchmark_blitters         ();
+static void            simgraph0_print_image_memory         ();
 static void            simgraph0_draw_signal_direction      (scr_coord_val, scr_coord_val, uint8, uint8, PIXVAL, PIXVAL, bool, uint8);
 static void            simgraph0_set_clip_rect              (scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val  CLIP_NUM_DEF, bool fit);
 static clip_dimension  simgraph0_get_clip_rect              (CLIP_NUM_DEF_NOUSE0);
@@ -148,6 +153,9 @@ simgraph_t g_simgraph0 = {
 	/*.mark_rect_dirty_wc          =*/ simgraph0_mark_rect_dirty_wc,
 	/*.mark_rect_dirty_clip        =*/ simgraph0_mark_rect_dirty_clip,
 	/*.mark_screen_dirty           =*/ simgraph0_mark_screen_dirty,
+	/*.is_rect_dirty               =*/ simgraph0_is_rect_dirty,
+	/*.set_world_layer             =*/ simgraph0_set_world_layer,
+	/*.copy_world_layer            =*/ simgraph0_copy_world_layer,
 	/*.get_screen_size             =*/ simgraph0_get_screen_size,
 	/*.set_screen_height           =*/ simgraph0_set_screen_height,
 	/*.set_screen_actual_width     =*/ simgraph0_set_screen_actual_width,
@@ -201,6 +209,8 @@ simgraph_t g_simgraph0 = {
 	/*.draw_right_triangle         =*/ simgraph0_draw_right_triangle,
 	/*.draw_signal_direction       =*/ simgraph0_draw_signal_direction,
 	/*.take_screenshot             =*/ simgraph0_take_screenshot,
+	/*.benchmark_blitters          =*/ simgraph0_benchmark_blitters,
+	/*.print_image_memory          =*/ simgraph0_print_image_memory,
 	/*.set_clip_rect               =*/ simgraph0_set_clip_rect,
 	/*.get_clip_rect               =*/ simgraph0_get_clip_rect,
 	/*.push_clip_rect              =*/ simgraph0_push_clip_rect,
@@ -268,6 +278,20 @@ static void simgraph0_mark_screen_dirty()
 {
 }
 
+static bool simgraph0_is_rect_dirty(scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val)
+{
+	return false;
+}
+
+static bool simgraph0_set_world_layer(bool)
+{
+	return true;
+}
+
+static void simgraph0_copy_world_layer(scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val)
+{
+}
+
 static void simgraph0_mark_img_dirty(image_id, scr_coord_val, scr_coord_val)
 {
 }
@@ -310,6 +334,14 @@ static bool simgraph0_take_screenshot(const scr_rect &, const char *)
 	return false;
 }
 
+static void simgraph0_benchmark_blitters()
+{
+}
+
+static void simgraph0_print_image_memory()
+{
+}
+
 
 static scr_rect simgraph0_get_image_offset(image_id)
 {
@@ -5,7 +5,9 @@
 
 #include "simgraph.h"
 
+#include "blitter.h"
 #include "font.h"
+#include "image_arena.h"
 
 #include "../dataobj/environment.h"
 #include "../dataobj/translator.h"
@@ -23,6 +25,7 @@
 #include "../sys/simsys.h"
 #include "../utils/simstring.h"
 #include "../utils/unicode.h"
+#include "../tpl/vector_tpl.h"
 
 #include <algorithm>
 #include <cmath>
@@ -326,11 +329,12 @@ struct imd {
 
 	uint8 recode_flags;
 	uint16 player_flags; // bit # is player number, ==1 cache image needs recoding
+	uint32 len;    // current zoom image data size (or base if not zoomed) (used for allocation purposes only)
 
-	PIXVAL* data[MAX_PLAYER_COUNT]; // current data - zoomed and recolored (player + daynight)
+	PIXVAL* data; // current data - zoomed and recolored (daynight) for player 0 and images without player colors
+	PIXVAL** player_data; // same for player 1 to MAX_PLAYER_COUNT-1, only allocated for images with player colors in use
 
 	PIXVAL* zoom_data; // zoomed original data
-	uint32 len;    // current zoom image data size (or base if not zoomed) (used for allocation purposes only)
 
 	sint16 base_x; // min x offset
 	sint16 base_y; // min y offset
@@ -340,6 +344,31 @@ struct imd {
 	PIXVAL* base_data; // original image data
 };
 
+
+// recolored data of an image for a player, or NULL
+static inline PIXVAL *get_img_data(const imd &image, const uint8 player_nr)
+{
+	if(  player_nr == 0  ) {
+		return image.data;
+	}
+	return image.player_data ? image.player_data[player_nr - 1] : NULL;
+}
+
+// where the recolored data of an image for a player is kept
+static inline PIXVAL *&img_data_ref(imd &image, const uint8 player_nr)
+{
+	if(  player_nr == 0  ) {
+		return image.data;
+	}
+	if(  image.player_data == NULL  ) {
+		image.player_data = MALLOCN( PIXVAL *, MAX_PLAYER_COUNT - 1 );
+		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT - 1;  i++  ) {
+			image.player_data[i] = NULL;
+		}
+	}
+	return image.player_data[player_nr - 1];
+}
+
 // Flags for recoding
 #define FLAG_HAS_PLAYER_COLOR (1)
 #define FLAG_HAS_TRANSPARENT_COLOR (2)
@@ -354,12 +383,28 @@ static scr_coord_val disp_actual_width  = 640; // window width
 static scr_coord_val disp_height        = 480; // window height
 
 
+/*
+ * Unpack buffers for zoom_img_data()
+ */
+struct rezoom_buffer_t {
+	uint8 *baseimage;
+	PIXVAL *baseimage2;
+	size_t size;
+};
+
 /*
  * Static buffers for rezoom_img()
  */
-static uint8 *rezoom_baseimage[MAX_THREADS];
-static PIXVAL *rezoom_baseimage2[MAX_THREADS];
-static size_t rezoom_size[MAX_THREADS];
+static rezoom_buffer_t rezoom_buffer[MAX_THREADS];
+
+/*
+ * Image data of one zoom level
+ */
+struct zoomed_img_t {
+	sint16 x, y, w, h; // h<0: not zoomed yet
+	uint32 len;
+	PIXVAL* data; // NULL: base data is used
+};
 
 /*
  * Image table
@@ -378,11 +423,69 @@ static image_id anz_images = 0;
 static image_id alloc_images = 0;
 
 
+/*
+ * Zooming or a new day/night level makes all images to be zoomed or recoloured again on their next draw.
+ * To avoid the stall after such a change, the zoomed images of a level are kept after leaving it, and
+ * a background job zooms the images for the neighbouring levels and recolours the images in use for
+ * the next day/night level ahead of time. All together this uses at most env_t::image_cache_size MB,
+ * the least recently used zoom levels are dropped first.
+ */
+struct zoom_cache_t {
+	zoomed_img_t *img; // NULL: nothing cached for this level
+	image_id count;    // entries in img
+	image_id next;     // first image the background job did not look at
+	size_t bytes;
+	uint32 last_used;
+};
+
+static zoom_cache_t zoom_cache[MAX_ZOOM_FACTOR+1];
+static uint32 zoom_cache_clock = 0;
+
+/*
+ * An image recoloured for the day/night level night_cache_level
+ */
+struct night_img_t {
+	image_id n;
+	uint8 player_nr;
+	PIXVAL *data;
+};
+
+static vector_tpl<night_img_t> night_cache;
+static uint16 *night_cache_players = NULL; // for each image the players already in night_cache
+static image_id night_cache_count = 0;     // entries in night_cache_players
+static image_id night_cache_next = 0;      // first image the background job did not look at
+static bool night_cache_stale = false;     // images were recoloured since the last look at them (guarded by recode_img_mutex)
+static int night_cache_level = -1;
+static size_t night_cache_bytes = 0;
+static PIXVAL rgbmap_next_night[RGBMAPSIZE];
+static PIXVAL specialcolormap_next_night[256];
+
+// images zoomed or recoloured between two looks of the main thread at the cache
+#define IMAGE_CACHE_BATCH (64)
+
+#ifdef MULTI_THREAD
+static pthread_t image_cache_thread;
+static bool image_cache_thread_running = false;
+static bool image_cache_quit = false;
+static pthread_mutex_t image_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t image_cache_cond = PTHREAD_COND_INITIALIZER;
+#endif
+
+
 /*
  * Output framebuffer
  */
 static PIXVAL* textur = NULL;
 
+/*
+ * The world is rendered into its own buffer, which is kept between frames.
+ * Only the dirty parts must be drawn again, the rest is just copied to textur.
+ */
+static PIXVAL* world_layer = NULL;
+static PIXVAL* framebuffer = NULL; // saved textur while drawing into the world layer
+static scr_coord_val world_layer_width = 0;
+static scr_coord_val world_layer_height = 0;
+
 
 /*
  * dirty tile management structures
@@ -510,6 +613,9 @@ static void            simgraph16_mark_img_dirty             (image_id image, sc
 static void            simgraph16_mark_rect_dirty_wc         (scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2);
 static void            simgraph16_mark_rect_dirty_clip       (scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2  CLIP_NUM_DEF);
 static void            simgraph16_mark_screen_dirty          ();
+static bool            simgraph16_is_rect_dirty              (scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
+static bool            simgraph16_set_world_layer            (bool active);
+static void            simgraph16_copy_world_layer           (scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h);
 static scr_size        simgraph16_get_screen_size            ();
 static void            simgraph16_set_screen_actual_width    (scr_coord_val w);
 static void            simgraph16_set_screen_height          (scr_coord_val const h);
@@ -562,6 +668,8 @@ static void            simgraph16_draw_filled_circle         (scr_coord_val, scr
 static void            simgraph16_draw_bezier                (scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val, const PIXVAL, scr_coord_val, scr_coord_val);
 static void            simgraph16_draw_right_triangle        (scr_coord_val, scr_coord_val, scr_coord_val, const PIXVAL, const bool);
 static bool            simgraph16_take_screenshot            (const scr_rect &, const char *);
+static void            simgraph16_benchmark_blitters         ();
+static void            simgraph16_print_image_memory         ();
 static void            simgraph16_draw_signal_direction      (scr_coord_val, scr_coord_val, uint8, uint8, PIXVAL, PIXVAL, bool, uint8);
 static void            simgraph16_set_clip_rect              (scr_coord_val, scr_coord_val, scr_coord_val, scr_coord_val  CLIP_NUM_DEF, bool fit);
 static clip_dimension  simgraph16_get_clip_rect              (CLIP_NUM_DEF_NOUSE0);
@@ -613,6 +721,9 @@ simgraph_t g_simgraph16 = {
 	/*.mark_rect_dirty_wc          =*/ simgraph16_mark_rect_dirty_wc,
 	/*.mark_rect_dirty_clip        =*/ simgraph16_mark_rect_dirty_clip,
 	/*.mark_screen_dirty           =*/ simgraph16_mark_screen_dirty,
+	/*.is_rect_dirty               =*/ simgraph16_is_rect_dirty,
+	/*.set_world_layer             =*/ simgraph16_set_world_layer,
+	/*.copy_world_layer            =*/ simgraph16_copy_world_layer,
 	/*.get_screen_size             =*/ simgraph16_get_screen_size,
 	/*.set_screen_height           =*/ simgraph16_set_screen_height,
 	/*.set_screen_actual_width     =*/ simgraph16_set_screen_actual_width,
@@ -666,6 +777,8 @@ simgraph_t g_simgraph16 = {
 	/*.draw_right_triangle         =*/ simgraph16_draw_right_triangle,
 	/*.draw_signal_direction       =*/ simgraph16_draw_signal_direction,
 	/*.take_screenshot             =*/ simgraph16_take_screenshot,
+	/*.benchmark_blitters          =*/ simgraph16_benchmark_blitters,
+	/*.print_image_memory          =*/ simgraph16_print_image_memory,
 	/*.set_clip_rect               =*/ simgraph16_set_clip_rect,
 	/*.get_clip_rect               =*/ simgraph16_get_clip_rect,
 	/*.push_clip_rect              =*/ simgraph16_push_clip_rect,
@@ -1073,6 +1186,71 @@ static void simgraph16_mark_screen_dirty()
 }
 
 
+/**
+ * Tests if any tile of the rectangle is dirty in this or the last frame
+ */
+static bool simgraph16_is_rect_dirty(scr_coord_val x1, scr_coord_val y1, scr_coord_val w, scr_coord_val h)
+{
+	scr_coord_val x2 = x1 + w - 1;
+	scr_coord_val y2 = y1 + h - 1;
+	if(  x2 < 0  ||  y2 < 0  ||  x1 >= disp_width  ||  y1 >= disp_height  ) {
+		return false;
+	}
+	x1 = max( x1, 0 ) >> DIRTY_TILE_SHIFT;
+	y1 = max( y1, 0 ) >> DIRTY_TILE_SHIFT;
+	x2 = min( x2, disp_width - 1 ) >> DIRTY_TILE_SHIFT;
+	y2 = min( y2, disp_height - 1 ) >> DIRTY_TILE_SHIFT;
+
+	for(  ;  y1 <= y2;  y1++  ) {
+		for(  int bit = y1 * tile_buffer_per_line + x1, end = bit + x2 - x1;  bit <= end;  bit++  ) {
+			if(  (tile_dirty[bit >> 5] | tile_dirty_old[bit >> 5]) & (1 << (bit & 31))  ) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+
+static bool simgraph16_set_world_layer(bool active)
+{
+	if(  !active  ) {
+		if(  framebuffer  ) {
+			textur = framebuffer;
+			framebuffer = NULL;
+		}
+		return true;
+	}
+
+	bool valid = true;
+	if(  world_layer == NULL  ||  world_layer_width != disp_width  ||  world_layer_height != disp_height  ) {
+		free( world_layer );
+		world_layer_width = disp_width;
+		world_layer_height = disp_height;
+		world_layer = MALLOCN( PIXVAL, world_layer_width * world_layer_height );
+		MEMZERON( world_layer, world_layer_width * world_layer_height );
+		valid = false;
+	}
+	if(  framebuffer == NULL  ) {
+		framebuffer = textur;
+		textur = world_layer;
+	}
+	return valid;
+}
+
+
+static void simgraph16_copy_world_layer(scr_coord_val x, scr_coord_val y, scr_coord_val w, scr_coord_val h)
+{
+	assert( framebuffer == NULL );
+	if(  world_layer == NULL  ||  !clip_lr( &x, &w, 0, disp_width )  ||  !clip_lr( &y, &h, 0, disp_height )  ) {
+		return;
+	}
+	for(  scr_coord_val yy = y;  yy < y + h;  yy++  ) {
+		memcpy( textur + yy * disp_width + x, world_layer + yy * disp_width + x, w * sizeof(PIXVAL) );
+	}
+}
+
+
 /**
  * the area of this image need update
  */
@@ -1096,27 +1274,25 @@ static void simgraph16_mark_img_dirty(image_id image, scr_coord_val xp, scr_coor
  * They are derived from a base image, which may need zooming too
  */
 
-/**
- * Flag all images for rezoom on next draw
- */
-static void rezoom()
-{
-	for(  image_id n = 0;  n < anz_images;  n++  ) {
-		if(  (images[n].recode_flags & FLAG_ZOOMABLE) != 0  &&  images[n].base_h > 0  ) {
-			images[n].recode_flags |= FLAG_REZOOM;
-		}
-	}
-}
+// forward declaration, implementation is further below
+static void image_cache_lock();
+static void image_cache_unlock();
+static void image_cache_zoom_changed(const uint32 old_zoom);
 
 
 void set_zoom_factor(int z)
 {
 	// do not zoom beyond 4 pixels
 	if(  (g_simgraph16.base_tile_raster_width * g_simgraph16.zoom_num[z]) / g_simgraph16.zoom_den[z] > 4  ) {
+		// the background job reads zoom_factor
+		image_cache_lock();
+		const uint32 old_zoom = zoom_factor;
 		zoom_factor = z;
 		g_simgraph16.tile_raster_width = (g_simgraph16.base_tile_raster_width * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-		dbg->message("set_zoom_factor()", "Zoom level now %d (%i/%i)", zoom_factor, g_simgraph16.zoom_num[zoom_factor], g_simgraph16.zoom_den[zoom_factor] );
-		rezoom();
+		// flag all images for rezoom on next draw, unless they are cached for this level
+		image_cache_zoom_changed( old_zoom );
+		image_cache_unlock();
+		dbg->message("set_zoom_factor()", "Zoom level now %d (%i/%i)", z, g_simgraph16.zoom_num[z], g_simgraph16.zoom_den[z] );
 	}
 }
 
@@ -1187,7 +1363,7 @@ static void recode()
 /**
  * Convert a certain image data to actual output data
  */
-static void recode_img_src_target(scr_coord_val h, PIXVAL *src, PIXVAL *target)
+static void recode_img_src_target(scr_coord_val h, PIXVAL *src, PIXVAL *target, const PIXVAL *rgbmap)
 {
 	if(  h > 0  ) {
 		do {
@@ -1202,7 +1378,7 @@ static void recode_img_src_target(scr_coord_val h, PIXVAL *src, PIXVAL *target)
 						if(  *src < 0x8020+(31*16)  ) {
 							// expand transparent player color
 							const uint8 alpha   = (*src-0x8020) % 31;
-							const PIXVAL colour = rgbmap_day_night[(*src-0x8020)/31+0x8000];
+							const PIXVAL colour = rgbmap[(*src-0x8020)/31+0x8000];
 
 							*target++ = 0x8020 + 31*31 + pixval_to_rgb343(colour)*31 + alpha;
 							src ++;
@@ -1214,9 +1390,9 @@ static void recode_img_src_target(scr_coord_val h, PIXVAL *src, PIXVAL *target)
 				}
 				else {
 					// now just convert the color pixels
-					while(  runlen--  ) {
-						*target++ = rgbmap_day_night[*src++];
-					}
+					blitter->recode( target, src, rgbmap, runlen );
+					target += runlen;
+					src += runlen;
 				}
 				// next clear run or zero = end
 			} while(  (runlen = *target++ = *src++)  );
@@ -1247,13 +1423,15 @@ static void recode_img(const image_id n, const sint8 player_nr)
 #endif
 	PIXVAL *src = images[n].zoom_data != NULL ? images[n].zoom_data : images[n].base_data;
 
-	if(  images[n].data[player_nr] == NULL  ) {
-		images[n].data[player_nr] = MALLOCN( PIXVAL, images[n].len );
+	PIXVAL *&data = img_data_ref( images[n], player_nr );
+	if(  data == NULL  ) {
+		data = image_arena_alloc( images[n].len );
 	}
 	// contains now the player color ...
 	activate_player_color( player_nr, true );
-	recode_img_src_target( images[n].h, src, images[n].data[player_nr] );
+	recode_img_src_target( images[n].h, src, data, rgbmap_day_night );
 	images[n].player_flags &= ~(1<<player_nr);
+	night_cache_stale = true;
 #ifdef MULTI_THREAD
 	pthread_mutex_unlock( &recode_img_mutex );
 #endif
@@ -1315,482 +1493,526 @@ PIXVAL inline zoomin_pixel(uint8 *p, uint8* pab, uint8 *prl, uint8* pdia)
 
 
 /**
- * Convert base image data to actual image size
- * Uses averages of all sampled points to get the "real" value
- * Blurs a bit
+ * Frees the zoomed and recoloured data of an image
  */
-static void rezoom_img(const image_id n)
+static void free_zoomed_img(const image_id n)
 {
-	// may this image be zoomed
-	if(  n < anz_images  &&  images[n].base_h > 0  ) {
-#ifdef MULTI_THREAD
-		pthread_mutex_lock( &rezoom_img_mutex[n % env_t::num_threads] );
-		if(  (images[n].recode_flags & FLAG_REZOOM) == 0  ) {
-			// other routine did already the re-zooming ...
-			pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
-			return;
+	image_arena_free( images[n].zoom_data );
+	images[n].zoom_data = NULL;
+	image_arena_free( images[n].data );
+	images[n].data = NULL;
+	if(  images[n].player_data  ) {
+		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT - 1;  i++  ) {
+			image_arena_free( images[n].player_data[i] );
 		}
-#endif
-		// we may need night conversion afterwards
-		images[n].player_flags = 0xFFFF; // recode all player colors
+		free( images[n].player_data );
+		images[n].player_data = NULL;
+	}
+}
 
-		//  we recalculate the len (since it may be larger than before)
-		// thus we have to free the old caches
-		if(  images[n].zoom_data != NULL  ) {
-			free( images[n].zoom_data );
-			images[n].zoom_data = NULL;
-		}
-		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
-			if(  images[n].data[i] != NULL  ) {
-				free( images[n].data[i] );
-				images[n].data[i] = NULL;
-			}
-		}
 
-		// just restore original size?
-		if(  zoom_factor == ZOOM_NEUTRAL  ||  (images[n].recode_flags&FLAG_ZOOMABLE) == 0  ) {
-			// this we can do be a simple copy ...
-			images[n].x = images[n].base_x;
-			images[n].w = images[n].base_w;
-			images[n].y = images[n].base_y;
-			images[n].h = images[n].base_h;
-			// recalculate length
-			sint16 h = images[n].base_h;
-			PIXVAL *sp = images[n].base_data;
+/**
+ * Use zoomed data for an image (which must have no zoomed or recoloured data)
+ */
+static void set_zoomed_img(const image_id n, const zoomed_img_t &zoomed)
+{
+	images[n].x = zoomed.x;
+	images[n].y = zoomed.y;
+	images[n].w = zoomed.w;
+	images[n].h = zoomed.h;
+	images[n].len = zoomed.len;
+	images[n].zoom_data = zoomed.data;
+}
 
-			while(  h-- > 0  ) {
-				do {
-					// clear run + colored run + next clear run
-					sp++;
-					sp += (*sp)&(~TRANSPARENT_RUN); // MSVC crashes on (*sp)&(~TRANSPARENT_RUN) + 1 !!!
-					sp ++;
-				} while(  *sp  );
-				sp++;
-			}
-			images[n].len = (uint32)(size_t)(sp - images[n].base_data);
-			images[n].recode_flags &= ~FLAG_REZOOM;
-#ifdef MULTI_THREAD
-			pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
-#endif
-			return;
-		}
 
-		// now we want to downsize the image
-		// just divide the sizes
-		images[n].x = (images[n].base_x * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-		images[n].y = (images[n].base_y * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-		images[n].w = (images[n].base_w * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-		images[n].h = (images[n].base_h * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-
-		if(  images[n].h > 0  &&  images[n].w > 0  ) {
-			// just recalculate the image in the new size
-			PIXVAL *src = images[n].base_data;
-			PIXVAL *dest = NULL;
-			// embed the baseimage in an image with margin ~ remainder
-			const sint16 x_rem = (images[n].base_x * g_simgraph16.zoom_num[zoom_factor]) % g_simgraph16.zoom_den[zoom_factor];
-			const sint16 y_rem = (images[n].base_y * g_simgraph16.zoom_num[zoom_factor]) % g_simgraph16.zoom_den[zoom_factor];
-			const sint16 xl_margin = max( x_rem, 0);
-			const sint16 xr_margin = max(-x_rem, 0);
-			const sint16 yl_margin = max( y_rem, 0);
-			const sint16 yr_margin = max(-y_rem, 0);
-			// baseimage top-left  corner is at (xl_margin, yl_margin)
-			// ...       low-right corner is at (xr_margin, yr_margin)
-
-			sint32 orgzoomwidth = ((images[n].base_w + g_simgraph16.zoom_den[zoom_factor] - 1 ) / g_simgraph16.zoom_den[zoom_factor]) * g_simgraph16.zoom_den[zoom_factor];
-			sint32 newzoomwidth = (orgzoomwidth*g_simgraph16.zoom_num[zoom_factor])/g_simgraph16.zoom_den[zoom_factor];
-			sint32 orgzoomheight = ((images[n].base_h + g_simgraph16.zoom_den[zoom_factor] - 1 ) / g_simgraph16.zoom_den[zoom_factor]) * g_simgraph16.zoom_den[zoom_factor];
-			sint32 newzoomheight = (orgzoomheight * g_simgraph16.zoom_num[zoom_factor]) / g_simgraph16.zoom_den[zoom_factor];
-
-			// we will unpack, re-sample, pack it
-
-			// thus the unpack buffer must at least fit the window => find out maximum size
-			// Note: This value is certainly way bigger than the average size we'll get,
-			// but it's the worst scenario possible, a succession of solid - transparent - solid - transparent
-			// pattern.
-			// This would encode EACH LINE as:
-			// 0x0000 (0 transparent) 0x0001 PIXWORD 0x0001 (every 2 pixels, 3 words) 0x0000 (EOL)
-			// The extra +1 is to make sure we cover divisions with module != 0
-			// We end with an over sized buffer for the normal usage, but since it's re-used for all re-zooms,
-			// it's not performance critical and we are safe from all possible inputs.
-
-			size_t new_size = ( ( (newzoomwidth * 3) / 2 ) + 1 + 2) * newzoomheight * sizeof(PIXVAL);
-			size_t unpack_size = (xl_margin + orgzoomwidth + xr_margin) * (yl_margin + orgzoomheight + yr_margin) * 4;
-			if(  unpack_size > new_size  ) {
-				new_size = unpack_size;
-			}
-			new_size = ((new_size * 128) + 127) / 128; // enlarge slightly to try and keep buffers on their own cacheline for multithreaded access. A portable aligned_alloc would be better.
-			if(  rezoom_size[n % env_t::num_threads] < new_size  ) {
-				free( rezoom_baseimage2[n % env_t::num_threads] );
-				free( rezoom_baseimage[n % env_t::num_threads] );
-				rezoom_size[n % env_t::num_threads] = new_size;
-				rezoom_baseimage[n % env_t::num_threads]  = MALLOCN( uint8, new_size );
-				rezoom_baseimage2[n % env_t::num_threads] = reinterpret_cast<PIXVAL *>(MALLOCN(uint8, new_size));
-			}
-			memset( rezoom_baseimage[n % env_t::num_threads], 255, new_size ); // fill with invalid data to mark transparent regions
+/**
+ * Length of the original image data
+ */
+static uint32 get_base_len(const imd &img)
+{
+	sint16 h = img.base_h;
+	PIXVAL *sp = img.base_data;
 
-			// index of top-left corner
-			uint32 baseoff = 4 * (yl_margin * (xl_margin + orgzoomwidth + xr_margin) + xl_margin);
-			sint32 basewidth = xl_margin + orgzoomwidth + xr_margin;
+	while(  h-- > 0  ) {
+		do {
+			// clear run + colored run + next clear run
+			sp++;
+			sp += (*sp)&(~TRANSPARENT_RUN); // MSVC crashes on (*sp)&(~TRANSPARENT_RUN) + 1 !!!
+			sp ++;
+		} while(  *sp  );
+		sp++;
+	}
+	return (uint32)(size_t)(sp - img.base_data);
+}
 
-			// now: unpack the image
-			for(  sint32 y = 0;  y < images[n].base_h;  ++y  ) {
-				uint16 runlen;
-				uint8 *p = rezoom_baseimage[n % env_t::num_threads] + baseoff + y * (basewidth * 4);
 
-				// decode line
-				runlen = *src++;
-				do {
-					// clear run
-					p += (runlen & ~TRANSPARENT_RUN) * 4;
-					// color pixel
-					runlen = (*src++) & ~TRANSPARENT_RUN;
-					while(  runlen--  ) {
-						// get rgb components
-						PIXVAL s = *src++;
-						*p++ = (s>>15);
-						*p++ = (s & 31);
-						s >>= 5;
-						*p++ = (s & 31);
-						s >>= 5;
-						*p++ = (s & 31);
-					}
-					runlen = *src++;
-				} while(  runlen != 0  );
-			}
+/**
+ * Convert base image data of @p img to the size of zoom level @p zoom into @p out,
+ * using the unpack buffers @p buf. Does not change @p img, so it can be used for any zoom level.
+ * Uses averages of all sampled points to get the "real" value
+ * Blurs a bit
+ */
+static void zoom_img_data(const imd &img, const uint32 zoom, rezoom_buffer_t &buf, zoomed_img_t &out)
+{
+	out.data = NULL;
+	out.len = img.len;
+
+	// just restore original size?
+	if(  zoom == ZOOM_NEUTRAL  ) {
+		// this we can do be a simple copy ...
+		out.x = img.base_x;
+		out.w = img.base_w;
+		out.y = img.base_y;
+		out.h = img.base_h;
+		out.len = get_base_len( img );
+		return;
+	}
 
-			// now we have the image, we do a repack then
-			dest = rezoom_baseimage2[n % env_t::num_threads];
-			switch(  g_simgraph16.zoom_den[zoom_factor]  ) {
-				case 1: {
-					assert(g_simgraph16.zoom_num[zoom_factor]==2);
-
-					// first half row - just copy values, do not fiddle with neighbor colors
-					uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff;
-					for(  sint16 x = 0;  x < orgzoomwidth;  x++  ) {
-						PIXVAL c1 = compress_pixel_transparent( p1 + (x * 4) );
-						// now set the pixel ...
-						dest[x * 2] = c1;
-						dest[x * 2 + 1] = c1;
-					}
-					// skip one line
-					dest += newzoomwidth;
-
-					for(  sint16 y = 0;  y < orgzoomheight - 1;  y++  ) {
-						uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + y * (basewidth * 4);
-						// copy leftmost pixels
-						dest[0] = compress_pixel_transparent( p1 );
-						dest[newzoomwidth] = compress_pixel_transparent( p1 + basewidth * 4 );
-						for(  sint16 x = 0;  x < orgzoomwidth - 1;  x++  ) {
-							uint8 *px1 = p1 + (x * 4);
-							// pixel at 2,2 in 2x2 superpixel
-							dest[x * 2 + 1] = zoomin_pixel( px1, px1 + 4, px1 + basewidth * 4, px1 + basewidth * 4 + 4 );
-
-							// 2x2 superpixel is transparent but original pixel was not
+	// now we want to downsize the image
+	// just divide the sizes
+	out.x = (img.base_x * g_simgraph16.zoom_num[zoom]) / g_simgraph16.zoom_den[zoom];
+	out.y = (img.base_y * g_simgraph16.zoom_num[zoom]) / g_simgraph16.zoom_den[zoom];
+	out.w = (img.base_w * g_simgraph16.zoom_num[zoom]) / g_simgraph16.zoom_den[zoom];
+	out.h = (img.base_h * g_simgraph16.zoom_num[zoom]) / g_simgraph16.zoom_den[zoom];
+
+	if(  out.h > 0  &&  out.w > 0  ) {
+		// just recalculate the image in the new size
+		PIXVAL *src = img.base_data;
+		PIXVAL *dest = NULL;
+		// embed the baseimage in an image with margin ~ remainder
+		const sint16 x_rem = (img.base_x * g_simgraph16.zoom_num[zoom]) % g_simgraph16.zoom_den[zoom];
+		const sint16 y_rem = (img.base_y * g_simgraph16.zoom_num[zoom]) % g_simgraph16.zoom_den[zoom];
+		const sint16 xl_margin = max( x_rem, 0);
+		const sint16 xr_margin = max(-x_rem, 0);
+		const sint16 yl_margin = max( y_rem, 0);
+		const sint16 yr_margin = max(-y_rem, 0);
+		// baseimage top-left  corner is at (xl_margin, yl_margin)
+		// ...       low-right corner is at (xr_margin, yr_margin)
+
+		sint32 orgzoomwidth = ((img.base_w + g_simgraph16.zoom_den[zoom] - 1 ) / g_simgraph16.zoom_den[zoom]) * g_simgraph16.zoom_den[zoom];
+		sint32 newzoomwidth = (orgzoomwidth*g_simgraph16.zoom_num[zoom])/g_simgraph16.zoom_den[zoom];
+		sint32 orgzoomheight = ((img.base_h + g_simgraph16.zoom_den[zoom] - 1 ) / g_simgraph16.zoom_den[zoom]) * g_simgraph16.zoom_den[zoom];
+		sint32 newzoomheight = (orgzoomheight * g_simgraph16.zoom_num[zoom]) / g_simgraph16.zoom_den[zoom];
+
+		// we will unpack, re-sample, pack it
+
+		// thus the unpack buffer must at least fit the window => find out maximum size
+		// Note: This value is certainly way bigger than the average size we'll get,
+		// but it's the worst scenario possible, a succession of solid - transparent - solid - transparent
+		// pattern.
+		// This would encode EACH LINE as:
+		// 0x0000 (0 transparent) 0x0001 PIXWORD 0x0001 (every 2 pixels, 3 words) 0x0000 (EOL)
+		// The extra +1 is to make sure we cover divisions with module != 0
+		// We end with an over sized buffer for the normal usage, but since it's re-used for all re-zooms,
+		// it's not performance critical and we are safe from all possible inputs.
+
+		size_t new_size = ( ( (newzoomwidth * 3) / 2 ) + 1 + 2) * newzoomheight * sizeof(PIXVAL);
+		size_t unpack_size = (xl_margin + orgzoomwidth + xr_margin) * (yl_margin + orgzoomheight + yr_margin) * 4;
+		if(  unpack_size > new_size  ) {
+			new_size = unpack_size;
+		}
+		new_size = ((new_size * 128) + 127) / 128; // enlarge slightly to try and keep buffers on their own cacheline for multithreaded access. A portable aligned_alloc would be better.
+		if(  buf.size < new_size  ) {
+			free( buf.baseimage2 );
+			free( buf.baseimage );
+			buf.size = new_size;
+			buf.baseimage  = MALLOCN( uint8, new_size );
+			buf.baseimage2 = reinterpret_cast<PIXVAL *>(MALLOCN(uint8, new_size));
+		}
+		memset( buf.baseimage, 255, new_size ); // fill with invalid data to mark transparent regions
+
+		// index of top-left corner
+		uint32 baseoff = 4 * (yl_margin * (xl_margin + orgzoomwidth + xr_margin) + xl_margin);
+		sint32 basewidth = xl_margin + orgzoomwidth + xr_margin;
+
+		// now: unpack the image
+		for(  sint32 y = 0;  y < img.base_h;  ++y  ) {
+			uint16 runlen;
+			uint8 *p = buf.baseimage + baseoff + y * (basewidth * 4);
+
+			// decode line
+			runlen = *src++;
+			do {
+				// clear run
+				p += (runlen & ~TRANSPARENT_RUN) * 4;
+				// color pixel
+				runlen = (*src++) & ~TRANSPARENT_RUN;
+				while(  runlen--  ) {
+					// get rgb components
+					PIXVAL s = *src++;
+					*p++ = (s>>15);
+					*p++ = (s & 31);
+					s >>= 5;
+					*p++ = (s & 31);
+					s >>= 5;
+					*p++ = (s & 31);
+				}
+				runlen = *src++;
+			} while(  runlen != 0  );
+		}
+
+		// now we have the image, we do a repack then
+		dest = buf.baseimage2;
+		switch(  g_simgraph16.zoom_den[zoom]  ) {
+			case 1: {
+				assert(g_simgraph16.zoom_num[zoom]==2);
+
+				// first half row - just copy values, do not fiddle with neighbor colors
+				uint8 *p1 = buf.baseimage + baseoff;
+				for(  sint16 x = 0;  x < orgzoomwidth;  x++  ) {
+					PIXVAL c1 = compress_pixel_transparent( p1 + (x * 4) );
+					// now set the pixel ...
+					dest[x * 2] = c1;
+					dest[x * 2 + 1] = c1;
+				}
+				// skip one line
+				dest += newzoomwidth;
+
+				for(  sint16 y = 0;  y < orgzoomheight - 1;  y++  ) {
+					uint8 *p1 = buf.baseimage + baseoff + y * (basewidth * 4);
+					// copy leftmost pixels
+					dest[0] = compress_pixel_transparent( p1 );
+					dest[newzoomwidth] = compress_pixel_transparent( p1 + basewidth * 4 );
+					for(  sint16 x = 0;  x < orgzoomwidth - 1;  x++  ) {
+						uint8 *px1 = p1 + (x * 4);
+						// pixel at 2,2 in 2x2 superpixel
+						dest[x * 2 + 1] = zoomin_pixel( px1, px1 + 4, px1 + basewidth * 4, px1 + basewidth * 4 + 4 );
+
+						// 2x2 superpixel is transparent but original pixel was not
+						// preserve one pixel
+						if(  dest[x * 2 + 1] == 0x73FE  &&  px1[0] != 255  &&  dest[x * 2] == 0x73FE  &&  dest[x * 2 - newzoomwidth] == 0x73FE  &&  dest[x * 2 - newzoomwidth - 1] == 0x73FE  ) {
 							// preserve one pixel
-							if(  dest[x * 2 + 1] == 0x73FE  &&  px1[0] != 255  &&  dest[x * 2] == 0x73FE  &&  dest[x * 2 - newzoomwidth] == 0x73FE  &&  dest[x * 2 - newzoomwidth - 1] == 0x73FE  ) {
-								// preserve one pixel
-								dest[x * 2 + 1] = compress_pixel( px1 );
-							}
+							dest[x * 2 + 1] = compress_pixel( px1 );
+						}
 
-							// pixel at 2,1 in next 2x2 superpixel
-							dest[x * 2 + 2] = zoomin_pixel( px1 + 4, px1, px1 + basewidth * 4 + 4, px1 + basewidth * 4 );
+						// pixel at 2,1 in next 2x2 superpixel
+						dest[x * 2 + 2] = zoomin_pixel( px1 + 4, px1, px1 + basewidth * 4 + 4, px1 + basewidth * 4 );
 
-							// pixel at 1,2 in next row 2x2 superpixel
-							dest[x * 2 + newzoomwidth + 1] = zoomin_pixel( px1 + basewidth * 4, px1 + basewidth * 4 + 4, px1, px1 + 4 );
+						// pixel at 1,2 in next row 2x2 superpixel
+						dest[x * 2 + newzoomwidth + 1] = zoomin_pixel( px1 + basewidth * 4, px1 + basewidth * 4 + 4, px1, px1 + 4 );
 
-							// pixel at 1,1 in next row next 2x2 superpixel
-							dest[x * 2 + newzoomwidth + 2] = zoomin_pixel( px1 + basewidth * 4 + 4, px1 + basewidth * 4, px1 + 4, px1 );
-						}
-						// copy rightmost pixels
-						dest[2 * orgzoomwidth - 1] = compress_pixel_transparent( p1 + 4 * (orgzoomwidth - 1) );
-						dest[2 * orgzoomwidth + newzoomwidth - 1] = compress_pixel_transparent( p1 + 4 * (orgzoomwidth - 1) + basewidth * 4 );
-						// skip two lines
-						dest += 2 * newzoomwidth;
-					}
-					// last half row - just copy values, do not fiddle with neighbor colors
-					p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + (orgzoomheight - 1) * (basewidth * 4);
-					for(  sint16 x = 0;  x < orgzoomwidth;  x++  ) {
-						PIXVAL c1 = compress_pixel_transparent( p1 + (x * 4) );
-						// now set the pixel ...
-						dest[x * 2]   = c1;
-						dest[x * 2 + 1] = c1;
+						// pixel at 1,1 in next row next 2x2 superpixel
+						dest[x * 2 + newzoomwidth + 2] = zoomin_pixel( px1 + basewidth * 4 + 4, px1 + basewidth * 4, px1 + 4, px1 );
 					}
-					break;
+					// copy rightmost pixels
+					dest[2 * orgzoomwidth - 1] = compress_pixel_transparent( p1 + 4 * (orgzoomwidth - 1) );
+					dest[2 * orgzoomwidth + newzoomwidth - 1] = compress_pixel_transparent( p1 + 4 * (orgzoomwidth - 1) + basewidth * 4 );
+					// skip two lines
+					dest += 2 * newzoomwidth;
+				}
+				// last half row - just copy values, do not fiddle with neighbor colors
+				p1 = buf.baseimage + baseoff + (orgzoomheight - 1) * (basewidth * 4);
+				for(  sint16 x = 0;  x < orgzoomwidth;  x++  ) {
+					PIXVAL c1 = compress_pixel_transparent( p1 + (x * 4) );
+					// now set the pixel ...
+					dest[x * 2]   = c1;
+					dest[x * 2 + 1] = c1;
 				}
-				case 2:
-					for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
-						uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 0 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p2 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 1 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
-							uint8 valid = 0;
-							uint8 r = 0, g = 0, b = 0;
-							sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom_factor] + 0 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom_factor] + 1 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							SumSubpixel( p1 + xreal1 );
-							SumSubpixel( p1 + xreal2 );
-							SumSubpixel( p2 + xreal1 );
-							SumSubpixel( p2 + xreal2 );
-							if(  valid == 0  ) {
-								*dest++ = 0x73FE;
-							}
-							else if(  valid == 255  ) {
-								*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
-							}
-							else {
-								*dest++ = (r/valid) + (((uint16)(g/valid))<<5) + (((uint16)(b/valid))<<10);
-							}
+				break;
+			}
+			case 2:
+				for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
+					uint8 *p1 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 0 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p2 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 1 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
+						uint8 valid = 0;
+						uint8 r = 0, g = 0, b = 0;
+						sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom] + 0 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom] + 1 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						SumSubpixel( p1 + xreal1 );
+						SumSubpixel( p1 + xreal2 );
+						SumSubpixel( p2 + xreal1 );
+						SumSubpixel( p2 + xreal2 );
+						if(  valid == 0  ) {
+							*dest++ = 0x73FE;
+						}
+						else if(  valid == 255  ) {
+							*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
+						}
+						else {
+							*dest++ = (r/valid) + (((uint16)(g/valid))<<5) + (((uint16)(b/valid))<<10);
 						}
 					}
-					break;
-				case 3:
-					for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
-						uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 0 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p2 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 1 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p3 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 2 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
-							uint8 valid = 0;
-							uint16 r = 0, g = 0, b = 0;
-							sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom_factor] + 0 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom_factor] + 1 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom_factor] + 2 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							SumSubpixel( p1 + xreal1 );
-							SumSubpixel( p1 + xreal2 );
-							SumSubpixel( p1 + xreal3 );
-							SumSubpixel( p2 + xreal1 );
-							SumSubpixel( p2 + xreal2 );
-							SumSubpixel( p2 + xreal3 );
-							SumSubpixel( p3 + xreal1 );
-							SumSubpixel( p3 + xreal2 );
-							SumSubpixel( p3 + xreal3 );
-							if(  valid == 0  ) {
-								*dest++ = 0x73FE;
-							}
-							else if(  valid == 255  ) {
-								*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
-							}
-							else {
-								*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
-							}
+				}
+				break;
+			case 3:
+				for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
+					uint8 *p1 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 0 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p2 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 1 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p3 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 2 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
+						uint8 valid = 0;
+						uint16 r = 0, g = 0, b = 0;
+						sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom] + 0 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom] + 1 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom] + 2 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						SumSubpixel( p1 + xreal1 );
+						SumSubpixel( p1 + xreal2 );
+						SumSubpixel( p1 + xreal3 );
+						SumSubpixel( p2 + xreal1 );
+						SumSubpixel( p2 + xreal2 );
+						SumSubpixel( p2 + xreal3 );
+						SumSubpixel( p3 + xreal1 );
+						SumSubpixel( p3 + xreal2 );
+						SumSubpixel( p3 + xreal3 );
+						if(  valid == 0  ) {
+							*dest++ = 0x73FE;
+						}
+						else if(  valid == 255  ) {
+							*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
+						}
+						else {
+							*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
 						}
 					}
-					break;
-				case 4:
-					for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
-						uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 0 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p2 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 1 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p3 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 2 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p4 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 3 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
-							uint8 valid = 0;
-							uint16 r = 0, g = 0, b = 0;
-							sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom_factor] + 0 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom_factor] + 1 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom_factor] + 2 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal4 = ((x * g_simgraph16.zoom_den[zoom_factor] + 3 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							SumSubpixel( p1 + xreal1 );
-							SumSubpixel( p1 + xreal2 );
-							SumSubpixel( p1 + xreal3 );
-							SumSubpixel( p1 + xreal4 );
-							SumSubpixel( p2 + xreal1 );
-							SumSubpixel( p2 + xreal2 );
-							SumSubpixel( p2 + xreal3 );
-							SumSubpixel( p2 + xreal4 );
-							SumSubpixel( p3 + xreal1 );
-							SumSubpixel( p3 + xreal2 );
-							SumSubpixel( p3 + xreal3 );
-							SumSubpixel( p3 + xreal4 );
-							SumSubpixel( p4 + xreal1 );
-							SumSubpixel( p4 + xreal2 );
-							SumSubpixel( p4 + xreal3 );
-							SumSubpixel( p4 + xreal4 );
-							if(  valid == 0  ) {
-								*dest++ = 0x73FE;
-							}
-							else if(  valid == 255  ) {
-								*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
-							}
-							else {
-								*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
-							}
+				}
+				break;
+			case 4:
+				for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
+					uint8 *p1 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 0 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p2 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 1 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p3 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 2 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p4 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 3 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
+						uint8 valid = 0;
+						uint16 r = 0, g = 0, b = 0;
+						sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom] + 0 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom] + 1 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom] + 2 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal4 = ((x * g_simgraph16.zoom_den[zoom] + 3 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						SumSubpixel( p1 + xreal1 );
+						SumSubpixel( p1 + xreal2 );
+						SumSubpixel( p1 + xreal3 );
+						SumSubpixel( p1 + xreal4 );
+						SumSubpixel( p2 + xreal1 );
+						SumSubpixel( p2 + xreal2 );
+						SumSubpixel( p2 + xreal3 );
+						SumSubpixel( p2 + xreal4 );
+						SumSubpixel( p3 + xreal1 );
+						SumSubpixel( p3 + xreal2 );
+						SumSubpixel( p3 + xreal3 );
+						SumSubpixel( p3 + xreal4 );
+						SumSubpixel( p4 + xreal1 );
+						SumSubpixel( p4 + xreal2 );
+						SumSubpixel( p4 + xreal3 );
+						SumSubpixel( p4 + xreal4 );
+						if(  valid == 0  ) {
+							*dest++ = 0x73FE;
+						}
+						else if(  valid == 255  ) {
+							*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
+						}
+						else {
+							*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
 						}
 					}
-					break;
-				case 8:
-					for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
-						uint8 *p1 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 0 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p2 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 1 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p3 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 2 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p4 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 3 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p5 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 4 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p6 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 5 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p7 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 6 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						uint8 *p8 = rezoom_baseimage[n % env_t::num_threads] + baseoff + ((y * g_simgraph16.zoom_den[zoom_factor] + 7 - y_rem) / g_simgraph16.zoom_num[zoom_factor]) * (basewidth * 4);
-						for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
-							uint8 valid = 0;
-							uint16 r = 0, g = 0, b = 0;
-							sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom_factor] + 0 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom_factor] + 1 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom_factor] + 2 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal4 = ((x * g_simgraph16.zoom_den[zoom_factor] + 3 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal5 = ((x * g_simgraph16.zoom_den[zoom_factor] + 4 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal6 = ((x * g_simgraph16.zoom_den[zoom_factor] + 5 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal7 = ((x * g_simgraph16.zoom_den[zoom_factor] + 6 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							sint16 xreal8 = ((x * g_simgraph16.zoom_den[zoom_factor] + 7 - x_rem) / g_simgraph16.zoom_num[zoom_factor]) * 4;
-							SumSubpixel( p1 + xreal1 );
-							SumSubpixel( p1 + xreal2 );
-							SumSubpixel( p1 + xreal3 );
-							SumSubpixel( p1 + xreal4 );
-							SumSubpixel( p1 + xreal5 );
-							SumSubpixel( p1 + xreal6 );
-							SumSubpixel( p1 + xreal7 );
-							SumSubpixel( p1 + xreal8 );
-							SumSubpixel( p2 + xreal1 );
-							SumSubpixel( p2 + xreal2 );
-							SumSubpixel( p2 + xreal3 );
-							SumSubpixel( p2 + xreal4 );
-							SumSubpixel( p2 + xreal5 );
-							SumSubpixel( p2 + xreal6 );
-							SumSubpixel( p2 + xreal7 );
-							SumSubpixel( p2 + xreal8 );
-							SumSubpixel( p3 + xreal1 );
-							SumSubpixel( p3 + xreal2 );
-							SumSubpixel( p3 + xreal3 );
-							SumSubpixel( p3 + xreal4 );
-							SumSubpixel( p3 + xreal5 );
-							SumSubpixel( p3 + xreal6 );
-							SumSubpixel( p3 + xreal7 );
-							SumSubpixel( p3 + xreal8 );
-							SumSubpixel( p4 + xreal1 );
-							SumSubpixel( p4 + xreal2 );
-							SumSubpixel( p4 + xreal3 );
-							SumSubpixel( p4 + xreal4 );
-							SumSubpixel( p4 + xreal5 );
-							SumSubpixel( p4 + xreal6 );
-							SumSubpixel( p4 + xreal7 );
-							SumSubpixel( p4 + xreal8 );
-							SumSubpixel( p5 + xreal1 );
-							SumSubpixel( p5 + xreal2 );
-							SumSubpixel( p5 + xreal3 );
-							SumSubpixel( p5 + xreal4 );
-							SumSubpixel( p5 + xreal5 );
-							SumSubpixel( p5 + xreal6 );
-							SumSubpixel( p5 + xreal7 );
-							SumSubpixel( p5 + xreal8 );
-							SumSubpixel( p6 + xreal1 );
-							SumSubpixel( p6 + xreal2 );
-							SumSubpixel( p6 + xreal3 );
-							SumSubpixel( p6 + xreal4 );
-							SumSubpixel( p6 + xreal5 );
-							SumSubpixel( p6 + xreal6 );
-							SumSubpixel( p6 + xreal7 );
-							SumSubpixel( p6 + xreal8 );
-							SumSubpixel( p7 + xreal1 );
-							SumSubpixel( p7 + xreal2 );
-							SumSubpixel( p7 + xreal3 );
-							SumSubpixel( p7 + xreal4 );
-							SumSubpixel( p7 + xreal5 );
-							SumSubpixel( p7 + xreal6 );
-							SumSubpixel( p7 + xreal7 );
-							SumSubpixel( p7 + xreal8 );
-							SumSubpixel( p8 + xreal1 );
-							SumSubpixel( p8 + xreal2 );
-							SumSubpixel( p8 + xreal3 );
-							SumSubpixel( p8 + xreal4 );
-							SumSubpixel( p8 + xreal5 );
-							SumSubpixel( p8 + xreal6 );
-							SumSubpixel( p8 + xreal7 );
-							SumSubpixel( p8 + xreal8 );
-							if(  valid == 0  ) {
-								*dest++ = 0x73FE;
-							}
-							else if(  valid == 255  ) {
-								*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
-							}
-							else {
-								*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
-							}
+				}
+				break;
+			case 8:
+				for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
+					uint8 *p1 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 0 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p2 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 1 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p3 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 2 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p4 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 3 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p5 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 4 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p6 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 5 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p7 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 6 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					uint8 *p8 = buf.baseimage + baseoff + ((y * g_simgraph16.zoom_den[zoom] + 7 - y_rem) / g_simgraph16.zoom_num[zoom]) * (basewidth * 4);
+					for(  sint16 x = 0;  x < newzoomwidth;  x++  ) {
+						uint8 valid = 0;
+						uint16 r = 0, g = 0, b = 0;
+						sint16 xreal1 = ((x * g_simgraph16.zoom_den[zoom] + 0 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal2 = ((x * g_simgraph16.zoom_den[zoom] + 1 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal3 = ((x * g_simgraph16.zoom_den[zoom] + 2 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal4 = ((x * g_simgraph16.zoom_den[zoom] + 3 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal5 = ((x * g_simgraph16.zoom_den[zoom] + 4 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal6 = ((x * g_simgraph16.zoom_den[zoom] + 5 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal7 = ((x * g_simgraph16.zoom_den[zoom] + 6 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						sint16 xreal8 = ((x * g_simgraph16.zoom_den[zoom] + 7 - x_rem) / g_simgraph16.zoom_num[zoom]) * 4;
+						SumSubpixel( p1 + xreal1 );
+						SumSubpixel( p1 + xreal2 );
+						SumSubpixel( p1 + xreal3 );
+						SumSubpixel( p1 + xreal4 );
+						SumSubpixel( p1 + xreal5 );
+						SumSubpixel( p1 + xreal6 );
+						SumSubpixel( p1 + xreal7 );
+						SumSubpixel( p1 + xreal8 );
+						SumSubpixel( p2 + xreal1 );
+						SumSubpixel( p2 + xreal2 );
+						SumSubpixel( p2 + xreal3 );
+						SumSubpixel( p2 + xreal4 );
+						SumSubpixel( p2 + xreal5 );
+						SumSubpixel( p2 + xreal6 );
+						SumSubpixel( p2 + xreal7 );
+						SumSubpixel( p2 + xreal8 );
+						SumSubpixel( p3 + xreal1 );
+						SumSubpixel( p3 + xreal2 );
+						SumSubpixel( p3 + xreal3 );
+						SumSubpixel( p3 + xreal4 );
+						SumSubpixel( p3 + xreal5 );
+						SumSubpixel( p3 + xreal6 );
+						SumSubpixel( p3 + xreal7 );
+						SumSubpixel( p3 + xreal8 );
+						SumSubpixel( p4 + xreal1 );
+						SumSubpixel( p4 + xreal2 );
+						SumSubpixel( p4 + xreal3 );
+						SumSubpixel( p4 + xreal4 );
+						SumSubpixel( p4 + xreal5 );
+						SumSubpixel( p4 + xreal6 );
+						SumSubpixel( p4 + xreal7 );
+						SumSubpixel( p4 + xreal8 );
+						SumSubpixel( p5 + xreal1 );
+						SumSubpixel( p5 + xreal2 );
+						SumSubpixel( p5 + xreal3 );
+						SumSubpixel( p5 + xreal4 );
+						SumSubpixel( p5 + xreal5 );
+						SumSubpixel( p5 + xreal6 );
+						SumSubpixel( p5 + xreal7 );
+						SumSubpixel( p5 + xreal8 );
+						SumSubpixel( p6 + xreal1 );
+						SumSubpixel( p6 + xreal2 );
+						SumSubpixel( p6 + xreal3 );
+						SumSubpixel( p6 + xreal4 );
+						SumSubpixel( p6 + xreal5 );
+						SumSubpixel( p6 + xreal6 );
+						SumSubpixel( p6 + xreal7 );
+						SumSubpixel( p6 + xreal8 );
+						SumSubpixel( p7 + xreal1 );
+						SumSubpixel( p7 + xreal2 );
+						SumSubpixel( p7 + xreal3 );
+						SumSubpixel( p7 + xreal4 );
+						SumSubpixel( p7 + xreal5 );
+						SumSubpixel( p7 + xreal6 );
+						SumSubpixel( p7 + xreal7 );
+						SumSubpixel( p7 + xreal8 );
+						SumSubpixel( p8 + xreal1 );
+						SumSubpixel( p8 + xreal2 );
+						SumSubpixel( p8 + xreal3 );
+						SumSubpixel( p8 + xreal4 );
+						SumSubpixel( p8 + xreal5 );
+						SumSubpixel( p8 + xreal6 );
+						SumSubpixel( p8 + xreal7 );
+						SumSubpixel( p8 + xreal8 );
+						if(  valid == 0  ) {
+							*dest++ = 0x73FE;
+						}
+						else if(  valid == 255  ) {
+							*dest++ = (0x8000 | r) + (((uint16)g)<<5) + (((uint16)b)<<10);
+						}
+						else {
+							*dest++ = (r/valid) | (((uint16)(g/valid))<<5) | (((uint16)(b/valid))<<10);
 						}
 					}
-					break;
-				default: assert(0);
-			}
+				}
+				break;
+			default: assert(0);
+		}
 
-			// now encode the image again
-			dest = reinterpret_cast<PIXVAL *>(rezoom_baseimage[n % env_t::num_threads]);
-			for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
-				PIXVAL *line = ((PIXVAL *)rezoom_baseimage2[n % env_t::num_threads]) + (y * newzoomwidth);
-				PIXVAL count;
-				sint16 x = 0;
-				uint16 clear_colored_run_pair_count = 0;
+		// now encode the image again
+		dest = reinterpret_cast<PIXVAL *>(buf.baseimage);
+		for(  sint16 y = 0;  y < newzoomheight;  y++  ) {
+			PIXVAL *line = ((PIXVAL *)buf.baseimage2) + (y * newzoomwidth);
+			PIXVAL count;
+			sint16 x = 0;
+			uint16 clear_colored_run_pair_count = 0;
 
-				do {
-					// check length of transparent pixels
-					for(  count = 0;  x < newzoomwidth  &&  line[x] == 0x73FE;  count++, x++  )
-						{}
-					// first runlength: transparent pixels
-					*dest++ = count;
-					uint16 has_alpha = 0;
-					// copy for non-transparent
-					count = 0;
-					while(  x < newzoomwidth  &&  line[x] != 0x73FE  ) {
-						PIXVAL pixval = line[x++];
-						if(  pixval >= 0x8020  &&  !has_alpha  ) {
-							if(  count  ) {
-								*dest++ = count;
-								dest += count;
-								count = 0;
-								*dest++ = TRANSPARENT_RUN;
-							}
-							has_alpha = TRANSPARENT_RUN;
+			do {
+				// check length of transparent pixels
+				for(  count = 0;  x < newzoomwidth  &&  line[x] == 0x73FE;  count++, x++  )
+					{}
+				// first runlength: transparent pixels
+				*dest++ = count;
+				uint16 has_alpha = 0;
+				// copy for non-transparent
+				count = 0;
+				while(  x < newzoomwidth  &&  line[x] != 0x73FE  ) {
+					PIXVAL pixval = line[x++];
+					if(  pixval >= 0x8020  &&  !has_alpha  ) {
+						if(  count  ) {
+							*dest++ = count;
+							dest += count;
+							count = 0;
+							*dest++ = TRANSPARENT_RUN;
 						}
-						else if(  pixval < 0x8020  &&  has_alpha  ) {
-							if(  count  ) {
-								*dest++ = count+TRANSPARENT_RUN;
-								dest += count;
-								count = 0;
-								*dest++ = TRANSPARENT_RUN;
-							}
-							has_alpha = 0;
+						has_alpha = TRANSPARENT_RUN;
+					}
+					else if(  pixval < 0x8020  &&  has_alpha  ) {
+						if(  count  ) {
+							*dest++ = count+TRANSPARENT_RUN;
+							dest += count;
+							count = 0;
+							*dest++ = TRANSPARENT_RUN;
 						}
-						count++;
-						dest[count] = pixval;
+						has_alpha = 0;
 					}
+					count++;
+					dest[count] = pixval;
+				}
 
-					/*
-					 * If it is not the first clear-colored-run pair and its colored run is empty
-					 * --> it is superfluous and can be removed by rolling back the pointer
-					 */
-					if(  clear_colored_run_pair_count > 0  &&  count == 0  ) {
-						dest--;
-						// this only happens at the end of a line, so no need to increment clear_colored_run_pair_count
-					}
-					else {
-						*dest++ = count+has_alpha; // number of colored pixels
-						dest += count; // skip them
-						clear_colored_run_pair_count++;
-					}
-				} while(  x < newzoomwidth  );
-				*dest++ = 0; // mark line end
-			}
+				/*
+				 * If it is not the first clear-colored-run pair and its colored run is empty
+				 * --> it is superfluous and can be removed by rolling back the pointer
+				 */
+				if(  clear_colored_run_pair_count > 0  &&  count == 0  ) {
+					dest--;
+					// this only happens at the end of a line, so no need to increment clear_colored_run_pair_count
+				}
+				else {
+					*dest++ = count+has_alpha; // number of colored pixels
+					dest += count; // skip them
+					clear_colored_run_pair_count++;
+				}
+			} while(  x < newzoomwidth  );
+			*dest++ = 0; // mark line end
+		}
 
-			// something left?
-			images[n].w = newzoomwidth;
-			images[n].h = newzoomheight;
-			if(  newzoomheight > 0  ) {
-				const size_t zoom_len = (size_t)(((uint8 *)dest) - ((uint8 *)rezoom_baseimage[n % env_t::num_threads]));
-				images[n].len = (uint32)(zoom_len / sizeof(PIXVAL));
-				images[n].zoom_data = MALLOCN(PIXVAL, images[n].len);
-				assert( images[n].zoom_data );
-				memcpy( images[n].zoom_data, rezoom_baseimage[n % env_t::num_threads], zoom_len );
-			}
+		// something left?
+		out.w = newzoomwidth;
+		out.h = newzoomheight;
+		if(  newzoomheight > 0  ) {
+			const size_t zoom_len = (size_t)(((uint8 *)dest) - ((uint8 *)buf.baseimage));
+			out.len = (uint32)(zoom_len / sizeof(PIXVAL));
+			out.data = image_arena_alloc(out.len);
+			assert( out.data );
+			memcpy( out.data, buf.baseimage, zoom_len );
 		}
-		else {
-//			if (images[n].w <= 0) {
+	}
+	else {
+//			if (out.w <= 0) {
 //				// h=0 will be ignored, with w=0 there was an error!
 //				printf("WARNING: image%d w=0!\n", n);
 //			}
-			images[n].h = 0;
+		out.h = 0;
+	}
+}
+
+
+/**
+ * Convert base image data to actual image size
+ */
+static void rezoom_img(const image_id n)
+{
+	// may this image be zoomed
+	if(  n < anz_images  &&  images[n].base_h > 0  ) {
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &rezoom_img_mutex[n % env_t::num_threads] );
+		if(  (images[n].recode_flags & FLAG_REZOOM) == 0  ) {
+			// other routine did already the re-zooming ...
+			pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
+			return;
 		}
+#endif
+		// we may need night conversion afterwards
+		images[n].player_flags = 0xFFFF; // recode all player colors
+
+		//  we recalculate the len (since it may be larger than before)
+		// thus we have to free the old caches
+		free_zoomed_img( n );
+
+		zoomed_img_t zoomed;
+		zoom_img_data( images[n], (images[n].recode_flags & FLAG_ZOOMABLE) ? zoom_factor : ZOOM_NEUTRAL, rezoom_buffer[n % env_t::num_threads], zoomed );
+		set_zoomed_img( n, zoomed );
+
 		images[n].recode_flags &= ~FLAG_REZOOM;
 #ifdef MULTI_THREAD
 		pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
@@ -1800,6 +2022,76 @@ static void rezoom_img(const image_id n)
 
 
 
+// ------------------ cache of images for other zoom and day/night levels ------------------
+
+static int night_direction = 1; // last change of the day/night level, the next one is likely the same
+
+static void image_cache_lock()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &image_cache_mutex );
+#endif
+}
+
+
+static void image_cache_unlock()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &image_cache_mutex );
+#endif
+}
+
+
+// there may be new work for the background job
+static void image_cache_wakeup()
+{
+#ifdef MULTI_THREAD
+	pthread_cond_signal( &image_cache_cond );
+#endif
+}
+
+
+static size_t image_cache_bytes()
+{
+	size_t bytes = night_cache_bytes;
+	for(  uint32 z = 0;  z <= MAX_ZOOM_FACTOR;  z++  ) {
+		bytes += zoom_cache[z].bytes;
+	}
+	return bytes;
+}
+
+
+static void zoom_cache_free(const uint32 z)
+{
+	zoom_cache_t &cache = zoom_cache[z];
+	if(  cache.img  ) {
+		for(  image_id n = 0;  n < cache.count;  n++  ) {
+			image_arena_free( cache.img[n].data );
+		}
+		free( cache.img );
+	}
+	cache.img = NULL;
+	cache.count = 0;
+	cache.next = 0;
+	cache.bytes = 0;
+}
+
+
+static void night_cache_free()
+{
+	for(  night_img_t const& recoloured : night_cache  ) {
+		image_arena_free( recoloured.data );
+	}
+	night_cache.clear();
+	free( night_cache_players );
+	night_cache_players = NULL;
+	night_cache_count = 0;
+	night_cache_next = 0;
+	night_cache_level = -1;
+	night_cache_bytes = 0;
+}
+
+
 // get next smallest size when scaling to percent
 static scr_size simgraph16_get_best_matching_size(const image_id n, sint16 zoom_percent)
 {
@@ -1827,6 +2119,8 @@ static void simgraph16_fit_img_to_width(const image_id n, sint16 new_w)
 		for(  int i=0;  i<=MAX_ZOOM_FACTOR;  i++  ) {
 			int zoom_w = (images[n].base_w * g_simgraph16.zoom_num[i]) / g_simgraph16.zoom_den[i];
 			if(  zoom_w <= new_w  ) {
+				// the background job must not see the changed zoom factor
+				image_cache_lock();
 				uint8 old_zoom_flag = images[n].recode_flags & FLAG_ZOOMABLE;
 				images[n].recode_flags |= FLAG_REZOOM | FLAG_ZOOMABLE;
 				zoom_factor = i;
@@ -1834,6 +2128,8 @@ static void simgraph16_fit_img_to_width(const image_id n, sint16 new_w)
 				images[n].recode_flags &= ~FLAG_ZOOMABLE;
 				images[n].recode_flags |= old_zoom_flag;
 				zoom_factor = old_zoom_factor;
+				night_cache_free();
+				image_cache_unlock();
 				return;
 			}
 		}
@@ -1841,7 +2137,10 @@ static void simgraph16_fit_img_to_width(const image_id n, sint16 new_w)
 }
 
 
-static void calc_base_pal_from_night_shift(const int night)
+/**
+ * Calculates the colour maps for a day/night level
+ */
+static void calc_night_pal(const int night, PIXVAL *rgbmap, PIXVAL *specialcolormap)
 {
 	const int night2 = min(night, 4);
 	const int day = 4 - night2;
@@ -1869,7 +2168,7 @@ static void calc_base_pal_from_night_shift(const int night)
 		G = (int)(G * RG_night_multiplier);
 		B = (int)(B * B_night_multiplier);
 
-		rgbmap_day_night[i] = get_system_color({ (uint8)R, (uint8)G, (uint8)B });
+		rgbmap[i] = get_system_color({ (uint8)R, (uint8)G, (uint8)B });
 	}
 
 	// again the same but for transparent colors
@@ -1886,7 +2185,7 @@ static void calc_base_pal_from_night_shift(const int night)
 		B = (int)(B *  B_night_multiplier);
 
 		PIXVAL color = get_system_color({ (uint8)R, (uint8)G, (uint8)B });
-		rgbmap_day_night[0x8000 +MAX_PLAYER_COUNT + LIGHT_COUNT + i] = color;
+		rgbmap[0x8000 +MAX_PLAYER_COUNT + LIGHT_COUNT + i] = color;
 	}
 
 	// player color map (and used for map display etc.)
@@ -1895,25 +2194,24 @@ static void calc_base_pal_from_night_shift(const int night)
 		const int G = (int)(special_pal[i].g * RG_night_multiplier);
 		const int B = (int)(special_pal[i].b *  B_night_multiplier);
 
-		specialcolormap_day_night[i] = get_system_color({ (uint8)R, (uint8)G, (uint8)B });
+		specialcolormap[i] = get_system_color({ (uint8)R, (uint8)G, (uint8)B });
 	}
 
 	// special light colors (actually, only non-darkening greys should be used)
 	for(i=0;  i<LIGHT_COUNT;  i++  ) {
-		specialcolormap_day_night[SPECIAL_COLOR_COUNT+i] = get_system_color( display_day_lights[i] );
+		specialcolormap[SPECIAL_COLOR_COUNT+i] = get_system_color( display_day_lights[i] );
 	}
 
 	// init with black for forbidden colors
 	for(i=SPECIAL_COLOR_COUNT+LIGHT_COUNT;  i<256;  i++  ) {
-		specialcolormap_day_night[i] = 0;
+		specialcolormap[i] = 0;
 	}
 
 	// default player colors
 	for(i=0;  i<8;  i++  ) {
-		rgbmap_day_night[0x8000+i] = specialcolormap_day_night[player_offsets[0][0]+i];
-		rgbmap_day_night[0x8008+i] = specialcolormap_day_night[player_offsets[0][1]+i];
+		rgbmap[0x8000+i] = specialcolormap[player_offsets[0][0]+i];
+		rgbmap[0x8008+i] = specialcolormap[player_offsets[0][1]+i];
 	}
-	player_night = 0;
 
 	// Lights
 	for (i = 0; i < LIGHT_COUNT; i++) {
@@ -1930,21 +2228,338 @@ static void calc_base_pal_from_night_shift(const int night)
 		const int B = (day_B * day + night_B * night2) >> 2;
 
 		PIXVAL color = get_system_color({ (uint8)max(R,0), (uint8)max(G,0), (uint8)max(B,0) });
-		rgbmap_day_night[0x8000 + MAX_PLAYER_COUNT + i] = color;
+		rgbmap[0x8000 + MAX_PLAYER_COUNT + i] = color;
 	}
 
+}
+
+
+static void calc_base_pal_from_night_shift(const int night)
+{
+	calc_night_pal( night, rgbmap_day_night, specialcolormap_day_night );
+	player_night = 0;
+
 	// convert to RGB xxx
 	recode();
 }
 
 
+/**
+ * Drops the least recently used zoom levels until @p extra more bytes fit into the cache.
+ * The current zoom level is never dropped, with @p keep_neighbours also not the levels next to it.
+ * @return false if there is not enough room even then
+ */
+static bool image_cache_make_room(const size_t extra, const bool keep_neighbours)
+{
+	const size_t budget = (size_t)env_t::image_cache_size << 20;
+	while(  image_cache_bytes() + extra > budget  ) {
+		uint32 lru = zoom_factor;
+		for(  uint32 z = 0;  z <= MAX_ZOOM_FACTOR;  z++  ) {
+			if(  zoom_cache[z].img == NULL  ||  z == zoom_factor  ||  (keep_neighbours  &&  (z + 1 == zoom_factor  ||  z == zoom_factor + 1))  ) {
+				continue;
+			}
+			if(  lru == zoom_factor  ||  zoom_cache[z].last_used < zoom_cache[lru].last_used  ) {
+				lru = z;
+			}
+		}
+		if(  lru == zoom_factor  ) {
+			return false;
+		}
+		zoom_cache_free( lru );
+	}
+	return true;
+}
+
+
+/**
+ * Keeps the zoomed images of @p old_zoom and takes the images of the new zoom_factor from the cache.
+ * All other zoomable images are zoomed again on their next draw.
+ * The caller holds the image cache lock.
+ */
+static void image_cache_zoom_changed(const uint32 old_zoom)
+{
+	zoom_cache_free( old_zoom );
+	if(  env_t::image_cache_size > 0  &&  old_zoom != zoom_factor  ) {
+		zoom_cache_t &cache = zoom_cache[old_zoom];
+		cache.img = MALLOCN( zoomed_img_t, anz_images );
+		cache.count = anz_images;
+		cache.next = 0;
+		cache.bytes = anz_images * sizeof(zoomed_img_t);
+		cache.last_used = ++zoom_cache_clock;
+		for(  image_id n = 0;  n < anz_images;  n++  ) {
+			zoomed_img_t &zoomed = cache.img[n];
+			zoomed.h = -1;
+			zoomed.data = NULL;
+			if(  (images[n].recode_flags & (FLAG_ZOOMABLE | FLAG_REZOOM)) == FLAG_ZOOMABLE  &&  images[n].base_h > 0  ) {
+				zoomed.x = images[n].x;
+				zoomed.y = images[n].y;
+				zoomed.w = images[n].w;
+				zoomed.h = images[n].h;
+				zoomed.len = images[n].len;
+				zoomed.data = images[n].zoom_data;
+				images[n].zoom_data = NULL;
+				if(  zoomed.data  ) {
+					cache.bytes += zoomed.len * sizeof(PIXVAL);
+				}
+			}
+		}
+	}
+
+	zoom_cache_t &cache = zoom_cache[zoom_factor];
+	for(  image_id n = 0;  n < anz_images;  n++  ) {
+		if(  (images[n].recode_flags & FLAG_ZOOMABLE) == 0  ||  images[n].base_h <= 0  ) {
+			continue;
+		}
+		if(  n < cache.count  &&  cache.img[n].h >= 0  ) {
+			free_zoomed_img( n );
+			set_zoomed_img( n, cache.img[n] );
+			cache.img[n].data = NULL;
+			images[n].player_flags = 0xFFFF; // recode all player colors
+			images[n].recode_flags &= ~FLAG_REZOOM;
+		}
+		else {
+			images[n].recode_flags |= FLAG_REZOOM;
+		}
+	}
+	zoom_cache_free( zoom_factor );
+
+	// the recoloured images have still the old size
+	night_cache_free();
+
+	image_cache_make_room( 0, false );
+	image_cache_wakeup();
+}
+
+
+#ifdef MULTI_THREAD
+/**
+ * One step of the background job: zooms some images for a neighbouring zoom level,
+ * or recolours some images for the next day/night level.
+ * @return false if there is nothing left to do
+ */
+static bool image_cache_step(rezoom_buffer_t &buf)
+{
+	if(  env_t::image_cache_size == 0  ||  anz_images == 0  ) {
+		return false;
+	}
+
+	// first zoom the images for the levels next to the current one
+	const uint32 neighbours[2] = { zoom_factor + 1, zoom_factor - 1 };
+	for(  uint32 i = 0;  i < 2;  i++  ) {
+		const uint32 z = neighbours[i];
+		if(  z > MAX_ZOOM_FACTOR  ||  (g_simgraph16.base_tile_raster_width * g_simgraph16.zoom_num[z]) / g_simgraph16.zoom_den[z] <= 4  ) {
+			continue;
+		}
+		zoom_cache_t &cache = zoom_cache[z];
+		if(  cache.img == NULL  ) {
+			if(  !image_cache_make_room( anz_images * sizeof(zoomed_img_t), true )  ) {
+				continue;
+			}
+			cache.img = MALLOCN( zoomed_img_t, anz_images );
+			cache.count = anz_images;
+			cache.next = 0;
+			cache.bytes = anz_images * sizeof(zoomed_img_t);
+			for(  image_id n = 0;  n < anz_images;  n++  ) {
+				cache.img[n].h = -1;
+				cache.img[n].data = NULL;
+			}
+		}
+		cache.last_used = ++zoom_cache_clock;
+		if(  cache.next >= cache.count  ) {
+			continue;
+		}
+
+		for(  uint32 done = 0;  done < IMAGE_CACHE_BATCH  &&  cache.next < cache.count;  cache.next++  ) {
+			const image_id n = cache.next;
+			zoomed_img_t &zoomed = cache.img[n];
+			if(  zoomed.h >= 0  ||  (images[n].recode_flags & FLAG_ZOOMABLE) == 0  ||  images[n].base_h <= 0  ) {
+				continue;
+			}
+			zoom_img_data( images[n], z, buf, zoomed );
+			done++;
+			const size_t bytes = zoomed.data ? zoomed.len * sizeof(PIXVAL) : 0;
+			if(  !image_cache_make_room( bytes, true )  ) {
+				// cache is full, this level stays incomplete
+				image_arena_free( zoomed.data );
+				zoomed.data = NULL;
+				zoomed.h = -1;
+				cache.next = cache.count;
+				break;
+			}
+			cache.bytes += bytes;
+		}
+		return true;
+	}
+
+	// then recolour the images in use for the next day/night level
+	if(  !env_t::night_shift  ||  night_shift < 0  ) {
+		return false;
+	}
+	int next_night = night_shift + night_direction;
+	if(  next_night < 0  ||  next_night > 4 + env_t::daynight_level  ) {
+		next_night = night_shift - night_direction;
+	}
+	if(  next_night != night_cache_level  ) {
+		night_cache_free();
+		calc_night_pal( next_night, rgbmap_next_night, specialcolormap_next_night );
+		night_cache_level = next_night;
+		night_cache_players = MALLOCN( uint16, anz_images );
+		memset( night_cache_players, 0, anz_images * sizeof(uint16) );
+		night_cache_count = anz_images;
+		night_cache_next = 0;
+		pthread_mutex_lock( &recode_img_mutex );
+		night_cache_stale = false;
+		pthread_mutex_unlock( &recode_img_mutex );
+	}
+	if(  night_cache_next >= night_cache_count  ) {
+		pthread_mutex_lock( &recode_img_mutex );
+		const bool stale = night_cache_stale;
+		night_cache_stale = false;
+		pthread_mutex_unlock( &recode_img_mutex );
+		if(  !stale  ) {
+			return false;
+		}
+		// look again for images recoloured meanwhile
+		night_cache_next = 0;
+	}
+
+	const size_t budget = (size_t)env_t::image_cache_size << 20;
+	for(  uint32 done = 0;  done < IMAGE_CACHE_BATCH  &&  night_cache_next < night_cache_count;  night_cache_next++  ) {
+		const image_id n = night_cache_next;
+		pthread_mutex_lock( &rezoom_img_mutex[n % env_t::num_threads] );
+		if(  (images[n].recode_flags & FLAG_REZOOM) == 0  ) {
+			PIXVAL *src = images[n].zoom_data != NULL ? images[n].zoom_data : images[n].base_data;
+			// drawing threads recolour images meanwhile
+			uint16 in_use = 0;
+			pthread_mutex_lock( &recode_img_mutex );
+			for(  uint8 player_nr = 0;  player_nr < MAX_PLAYER_COUNT;  player_nr++  ) {
+				if(  (images[n].player_flags & (1 << player_nr)) == 0  &&  get_img_data( images[n], player_nr ) != NULL  ) {
+					in_use |= 1 << player_nr;
+				}
+			}
+			pthread_mutex_unlock( &recode_img_mutex );
+			for(  uint8 player_nr = 0;  player_nr < MAX_PLAYER_COUNT;  player_nr++  ) {
+				const uint16 bit = 1 << player_nr;
+				if(  (in_use & bit) == 0  ||  (night_cache_players[n] & bit)  ) {
+					// not in use or done already
+					continue;
+				}
+				const size_t bytes = images[n].len * sizeof(PIXVAL);
+				if(  image_cache_bytes() + bytes > budget  ) {
+					// cache is full
+					night_cache_next = night_cache_count - 1;
+					break;
+				}
+				for(  uint8 i = 0;  i < 8;  i++  ) {
+					rgbmap_next_night[0x8000+i] = specialcolormap_next_night[player_offsets[player_nr][0]+i];
+					rgbmap_next_night[0x8008+i] = specialcolormap_next_night[player_offsets[player_nr][1]+i];
+				}
+				night_img_t recoloured;
+				recoloured.n = n;
+				recoloured.player_nr = player_nr;
+				recoloured.data = image_arena_alloc( images[n].len );
+				recode_img_src_target( images[n].h, src, recoloured.data, rgbmap_next_night );
+				night_cache.append( recoloured );
+				night_cache_players[n] |= bit;
+				night_cache_bytes += bytes;
+				done++;
+			}
+		}
+		pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
+	}
+	return true;
+}
+
+
+static void *image_cache_thread_loop(void *)
+{
+	rezoom_buffer_t buf = { NULL, NULL, 0 };
+
+	pthread_mutex_lock( &image_cache_mutex );
+	while(  !image_cache_quit  ) {
+		if(  image_cache_step( buf )  ) {
+			// let the main thread in between steps
+			pthread_mutex_unlock( &image_cache_mutex );
+			dr_sleep( 1 );
+			pthread_mutex_lock( &image_cache_mutex );
+		}
+		else {
+			pthread_cond_wait( &image_cache_cond, &image_cache_mutex );
+		}
+	}
+	pthread_mutex_unlock( &image_cache_mutex );
+
+	free( buf.baseimage2 );
+	free( buf.baseimage );
+	return NULL;
+}
+#endif
+
+
+/**
+ * Takes the images recoloured for the day/night level @p night from the cache.
+ * Needs the colour maps of this level in rgbmap_day_night and specialcolormap_day_night.
+ */
+static void night_cache_install(const int night)
+{
+	if(  night != night_cache_level  ) {
+		return;
+	}
+	for(  night_img_t const& recoloured : night_cache  ) {
+		const image_id n = recoloured.n;
+		const uint16 bit = 1 << recoloured.player_nr;
+		if(  n < anz_images  &&  (images[n].recode_flags & FLAG_REZOOM) == 0  &&  (images[n].player_flags & bit)  ) {
+			PIXVAL *&data = img_data_ref( images[n], recoloured.player_nr );
+			image_arena_free( data );
+			data = recoloured.data;
+			images[n].player_flags &= ~bit;
+		}
+		else {
+			image_arena_free( recoloured.data );
+		}
+	}
+	night_cache.clear();
+}
+
+
 static void simgraph16_set_daynight_level(int night)
 {
 	if(  night != night_shift  ) {
+		image_cache_lock();
+		night_direction = night > night_shift ? 1 : -1;
 		night_shift = night;
-		calc_base_pal_from_night_shift(night);
+		if(  night == night_cache_level  ) {
+			// prepared by the background job
+			memcpy( rgbmap_day_night, rgbmap_next_night, RGBMAPSIZE * sizeof(PIXVAL) );
+			memcpy( specialcolormap_day_night, specialcolormap_next_night, 256 * sizeof(PIXVAL) );
+			for(  uint8 i = 0;  i < 8;  i++  ) {
+				rgbmap_day_night[0x8000+i] = specialcolormap_day_night[player_offsets[0][0]+i];
+				rgbmap_day_night[0x8008+i] = specialcolormap_day_night[player_offsets[0][1]+i];
+			}
+			player_night = 0;
+			recode();
+			night_cache_install( night );
+		}
+		else {
+			calc_base_pal_from_night_shift(night);
+		}
+		night_cache_free();
+		image_cache_wakeup();
+		image_cache_unlock();
 		simgraph16_mark_screen_dirty();
 	}
+	else {
+#ifdef MULTI_THREAD
+		pthread_mutex_lock( &recode_img_mutex );
+		const bool stale = night_cache_stale;
+		pthread_mutex_unlock( &recode_img_mutex );
+#else
+		const bool stale = night_cache_stale;
+#endif
+		if(  stale  ) {
+			image_cache_wakeup();
+		}
+	}
 }
 
 
@@ -1958,6 +2573,7 @@ static void simgraph16_set_player_color_scheme(const int player, const uint8 col
 
 		if(player==player_day  ||  player==player_night) {
 			// and recalculate map (and save it)
+			image_cache_lock();
 			calc_base_pal_from_night_shift(0);
 			memcpy(rgbmap_all_day, rgbmap_day_night, RGBMAPSIZE * sizeof(PIXVAL));
 			if(night_shift!=0) {
@@ -1965,8 +2581,14 @@ static void simgraph16_set_player_color_scheme(const int player, const uint8 col
 			}
 			// calc_base_pal_from_night_shift resets player_night to 0
 			player_day = player_night;
+			image_cache_unlock();
 		}
 
+		// recoloured images have the old colors
+		image_cache_lock();
+		night_cache_free();
+		image_cache_unlock();
+
 		recode();
 		simgraph16_mark_screen_dirty();
 	}
@@ -1994,7 +2616,9 @@ static image_id simgraph16_register_image(const image_t *image_in)
 			// overflow
 			dbg->fatal( "register_image", "*** Out of images (more than %li!) ***", anz_images );
 		}
+		image_cache_lock();
 		images = REALLOC(images, imd, alloc_images);
+		image_cache_unlock();
 	}
 
 	const image_id id = anz_images;
@@ -2037,10 +2661,8 @@ static image_id simgraph16_register_image(const image_t *image_in)
 		} while(  runlen!=0  ); // end of row: runlen == 0
 	}
 
-	for(  uint8 i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
-		image->data[i] = NULL;
-	}
-
+	image->data = NULL;
+	image->player_data = NULL;
 	image->zoom_data = NULL;
 	image->len = image_in->len;
 
@@ -2060,16 +2682,16 @@ static image_id simgraph16_register_image(const image_t *image_in)
 // (mostly needed when changing climate zones)
 static void simgraph16_free_all_images_above( image_id above )
 {
+	image_cache_lock();
+	for(  uint32 z = 0;  z <= MAX_ZOOM_FACTOR;  z++  ) {
+		zoom_cache_free( z );
+	}
+	night_cache_free();
+	image_cache_unlock();
+
 	while(  above < anz_images  ) {
 		anz_images--;
-		if(  images[anz_images].zoom_data != NULL  ) {
-			free( images[anz_images].zoom_data );
-		}
-		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
-			if(  images[anz_images].data[i] != NULL  ) {
-				free( images[anz_images].data[i] );
-			}
-		}
+		free_zoomed_img( anz_images );
 	}
 }
 
@@ -2112,11 +2734,18 @@ static scr_rect simgraph16_get_base_image_offset(image_id image)
 // forward declaration, implementation is further below
 PIXVAL colors_blend_alpha32(PIXVAL background, PIXVAL foreground, int alpha);
 
+// shorter runs are copied inline, since the call to the blitter costs more
+#define BLITTER_MIN_RUN (8)
+
 /**
  * Copy Pixel from src to dest
  */
 static inline void pixcopy(PIXVAL *dest, const PIXVAL *src, const PIXVAL * const end)
 {
+	if(  end - src >= BLITTER_MIN_RUN  ) {
+		blitter->copy( dest, src, end - src );
+		return;
+	}
 	// for gcc this seems to produce the optimal code ...
 	while (src < end) {
 		*dest++ = *src++;
@@ -2130,6 +2759,10 @@ static inline void pixcopy(PIXVAL *dest, const PIXVAL *src, const PIXVAL * const
 static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
+		if(  end - src >= BLITTER_MIN_RUN  ) {
+			blitter->recode( dest, src, rgbmap_current, end - src );
+			return;
+		}
 		while (src < end) {
 			*dest++ = rgbmap_current[*src++];
 		}
@@ -2153,6 +2786,10 @@ static inline void colorpixcopy(PIXVAL* dest, const PIXVAL* src, const PIXVAL* c
 static inline void colorpixcopydaytime(PIXVAL* dest, const PIXVAL* src, const PIXVAL* const end)
 {
 	if (*src < 0x8020) {
+		if(  end - src >= BLITTER_MIN_RUN  ) {
+			blitter->recode( dest, src, rgbmap_current, end - src );
+			return;
+		}
 		while (src < end) {
 			*dest++ = rgbmap_current[*src++];
 		}
@@ -2419,7 +3056,7 @@ static void simgraph16_draw_img_aux(const image_id n, scr_coord_val xp, scr_coor
 
 		if(  use_player > 0  ) {
 			// player colour images are rezoomed/recoloured in display_color_img
-			sp = images[n].data[use_player];
+			sp = get_img_data( images[n], use_player );
 			if(  sp == NULL  ) {
 				dbg->warning("display_img_aux", "CImg[%i] %u failed!", use_player, n);
 				return;
@@ -2433,7 +3070,7 @@ static void simgraph16_draw_img_aux(const image_id n, scr_coord_val xp, scr_coor
 			else if(  (images[n].player_flags & 1)  ) {
 				recode_img( n, 0 );
 			}
-			sp = images[n].data[0];
+			sp = images[n].data;
 			if(  sp == NULL  ) {
 				dbg->warning("display_img_aux", "Img %u failed!", n);
 				return;
@@ -2914,58 +3551,8 @@ static PIXVAL simgraph16_blend_colors(PIXVAL background, PIXVAL foreground, int
 
 
 /* from here code for transparent images */
-typedef void (*blend_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL colour, const PIXVAL len);
-
-// templated structures to specialize for the different blend modes: 25/50/75 percent
-struct blend25_t { static inline PIXVAL blend(PIXVAL background, PIXVAL foreground) { return 3 * rgb_shr2(background) + rgb_shr2(foreground); } };
-struct blend50_t { static inline PIXVAL blend(PIXVAL background, PIXVAL foreground) { return rgb_shr1(background) + rgb_shr1(foreground); }     };
-struct blend75_t { static inline PIXVAL blend(PIXVAL background, PIXVAL foreground) { return rgb_shr2(background) + 3 * rgb_shr2(foreground); } };
-
-template<class F> void pix_blend_tpl(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
-{
-	const PIXVAL *const end = dest + len;
-	while (dest < end) {
-		*dest = F::blend(*dest, *src);
-		dest++;
-		src++;
-	}
-}
-
-// the following 6 functions are for display_base_img_blend()
-template<class F> void pix_blend_recode_tpl(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
-{
-	const PIXVAL *const end = dest + len;
-	while (dest < end) {
-		*dest = F::blend(*dest, rgbmap_current[*src]);
-		dest++;
-		src++;
-	}
-}
-
-template<class F> void pix_outline_tpl(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
-{
-	const PIXVAL *const end = dest + len;
-	while (dest < end) {
-		*dest = F::blend(*dest, colour);
-		dest++;
-	}
-}
-
-// save them for easier access
-static blend_proc blend[3] = {
-	pix_blend_tpl<blend25_t>,
-	pix_blend_tpl<blend50_t>,
-	pix_blend_tpl<blend75_t> };
-
-static blend_proc blend_recode[3] = {
-	pix_blend_recode_tpl<blend25_t>,
-	pix_blend_recode_tpl<blend50_t>,
-	pix_blend_recode_tpl<blend75_t>};
-
-static blend_proc outline[3] = {
-	pix_outline_tpl<blend25_t>,
-	pix_outline_tpl<blend50_t>,
-	pix_outline_tpl<blend75_t>};
+// the pixel loops for 25/50/75 percent are in the blitter
+typedef blit_blend_proc blend_proc;
 
 
 /**
@@ -2985,10 +3572,10 @@ static void simgraph16_tint_rect(scr_coord_val xp, scr_coord_val yp, scr_coord_v
 			case 48:
 			{
 				// fast blending with 1/4 | 1/2 | 3/4 percentage
-				blend_proc blend = outline[ (alpha>>4) - 1 ];
+				blend_proc blend = blitter->outline[ (alpha>>4) - 1 ];
 
 				for(  scr_coord_val y=0;  y<h;  y++  ) {
-					blend( textur + xp + (yp+y) * disp_width, NULL, colval, w );
+					blend( textur + xp + (yp+y) * disp_width, NULL, NULL, colval, w );
 				}
 			}
 			break;
@@ -3045,7 +3632,7 @@ static void display_img_blend_wc(scr_coord_val h, const scr_coord_val xp, const
 				if(  xpos + runlen > CR.clip_rect.x  &&  xpos < CR.clip_rect.xx  ) {
 					const int left = (xpos >= CR.clip_rect.x ? 0 : CR.clip_rect.x - xpos);
 					const int len  = (CR.clip_rect.xx - xpos >= runlen ? runlen : CR.clip_rect.xx - xpos);
-					p(tp + xpos + left, sp + left, colour, len - left);
+					p(tp + xpos + left, sp + left, rgbmap_current, colour, len - left);
 				}
 
 				sp += runlen;
@@ -3070,61 +3657,10 @@ static PIXVAL get_alpha_mask(const unsigned alpha_flags)
 }
 
 
-typedef void (*alpha_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const PIXVAL alpha_mask, const PIXVAL colour, const PIXVAL len);
-
-static void alpha(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const PIXVAL alpha_mask, const PIXVAL , const PIXVAL len)
-{
-	const PIXVAL *const end = dest + len;
-
-	while(  dest < end  ) {
-		// read mask components - always 15bpp
-		uint16 masked = *alphamap & alpha_mask;
-		uint16 alpha_value = (masked & 0x1f) + ((masked >> 5) & 0x1f) + ((masked >> 10) & 0x1f);
-
-		if(  alpha_value > 30  ) {
-			// opaque, just copy source
-			*dest = *src;
-		}
-		else if(  alpha_value > 0  ) {
-			alpha_value = alpha_value > 15 ? alpha_value + 1 : alpha_value;
-
-			*dest = colors_blend_alpha32(*dest, *src, alpha_value);
-		}
-
-		dest++;
-		src++;
-		alphamap++;
-	}
-}
-
-
-static void alpha_recode(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const PIXVAL alpha_mask, const PIXVAL , const PIXVAL len)
-{
-	const PIXVAL *const end = dest + len;
-
-	while(  dest < end  ) {
-		// read mask components - always 15bpp
-		uint16 masked = *alphamap & alpha_mask;
-		uint16 alpha_value = (masked & 0x1f) + ((masked >> 5) & 0x1f) + ((masked >> 10) & 0x1f);
-
-		if(  alpha_value > 30  ) {
-			// opaque, just copy source
-			*dest = rgbmap_current[*src];
-		}
-		else if(  alpha_value > 0  ) {
-			alpha_value = alpha_value > 15 ? alpha_value + 1 : alpha_value;
-
-			*dest = colors_blend_alpha32(*dest, rgbmap_current[*src], alpha_value);
-		}
-
-		dest++;
-		src++;
-		alphamap++;
-	}
-}
+typedef blit_alpha_proc alpha_proc;
 
 
-static void display_img_alpha_wc(scr_coord_val h, const scr_coord_val xp, const scr_coord_val yp, const PIXVAL *sp, const PIXVAL *alphamap, const PIXVAL alpha_mask, int colour, alpha_proc p  CLIP_NUM_DEF )
+static void display_img_alpha_wc(scr_coord_val h, const scr_coord_val xp, const scr_coord_val yp, const PIXVAL *sp, const PIXVAL *alphamap, const PIXVAL alpha_mask, alpha_proc p  CLIP_NUM_DEF )
 {
 	if(  h > 0  ) {
 		PIXVAL *tp = textur + yp * disp_width;
@@ -3148,7 +3684,7 @@ static void display_img_alpha_wc(scr_coord_val h, const scr_coord_val xp, const
 				if(  xpos + runlen > CR.clip_rect.x  &&  xpos < CR.clip_rect.xx  ) {
 					const int left = (xpos >= CR.clip_rect.x ? 0 : CR.clip_rect.x - xpos);
 					const int len  = (CR.clip_rect.xx - xpos >= runlen ? runlen : CR.clip_rect.xx - xpos);
-					p( tp + xpos + left, sp + left, alphamap + left, alpha_mask, colour, len - left );
+					p( tp + xpos + left, sp + left, rgbmap_current, alphamap + left, alpha_mask, len - left );
 				}
 
 				sp += runlen;
@@ -3177,7 +3713,7 @@ static void simgraph16_draw_rezoomed_img_blend(const image_id n, scr_coord_val x
 		else if(  (images[n].player_flags & 1)  ) {
 			recode_img( n, 0 );
 		}
-		PIXVAL *sp = images[n].data[0];
+		PIXVAL *sp = images[n].data;
 
 		// now, since zooming may have change this image
 		xp += images[n].x;
@@ -3225,7 +3761,7 @@ static void simgraph16_draw_rezoomed_img_blend(const image_id n, scr_coord_val x
 			// get the real color
 			const PIXVAL color = color_index & 0xFFFF;
 			// we use function pointer for the blend runs for the moment ...
-			blend_proc pix_blend = (color_index&OUTLINE_FLAG) ? outline[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ] : blend[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ];
+			blend_proc pix_blend = (color_index&OUTLINE_FLAG) ? blitter->outline[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ] : blitter->blend[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ];
 
 			// marking change?
 			if(  dirty  ) {
@@ -3237,7 +3773,7 @@ static void simgraph16_draw_rezoomed_img_blend(const image_id n, scr_coord_val x
 }
 
 
-static void simgraph16_draw_rezoomed_img_alpha(const image_id n, const image_id alpha_n, const unsigned alpha_flags, scr_coord_val xp, scr_coord_val yp, const sint8 /*player_nr*/, const FLAGGED_PIXVAL color_index, const bool /*daynight*/, const bool dirty  CLIP_NUM_DEF)
+static void simgraph16_draw_rezoomed_img_alpha(const image_id n, const image_id alpha_n, const unsigned alpha_flags, scr_coord_val xp, scr_coord_val yp, const sint8 /*player_nr*/, const FLAGGED_PIXVAL /*color_index*/, const bool /*daynight*/, const bool dirty  CLIP_NUM_DEF)
 {
 	if(  n < anz_images  &&  alpha_n < anz_images  ) {
 		// need to go to nightmode and or rezoomed?
@@ -3251,7 +3787,7 @@ static void simgraph16_draw_rezoomed_img_alpha(const image_id n, const image_id
 		if(  (images[alpha_n].recode_flags & FLAG_REZOOM)  ) {
 			rezoom_img( alpha_n );
 		}
-		PIXVAL *sp = images[n].data[0];
+		PIXVAL *sp = images[n].data;
 		// alphamap image uses base data as we don't want to recode
 		PIXVAL *alphamap = images[alpha_n].zoom_data != NULL ? images[alpha_n].zoom_data : images[alpha_n].base_data;
 		// now, since zooming may have change this image
@@ -3303,14 +3839,12 @@ static void simgraph16_draw_rezoomed_img_alpha(const image_id n, const image_id
 		{
 			// needed now ...
 			const scr_coord_val w = images[n].w;
-			// get the real color
-			const PIXVAL color = color_index & 0xFFFF;
 
 			// marking change?
 			if(  dirty  ) {
 				simgraph16_mark_rect_dirty_wc( xp, yp, xp + w - 1, yp + h - 1 );
 			}
-			display_img_alpha_wc( h, xp, yp, sp, alphamap, get_alpha_mask(alpha_flags), color, alpha  CLIP_NUM_PAR );
+			display_img_alpha_wc( h, xp, yp, sp, alphamap, get_alpha_mask(alpha_flags), blitter->alpha  CLIP_NUM_PAR );
 		}
 	}
 }
@@ -3364,7 +3898,7 @@ static void simgraph16_draw_base_img_blend(const image_id n, scr_coord_val xp, s
 		// new block for new variables
 		{
 			const PIXVAL color = color_index & 0xFFFF;
-			blend_proc pix_blend = (color_index&OUTLINE_FLAG) ? outline[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ] : blend_recode[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ];
+			blend_proc pix_blend = (color_index&OUTLINE_FLAG) ? blitter->outline[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ] : blitter->blend_recode[ (color_index&TRANSPARENT_FLAGS)/TRANSPARENT25_FLAG - 1 ];
 
 			// recode is needed only for blending
 			if(  !(color_index&OUTLINE_FLAG)  ) {
@@ -3441,8 +3975,6 @@ static void simgraph16_draw_base_img_alpha(const image_id n, const image_id alph
 
 		// new block for new variables
 		{
-			const PIXVAL color = color_index & 0xFFFF;
-
 			// recode is needed only for blending
 			if(  !(color_index & OUTLINE_FLAG)  ) {
 				// colors for 2nd company color
@@ -3458,7 +3990,7 @@ static void simgraph16_draw_base_img_alpha(const image_id n, const image_id alph
 			if(  dirty  ) {
 				simgraph16_mark_rect_dirty_wc( x, y, x + w - 1, y + h - 1 );
 			}
-			display_img_alpha_wc( h, x, y, sp, alphamap, get_alpha_mask(alpha_flags), color, alpha_recode  CLIP_NUM_PAR );
+			display_img_alpha_wc( h, x, y, sp, alphamap, get_alpha_mask(alpha_flags), blitter->alpha_recode  CLIP_NUM_PAR );
 		}
 	} // number ok
 }
@@ -4688,9 +5220,9 @@ static bool simgraph16_init(scr_size window_size, sint16 full_screen)
 #ifdef MULTI_THREAD
 		pthread_mutex_init( &rezoom_img_mutex[i], NULL );
 #endif
-		rezoom_baseimage[i] = NULL;
-		rezoom_baseimage2[i] = NULL;
-		rezoom_size[i] = 0;
+		rezoom_buffer[i].baseimage = NULL;
+		rezoom_buffer[i].baseimage2 = NULL;
+		rezoom_buffer[i].size = 0;
 	}
 
 	// get real width from os-dependent routines
@@ -4701,6 +5233,13 @@ static bool simgraph16_init(scr_size window_size, sint16 full_screen)
 	}
 
 	textur = dr_textur_init();
+	blitter_init();
+
+#ifdef MULTI_THREAD
+	// zooms and recolours images ahead of time
+	image_cache_quit = false;
+	image_cache_thread_running = pthread_create( &image_cache_thread, NULL, image_cache_thread_loop, NULL ) == 0;
+#endif
 
 	// init, load, and check fonts
 	if (!gfx->load_font(env_t::fontname.c_str(), false)) {
@@ -4778,14 +5317,27 @@ static bool simgraph16_is_display_init()
  */
 static void simgraph16_exit()
 {
+#ifdef MULTI_THREAD
+	if(  image_cache_thread_running  ) {
+		pthread_mutex_lock( &image_cache_mutex );
+		image_cache_quit = true;
+		pthread_cond_signal( &image_cache_cond );
+		pthread_mutex_unlock( &image_cache_mutex );
+		pthread_join( image_cache_thread, NULL );
+		image_cache_thread_running = false;
+	}
+#endif
+
 	dr_os_close();
 
 	free( tile_dirty_old );
 	free( tile_dirty );
+	free( world_layer );
 	gfx->free_all_images_above(0);
 	free(images);
 
 	tile_dirty = tile_dirty_old = NULL;
+	world_layer = NULL;
 	images = NULL;
 #ifdef MULTI_THREAD
 	pthread_mutex_destroy( &recode_img_mutex );
@@ -4859,6 +5411,140 @@ static bool simgraph16_take_screenshot(const scr_rect &area, const char *filenam
 }
 
 
+#define BENCHMARK_IMAGES (2048)
+#define BENCHMARK_ROUNDS (16)
+
+/**
+ * Draws the first images of the pakset in all modes with every blitter
+ * into an offscreen buffer and prints the throughput as CSV.
+ */
+static void simgraph16_benchmark_blitters()
+{
+	static const char *const mode_names[] = { "copy", "recode", "recode_daytime", "blend", "outline", "alpha", "alpha_recode" };
+
+	// the screen is not touched
+	PIXVAL *const saved_textur = textur;
+	textur = MALLOCN( PIXVAL, disp_width * disp_height );
+	MEMZERON( textur, disp_width * disp_height );
+	const clip_dimension saved_clip = simgraph16_get_clip_rect( CLIP_NUM_DEFAULT_VALUE );
+	simgraph16_set_clip_rect( 0, 0, disp_width, disp_height  CLIP_NUM_DEFAULT, false );
+	const blitter_t *const saved_blitter = blitter;
+
+	image_id ids[BENCHMARK_IMAGES];
+	uint32 count = 0;
+	for(  image_id n = 0;  n < anz_images  &&  count < BENCHMARK_IMAGES;  n++  ) {
+		if(  images[n].base_h > 0  &&  images[n].base_w > 0  ) {
+			ids[count++] = n;
+		}
+	}
+
+	printf( "blitter,mode,images,pixels,ms,mpixel_per_s\n" );
+	for(  uint32 b = 0;  b < blitter_get_count();  b++  ) {
+		blitter = blitter_get( b );
+
+		for(  int mode = 0;  mode < 7;  mode++  ) {
+			uint64 pixels = 0;
+			uint64 start = 0;
+			// the first round rezooms and recodes the images, so it is not timed
+			for(  int round = 0;  round <= BENCHMARK_ROUNDS;  round++  ) {
+				if(  round == 1  ) {
+					start = dr_time_us();
+				}
+				for(  uint32 i = 0;  i < count;  i++  ) {
+					const image_id n = ids[i];
+					const scr_coord_val x = (i * 37) % max( 1, disp_width - 64 );
+					const scr_coord_val y = (i * 53) % max( 1, disp_height - 64 );
+					switch(  mode  ) {
+						case 0: simgraph16_draw_img_aux( n, x, y, 1, true, false  CLIP_NUM_DEFAULT ); break;
+						case 1: simgraph16_draw_color_img( n, x, y, 1, true, false  CLIP_NUM_DEFAULT ); break;
+						case 2: simgraph16_draw_color_img( n, x, y, 1, false, false  CLIP_NUM_DEFAULT ); break;
+						case 3: simgraph16_draw_rezoomed_img_blend( n, x, y, 1, TRANSPARENT50_FLAG, true, false  CLIP_NUM_DEFAULT ); break;
+						case 4: simgraph16_draw_rezoomed_img_blend( n, x, y, 1, TRANSPARENT50_FLAG | OUTLINE_FLAG | gfx->palette_lookup(COL_WHITE), true, false  CLIP_NUM_DEFAULT ); break;
+						case 5: simgraph16_draw_rezoomed_img_alpha( n, n, ALPHA_RED | ALPHA_GREEN | ALPHA_BLUE, x, y, 1, 0, true, false  CLIP_NUM_DEFAULT ); break;
+						case 6: simgraph16_draw_base_img_alpha( n, n, ALPHA_RED | ALPHA_GREEN | ALPHA_BLUE, x, y, 1, 0, true, false  CLIP_NUM_DEFAULT ); break;
+					}
+					if(  round == 0  ) {
+						pixels += images[n].w * images[n].h;
+					}
+				}
+			}
+			const uint64 us = max( (uint64)1, dr_time_us() - start );
+			printf( "%s,%s,%u,%u,%.3f,%.1f\n", blitter->name, mode_names[mode], count, (unsigned)pixels, us / 1000.0, (double)(pixels * BENCHMARK_ROUNDS) / us );
+		}
+	}
+
+	blitter = saved_blitter;
+	free( textur );
+	textur = saved_textur;
+	simgraph16_set_clip_rect( saved_clip.x, saved_clip.y, saved_clip.w, saved_clip.h  CLIP_NUM_DEFAULT, false );
+}
+
+
+/**
+ * Prints the memory used for images by category.
+ */
+static void simgraph16_print_image_memory()
+{
+	size_t base_bytes = 0, zoom_bytes = 0, day_night_bytes = 0, player_bytes = 0, table_bytes = alloc_images * sizeof(imd);
+	uint32 zoom_count = 0, day_night_count = 0, player_count = 0, player_tables = 0;
+
+	image_cache_lock();
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &recode_img_mutex );
+#endif
+	for(  image_id n = 0;  n < anz_images;  n++  ) {
+		const imd &image = images[n];
+		if(  image.base_h > 0  ) {
+			base_bytes += get_base_len( image ) * sizeof(PIXVAL);
+		}
+		if(  image.zoom_data  ) {
+			zoom_bytes += image_arena_get_size( image.zoom_data );
+			zoom_count++;
+		}
+		if(  image.data  ) {
+			day_night_bytes += image_arena_get_size( image.data );
+			day_night_count++;
+		}
+		if(  image.player_data  ) {
+			table_bytes += (MAX_PLAYER_COUNT - 1) * sizeof(PIXVAL *);
+			player_tables++;
+			for(  uint8 i = 0;  i < MAX_PLAYER_COUNT - 1;  i++  ) {
+				if(  image.player_data[i]  ) {
+					player_bytes += image_arena_get_size( image.player_data[i] );
+					player_count++;
+				}
+			}
+		}
+	}
+	size_t zoom_cache_bytes = 0;
+	for(  uint32 z = 0;  z <= MAX_ZOOM_FACTOR;  z++  ) {
+		zoom_cache_bytes += zoom_cache[z].bytes;
+	}
+	const size_t night_bytes = night_cache_bytes;
+	const uint32 night_count = night_cache.get_count();
+#ifdef MULTI_THREAD
+	pthread_mutex_unlock( &recode_img_mutex );
+#endif
+	image_cache_unlock();
+
+	size_t arena_used, arena_reserved;
+	uint32 arena_blocks;
+	image_arena_get_stats( arena_used, arena_reserved, arena_blocks );
+
+	printf( "category,buffers,kbytes\n" );
+	printf( "image table,%u,%u\n", (unsigned)anz_images, (unsigned)(table_bytes >> 10) );
+	printf( "pakset data,%u,%u\n", (unsigned)anz_images, (unsigned)(base_bytes >> 10) );
+	printf( "zoomed,%u,%u\n", zoom_count, (unsigned)(zoom_bytes >> 10) );
+	printf( "day/night,%u,%u\n", day_night_count, (unsigned)(day_night_bytes >> 10) );
+	printf( "player colors,%u,%u\n", player_count, (unsigned)(player_bytes >> 10) );
+	printf( "player color tables,%u,%u\n", player_tables, (unsigned)((player_tables * (MAX_PLAYER_COUNT - 1) * sizeof(PIXVAL *)) >> 10) );
+	printf( "zoom cache,-,%u\n", (unsigned)(zoom_cache_bytes >> 10) );
+	printf( "day/night cache,%u,%u\n", night_count, (unsigned)(night_bytes >> 10) );
+	printf( "arena in use,-,%u\n", (unsigned)(arena_used >> 10) );
+	printf( "arena reserved,%u,%u\n", arena_blocks, (unsigned)(arena_reserved >> 10) );
+}
+
+
 static void simgraph16_set_image_procs(bool is_global)
 {
 	if(  is_global  ) {
@@ -4882,4 +5568,8 @@ void simgraph16_set_light_color(int light_idx, rgb888_t day_colour, rgb888_t nig
 {
 	display_day_lights[light_idx]   = day_colour;
 	display_night_lights[light_idx] = night_colour;
+
+	image_cache_lock();
+	night_cache_free();
+	image_cache_unlock();
 }
@@ -22,9 +22,25 @@
 #include "../dataobj/environment.h"
 #include "../obj/zeiger.h"
 #include "../utils/simrandom.h"
+#include "../tpl/vector_tpl.h"
+#include "../sys/simsys.h"
 
 uint16 win_get_statusbar_height(); // simwin.h
 
+// the parts of the world layer, which must be drawn again in this frame (in bands of WORLD_BAND_HEIGHT)
+static vector_tpl<scr_rect> world_spans;
+static bool redraw_whole_world = true;
+
+#define WORLD_BAND_HEIGHT (64)
+#define WORLD_COLUMN_WIDTH (16)
+
+// the parts of the screen the threads take from their queues, when everything is drawn
+#define RENDER_CHUNK_HEIGHT (2*WORLD_BAND_HEIGHT)
+
+// time each thread spent drawing the world in the last frame
+static uint32 render_busy_us[MAX_THREADS];
+static uint8 render_threads_used = 1;
+
 main_view_t::main_view_t(karte_t *welt)
 {
 	this->welt = welt;
@@ -55,25 +71,48 @@ static simthread_barrier_t display_barrier_end;
 // to start a thread
 typedef struct{
 	main_view_t *show_routine;
-	koord   lt_cl, wh_cl; // pos/size of clipping rect for this thread
-	koord   lt, wh;       // pos/size of region to display. set larger than clipping for correct display of trees at thread seams
-	sint16  y_min;
-	sint16  y_max;
 	sint8   thread_num;
 } display_region_param_t;
 
 // now the parameters
 static display_region_param_t ka[MAX_THREADS];
 
+/**
+ * The chunks of the screen a thread draws. Each thread starts with the chunks of its own stripe
+ * from the top, threads without work left take the chunks of the others from the bottom.
+ */
+struct render_queue_t
+{
+	vector_tpl<scr_rect> chunks;
+	uint32 first, last;
+	pthread_mutex_t mutex;
+};
+
+static render_queue_t render_queue[MAX_THREADS];
+
+// next chunk for this thread, false if all chunks are taken
+static bool render_queue_get( const sint8 thread_num, scr_rect &chunk )
+{
+	for(  int i = 0;  i < env_t::num_threads;  i++  ) {
+		render_queue_t &queue = render_queue[ (thread_num + i) % env_t::num_threads ];
+		pthread_mutex_lock( &queue.mutex );
+		if(  queue.first < queue.last  ) {
+			chunk = i == 0 ? queue.chunks[queue.first++] : queue.chunks[--queue.last];
+			pthread_mutex_unlock( &queue.mutex );
+			return true;
+		}
+		pthread_mutex_unlock( &queue.mutex );
+	}
+	return false;
+}
+
 void *display_region_thread( void *ptr )
 {
 	display_region_param_t *view = reinterpret_cast<display_region_param_t *>(ptr);
 
 	while(true) {
 		simthread_barrier_wait( &display_barrier_start ); // wait for all to start
-		gfx->clear_all_poly_clip( view->thread_num );
-		gfx->set_clip_rect( view->lt_cl.x, view->lt_cl.y, view->wh_cl.x, view->wh_cl.y, view->thread_num, false);
-		view->show_routine->display_region( view->lt, view->wh, view->y_min, view->y_max, false, true, view->thread_num );
+		view->show_routine->display_chunks( view->thread_num );
 		simthread_barrier_wait( &display_barrier_end ); // wait for all to finish
 	}
 }
@@ -123,6 +162,13 @@ void main_view_t::display(bool force_dirty)
 
 	gfx->set_clip_rect(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h CLIP_NUM_DEFAULT, false);
 
+	// draw the world into its own layer, which keeps the unchanged parts of the last frame
+	if(  env_t::world_layer_cache  &&  !gfx->set_world_layer(true)  ) {
+		// new layer: nothing in there yet
+		force_dirty = true;
+		outside_visible = true;
+	}
+
 	// redraw everything?
 	force_dirty = force_dirty || welt->is_dirty();
 	welt->unset_dirty();
@@ -164,18 +210,6 @@ void main_view_t::display(bool force_dirty)
 		gfx->set_daynight_level(hours2night[hours2]+env_t::daynight_level);
 	}
 
-	// not very elegant, but works:
-	// fill everything with black for Underground mode ...
-	if( grund_t::underground_mode ) {
-		gfx->draw_rect(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h, gfx->palette_lookup(COL_BLACK), force_dirty);
-	}
-	else if( welt->is_background_dirty()  &&  outside_visible  ) {
-		// we check if background will be visible, no need to clear screen if it's not.
-		display_background(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h, force_dirty);
-		welt->unset_background_dirty();
-		// reset
-		outside_visible = false;
-	}
 	// to save calls to grund_t::get_disp_height
 	// gr->get_disp_height() == min(gr->get_hoehe(), hmax_ground)
 	const sint8 hmax_ground = (grund_t::underground_mode==grund_t::ugm_level) ? grund_t::underground_level : 127;
@@ -202,6 +236,60 @@ void main_view_t::display(bool force_dirty)
 		viewport->prepared_rect = view_rect;
 	}
 
+	// find the parts of the world layer which changed since the last frame
+	world_spans.clear();
+	redraw_whole_world = true;
+	if(  env_t::world_layer_cache  ) {
+		mark_world_dirty( clip_rr, y_min, dpy_height + 4 * 4 );
+
+		sint32 dirty_area = 0;
+		for(  scr_coord_val y = clip_rr.y;  y < clip_rr.get_bottom();  y += WORLD_BAND_HEIGHT  ) {
+			const scr_coord_val h = min( WORLD_BAND_HEIGHT, clip_rr.get_bottom() - y );
+			scr_coord_val x = clip_rr.x;
+			while(  x < clip_rr.get_right()  ) {
+				while(  x < clip_rr.get_right()  &&  !gfx->is_rect_dirty( x, y, WORLD_COLUMN_WIDTH, h )  ) {
+					x += WORLD_COLUMN_WIDTH;
+				}
+				const scr_coord_val start = x;
+				while(  x < clip_rr.get_right()  &&  gfx->is_rect_dirty( x, y, WORLD_COLUMN_WIDTH, h )  ) {
+					x += WORLD_COLUMN_WIDTH;
+				}
+				if(  x > start  ) {
+					const scr_coord_val w = min( x, clip_rr.get_right() ) - start;
+					world_spans.append( scr_rect( start, y, w, h ) );
+					dirty_area += w * h;
+				}
+			}
+		}
+		// many small spans are slower than drawing everything
+		redraw_whole_world = dirty_area * 2 > clip_rr.w * clip_rr.h;
+	}
+
+	if(  !redraw_whole_world  ) {
+		// only the dirty parts are drawn again, so only these need a new background
+		for(  scr_rect const& r : world_spans  ) {
+			if(  grund_t::underground_mode  ) {
+				gfx->draw_rect( r.x, r.y, r.w, r.h, gfx->palette_lookup(COL_BLACK), false );
+			}
+			else if(  outside_visible  ) {
+				display_background( r.x, r.y, r.w, r.h, false );
+			}
+		}
+		welt->unset_background_dirty();
+	}
+	// not very elegant, but works:
+	// fill everything with black for Underground mode ...
+	else if( grund_t::underground_mode ) {
+		gfx->draw_rect(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h, gfx->palette_lookup(COL_BLACK), force_dirty);
+	}
+	else if( welt->is_background_dirty()  &&  outside_visible  ) {
+		// we check if background will be visible, no need to clear screen if it's not.
+		display_background(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h, force_dirty);
+		welt->unset_background_dirty();
+		// reset
+		outside_visible = false;
+	}
+
 #ifdef MULTI_THREAD
 	if(  can_multithreading  ) {
 		if(  !spawned_threads  ) {
@@ -214,11 +302,15 @@ void main_view_t::display(bool force_dirty)
 			// init barrier
 			simthread_barrier_init( &display_barrier_start, NULL, env_t::num_threads );
 			simthread_barrier_init( &display_barrier_end, NULL, env_t::num_threads );
+			for(  int t = 0;  t < env_t::num_threads;  t++  ) {
+				pthread_mutex_init( &render_queue[t].mutex, NULL );
+			}
 
 			for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
 				if(  pthread_create( &thread[t], &attr, display_region_thread, (void *)&ka[t] )  ) {
 					can_multithreading = false;
 					dbg->error( "main_view_t::display()", "cannot multi-thread, error at thread #%i", t+1 );
+					gfx->set_world_layer(false);
 					return;
 				}
 			}
@@ -226,20 +318,36 @@ void main_view_t::display(bool force_dirty)
 			pthread_attr_destroy( &attr );
 		}
 
-		// set parameter for each thread
+		// cut the stripe of each thread into chunks
 		const scr_coord_val wh_x = clip_rr.w / env_t::num_threads;
-		scr_coord_val lt_x = clip_rr.x;
-		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
+		for(  int t = 0;  t < env_t::num_threads;  t++  ) {
+			const scr_coord_val lt_x = clip_rr.x + t * wh_x;
+			// the last stripe ends at the screen edge (in case disp_width % num_threads != 0)
+			const scr_coord_val rt_x = t < env_t::num_threads - 1 ? lt_x + wh_x : clip_rr.get_right();
+
+			render_queue_t &queue = render_queue[t];
+			queue.chunks.clear();
+			if(  redraw_whole_world  ) {
+				for(  scr_coord_val y = clip_rr.y;  y < clip_rr.get_bottom();  y += RENDER_CHUNK_HEIGHT  ) {
+					queue.chunks.append( scr_rect( lt_x, y, rt_x - lt_x, min( RENDER_CHUNK_HEIGHT, clip_rr.get_bottom() - y ) ) );
+				}
+			}
+			else {
+				for(  scr_rect const& span : world_spans  ) {
+					const scr_coord_val left  = max( span.x, lt_x );
+					const scr_coord_val right = min( span.get_right(), rt_x );
+					if(  left < right  ) {
+						queue.chunks.append( scr_rect( left, span.y, right - left, span.h ) );
+					}
+				}
+			}
+			queue.first = 0;
+			queue.last = queue.chunks.get_count();
+
 			ka[t].show_routine = this;
-			ka[t].lt_cl = koord( lt_x, clip_rr.y );
-			ka[t].wh_cl = koord( wh_x, clip_rr.h );
-			ka[t].lt = ka[t].lt_cl - koord( IMG_SIZE/2, 0 ); // process tiles IMG_SIZE/2 outside clipping range for correct tree display at thread seams
-			ka[t].wh = ka[t].wh_cl + koord( IMG_SIZE, 0 );
-			ka[t].y_min = y_min;
-			ka[t].y_max = dpy_height + 4 * 4;
 			ka[t].thread_num = t;
-			lt_x += wh_x;
 		}
+		render_threads_used = env_t::num_threads;
 
 		// init variables required to draw smart cursor
 		threads_req_pause = false;
@@ -248,10 +356,8 @@ void main_view_t::display(bool force_dirty)
 		// and start drawing
 		simthread_barrier_wait( &display_barrier_start );
 
-		// the last we can run ourselves, setting clip_wh to the screen edge instead of wh_x (in case disp_width % num_threads != 0)
-		gfx->clear_all_poly_clip( env_t::num_threads - 1 );
-		gfx->set_clip_rect( lt_x, clip_rr.y, clip_rr.w, clip_rr.h, env_t::num_threads - 1, false);
-		display_region( koord( lt_x - IMG_SIZE / 2, clip_rr.y ), koord( clip_rr.x + clip_rr.w + IMG_SIZE, clip_rr.h ), y_min, dpy_height + 4 * 4, false, true, env_t::num_threads - 1 );
+		// the last we can run ourselves
+		display_chunks( env_t::num_threads - 1 );
 
 		simthread_barrier_wait( &display_barrier_end );
 
@@ -261,13 +367,20 @@ void main_view_t::display(bool force_dirty)
 	else {
 		// slow serial way of display
 		gfx->clear_all_poly_clip( CLIP_NUM_DEFAULT_VALUE );
-		display_region( koord(clip_rr.x, clip_rr.y), koord(clip_rr.w, clip_rr.h), y_min, dpy_height + 4 * 4, false, false, 0 );
+		display_world( clip_rr, y_min, dpy_height + 4 * 4 );
 	}
 #else
 	gfx->clear_all_poly_clip();
-	display_region(koord(clip_rr.x, clip_rr.y), koord(clip_rr.w, clip_rr.h), y_min, dpy_height + 4 * 4, false );
+	display_world( clip_rr, y_min, dpy_height + 4 * 4 );
 #endif
 
+	if(  env_t::world_layer_cache  ) {
+		// back to the framebuffer, everything else is drawn on top of the world each frame
+		gfx->set_world_layer(false);
+		gfx->set_clip_rect(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h CLIP_NUM_DEFAULT, false);
+		gfx->copy_world_layer(clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h);
+	}
+
 	// and finally overlays (station coverage and signs)
 	bool plotted = false; // display overlays even on very large mountains
 	for(sint16 y=y_min; y<dpy_height+4*4  ||  plotted; y++) {
@@ -582,18 +695,176 @@ void main_view_t::display_region( koord lt, koord wh, sint16 y_min, sint16 y_max
 			}
 		}
 	}
+}
+
+
+void main_view_t::display_world( const scr_rect &clip_rr, sint16 y_min, sint16 y_max )
+{
+	const uint64 start = dr_time_us();
+
+	if(  redraw_whole_world  ) {
+		const sint16 IMG_SIZE = gfx->get_tile_raster_width();
+		gfx->set_clip_rect( clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h  CLIP_NUM_DEFAULT, false );
+		// process tiles IMG_SIZE/2 outside clipping range for correct tree display at the screen edges
+#ifdef MULTI_THREAD
+		display_region( koord( clip_rr.x - IMG_SIZE/2, clip_rr.y ), koord( clip_rr.w + IMG_SIZE, clip_rr.h ), y_min, y_max, false, false, CLIP_NUM_DEFAULT_VALUE );
+#else
+		display_region( koord( clip_rr.x - IMG_SIZE/2, clip_rr.y ), koord( clip_rr.w + IMG_SIZE, clip_rr.h ), y_min, y_max, false );
+#endif
+	}
+	else {
+		for(  scr_rect const& span : world_spans  ) {
 #ifdef MULTI_THREAD
-	// show thread as paused when finished
-	if(  threaded  ) {
-		pthread_mutex_lock( &hide_mutex );
-		num_threads_paused++;
-		pthread_cond_broadcast( &waiting_cond );
-		pthread_mutex_unlock( &hide_mutex );
+			display_chunk( span, false, CLIP_NUM_DEFAULT_VALUE );
+#else
+			display_chunk( span );
+#endif
+		}
+		gfx->set_clip_rect( clip_rr.x, clip_rr.y, clip_rr.w, clip_rr.h  CLIP_NUM_DEFAULT, false );
 	}
+
+	render_busy_us[0] = (uint32)(dr_time_us() - start);
+	render_threads_used = 1;
+}
+
+
+#ifdef MULTI_THREAD
+void main_view_t::display_chunks( const sint8 thread_num )
+{
+	const uint64 start = dr_time_us();
+
+	scr_rect chunk;
+	while(  render_queue_get( thread_num, chunk )  ) {
+		gfx->clear_all_poly_clip( thread_num );
+		display_chunk( chunk, true, thread_num );
+	}
+
+	render_busy_us[thread_num] = (uint32)(dr_time_us() - start);
+
+	// show thread as paused when finished
+	pthread_mutex_lock( &hide_mutex );
+	num_threads_paused++;
+	pthread_cond_broadcast( &waiting_cond );
+	pthread_mutex_unlock( &hide_mutex );
+}
+#endif
+
+
+#ifdef MULTI_THREAD
+void main_view_t::display_chunk( const scr_rect &chunk, bool threaded, const sint8 clip_num )
+#else
+void main_view_t::display_chunk( const scr_rect &chunk )
+#endif
+{
+	const sint16 IMG_SIZE = gfx->get_tile_raster_width();
+	const int const_y_off = viewport->get_y_off();
+	const sint8 hmax_ground = (grund_t::underground_mode == grund_t::ugm_level) ? grund_t::underground_level : 127;
+	const sint16 lowest_px  = tile_raster_scale_y( min( hmax_ground, welt->min_height ) * TILE_HEIGHT_STEP, IMG_SIZE );
+	const sint16 highest_px = tile_raster_scale_y( min( hmax_ground, welt->max_height ) * TILE_HEIGHT_STEP, IMG_SIZE );
+
+	gfx->set_clip_rect( chunk.x, chunk.y, chunk.w, chunk.h  CLIP_NUM_PAR, false );
+
+	// only the rows of tiles, whose ground (IMG_SIZE) or objects (3*IMG_SIZE) can reach into this chunk
+	const sint16 chunk_y_min = (chunk.y - IMG_SIZE + lowest_px - const_y_off) / (IMG_SIZE / 4) - 1;
+	const sint16 chunk_y_max = (chunk.get_bottom() + 3 * IMG_SIZE + highest_px - const_y_off) / (IMG_SIZE / 4) + 2;
+
+	// process tiles IMG_SIZE/2 outside clipping range for correct tree display at the seams
+#ifdef MULTI_THREAD
+	display_region( koord( chunk.x - IMG_SIZE/2, chunk.y ), koord( chunk.w + IMG_SIZE, chunk.h ), chunk_y_min, chunk_y_max, false, threaded, clip_num );
+#else
+	display_region( koord( chunk.x - IMG_SIZE/2, chunk.y ), koord( chunk.w + IMG_SIZE, chunk.h ), chunk_y_min, chunk_y_max, false );
 #endif
 }
 
 
+uint32 main_view_t::get_render_busy_time( uint8 thread )
+{
+	return thread < render_threads_used ? render_busy_us[thread] : 0;
+}
+
+
+uint8 main_view_t::get_render_thread_count()
+{
+	return render_threads_used;
+}
+
+
+void main_view_t::mark_world_dirty( const scr_rect &clip_rr, sint16 y_min, sint16 y_max )
+{
+	const sint16 IMG_SIZE = gfx->get_tile_raster_width();
+
+	const int i_off = viewport->get_world_position().x + viewport->get_viewport_ij_offset().x;
+	const int j_off = viewport->get_world_position().y + viewport->get_viewport_ij_offset().y;
+	const int const_x_off = viewport->get_x_off();
+	const int const_y_off = viewport->get_y_off();
+
+	const scr_size screen = gfx->get_screen_size();
+	const int dpy_width = screen.w / IMG_SIZE + 2;
+
+	const sint8 hmax_ground = (grund_t::underground_mode == grund_t::ugm_level) ? grund_t::underground_level : 127;
+	const koord cursor_pos = welt->get_zeiger() ? welt->get_zeiger()->get_pos().get_2d() : koord(-1000, -1000);
+
+	for(  int y = y_min;  y < y_max;  y++  ) {
+		const sint16 ypos = y * (IMG_SIZE / 4) + const_y_off;
+		bool plotted = false;
+
+		for(  sint16 x = -2 - ((y + dpy_width) & 1);  (x * (IMG_SIZE / 2) + const_x_off) < clip_rr.get_right();  x += 2  ) {
+			const int xpos = x * (IMG_SIZE / 2) + const_x_off;
+			if(  xpos + IMG_SIZE <= clip_rr.x  ) {
+				continue;
+			}
+			const koord pos( ((y + x) >> 1) + i_off, ((y - x) >> 1) + j_off );
+			const planquadrat_t *plan = welt->access( pos );
+			if(  !plan  ||  !plan->get_kartenboden()  ) {
+				continue;
+			}
+			const grund_t *kb = plan->get_kartenboden();
+			const sint16 yypos = ypos - tile_raster_scale_y( min( kb->get_hoehe(), hmax_ground ) * TILE_HEIGHT_STEP, IMG_SIZE );
+			if(  yypos - IMG_SIZE * 3 >= clip_rr.get_bottom()  ||  yypos + IMG_SIZE <= clip_rr.y  ) {
+				continue;
+			}
+			plotted = true;
+
+			// trees and buildings are hidden/shown again around the cursor
+			bool changed = env_t::hide_under_cursor  &&  shortest_distance( pos, cursor_pos ) <= env_t::cursor_hide_range + 2u;
+			// animated water and beaches
+			if(  wasser_t::change_stage  &&  (kb->is_water()  ||  welt->min_hgt( pos ) <= welt->get_water_hgt( pos ))  ) {
+				changed = true;
+			}
+
+			sint8 htop = kb->get_hoehe();
+			for(  uint8 n = 0;  n < plan->get_boden_count();  n++  ) {
+				const grund_t *gr = plan->get_boden_bei( n );
+				htop = max( htop, gr->get_hoehe() );
+				changed |= gr->get_flag( grund_t::dirty );
+				for(  uint8 k = 0;  k < gr->obj_count();  k++  ) {
+					const obj_t *obj = gr->obj_bei( k );
+					if(  obj->get_flag( obj_t::dirty )  ) {
+						if(  obj->is_moving()  ) {
+							// vehicles are drawn up to half a tile off their position, aircraft also high above it
+							gfx->mark_rect_dirty_wc( xpos - IMG_SIZE / 2, yypos - IMG_SIZE * 4, xpos + (IMG_SIZE * 3) / 2 - 1, yypos + IMG_SIZE - 1 );
+						}
+						else {
+							changed = true;
+						}
+					}
+				}
+			}
+
+			if(  changed  ) {
+				const sint16 ytop = ypos - tile_raster_scale_y( min( htop, hmax_ground ) * TILE_HEIGHT_STEP, IMG_SIZE ) - IMG_SIZE * 3;
+				gfx->mark_rect_dirty_wc( xpos, ytop, xpos + IMG_SIZE - 1, yypos + IMG_SIZE - 1 );
+			}
+		}
+
+		// high mountains at the lower border
+		if(  plotted  &&  y == y_max - 1  ) {
+			y_max++;
+		}
+	}
+}
+
+
 void main_view_t::display_background( scr_coord_val xp, scr_coord_val yp, scr_coord_val w, scr_coord_val h, bool dirty )
 {
 	if(  !(env_t::draw_earth_border  &&  env_t::draw_outside_tile)  ) {
@@ -69,7 +69,40 @@ public:
 	void display_region( koord lt, koord wh, sint16 y_min, const sint16 y_max, bool force_dirty );
 #endif
 
+#ifdef MULTI_THREAD
+	/**
+	 * Draws the chunks of the world queued for thread @p thread_num and then those left over by the other threads.
+	 * This is a internal function of the class.
+	 */
+	void display_chunks( const sint8 thread_num );
+#endif
+
+	/// Time in microseconds each of the get_render_thread_count() threads spent drawing the world in the last frame.
+	static uint32 get_render_busy_time( uint8 thread );
+	static uint8 get_render_thread_count();
+
 private:
+	/**
+	 * Draws the world inside @p clip_rr single threaded. With the world layer cache,
+	 * only the changed parts are drawn again, otherwise the whole rectangle.
+	 */
+	void display_world( const scr_rect &clip_rr, sint16 y_min, sint16 y_max );
+
+	/**
+	 * Draws the world inside the rectangle @p chunk by display_region(), processing only those rows of tiles which can reach into it.
+	 */
+#ifdef MULTI_THREAD
+	void display_chunk( const scr_rect &chunk, bool threaded, const sint8 clip_num );
+#else
+	void display_chunk( const scr_rect &chunk );
+#endif
+
+	/**
+	 * Marks the screen area of all visible tiles with changed grounds or objects as dirty,
+	 * since only dirty parts of the world layer are drawn again.
+	 */
+	void mark_world_dirty( const scr_rect &clip_rr, sint16 y_min, sint16 y_max );
+
 	/**
 	 * Draws background in the specified rectangular screen coordinates.
 	 * @param xp X screen coordinate of the left-top corner.
@@ -15,6 +15,7 @@
 #include "../obj/baum.h"
 #include "../obj/zeiger.h"
 #include "../display/simgraph.h"
+#include "../display/simview.h"
 #include "../tool/simmenu.h"
 #include "../player/simplay.h"
 #include "../utils/simstring.h"
@@ -176,6 +177,11 @@ gui_settings_t::gui_settings_t()
 	idle_time_value_label.buf().printf(" 9999 ms");
 	idle_time_value_label.update();
 	add_component( &idle_time_value_label, 2 );
+	// Time each thread spent drawing the world
+	new_component<gui_label_t>("Render:");
+	render_time_value_label.buf().printf(" 99/99 ms");
+	render_time_value_label.update();
+	add_component( &render_time_value_label, 2 );
 	// FPS label
 	new_component<gui_label_t>("FPS:");
 	fps_value_label.buf().printf(" 99.9 fps");
@@ -195,6 +201,12 @@ void gui_settings_t::draw(scr_coord offset)
 	frame_time_value_label.update();
 	idle_time_value_label.buf().printf(" %d ms", world()->get_idle_time() );
 	idle_time_value_label.update();
+	render_time_value_label.buf().append( " " );
+	for(  uint8 t = 0;  t < main_view_t::get_render_thread_count();  t++  ) {
+		render_time_value_label.buf().printf( t ? "/%u" : "%u", main_view_t::get_render_busy_time( t ) / 1000 );
+	}
+	render_time_value_label.buf().append( " ms" );
+	render_time_value_label.update();
 
 	// fps_label
 	uint32 target_fps = world()->is_fast_forward() ? env_t::ff_fps : env_t::fps;
@@ -32,6 +32,7 @@ private:
 	gui_label_buf_t
 		frame_time_value_label,
 		idle_time_value_label,
+		render_time_value_label,
 		fps_value_label,
 		simloops_value_label;
 
@@ -0,0 +1,265 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "chunked_file_rdwr_stream.h"
+
+#include "../../dataobj/environment.h"
+#include "../../simdebug.h"
+#include "../../simmem.h"
+#include "../../macros.h"
+#include "../../utils/simthread.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+
+chunked_file_rdwr_stream_t::chunked_file_rdwr_stream_t(const std::string &filename, bool writing, size_t chunk_size) :
+	raw_file_rdwr_stream_t(filename, writing),
+	chunk_size(chunk_size),
+	chunks(NULL),
+	slots(0),
+	active(0),
+	current(0),
+	pos(0),
+	batch_size(1),
+	end_of_chunks(false)
+{
+}
+
+
+chunked_file_rdwr_stream_t::~chunked_file_rdwr_stream_t()
+{
+	if(  chunks  ) {
+		for(  uint32 i=0;  i<slots;  i++  ) {
+			free( chunks[i].plain );
+			free( chunks[i].packed );
+		}
+		free( chunks );
+	}
+}
+
+
+void chunked_file_rdwr_stream_t::init_chunks()
+{
+	assert( chunks == NULL );
+#ifdef MULTI_THREAD
+	slots = max( 1, env_t::num_threads );
+#else
+	slots = 1;
+#endif
+	chunks = MALLOCN( chunk_t, slots );
+	for(  uint32 i=0;  i<slots;  i++  ) {
+		chunk_t &c = chunks[i];
+		c.plain_size = chunk_size;
+		c.plain = MALLOCN( uint8, chunk_size );
+		c.plain_len = 0;
+		c.packed = NULL;
+		c.packed_len = 0;
+		c.packed_size = 0;
+		c.context = NULL;
+		c.ok = true;
+	}
+	active = current = 0;
+	pos = 0;
+	// when reading, the first chunk is not yet there
+	if(  is_reading()  ) {
+		chunks[0].plain_len = 0;
+		active = 1;
+	}
+}
+
+
+void chunked_file_rdwr_stream_t::reserve_packed(chunk_t &c, size_t size)
+{
+	if(  c.packed_size < size  ) {
+		c.packed = REALLOC( c.packed, uint8, size );
+		c.packed_size = size;
+	}
+}
+
+
+void *chunked_file_rdwr_stream_t::chunk_thread(void *ptr)
+{
+	job_t *job = (job_t *)ptr;
+	job->chunk->ok = job->compress ? job->stream->compress_chunk( *job->chunk ) : job->stream->decompress_chunk( *job->chunk );
+	return NULL;
+}
+
+
+bool chunked_file_rdwr_stream_t::process_batch(bool compress)
+{
+	job_t *jobs = new job_t[active];
+	for(  uint32 i=0;  i<active;  i++  ) {
+		jobs[i].stream = this;
+		jobs[i].chunk = chunks+i;
+		jobs[i].compress = compress;
+	}
+
+#ifdef MULTI_THREAD
+	pthread_t *threads = new pthread_t[active];
+	bool *started = new bool[active];
+	for(  uint32 i=1;  i<active;  i++  ) {
+		started[i] = pthread_create( threads+i, NULL, chunk_thread, jobs+i ) == 0;
+	}
+	chunk_thread( jobs );
+	for(  uint32 i=1;  i<active;  i++  ) {
+		if(  started[i]  ) {
+			pthread_join( threads[i], NULL );
+		}
+		else {
+			// could not start a thread => do it here
+			chunk_thread( jobs+i );
+		}
+	}
+	delete [] started;
+	delete [] threads;
+#else
+	for(  uint32 i=0;  i<active;  i++  ) {
+		chunk_thread( jobs+i );
+	}
+#endif
+	delete [] jobs;
+
+	for(  uint32 i=0;  i<active;  i++  ) {
+		if(  !chunks[i].ok  ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+bool chunked_file_rdwr_stream_t::write_batch()
+{
+	if(  active == 0  ) {
+		return true;
+	}
+	if(  !process_batch( true )  ) {
+		dbg->error( "chunked_file_rdwr_stream_t::write_batch", "Error during compression" );
+		status = STATUS_ERR_WRITEFAILURE;
+		return false;
+	}
+	for(  uint32 i=0;  i<active;  i++  ) {
+		if(  raw_file_rdwr_stream_t::write( chunks[i].packed, chunks[i].packed_len ) != chunks[i].packed_len  ) {
+			// status already set
+			return false;
+		}
+		chunks[i].plain_len = 0;
+	}
+	active = 0;
+	return true;
+}
+
+
+size_t chunked_file_rdwr_stream_t::chunked_write(const void *buf, size_t len)
+{
+	assert( is_writing()  &&  chunks );
+
+	const uint8 *src = (const uint8 *)buf;
+	size_t done = 0;
+	while(  done < len  ) {
+		chunk_t &c = chunks[current];
+		const size_t copy = std::min( len - done, chunk_size - c.plain_len );
+		memcpy( c.plain + c.plain_len, src + done, copy );
+		c.plain_len += copy;
+		done += copy;
+
+		if(  c.plain_len == chunk_size  ) {
+			current ++;
+			active = current;
+			if(  current == slots  ) {
+				// all chunks full
+				if(  !write_batch()  ) {
+					return 0;
+				}
+				current = 0;
+			}
+		}
+	}
+	status = STATUS_OK;
+	return done;
+}
+
+
+void chunked_file_rdwr_stream_t::finish_chunks()
+{
+	if(  chunks  &&  is_writing()  &&  status == STATUS_OK  ) {
+		active = current + (chunks[current].plain_len > 0);
+		write_batch();
+		current = 0;
+	}
+}
+
+
+bool chunked_file_rdwr_stream_t::read_batch()
+{
+	current = 0;
+	pos = 0;
+	active = 0;
+	while(  !end_of_chunks  &&  active < batch_size  ) {
+		chunk_t &c = chunks[active];
+		if(  !read_chunk( c )  ) {
+			if(  status != STATUS_EOF  ) {
+				// error, status already set
+				break;
+			}
+			end_of_chunks = true;
+			status = STATUS_OK;
+			break;
+		}
+		if(  c.plain_len > c.plain_size  ) {
+			c.plain = REALLOC( c.plain, uint8, c.plain_len );
+			c.plain_size = c.plain_len;
+		}
+		active ++;
+	}
+	// after the first chunk read all we can handle at once
+	batch_size = slots;
+
+	if(  status == STATUS_OK  &&  active > 0  ) {
+		if(  process_batch( false )  ) {
+			return true;
+		}
+		dbg->error( "chunked_file_rdwr_stream_t::read_batch", "Error during decompression" );
+		status = STATUS_ERR_CORRUPT;
+	}
+	// nothing (more) to read: leave an empty chunk
+	chunks[0].plain_len = 0;
+	active = 1;
+	return false;
+}
+
+
+size_t chunked_file_rdwr_stream_t::chunked_read(void *buf, size_t len)
+{
+	assert( is_reading()  &&  chunks );
+
+	uint8 *dest = (uint8 *)buf;
+	size_t done = 0;
+	while(  done < len  ) {
+		if(  pos == chunks[current].plain_len  ) {
+			// current chunk used up
+			current ++;
+			pos = 0;
+			if(  current >= active  ) {
+				if(  !read_batch()  ) {
+					if(  status == STATUS_OK  ) {
+						// end of the last chunk
+						status = STATUS_EOF;
+					}
+					return done;
+				}
+			}
+			continue;
+		}
+		const size_t copy = std::min( len - done, chunks[current].plain_len - pos );
+		memcpy( dest + done, chunks[current].plain + pos, copy );
+		pos += copy;
+		done += copy;
+	}
+	status = STATUS_OK;
+	return done;
+}
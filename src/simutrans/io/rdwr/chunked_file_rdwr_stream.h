@@ -0,0 +1,101 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef IO_RDWR_CHUNKED_FILE_RDWR_STREAM_H
+#define IO_RDWR_CHUNKED_FILE_RDWR_STREAM_H
+
+
+#include "raw_file_rdwr_stream.h"
+
+
+/**
+ * Base for compressed file streams which store the data as a sequence of
+ * independently compressed frames, one per chunk of uncompressed data.
+ * Up to env_t::num_threads chunks are (de)compressed at the same time.
+ * Derived classes supply the codec and the framing; they may also keep
+ * their own unchunked read()/write() for older files.
+ */
+class chunked_file_rdwr_stream_t : public raw_file_rdwr_stream_t
+{
+protected:
+	struct chunk_t
+	{
+		uint8 *plain;        ///< uncompressed data
+		size_t plain_len;
+		size_t plain_size;   ///< allocated size of plain
+		uint8 *packed;       ///< compressed frame
+		size_t packed_len;
+		size_t packed_size;  ///< allocated size of packed
+		void *context;       ///< codec state of the derived class, only used by one thread at a time
+		bool ok;
+	};
+
+	chunked_file_rdwr_stream_t(const std::string &filename, bool writing, size_t chunk_size);
+	~chunked_file_rdwr_stream_t();
+
+	/// Switches to chunked mode, must be called before the first chunked_read()/chunked_write()
+	void init_chunks();
+	bool is_chunked() const { return chunks != NULL; }
+
+	/// Compresses and writes the remaining data; derived classes must call this from their destructor.
+	void finish_chunks();
+
+	size_t chunked_read(void *buf, size_t len);
+	size_t chunked_write(const void *buf, size_t len);
+
+	/// makes sure c.packed can hold @p size bytes
+	static void reserve_packed(chunk_t &c, size_t size);
+
+	uint32 get_chunk_count() const { return slots; }
+	chunk_t &get_chunk(uint32 i) { return chunks[i]; }
+
+	/// Compresses c.plain into c.packed (including any frame header). Runs on worker threads.
+	virtual bool compress_chunk(chunk_t &c) = 0;
+
+	/// Decompresses c.packed into c.plain; c.plain_len is already set by read_chunk(). Runs on worker threads.
+	virtual bool decompress_chunk(chunk_t &c) = 0;
+
+	/**
+	 * Reads the next frame into c.packed and sets c.plain_len to its uncompressed size.
+	 * @returns false at the end of the file (status STATUS_EOF) or on errors (status set accordingly)
+	 */
+	virtual bool read_chunk(chunk_t &c) = 0;
+
+private:
+	const size_t chunk_size;
+
+	chunk_t *chunks;
+	uint32 slots;
+
+	/// number of chunks filled (writing) or decompressed (reading)
+	uint32 active;
+	/// chunk currently filled or read and the position in it
+	uint32 current;
+	size_t pos;
+
+	/// number of chunks to read at once; starts with one so reading only the header stays cheap
+	uint32 batch_size;
+	bool end_of_chunks;
+
+	/// (de)compresses chunks[0..active)
+	bool process_batch(bool compress);
+
+	/// compresses and writes chunks[0..active)
+	bool write_batch();
+
+	/// reads and decompresses the next chunks
+	bool read_batch();
+
+	struct job_t
+	{
+		chunked_file_rdwr_stream_t *stream;
+		chunk_t *chunk;
+		bool compress;
+	};
+	static void *chunk_thread(void *job);
+};
+
+
+#endif
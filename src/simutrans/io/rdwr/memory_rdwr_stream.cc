@@ -0,0 +1,188 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "memory_rdwr_stream.h"
+
+#include "../../simmem.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+memory_rdwr_stream_t::memory_rdwr_stream_t() :
+	rdwr_stream_t(true),
+	queued_bytes(0),
+	max_queued(0),
+	finished(false),
+	cancelled(false)
+{
+	current.data = NULL;
+	current.len = 0;
+#ifdef MULTI_THREAD
+	pthread_mutex_init( &mutex, NULL );
+	pthread_cond_init( &cond, NULL );
+#endif
+	status = STATUS_OK;
+}
+
+
+memory_rdwr_stream_t::~memory_rdwr_stream_t()
+{
+	free_chunks();
+#ifdef MULTI_THREAD
+	pthread_cond_destroy( &cond );
+	pthread_mutex_destroy( &mutex );
+#endif
+}
+
+
+void memory_rdwr_stream_t::free_chunks()
+{
+	while(  !queue.empty()  ) {
+		free( queue.remove_first().data );
+	}
+	queued_bytes = 0;
+	free( current.data );
+	current.data = NULL;
+	current.len = 0;
+}
+
+
+size_t memory_rdwr_stream_t::write(const void *buf, size_t buf_len)
+{
+	assert(is_writing());
+	assert(!finished);
+
+	const char *src = (const char *)buf;
+	size_t left = buf_len;
+	while(  left > 0  ) {
+		if(  current.data == NULL  ) {
+			current.data = (char *)malloc( CHUNK_SIZE );
+			if(  current.data == NULL  ) {
+				status = STATUS_ERR_FULL;
+				return 0;
+			}
+			current.len = 0;
+		}
+		const size_t n = std::min<size_t>( left, CHUNK_SIZE - current.len );
+		memcpy( current.data + current.len, src, n );
+		current.len += n;
+		src += n;
+		left -= n;
+
+		if(  current.len == CHUNK_SIZE  ) {
+#ifdef MULTI_THREAD
+			pthread_mutex_lock( &mutex );
+			while(  max_queued > 0  &&  queued_bytes >= max_queued  &&  !cancelled  ) {
+				pthread_cond_wait( &cond, &mutex );
+			}
+#endif
+			if(  cancelled  ) {
+				// dropped, the chunk is reused
+				current.len = 0;
+			}
+			else {
+				queue.append( current );
+				queued_bytes += current.len;
+				current.data = NULL;
+			}
+#ifdef MULTI_THREAD
+			pthread_cond_broadcast( &cond );
+			pthread_mutex_unlock( &mutex );
+#endif
+		}
+	}
+	status = STATUS_OK;
+	return buf_len;
+}
+
+
+void memory_rdwr_stream_t::set_max_queued(size_t bytes)
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &mutex );
+	max_queued = bytes;
+	pthread_cond_broadcast( &cond );
+	pthread_mutex_unlock( &mutex );
+#else
+	max_queued = bytes;
+#endif
+}
+
+
+void memory_rdwr_stream_t::finish()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &mutex );
+#endif
+	if(  current.data  &&  current.len > 0  &&  !cancelled  ) {
+		queue.append( current );
+		queued_bytes += current.len;
+	}
+	else {
+		free( current.data );
+	}
+	current.data = NULL;
+	current.len = 0;
+	finished = true;
+#ifdef MULTI_THREAD
+	pthread_cond_broadcast( &cond );
+	pthread_mutex_unlock( &mutex );
+#endif
+}
+
+
+void memory_rdwr_stream_t::cancel()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &mutex );
+#endif
+	cancelled = true;
+	while(  !queue.empty()  ) {
+		free( queue.remove_first().data );
+	}
+	queued_bytes = 0;
+#ifdef MULTI_THREAD
+	pthread_cond_broadcast( &cond );
+	pthread_mutex_unlock( &mutex );
+#endif
+}
+
+
+bool memory_rdwr_stream_t::is_cancelled()
+{
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &mutex );
+	const bool ret = cancelled;
+	pthread_mutex_unlock( &mutex );
+	return ret;
+#else
+	return cancelled;
+#endif
+}
+
+
+char *memory_rdwr_stream_t::pop_chunk(size_t &len)
+{
+	char *data = NULL;
+	len = 0;
+#ifdef MULTI_THREAD
+	pthread_mutex_lock( &mutex );
+	while(  queue.empty()  &&  !finished  &&  !cancelled  ) {
+		pthread_cond_wait( &cond, &mutex );
+	}
+#endif
+	if(  !queue.empty()  &&  !cancelled  ) {
+		chunk_t chunk = queue.remove_first();
+		queued_bytes -= chunk.len;
+		data = chunk.data;
+		len = chunk.len;
+	}
+#ifdef MULTI_THREAD
+	pthread_cond_broadcast( &cond );
+	pthread_mutex_unlock( &mutex );
+#endif
+	return data;
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef IO_RDWR_MEMORY_RDWR_STREAM_H
+#define IO_RDWR_MEMORY_RDWR_STREAM_H
+
+
+#include "rdwr_stream.h"
+
+#include "../../tpl/slist_tpl.h"
+
+#include <cassert>
+
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+#endif
+
+
+/**
+ * Queues the written data in memory in chunks of fixed size, which another thread
+ * takes with pop_chunk(), e.g. to compress and save them meanwhile.
+ */
+class memory_rdwr_stream_t : public rdwr_stream_t
+{
+public:
+	enum { CHUNK_SIZE = 1 << 22 }; // 4 MiB
+
+	memory_rdwr_stream_t();
+	~memory_rdwr_stream_t();
+
+public:
+	// not implemented
+	size_t read(void *, size_t) OVERRIDE { assert(false); return 0; }
+
+	/// @copydoc rdwr_stream_t::write
+	/// Waits while more than the set limit is queued. After cancel() the data is dropped.
+	size_t write(const void *buf, size_t len) OVERRIDE;
+
+	/// Lets write() wait while more than @p bytes are queued; 0 (the default) queues everything.
+	/// Only set a limit when another thread takes the chunks.
+	void set_max_queued(size_t bytes);
+
+	/// No more data will be written: the last partial chunk is queued.
+	void finish();
+
+	/// Drops all queued and further data, e.g. because it cannot be saved anyway.
+	void cancel();
+
+	bool is_cancelled();
+
+	/// Waits for the next chunk (allocated with malloc, the caller frees it).
+	/// @returns NULL when all data is taken after finish(), or after cancel()
+	char *pop_chunk(size_t &len);
+
+private:
+	struct chunk_t
+	{
+		char *data;
+		size_t len;
+	};
+
+	void free_chunks();
+
+	slist_tpl<chunk_t> queue;
+	size_t queued_bytes;
+	size_t max_queued;
+
+	/// chunk being filled by write()
+	chunk_t current;
+
+	bool finished;
+	bool cancelled;
+
+#ifdef MULTI_THREAD
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+#endif
+};
+
+
+#endif
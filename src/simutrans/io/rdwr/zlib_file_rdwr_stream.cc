@@ -11,25 +11,51 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstring>
+
+
+#define ZLIB_CHUNK_SIZE (1 << 20) // 1MiB uncompressed per gzip member
+
+/// gzip member header: deflate, FEXTRA set, no time, unknown OS; extra field "ST" with the member size
+static const uint8 member_header[16] = { 0x1F, 0x8B, 8, 4, 0, 0, 0, 0, 0, 0xFF, 8, 0, 'S', 'T', 4, 0 };
+#define MEMBER_HEADER_SIZE  (sizeof(member_header) + 4)
+#define MEMBER_TRAILER_SIZE (8) // CRC32 and size
 
 
 zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t(const std::string &filename, bool writing, int compression) :
-	rdwr_stream_t(writing)
+	chunked_file_rdwr_stream_t(filename, writing, ZLIB_CHUNK_SIZE),
+	gzfp(Z_NULL),
+	compression(clamp( compression, 1, 9 ))
 {
+	if (status != STATUS_OK) {
+		return; // Could not open file
+	}
+
+	if (is_writing()) {
+		init_chunks();
+		return;
+	}
+
+	// files with our members can be read in chunks
+	uint8 header[MEMBER_HEADER_SIZE];
+	if (raw_file_rdwr_stream_t::read(header, MEMBER_HEADER_SIZE) == MEMBER_HEADER_SIZE  &&  memcmp(header, member_header, sizeof(member_header)) == 0) {
+		fseek(file, 0, SEEK_SET);
+		status = STATUS_OK;
+		init_chunks();
+		return;
+	}
+
+	// all other gzip files
+	fclose(file);
+	file = NULL;
+
 	// Should be 0 anyway, but make sure to only catch errors from zlib
 	// zlib might not set errno appropriately in all error cases
 	// (source: https://refspecs.linuxbase.org/LSB_3.0.0/LSB-Core-generic/LSB-Core-generic/zlib-gzopen-1.html)
 	// so reset it to a known value. The value will be translated to GENERIC_ERROR by set_status_from_errno
 	errno = 0;
 
-	if (is_writing()) {
-		compression = clamp( compression, 1, 9 );
-		char compr[4] = { 'w', 'b', (char)('0' + compression), 0 };
-		gzfp = dr_gzopen(filename.c_str(), compr);
-	}
-	else {
-		gzfp = dr_gzopen(filename.c_str(), "rb");
-	}
+	gzfp = dr_gzopen(filename.c_str(), "rb");
 
 	if (gzfp == Z_NULL) {
 		set_status_from_errno();
@@ -44,10 +70,12 @@ zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t(const std::string &filename, bo
 zlib_file_rdwr_stream_t::~zlib_file_rdwr_stream_t()
 {
 	if (is_writing()) {
-		gzflush(gzfp, Z_FINISH);
+		finish_chunks();
 	}
 
-	gzclose(gzfp);
+	if (gzfp != Z_NULL) {
+		gzclose(gzfp);
+	}
 }
 
 
@@ -55,6 +83,10 @@ size_t zlib_file_rdwr_stream_t::read(void *buf, size_t len)
 {
 	assert(!is_writing());
 
+	if (is_chunked()) {
+		return chunked_read(buf, len);
+	}
+
 	const int bytes_read = gzread(gzfp, buf, len);
 
 	if (bytes_read >= 0 && (size_t)bytes_read == len) {
@@ -85,27 +117,112 @@ size_t zlib_file_rdwr_stream_t::write(const void *buf, size_t len)
 	assert(is_writing());
 	assert(len > 0);
 
-	const int bytes_written = gzwrite(gzfp, const_cast<void *>(buf), len);
+	return chunked_write(buf, len);
+}
+
 
-	if (bytes_written <= 0) {
-		// error occurred
-		int errnum = Z_OK;
-		gzerror(gzfp, &errnum);
+static void put_le32(uint8 *p, uint32 v)
+{
+	p[0] = v & 0xFF;
+	p[1] = (v >> 8) & 0xFF;
+	p[2] = (v >> 16) & 0xFF;
+	p[3] = (v >> 24) & 0xFF;
+}
 
-		switch (errnum) {
-			case Z_MEM_ERROR:    status = STATUS_ERR_WRITEFAILURE;    return 0; // memerror means the lib could not malloc 260k => something else must be very wrong
-			case Z_STREAM_ERROR: status = STATUS_ERR_NOT_INITIALIZED; return 0;
-			case Z_BUF_ERROR:    status = STATUS_ERR_FULL;            return 0;
-			case Z_ERRNO:        set_status_from_errno();             return 0;
-		}
 
-		status = STATUS_ERR_GENERIC_ERROR;
-		return 0;
+static uint32 get_le32(const uint8 *p)
+{
+	return (uint32)p[0] | ((uint32)p[1] << 8) | ((uint32)p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+
+bool zlib_file_rdwr_stream_t::compress_chunk(chunk_t &c)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (deflateInit2(&zs, compression, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+		return false;
 	}
-	else {
-		status = STATUS_OK;
-		return bytes_written;
+
+	const size_t bound = deflateBound(&zs, c.plain_len);
+	reserve_packed(c, MEMBER_HEADER_SIZE + bound + MEMBER_TRAILER_SIZE);
+
+	zs.next_in = c.plain;
+	zs.avail_in = c.plain_len;
+	zs.next_out = c.packed + MEMBER_HEADER_SIZE;
+	zs.avail_out = bound;
+	const int ret = deflate(&zs, Z_FINISH);
+	const size_t deflated = zs.total_out;
+	deflateEnd(&zs);
+	if (ret != Z_STREAM_END) {
+		return false;
+	}
+
+	c.packed_len = MEMBER_HEADER_SIZE + deflated + MEMBER_TRAILER_SIZE;
+	memcpy(c.packed, member_header, sizeof(member_header));
+	put_le32(c.packed + sizeof(member_header), c.packed_len);
+	uint8 *trailer = c.packed + MEMBER_HEADER_SIZE + deflated;
+	put_le32(trailer, crc32(crc32(0, NULL, 0), c.plain, c.plain_len));
+	put_le32(trailer + 4, c.plain_len);
+	return true;
+}
+
+
+bool zlib_file_rdwr_stream_t::decompress_chunk(chunk_t &c)
+{
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (inflateInit2(&zs, -MAX_WBITS) != Z_OK) {
+		return false;
+	}
+
+	zs.next_in = c.packed + MEMBER_HEADER_SIZE;
+	zs.avail_in = c.packed_len - MEMBER_HEADER_SIZE - MEMBER_TRAILER_SIZE;
+	zs.next_out = c.plain;
+	zs.avail_out = c.plain_len;
+	const int ret = inflate(&zs, Z_FINISH);
+	const size_t inflated = zs.total_out;
+	inflateEnd(&zs);
+
+	const uint8 *trailer = c.packed + c.packed_len - MEMBER_TRAILER_SIZE;
+	return ret == Z_STREAM_END  &&  inflated == c.plain_len  &&  get_le32(trailer) == crc32(crc32(0, NULL, 0), c.plain, c.plain_len);
+}
+
+
+bool zlib_file_rdwr_stream_t::read_chunk(chunk_t &c)
+{
+	uint8 header[MEMBER_HEADER_SIZE];
+	const size_t got = raw_file_rdwr_stream_t::read(header, MEMBER_HEADER_SIZE);
+	if (got == 0  &&  status == STATUS_EOF) {
+		return false;
+	}
+	if (got != MEMBER_HEADER_SIZE  ||  memcmp(header, member_header, sizeof(member_header)) != 0) {
+		dbg->error("zlib_file_rdwr_stream_t::read_chunk", "Damaged or unknown gzip member");
+		status = STATUS_ERR_CORRUPT;
+		return false;
+	}
+
+	const uint32 member_len = get_le32(header + sizeof(member_header));
+	if (member_len < MEMBER_HEADER_SIZE + MEMBER_TRAILER_SIZE  ||  member_len > 2*ZLIB_CHUNK_SIZE + 65536) {
+		dbg->error("zlib_file_rdwr_stream_t::read_chunk", "Invalid gzip member size %u", member_len);
+		status = STATUS_ERR_CORRUPT;
+		return false;
+	}
+
+	reserve_packed(c, member_len);
+	memcpy(c.packed, header, MEMBER_HEADER_SIZE);
+	if (raw_file_rdwr_stream_t::read(c.packed + MEMBER_HEADER_SIZE, member_len - MEMBER_HEADER_SIZE) != member_len - MEMBER_HEADER_SIZE) {
+		status = STATUS_ERR_CORRUPT;
+		return false;
+	}
+	c.packed_len = member_len;
+	c.plain_len = get_le32(c.packed + member_len - 4);
+	if (c.plain_len > 2*ZLIB_CHUNK_SIZE) {
+		status = STATUS_ERR_CORRUPT;
+		return false;
 	}
+	status = STATUS_OK;
+	return true;
 }
 
 
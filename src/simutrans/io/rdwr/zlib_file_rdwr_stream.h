@@ -7,13 +7,19 @@
 #define IO_RDWR_ZLIB_FILE_RDWR_STREAM_H
 
 
-#include "rdwr_stream.h"
+#include "chunked_file_rdwr_stream.h"
 
 #include <zlib.h>
 
 
-/// Reads/writes data from/to a zlib/gzip (deflate) compressed file.
-class zlib_file_rdwr_stream_t : public rdwr_stream_t
+/**
+ * Reads/writes data from/to a zlib/gzip (deflate) compressed file.
+ * Writes one gzip member per chunk; each member has an extra field with its
+ * size, so the reader can find and inflate several members at once. Any gzip
+ * reader can still read these files. Files without these members are read
+ * through gzread().
+ */
+class zlib_file_rdwr_stream_t : public chunked_file_rdwr_stream_t
 {
 public:
 	zlib_file_rdwr_stream_t(const std::string &filename, bool writing, int compression);
@@ -26,11 +32,18 @@ public:
 	/// @copydoc rdwr_stream_t::write
 	size_t write(const void *buf, size_t len) OVERRIDE;
 
+protected:
+	bool compress_chunk(chunk_t &c) OVERRIDE;
+	bool decompress_chunk(chunk_t &c) OVERRIDE;
+	bool read_chunk(chunk_t &c) OVERRIDE;
+
 private:
 	void set_status_from_errno();
 
 private:
+	/// only for files without chunks
 	gzFile gzfp;
+	int compression;
 };
 
 
@@ -554,26 +554,17 @@ network_command_t* network_get_received_command()
  */
 network_command_t *network_check_activity(int timeout)
 {
-	fd_set fds;
-	FD_ZERO(&fds);
-
-	socket_list_t::fill_set(&fds);
-
-	// time out: MAC complains about too long timeouts
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000ul;
-
-	int action = select( FD_SETSIZE, &fds, NULL, NULL, &tv );
-	if(  action<=0  ) {
+	if(  !socket_list_t::poll(timeout)  ) {
 		// timeout: return command from the queue
 		return network_get_received_command();
 	}
 
 	// accept new connection
-	socket_list_t::server_socket_iterator_t iter_s(&fds);
-	while(iter_s.next()) {
-		SOCKET accept_sock = iter_s.get_current();
+	for(  uint32 i=0;  i<socket_list_t::get_server_sockets();  i++  ) {
+		if(  !socket_list_t::is_readable(i)  ) {
+			continue;
+		}
+		SOCKET accept_sock = socket_list_t::get_socket(i);
 
 		if(  accept_sock!=INVALID_SOCKET  ) {
 			struct sockaddr_in client_name;
@@ -602,17 +593,17 @@ network_command_t *network_check_activity(int timeout)
 		}
 	}
 
-	// receive from clients
-	socket_list_t::client_socket_iterator_t iter_c(&fds);
-	while(iter_c.next()) {
-		SOCKET sender = iter_c.get_current();
-
-		if (sender != INVALID_SOCKET  &&  socket_list_t::has_client(sender)) {
-			uint32 client_id = socket_list_t::get_client_id(sender);
+	// receive from clients, clients accepted above are not ready yet
+	for(  uint32 client_id=socket_list_t::get_server_sockets();  client_id<socket_list_t::get_count();  client_id++  ) {
+		if(  socket_list_t::is_writable(client_id)  ) {
+			// queued packets can go out while we are here anyway
+			socket_list_t::get_client(client_id).process_send_queue();
+		}
+		if(  socket_list_t::is_readable(client_id)  ) {
 			network_command_t *nwc = socket_list_t::get_client(client_id).receive_nwc();
 			if (nwc) {
 				received_command_queue.append(nwc);
-				dbg->warning( "network_check_activity()", "received cmd %s (id %d) from socket[%d]", nwc->get_name(), nwc->get_id(), sender );
+				dbg->warning( "network_check_activity()", "received cmd %s (id %d) from socket[%d]", nwc->get_name(), nwc->get_id(), socket_list_t::get_socket(client_id) );
 			}
 			// errors are caught and treated in socket_info_t::receive_nwc
 		}
@@ -623,34 +614,17 @@ network_command_t *network_check_activity(int timeout)
 
 void network_process_send_queues(int timeout)
 {
-	fd_set fds;
-	FD_ZERO(&fds);
-
-	socket_list_t::fill_set(&fds);
-
-	// time out
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000ul;
-
-	int action = select( FD_SETSIZE, NULL, &fds, NULL, &tv );
-
-	if(  action<=0  ) {
+	if(  !socket_list_t::poll(timeout)  ) {
 		// timeout: return
 		return;
 	}
 
 	// send to clients
-	socket_list_t::client_socket_iterator_t iter_c(&fds);
-	while(iter_c.next()  &&  action>0) {
-		SOCKET sock = iter_c.get_current();
-
-		if (sock != INVALID_SOCKET  &&  socket_list_t::has_client(sock)) {
-			uint32 client_id = socket_list_t::get_client_id(sock);
+	for(  uint32 client_id=socket_list_t::get_server_sockets();  client_id<socket_list_t::get_count();  client_id++  ) {
+		if(  socket_list_t::is_writable(client_id)  ) {
 			socket_list_t::get_client(client_id).process_send_queue();
 			// errors are caught and treated in socket_info_t::process_send_queue
 		}
-		action --;
 	}
 }
 
@@ -723,6 +697,33 @@ void network_send_server(network_command_t* nwc )
 }
 
 
+/**
+ * send() which returns with EWOULDBLOCK instead of waiting, if nonblocking is set;
+ * sockets stay blocking otherwise, the file transfers depend on it
+ */
+static int send_nonblocking( SOCKET dest, const char *buf, int len, bool nonblocking )
+{
+#if USE_WINSOCK
+	if(  nonblocking  ) {
+		u_long mode = 1;
+		ioctlsocket( dest, FIONBIO, &mode );
+		const int sent = send( dest, buf, len, 0 );
+		const int err = WSAGetLastError();
+		mode = 0;
+		ioctlsocket( dest, FIONBIO, &mode );
+		WSASetLastError( err );
+		return sent;
+	}
+	return send( dest, buf, len, 0 );
+#elif defined(MSG_DONTWAIT)
+	return send( dest, buf, len, nonblocking ? MSG_DONTWAIT : 0 );
+#else
+	(void)nonblocking;
+	return send( dest, buf, len, 0 );
+#endif
+}
+
+
 /**
  * send data to dest
  *
@@ -743,7 +744,7 @@ bool network_send_data( SOCKET dest, const char *buf, const uint16 size, uint16
 #endif
 
 	while (count < size) {
-		const int sent = send(dest, buf+count, size-count, 0);
+		const int sent = send_nonblocking(dest, buf+count, size-count, timeout_ms <= 0);
 
 		if (sent == -1) {
 			const int err = GET_LAST_ERROR();
@@ -31,6 +31,8 @@
 #	include <errno.h>
 #	undef  EINPROGRESS
 #	define EINPROGRESS WSAEWOULDBLOCK
+#	undef  EWOULDBLOCK
+#	define EWOULDBLOCK WSAEWOULDBLOCK
 #else
 	// beos specific headers
 #	ifdef  __BEOS__
@@ -105,7 +107,7 @@ network_command_t* network_check_activity(int timeout);
  * if timeout_ms is positive:
  *    try to send all data, return true if all data are sent otherwise false
  * if timeout_ms is not positive:
- *    try to send as much as possible but return after one send attempt
+ *    try to send as much as possible without blocking, return after one send attempt
  *    return true if connection is still open and sending can be continued later
  *
  * @param buf the data
@@ -125,6 +127,10 @@ bool network_send_data( SOCKET dest, const char *buf, const uint16 size, uint16
  */
 bool network_receive_data( SOCKET sender, void *dest, uint16 len, uint16 &received, int timeout_ms );
 
+/**
+ * sends queued packets to all clients which can take them,
+ * waits at most timeout milliseconds for one to become writable
+ */
 void network_process_send_queues(int timeout);
 
 // true, if I can write on the server connection
@@ -85,6 +85,18 @@ bool network_command_t::send(SOCKET s)
 }
 
 
+void network_command_t::send_queued(SOCKET s)
+{
+	const uint32 client_id = socket_list_t::get_client_id(s);
+	if(  client_id < socket_list_t::get_server_sockets()  ||  !socket_list_t::is_valid_client_id(client_id)  ) {
+		send(s);
+		return;
+	}
+	prepare_to_send();
+	socket_list_t::get_client(client_id).send_queue_append( copy_packet() );
+}
+
+
 packet_t* network_command_t::copy_packet() const
 {
 	if (packet) {
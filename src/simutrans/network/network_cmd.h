@@ -67,6 +67,13 @@ public:
 	 */
 	bool send(SOCKET s);
 
+	/**
+	 * appends a copy to the send queue of a client socket,
+	 * thus a slow client does not stall the server
+	 * other sockets are sent to directly
+	 */
+	void send_queued(SOCKET s);
+
 	// write our data to the packet
 	virtual void rdwr();
 
@@ -10,6 +10,7 @@
 #include "network_socket_list.h"
 #include "network_cmp_pakset.h"
 #include "network_cmd_scenario.h"
+#include "network_delta.h"
 
 #include "../dataobj/loadsave.h"
 #include "../dataobj/gameinfo.h"
@@ -273,7 +274,7 @@ void nwc_nick_t::server_tools(karte_t *welt, uint32 client_id, uint8 what, const
 			if (client_id > 0) {
 				// send new nickname back to client
 				nwc_nick_t nwc(nick);
-				nwc.send(info.socket);
+				nwc.send_queued(info.socket);
 			}
 			else {
 				// human at server
@@ -286,7 +287,7 @@ void nwc_nick_t::server_tools(karte_t *welt, uint32 client_id, uint8 what, const
 			if (client_id > 0) {
 				// send old nickname back to client
 				nwc_nick_t nwc(info.nickname);
-				nwc.send(info.socket);
+				nwc.send_queued(info.socket);
 			}
 			else {
 				// human at server
@@ -436,7 +437,7 @@ bool nwc_chat_t::execute (karte_t* welt)
 					&&  i != client_id
 					&&  destination == dest_info.nickname.c_str()  )
 				{
-					nwchat->send( dest_info.socket );
+					nwchat->send_queued( dest_info.socket );
 				}
 			}
 
@@ -466,12 +467,19 @@ bool nwc_chat_t::execute (karte_t* welt)
 
 
 SOCKET nwc_join_t::pending_join_client = INVALID_SOCKET;
+sha1_hash_t nwc_join_t::pending_join_base;
 
 void nwc_join_t::rdwr()
 {
 	nwc_nick_t::rdwr();
 	packet->rdwr_long(client_id);
 	packet->rdwr_byte(answer);
+	if(  answer == JOIN_WITH_BASE  ) {
+		// only from clients, ignored by older servers
+		for(  uint8 i=0;  i<20;  i++  ) {
+			packet->rdwr_byte(base_hash[i]);
+		}
+	}
 }
 
 
@@ -496,8 +504,11 @@ bool nwc_join_t::execute(karte_t *welt)
 		nwj.rdwr();
 		if(  nwj.send( packet->get_sender() )  ) {
 			if(  nwj.answer==1  ) {
+				pending_join_base = answer == JOIN_WITH_BASE ? base_hash : sha1_hash_t();
 				// now send sync command
-				const uint32 new_map_counter = welt->generate_new_map_counter();
+				// a new map counter invalidates older commands of the clients which reload the game,
+				// an unchanged one tells them to continue without reloading
+				const uint32 new_map_counter = env_t::server_join_sync_all ? welt->generate_new_map_counter() : welt->get_map_counter();
 				// since network_send_all() does not include non-playing clients -> send sync command separately to the joining client
 				nwc_sync_t nw_sync(welt->get_sync_steps() + 1, welt->get_map_counter(), nwj.client_id, new_map_counter);
 				nw_sync.rdwr();
@@ -659,7 +670,7 @@ bool nwc_auth_player_t::execute(karte_t *welt)
 				// send unlock-info to player on the client (to clear unlock_pending flag)
 				nwc_auth_player_t nwc;
 				nwc.player_unlocked = info.player_unlocked;
-				nwc.send( get_sender());
+				nwc.send_queued( get_sender());
 			}
 		}
 	}
@@ -774,7 +785,11 @@ void nwc_sync_t::do_command(karte_t *welt)
 	// transfer game, all clients need to sync (save, reload, and pause)
 	// now save and send
 	dr_chdir( env_t::user_dir );
-	if(  !env_t::server  ) {
+	if(  !env_t::server  &&  new_map_counter == welt->get_map_counter()  ) {
+		// only the joining client loads the game, we continue like we had loaded it
+		welt->reset_unsaved_state();
+	}
+	else if(  !env_t::server  ) {
 		char fn[256];
 		sprintf( fn, "client%i-network.sve", network_get_client_id() );
 
@@ -829,6 +844,17 @@ void nwc_sync_t::do_command(karte_t *welt)
 			env_t::restore_UI = true;
 			welt->save( fn, false, SERVER_SAVEGAME_VER_NR, false );
 			env_t::restore_UI = old_restore_UI;
+
+			if(  !env_t::server_join_sync_all  ) {
+				// we do not load the game, so restore password hashes for us
+				sprintf( fn, "server%d-pwdhash.sve", env_t::server );
+				loadsave_t pwdrdfile;
+				if(  pwdrdfile.rd_open(fn) == loadsave_t::FILE_STATUS_OK  ) {
+					welt->rdwr_player_password_hashes( &pwdrdfile );
+					pwdrdfile.close();
+				}
+				sprintf( fn, "server%d-network.sve", env_t::server );
+			}
 		}
 		else {
 			sprintf(fn, "server%d-network.sve", env_t::server);
@@ -840,22 +866,47 @@ void nwc_sync_t::do_command(karte_t *welt)
 			}
 		}
 
+		// send only the difference, if the client still has an older game from us
+		const char *send_fn = fn;
+		char delta_fn[256];
+		if(  env_t::server_join_delta  ) {
+			sprintf( delta_fn, "server%d-delta.sve", env_t::server );
+			if(  network_delta_prepare_server( fn, nwc_join_t::pending_join_base, delta_fn )  ) {
+				send_fn = delta_fn;
+			}
+		}
+
+		if(  !env_t::server_join_sync_all  &&  socket_list_t::is_valid_client_id(client_id)  ) {
+			// commands broadcasted before the game was saved must arrive before it
+			socket_list_t::get_client(client_id).flush_send_queue();
+		}
+
 		// ok, now sending game
 		// this sends nwc_game_t
-		const char *err = network_send_file( socket_list_t::get_socket(client_id), fn );
+		const char *err = network_send_file( socket_list_t::get_socket(client_id), send_fn );
 		if (err) {
 			dbg->warning("nwc_sync_t::do_command","send game failed with: %s", err);
 		}
 
 		uint32 old_sync_steps = welt->get_sync_steps();
-		welt->load( fn );
-		welt->type_of_generation = karte_t::LOADED_WORLD;
+		if(  env_t::server_join_sync_all  ) {
+			welt->load( fn );
+			welt->type_of_generation = karte_t::LOADED_WORLD;
 
-		// restore steps
-		welt->network_game_set_pause( false, old_sync_steps);
+			// restore steps
+			welt->network_game_set_pause( false, old_sync_steps);
 
-		// apply new map counter
-		welt->set_map_counter(new_map_counter);
+			// apply new map counter
+			welt->set_map_counter(new_map_counter);
+		}
+		else {
+			// continue like the joining client after loading, as the other clients do
+			welt->reset_unsaved_state();
+			// the client discarded the commands not yet executed while it waited for the game
+			welt->send_command_queue( client_id );
+			// the game continues, so the save is outdated
+			welt->has_current_network_save = false;
+		}
 
 		// unpause the client that received the game
 		// we do not want to wait for him (maybe loading failed due to pakset-errors)
@@ -1370,7 +1421,7 @@ bool nwc_service_t::execute(karte_t *welt)
 				socket_list_t::get_client(sender_id).state = socket_info_t::admin;
 			}
 			nws.number = ok ? sender_id : 0;
-			nws.send(packet->get_sender());
+			nws.send_queued(packet->get_sender());
 			break;
 		}
 
@@ -1383,7 +1434,7 @@ bool nwc_service_t::execute(karte_t *welt)
 			nwc_service_t nws;
 			nws.flag = SRVC_GET_CLIENT_LIST;
 			// send, socket list will be written in rdwr
-			nws.send(packet->get_sender());
+			nws.send_queued(packet->get_sender());
 			break;
 		}
 
@@ -1401,15 +1452,10 @@ bool nwc_service_t::execute(karte_t *welt)
 				}
 			}
 			if (ban  &&  address.ip) {
-				fd_set fd;
-				FD_ZERO(&fd);
-				socket_list_t::fill_set(&fd);
-				socket_list_t::client_socket_iterator_t iter(&fd);
-				while(iter.next()) {
-					SOCKET sock = iter.get_current();
-					socket_info_t& info = socket_list_t::get_client(socket_list_t::get_client_id(sock));
-					if (address.matches(info.address)) {
-						socket_list_t::remove_client(sock);
+				for(uint32 i=socket_list_t::get_server_sockets(); i<socket_list_t::get_count(); i++) {
+					socket_info_t& info = socket_list_t::get_client(i);
+					if (info.is_active()  &&  info.socket!=INVALID_SOCKET  &&  address.matches(info.address)) {
+						socket_list_t::remove_client(info.socket);
 					}
 				}
 				blacklist.append(address);
@@ -1420,7 +1466,7 @@ bool nwc_service_t::execute(karte_t *welt)
 			nwc_service_t nws;
 			nws.flag = SRVC_GET_BLACK_LIST;
 			// send, blacklist will be written in rdwr
-			nws.send(packet->get_sender());
+			nws.send_queued(packet->get_sender());
 			break;
 		}
 
@@ -1519,7 +1565,7 @@ bool nwc_service_t::execute(karte_t *welt)
 			if (text  &&  (strlen(text) > MAX_PACKET_LEN - 256)) {
 				text[MAX_PACKET_LEN - 256] = 0;
 			}
-			nws.send(packet->get_sender());
+			nws.send_queued(packet->get_sender());
 			break;
 		}
 
@@ -113,6 +113,8 @@ private:
  * nwc_join_t
  * @from-client: client wants to join the server
  *      server sends nwc_join_t to sender, nwc_sync_t to all clients
+ *      @data answer == JOIN_WITH_BASE: hash of the game kept from the last join follows,
+ *            the server may send a delta to it (see network_delta.h)
  * @from-server:
  *      @data answer == 1 (if joining now is ok)
  *      @data client_id
@@ -126,14 +128,20 @@ public:
 	bool execute(karte_t *) OVERRIDE;
 	void rdwr() OVERRIDE;
 
+	enum { JOIN_WITH_BASE = 2 };
+
 	uint32 client_id;
 	uint8 answer;
+	sha1_hash_t base_hash;
 
 	/**
 	 * this clients is in the process of joining
 	 */
 	static SOCKET pending_join_client;
 
+	/// hash of the game the joining client still has (empty if none)
+	static sha1_hash_t pending_join_base;
+
 	static bool is_pending() { return pending_join_client != INVALID_SOCKET; }
 private:
 	nwc_join_t(const nwc_join_t&);
@@ -0,0 +1,476 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "network_delta.h"
+
+#include "../simdebug.h"
+#include "../simmem.h"
+#include "../macros.h"
+#include "../sys/simsys.h"
+#include "../dataobj/environment.h"
+#include "../dataobj/loadsave.h"
+#include "../io/classify_file.h"
+#include "../io/rdwr/memory_rdwr_stream.h"
+#include "../io/rdwr/raw_file_rdwr_stream.h"
+#include "../io/rdwr/zlib_file_rdwr_stream.h"
+#include "../utils/sha1.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+
+
+/*
+ * Delta file: gzip compressed
+ *   "SimDelta", uint32 version, base hash (20 bytes), result hash (20 bytes), uint64 result length
+ *   followed by operations, all numbers little endian:
+ *   OP_COPY    uint32 offset in base, uint32 length
+ *   OP_LITERAL uint32 length, data
+ *   OP_END
+ */
+#define DELTA_MAGIC      "SimDelta"
+#define DELTA_MAGIC_LEN  (8)
+#define DELTA_VERSION    (1)
+#define DELTA_HEADER_LEN (DELTA_MAGIC_LEN + 4 + 20 + 20 + 8)
+
+// bytes per indexed block of the base; smaller finds more matches but needs a larger index
+#define DELTA_BLOCK (256)
+
+#define MAX_SERVER_BASES (4)
+#define CLIENT_BASE_NAME "client-network-base.sve"
+
+enum delta_op_t { OP_END = 0, OP_COPY = 1, OP_LITERAL = 2 };
+
+
+/// uncompressed content of a file
+struct plain_t
+{
+	uint8 *data;
+	size_t len;
+
+	plain_t() : data(NULL), len(0) {}
+	~plain_t() { free(data); }
+};
+
+
+static bool read_stream(rdwr_stream_t *s, plain_t &p)
+{
+	size_t size = 1 << 22;
+	p.data = MALLOCN(uint8, size);
+	p.len = 0;
+	while(  s->get_status() == rdwr_stream_t::STATUS_OK  ) {
+		if(  p.len == size  ) {
+			size += size >> 1;
+			p.data = REALLOC(p.data, uint8, size);
+		}
+		p.len += s->read(p.data + p.len, size - p.len);
+	}
+	return s->get_status() == rdwr_stream_t::STATUS_EOF;
+}
+
+
+/// reads the uncompressed content of a savegame
+static bool read_plain(const char *filename, plain_t &p)
+{
+	file_info_t info;
+	if(  classify_save_file(filename, &info) != FILE_CLASSIFY_OK  ) {
+		return false;
+	}
+	rdwr_stream_t *s = loadsave_t::create_read_stream(filename, info.file_type);
+	const bool ok = s  &&  read_stream(s, p);
+	delete s;
+	return ok;
+}
+
+
+static bool write_file(const char *filename, const uint8 *data, size_t len)
+{
+	FILE *f = dr_fopen(filename, "wb");
+	if(  f == NULL  ) {
+		return false;
+	}
+	const bool ok = fwrite(data, 1, len, f) == len;
+	return (fclose(f) == 0)  &&  ok;
+}
+
+
+static void calc_hash(const plain_t &p, sha1_hash_t &hash)
+{
+	SHA1 sha;
+	for(  size_t pos = 0;  pos < p.len;  pos += 1 << 30  ) {
+		const size_t len = std::min(p.len - pos, (size_t)1 << 30);
+		sha.Input((const char *)p.data + pos, (uint32)len);
+	}
+	sha.Result(hash);
+}
+
+
+static void put_u8(memory_rdwr_stream_t &out, uint8 v)
+{
+	out.write(&v, 1);
+}
+
+
+static void put_u32(memory_rdwr_stream_t &out, uint32 v)
+{
+	const uint8 b[4] = { (uint8)v, (uint8)(v >> 8), (uint8)(v >> 16), (uint8)(v >> 24) };
+	out.write(b, 4);
+}
+
+
+static uint32 get_u32(const uint8 *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32)p[3] << 24);
+}
+
+
+static void put_literal(memory_rdwr_stream_t &out, const uint8 *data, size_t len)
+{
+	while(  len > 0  ) {
+		const uint32 n = (uint32)std::min(len, (size_t)0x7FFFFFFF);
+		put_u8(out, OP_LITERAL);
+		put_u32(out, n);
+		out.write(data, n);
+		data += n;
+		len -= n;
+	}
+}
+
+
+static void put_copy(memory_rdwr_stream_t &out, size_t offset, size_t len)
+{
+	while(  len > 0  ) {
+		const uint32 n = (uint32)std::min(len, (size_t)0x7FFFFFFF);
+		put_u8(out, OP_COPY);
+		put_u32(out, (uint32)offset);
+		put_u32(out, n);
+		offset += n;
+		len -= n;
+	}
+}
+
+
+// polynomial rolling hash over DELTA_BLOCK bytes
+#define ROLL_MUL (0x01000193u)
+
+static uint32 block_hash(const uint8 *p)
+{
+	uint32 h = 0;
+	for(  int i = 0;  i < DELTA_BLOCK;  i++  ) {
+		h = h * ROLL_MUL + p[i];
+	}
+	return h;
+}
+
+
+static inline uint32 hash_slot(uint32 h, uint32 bits)
+{
+	return (h * 2654435761u) >> (32 - bits);
+}
+
+
+/**
+ * Finds the blocks of @p base in @p cur (at any offset) and writes copy operations
+ * for them and literals for everything else.
+ */
+static void create_delta(const plain_t &base, const plain_t &cur, const sha1_hash_t &base_hash, const sha1_hash_t &cur_hash, memory_rdwr_stream_t &out)
+{
+	out.write(DELTA_MAGIC, DELTA_MAGIC_LEN);
+	put_u32(out, DELTA_VERSION);
+	for(  int i = 0;  i < 20;  i++  ) {
+		put_u8(out, base_hash[i]);
+	}
+	for(  int i = 0;  i < 20;  i++  ) {
+		put_u8(out, cur_hash[i]);
+	}
+	put_u32(out, (uint32)cur.len);
+	put_u32(out, (uint32)((uint64)cur.len >> 32));
+
+	// index the blocks of the base; the first one wins on collisions
+	const size_t blocks = base.len / DELTA_BLOCK;
+	uint32 bits = 10;
+	while(  ((size_t)1 << bits) < 2 * blocks  &&  bits < 28  ) {
+		bits++;
+	}
+	uint32 *table = MALLOCN(uint32, (size_t)1 << bits);
+	memset(table, 0xFF, sizeof(uint32) << bits);
+	for(  size_t b = 0;  b < blocks;  b++  ) {
+		uint32 &slot = table[hash_slot(block_hash(base.data + b * DELTA_BLOCK), bits)];
+		if(  slot == 0xFFFFFFFFu  ) {
+			slot = (uint32)b;
+		}
+	}
+
+	// ROLL_MUL^(DELTA_BLOCK-1) to remove the leaving byte
+	uint32 out_factor = 1;
+	for(  int i = 1;  i < DELTA_BLOCK;  i++  ) {
+		out_factor *= ROLL_MUL;
+	}
+
+	size_t literal_start = 0;
+	size_t i = 0;
+	uint32 h = cur.len >= DELTA_BLOCK ? block_hash(cur.data) : 0;
+	while(  i + DELTA_BLOCK <= cur.len  ) {
+		const uint32 b = table[hash_slot(h, bits)];
+		if(  b != 0xFFFFFFFFu  &&  memcmp(base.data + (size_t)b * DELTA_BLOCK, cur.data + i, DELTA_BLOCK) == 0  ) {
+			// extend the match in both directions
+			size_t start = i;
+			size_t base_start = (size_t)b * DELTA_BLOCK;
+			while(  start > literal_start  &&  base_start > 0  &&  base.data[base_start - 1] == cur.data[start - 1]  ) {
+				start--;
+				base_start--;
+			}
+			size_t end = i + DELTA_BLOCK;
+			size_t base_end = base_start + (end - start);
+			while(  end < cur.len  &&  base_end < base.len  &&  base.data[base_end] == cur.data[end]  ) {
+				end++;
+				base_end++;
+			}
+			put_literal(out, cur.data + literal_start, start - literal_start);
+			put_copy(out, base_start, end - start);
+			literal_start = i = end;
+			if(  i + DELTA_BLOCK <= cur.len  ) {
+				h = block_hash(cur.data + i);
+			}
+			continue;
+		}
+		if(  i + DELTA_BLOCK < cur.len  ) {
+			h = (h - cur.data[i] * out_factor) * ROLL_MUL + cur.data[i + DELTA_BLOCK];
+		}
+		i++;
+	}
+	put_literal(out, cur.data + literal_start, cur.len - literal_start);
+	put_u8(out, OP_END);
+
+	free(table);
+}
+
+
+/// rebuilds the game from @p base and @p delta; @returns an error message or NULL
+static const char *apply_delta(const plain_t &base, const sha1_hash_t &base_hash, const plain_t &delta, plain_t &result)
+{
+	const uint8 *p = delta.data;
+	const uint8 *const end = delta.data + delta.len;
+
+	if(  delta.len < DELTA_HEADER_LEN  ||  memcmp(p, DELTA_MAGIC, DELTA_MAGIC_LEN) != 0  ||  get_u32(p + DELTA_MAGIC_LEN) != DELTA_VERSION  ) {
+		return "Corrupt file";
+	}
+	p += DELTA_MAGIC_LEN + 4;
+	if(  sha1_hash_t(p) != base_hash  ) {
+		return "Not the game of the last connection";
+	}
+	const sha1_hash_t result_hash(p + 20);
+	p += 40;
+	const uint64 len = get_u32(p) | ((uint64)get_u32(p + 4) << 32);
+	p += 8;
+	if(  len > (size_t)-1  ) {
+		return "Not enough empty space";
+	}
+
+	result.len = (size_t)len;
+	result.data = MALLOCN(uint8, std::max(result.len, (size_t)1));
+	size_t pos = 0;
+	while(  p < end  &&  *p != OP_END  ) {
+		const uint8 op = *p++;
+		if(  op == OP_COPY  &&  end - p >= 8  ) {
+			const size_t offset = get_u32(p);
+			const size_t n = get_u32(p + 4);
+			p += 8;
+			if(  offset > base.len  ||  n > base.len - offset  ||  n > result.len - pos  ) {
+				return "Corrupt file";
+			}
+			memcpy(result.data + pos, base.data + offset, n);
+			pos += n;
+		}
+		else if(  op == OP_LITERAL  &&  end - p >= 4  ) {
+			const size_t n = get_u32(p);
+			p += 4;
+			if(  n > (size_t)(end - p)  ||  n > result.len - pos  ) {
+				return "Corrupt file";
+			}
+			memcpy(result.data + pos, p, n);
+			p += n;
+			pos += n;
+		}
+		else {
+			return "Corrupt file";
+		}
+	}
+	if(  p == end  ||  pos != result.len  ) {
+		return "Corrupt file";
+	}
+
+	sha1_hash_t hash;
+	calc_hash(result, hash);
+	return hash == result_hash ? NULL : "Corrupt file";
+}
+
+
+/*
+ * server side
+ */
+
+static sha1_hash_t server_base_hash[MAX_SERVER_BASES];
+static bool server_base_valid[MAX_SERVER_BASES] = { false };
+static uint32 server_base_next = 0;
+
+
+static void get_server_base_name(char *buf, uint32 i)
+{
+	sprintf(buf, "server%d-base%u.sve", env_t::server, i);
+}
+
+
+bool network_delta_prepare_server(const char *savegame, const sha1_hash_t &client_base, const char *delta_name)
+{
+	plain_t cur;
+	if(  !read_plain(savegame, cur)  ) {
+		dbg->warning("network_delta_prepare_server()", "Cannot read '%s'", savegame);
+		return false;
+	}
+	sha1_hash_t cur_hash;
+	calc_hash(cur, cur_hash);
+
+	// read the base of the client before it is possibly replaced below
+	plain_t base;
+	bool have_base = false;
+	if(  !client_base.empty()  ) {
+		for(  uint32 i = 0;  i < MAX_SERVER_BASES;  i++  ) {
+			if(  server_base_valid[i]  &&  server_base_hash[i] == client_base  ) {
+				char fn[256];
+				get_server_base_name(fn, i);
+				if(  read_plain(fn, base)  ) {
+					sha1_hash_t hash;
+					calc_hash(base, hash);
+					have_base = hash == client_base;
+				}
+				// file changed or gone
+				server_base_valid[i] = have_base;
+				break;
+			}
+		}
+	}
+
+	// remember the current game
+	bool known = false;
+	for(  uint32 i = 0;  i < MAX_SERVER_BASES  &&  !known;  i++  ) {
+		known = server_base_valid[i]  &&  server_base_hash[i] == cur_hash;
+	}
+	if(  !known  ) {
+		char fn[256];
+		get_server_base_name(fn, server_base_next);
+		server_base_valid[server_base_next] = write_file(fn, cur.data, cur.len);
+		server_base_hash[server_base_next] = cur_hash;
+		server_base_next = (server_base_next + 1) % MAX_SERVER_BASES;
+	}
+
+	if(  !have_base  ||  base.len > 0xFFFFFFFFu  ) {
+		return false;
+	}
+
+	memory_rdwr_stream_t delta;
+	create_delta(base, cur, client_base, cur_hash, delta);
+	{
+		zlib_file_rdwr_stream_t out(delta_name, true, 6);
+		delta.finish();
+		size_t len;
+		while(  char *data = delta.pop_chunk(len)  ) {
+			for(  size_t pos = 0;  pos < len  &&  out.get_status() == rdwr_stream_t::STATUS_OK;  pos += 1 << 20  ) {
+				out.write(data + pos, std::min(len - pos, (size_t)1 << 20));
+			}
+			free(data);
+		}
+		if(  out.get_status() != rdwr_stream_t::STATUS_OK  ) {
+			dbg->warning("network_delta_prepare_server()", "Cannot write '%s'", delta_name);
+			return false;
+		}
+	}
+
+	// only worth it if smaller
+	FILE *f = dr_fopen(savegame, "rb");
+	FILE *d = dr_fopen(delta_name, "rb");
+	long full_size = -1, delta_size = -1;
+	if(  f  &&  d  ) {
+		fseek(f, 0, SEEK_END);
+		fseek(d, 0, SEEK_END);
+		full_size = ftell(f);
+		delta_size = ftell(d);
+	}
+	if(  f  ) {
+		fclose(f);
+	}
+	if(  d  ) {
+		fclose(d);
+	}
+	dbg->message("network_delta_prepare_server()", "delta %ld bytes, full game %ld bytes", delta_size, full_size);
+	return delta_size >= 0  &&  delta_size < full_size;
+}
+
+
+/*
+ * client side
+ */
+
+bool network_delta_get_client_base(sha1_hash_t &hash)
+{
+	plain_t base;
+	FILE *f = dr_fopen(CLIENT_BASE_NAME, "rb");
+	if(  f == NULL  ) {
+		return false;
+	}
+	raw_file_rdwr_stream_t s(f, false);
+	if(  !read_stream(&s, base)  ||  base.len == 0  ) {
+		return false;
+	}
+	calc_hash(base, hash);
+	return true;
+}
+
+
+const char *network_delta_receive(const char *filename)
+{
+	plain_t game;
+	zlib_file_rdwr_stream_t in(filename, false, 0);
+	uint8 magic[DELTA_MAGIC_LEN];
+	if(  in.get_status() == rdwr_stream_t::STATUS_OK  &&  in.read(magic, DELTA_MAGIC_LEN) == DELTA_MAGIC_LEN  &&  memcmp(magic, DELTA_MAGIC, DELTA_MAGIC_LEN) == 0  ) {
+		plain_t delta;
+		if(  !read_stream(&in, delta)  ) {
+			return "Corrupt file";
+		}
+		// put the magic in front again
+		delta.data = REALLOC(delta.data, uint8, delta.len + DELTA_MAGIC_LEN);
+		memmove(delta.data + DELTA_MAGIC_LEN, delta.data, delta.len);
+		memcpy(delta.data, magic, DELTA_MAGIC_LEN);
+		delta.len += DELTA_MAGIC_LEN;
+
+		plain_t base;
+		sha1_hash_t base_hash;
+		if(  !read_plain(CLIENT_BASE_NAME, base)  ) {
+			return "Could not open file";
+		}
+		calc_hash(base, base_hash);
+		if(  const char *err = apply_delta(base, base_hash, delta, game)  ) {
+			// next time without delta
+			dr_remove(CLIENT_BASE_NAME);
+			return err;
+		}
+		if(  !write_file(filename, game.data, game.len)  ) {
+			return "Failed to write file";
+		}
+		dbg->message("network_delta_receive()", "rebuilt game of %lu bytes from delta of %lu bytes", (unsigned long)game.len, (unsigned long)delta.len);
+	}
+	else if(  !read_plain(filename, game)  ) {
+		// will fail on loading anyway
+		return NULL;
+	}
+
+	// keep it for the next time
+	if(  !write_file(CLIENT_BASE_NAME, game.data, game.len)  ) {
+		dbg->warning("network_delta_receive()", "Cannot write '%s'", CLIENT_BASE_NAME);
+		dr_remove(CLIENT_BASE_NAME);
+	}
+	return NULL;
+}
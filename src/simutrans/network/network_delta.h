@@ -0,0 +1,40 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef NETWORK_NETWORK_DELTA_H
+#define NETWORK_NETWORK_DELTA_H
+
+
+#include "../utils/sha1_hash.h"
+
+
+/**
+ * Savegame deltas for joining clients.
+ *
+ * Server and clients keep the uncompressed content of the last games sent ("bases"),
+ * identified by their SHA-1. A client that still has a base known to the server
+ * receives only the difference to it instead of the full game.
+ */
+
+/**
+ * Server: remembers @p savegame, which is about to be sent to a joining client.
+ * If the client still has a base with hash @p client_base and the difference is
+ * smaller than @p savegame, writes it to @p delta_name and returns true.
+ * Then @p delta_name should be sent instead of @p savegame.
+ */
+bool network_delta_prepare_server(const char *savegame, const sha1_hash_t &client_base, const char *delta_name);
+
+/// Client: hash of the base kept from the last join; false if there is none
+bool network_delta_get_client_base(sha1_hash_t &hash);
+
+/**
+ * Client: processes the received game @p filename. If it is a delta, it is replaced by
+ * the full (uncompressed) game. Its content is kept as base for the next join.
+ * @returns error message or NULL
+ */
+const char *network_delta_receive(const char *filename);
+
+
+#endif
@@ -110,6 +110,7 @@ const char *network_receive_file(const SOCKET src_sock, const char *const save_a
 
 #include "network_cmd.h"
 #include "network_cmd_ingame.h"
+#include "network_delta.h"
 #include "network_socket_list.h"
 
 #include "../dataobj/loadsave.h"
@@ -206,6 +207,9 @@ const char *network_connect(const char *cp, karte_t *world)
 		// want to join
 		{
 			nwc_join_t nwc_join( env_t::nickname.c_str() );
+			if(  network_delta_get_client_base( nwc_join.base_hash )  ) {
+				nwc_join.answer = nwc_join_t::JOIN_WITH_BASE;
+			}
 			nwc_join.rdwr();
 			if (!nwc_join.send(my_client_socket)) {
 				err = "send of NWC_JOIN failed";
@@ -273,6 +277,10 @@ const char *network_connect(const char *cp, karte_t *world)
 		char filename[256];
 		sprintf( filename, "client%i-network.sve", network_get_client_id() );
 		err = network_receive_file( my_client_socket, filename, len );
+		if(  err == NULL  ) {
+			// rebuild the game, if only the difference was sent
+			err = network_delta_receive( filename );
+		}
 	}
 end:
 	if(err) {
@@ -7,11 +7,23 @@
 #include "network_cmd.h"
 #include "network_cmd_ingame.h"
 #include "network_packet.h"
+#include "../macros.h"
+
+#include <string.h>
 
 #ifndef NETTOOL
 #include "../dataobj/environment.h"
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#define USE_EPOLL
+
+// -1 until the first socket is registered, or if epoll is not available
+static int epoll_fd = -1;
+static bool epoll_failed = false;
+#endif
+
 
 bool connection_info_t::operator==(const connection_info_t& other) const
 {
@@ -33,7 +45,10 @@ void socket_info_t::reset()
 		packet_t *p = send_queue.remove_first();
 		delete p;
 	}
+	poll_ready = 0;
 	if (socket != INVALID_SOCKET) {
+		// unregister before the socket number can be reused
+		socket_list_t::update_poll(this, true);
 		network_close_socket(socket);
 	}
 	if (state != has_left) {
@@ -90,6 +105,27 @@ void socket_info_t::process_send_queue()
 			break;
 		}
 	}
+	// stop watching for writing once the queue is empty
+	socket_list_t::update_poll(this);
+}
+
+
+void socket_info_t::flush_send_queue()
+{
+	while(!send_queue.empty()) {
+		packet_t *p = send_queue.front();
+		p->send(socket, true);
+		if (p->has_failed()) {
+			// close this client, clear the send_queue
+			socket_list_t::remove_client(socket);
+			break;
+		}
+		else if (p->is_ready()) {
+			send_queue.remove_first();
+			delete p;
+		}
+	}
+	socket_list_t::update_poll(this);
 }
 
 
@@ -98,6 +134,8 @@ void socket_info_t::send_queue_append(packet_t *p)
 	if (p) {
 		if (!p->has_failed()) {
 			send_queue.append(p);
+			// sent when the socket becomes writable
+			socket_list_t::update_poll(this);
 		}
 		else {
 			delete p;
@@ -196,6 +234,7 @@ void socket_list_t::add_client( SOCKET sock, uint32 ip )
 	list[i]->socket = sock;
 	list[i]->address = net_address_t(ip, 0);
 	change_state( i, socket_info_t::connected );
+	update_poll( list[i] );
 
 	network_set_socket_nodelay( sock );
 }
@@ -221,6 +260,7 @@ void socket_list_t::add_server( SOCKET sock )
 	}
 	list[i]->socket = sock;
 	change_state(i, socket_info_t::server);
+	update_poll( list[i] );
 	if (i==0) {
 #ifndef NETTOOL
 		// set server nickname
@@ -302,7 +342,7 @@ void socket_list_t::unlock_player_all(uint8 player_nr, bool unlock, uint32 excep
 					network_send_server(nwc);
 				}
 				else {
-					nwc->send(list[i]->socket);
+					nwc->send_queued(list[i]->socket);
 					delete nwc;
 				}
 			}
@@ -357,6 +397,102 @@ plainstring socket_list_t::get_all_nicks()
 }
 
 
+void socket_list_t::update_poll(socket_info_t *info, bool remove)
+{
+	uint8 events = 0;
+	if(  !remove  &&  info->is_active()  &&  info->socket != INVALID_SOCKET  ) {
+		events = POLL_READ;
+		if(  !info->send_queue.empty()  &&  info->state != socket_info_t::server  ) {
+			events |= POLL_WRITE;
+		}
+	}
+	if(  events == info->poll_events  ) {
+		return;
+	}
+
+#ifdef USE_EPOLL
+	if(  epoll_fd == -1  &&  !epoll_failed  ) {
+		epoll_fd = epoll_create1( EPOLL_CLOEXEC );
+		if(  epoll_fd == -1  ) {
+			dbg->warning( "socket_list_t::update_poll", "epoll not available, using select: \"%s\"", strerror(errno) );
+			epoll_failed = true;
+		}
+	}
+	if(  epoll_fd != -1  ) {
+		struct epoll_event ev;
+		ev.events = ((events & POLL_READ) ? (uint32)EPOLLIN : 0u) | ((events & POLL_WRITE) ? (uint32)EPOLLOUT : 0u);
+		ev.data.ptr = info;
+		const int op = info->poll_events == 0 ? EPOLL_CTL_ADD : (events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD);
+		if(  epoll_ctl( epoll_fd, op, info->socket, &ev ) != 0  ) {
+			dbg->warning( "socket_list_t::update_poll", "epoll_ctl(%d) failed for socket[%d]: \"%s\"", op, info->socket, strerror(errno) );
+		}
+	}
+#endif
+	info->poll_events = events;
+}
+
+
+bool socket_list_t::poll(int timeout_ms)
+{
+	for(socket_info_t* const i : list) {
+		i->poll_ready = 0;
+	}
+
+#ifdef USE_EPOLL
+	if(  epoll_fd != -1  ) {
+		// level triggered: sockets not reported this time are reported by the next call
+		struct epoll_event events[256];
+		const int action = epoll_wait( epoll_fd, events, lengthof(events), timeout_ms );
+		for(  int e=0;  e<action;  e++  ) {
+			socket_info_t *info = (socket_info_t *)events[e].data.ptr;
+			// errors and hangups are noticed by the next recv()
+			if(  events[e].events & (EPOLLIN | EPOLLERR | EPOLLHUP)  ) {
+				info->poll_ready |= POLL_READ;
+			}
+			if(  events[e].events & EPOLLOUT  ) {
+				info->poll_ready |= POLL_WRITE;
+			}
+		}
+		return action > 0;
+	}
+#endif
+
+	fd_set fds_read, fds_write;
+	FD_ZERO(&fds_read);
+	FD_ZERO(&fds_write);
+	SOCKET s_max = 0;
+	for(socket_info_t* const i : list) {
+		if(  i->poll_events  ) {
+			s_max = max( i->socket, s_max );
+			FD_SET( i->socket, &fds_read );
+			if(  i->poll_events & POLL_WRITE  ) {
+				FD_SET( i->socket, &fds_write );
+			}
+		}
+	}
+
+	// time out: MAC complains about too long timeouts
+	struct timeval tv;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000ul;
+
+	if(  select( s_max+1, &fds_read, &fds_write, NULL, &tv ) <= 0  ) {
+		return false;
+	}
+	for(socket_info_t* const i : list) {
+		if(  i->poll_events  ) {
+			if(  FD_ISSET( i->socket, &fds_read )  ) {
+				i->poll_ready |= POLL_READ;
+			}
+			if(  FD_ISSET( i->socket, &fds_write )  ) {
+				i->poll_ready |= POLL_WRITE;
+			}
+		}
+	}
+	return true;
+}
+
+
 SOCKET socket_list_t::fill_set(fd_set *fds)
 {
 	SOCKET s_max = 0;
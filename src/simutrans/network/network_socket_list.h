@@ -62,13 +62,19 @@ private:
 	packet_t *packet;
 	slist_tpl<packet_t *> send_queue;
 
+	/// events the poller watches for, and those it reported by the last socket_list_t::poll()
+	uint8 poll_events;
+	uint8 poll_ready;
+
+	friend class socket_list_t;
+
 public:
 	connection_state_t state;
 	SOCKET socket;
 	uint16 player_unlocked;
 
 public:
-	socket_info_t() : connection_info_t(), packet(0), send_queue(), state(inactive), socket(INVALID_SOCKET), player_unlocked(0) {}
+	socket_info_t() : connection_info_t(), packet(0), send_queue(), poll_events(0), poll_ready(0), state(inactive), socket(INVALID_SOCKET), player_unlocked(0) {}
 
 	~socket_info_t();
 
@@ -88,10 +94,15 @@ public:
 	network_command_t* receive_nwc();
 
 	/**
-	 *
+	 * sends as much of the queued packets as possible without blocking
 	 */
 	void process_send_queue();
 
+	/**
+	 * sends all queued packets completely, e.g. before data is sent directly to the socket
+	 */
+	void flush_send_queue();
+
 	void send_queue_append(packet_t *p);
 
 	/**
@@ -203,6 +214,29 @@ public:
 private:
 	static void book_state_change(socket_info_t::connection_state_t state, sint8 incr);
 
+	enum { POLL_READ = 1, POLL_WRITE = 2 };
+
+	/**
+	 * (un)registers the socket with the poller: all active sockets are watched for reading,
+	 * client sockets with queued packets for writing too
+	 * @param remove if true, the socket is about to be closed
+	 */
+	static void update_poll(socket_info_t *info, bool remove = false);
+
+	friend class socket_info_t;
+
+public:
+	/**
+	 * waits at most timeout_ms for activity,
+	 * uses epoll where available and select otherwise
+	 * @return false on timeout or error
+	 */
+	static bool poll(int timeout_ms);
+
+	/// results of the last poll()
+	static bool is_readable(uint32 client_id) { return client_id < list.get_count()  &&  (list[client_id]->poll_ready & POLL_READ); }
+	static bool is_writable(uint32 client_id) { return client_id < list.get_count()  &&  (list[client_id]->poll_ready & POLL_WRITE); }
+
 public: // from now stuff to deal with fd_set's
 
 	/**
@@ -16,7 +16,7 @@ const way_desc_t *maglev_t::default_maglev=NULL;
 /**
  * File loading constructor.
  */
-maglev_t::maglev_t(loadsave_t *file) : schiene_t()
+maglev_t::maglev_t(loadsave_t *file) : schiene_t(maglev_wt)
 {
 	rdwr(file);
 }
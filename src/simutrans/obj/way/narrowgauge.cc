@@ -12,7 +12,7 @@ const way_desc_t *narrowgauge_t::default_narrowgauge=NULL;
 
 
 
-narrowgauge_t::narrowgauge_t(loadsave_t *file) : schiene_t()
+narrowgauge_t::narrowgauge_t(loadsave_t *file) : schiene_t(narrowgauge_wt)
 {
 	rdwr(file);
 }
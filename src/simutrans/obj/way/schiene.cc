@@ -25,7 +25,7 @@ const way_desc_t *schiene_t::default_schiene=NULL;
 bool schiene_t::show_reservations = false;
 
 
-schiene_t::schiene_t() : weg_t()
+schiene_t::schiene_t(waytype_t wt) : weg_t(wt)
 {
 	reserved2 = reserved = convoihandle_t();
 	enter = enter2 = 0;
@@ -39,7 +39,7 @@ schiene_t::schiene_t() : weg_t()
 }
 
 
-schiene_t::schiene_t(loadsave_t *file) : weg_t()
+schiene_t::schiene_t(loadsave_t *file) : weg_t(track_wt)
 {
 	reserved2 = reserved = convoihandle_t();
 	enter = enter2 = 0;
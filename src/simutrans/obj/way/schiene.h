@@ -38,7 +38,8 @@ public:
 	*/
 	schiene_t(loadsave_t *file);
 
-	schiene_t();
+	/// @param wt waytype of derived classes (maglev etc.)
+	explicit schiene_t(waytype_t wt = track_wt);
 
 	waytype_t get_waytype() const OVERRIDE {return track_wt;}
 
@@ -17,13 +17,13 @@
 const way_desc_t *strasse_t::default_strasse=NULL;
 
 
-strasse_t::strasse_t(loadsave_t *file) : weg_t()
+strasse_t::strasse_t(loadsave_t *file) : weg_t(road_wt)
 {
 	rdwr(file);
 }
 
 
-strasse_t::strasse_t() : weg_t()
+strasse_t::strasse_t() : weg_t(road_wt)
 {
 	set_gehweg(false);
 	set_desc(default_strasse);
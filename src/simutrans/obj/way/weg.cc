@@ -5,6 +5,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "weg.h"
 
@@ -34,7 +35,6 @@
 #include "../../descriptor/way_desc.h"
 #include "../../descriptor/roadsign_desc.h"
 
-#include "../../tpl/slist_tpl.h"
 
 #ifdef MULTI_THREAD
 #include "../../utils/simthread.h"
@@ -45,16 +45,27 @@ static recursive_mutex_maker_t weg_cim_maker(weg_calc_image_mutex);
 /**
  * Alle instantiierten Wege
  */
-slist_tpl <weg_t *> alle_wege;
+weg_t::way_list_t weg_t::way_lists[MAX_WAY_LISTS];
 
 uint16 weg_t::cityroad_speed = 50;
 
 /**
- * Get list of all ways
+ * Get list of all ways of this waytype
  */
-const slist_tpl <weg_t*> &weg_t::get_alle_wege()
+const vector_tpl<weg_t *> &weg_t::get_alle_wege(waytype_t wt)
 {
-	return alle_wege;
+	assert(get_list_nr(wt) < MAX_WAY_LISTS);
+	return way_lists[get_list_nr(wt)].ways;
+}
+
+
+uint32 weg_t::get_alle_wege_count()
+{
+	uint32 count = 0;
+	for(  uint8 i = 0;  i < MAX_WAY_LISTS;  i++  ) {
+		count += way_lists[i].ways.get_count();
+	}
+	return count;
 }
 
 
@@ -69,8 +80,8 @@ void weg_t::set_cityroad_speedlimit(uint16 new_limit)
 {
 	if (cityroad_speed != new_limit) {
 		cityroad_speed = new_limit;
-		for(weg_t *w : alle_wege) {
-			if(  w->hat_gehweg()  &&  w->get_waytype() == road_wt  ) {
+		for(weg_t *w : get_alle_wege(road_wt)) {
+			if(  w->hat_gehweg()  ) {
 				if (const way_desc_t* desc = w->get_desc()) {
 					w->set_max_speed(min(desc->get_topspeed(), cityroad_speed));
 				}
@@ -154,15 +165,12 @@ void weg_t::set_desc(const way_desc_t *b)
 }
 
 
-/**
- * initializes statistic array
- */
-void weg_t::init_statistics()
+void weg_t::set_gehweg(const bool yesno)
 {
-	for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
-		for(  int month=0;  month<MAX_WAY_STAT_MONTHS;  month++  ) {
-			statistics[month][type] = 0;
-		}
+	sidewalk_flag = yesno;
+	// the same limit as set_desc() and loading apply
+	if(  yesno  &&  desc  &&  desc->get_wtyp() == road_wt  ) {
+		max_speed = min( desc->get_topspeed(), cityroad_speed );
 	}
 }
 
@@ -170,13 +178,22 @@ void weg_t::init_statistics()
 /**
  * Initializes all member variables
  */
-void weg_t::init()
+void weg_t::init(waytype_t wt)
 {
 	ribi = ribi_maske = ribi_t::none;
 	max_speed = 450;
 	desc = 0;
-	init_statistics();
-	alle_wege.insert(this);
+
+	list_nr = get_list_nr(wt);
+	assert(list_nr < MAX_WAY_LISTS);
+	way_list_t &list = way_lists[list_nr];
+	list_index = list.ways.get_count();
+	list.ways.append(this);
+	for(  int month = 0;  month < MAX_WAY_STAT_MONTHS;  month++  ) {
+		for(  int type = 0;  type < MAX_WAY_STATISTICS;  type++  ) {
+			list.statistics[month][type].append(0);
+		}
+	}
 	close_diagonal_state = 0;
 	diagonal_flag = 0;
 	switch_state = 0;
@@ -194,7 +211,20 @@ void weg_t::init()
 
 weg_t::~weg_t()
 {
-	alle_wege.remove(this);
+	// move the last way into the freed place
+	way_list_t &list = way_lists[list_nr];
+	weg_t *last = list.ways.back();
+	list.ways[list_index] = last;
+	for(  int month = 0;  month < MAX_WAY_STAT_MONTHS;  month++  ) {
+		for(  int type = 0;  type < MAX_WAY_STATISTICS;  type++  ) {
+			vector_tpl<sint16> &values = list.statistics[month][type];
+			values[list_index] = values.back();
+			values.pop_back();
+		}
+	}
+	last->list_index = list_index;
+	list.ways.pop_back();
+
 	player_t *player=get_owner();
 	if(player) {
 		player_t::add_maintenance( player,  -desc->get_maintenance(), desc->get_finance_waytype() );
@@ -276,10 +306,10 @@ void weg_t::rdwr(loadsave_t *file)
 
 	for(  int type=0;  type<MAX_WAY_STATISTICS;  type++  ) {
 		for(  int month=0;  month<MAX_WAY_STAT_MONTHS;  month++  ) {
-			sint32 w = statistics[month][type];
+			sint32 w = statistic(month, type);
 			file->rdwr_long(w);
-			statistics[month][type] = (sint16)w;
-			// DBG_DEBUG("weg_t::rdwr()", "statistics[%d][%d]=%d", month, type, statistics[month][type]);
+			statistic(month, type) = (sint16)w;
+			// DBG_DEBUG("weg_t::rdwr()", "statistics[%d][%d]=%d", month, type, statistic(month, type));
 		}
 	}
 }
@@ -305,13 +335,13 @@ void weg_t::info(cbuffer_t & buf) const
 	}
 
 #if 1
-	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), statistics[1][1]);
+	buf.printf(translator::translate("convoi passed last\nmonth %i\n"), statistic(1, WAY_STAT_CONVOIS));
 #else
 	// Debug - output stats
 	buf.append("\n");
 	for (int type=0; type<MAX_WAY_STATISTICS; type++) {
 		for (int month=0; month<MAX_WAY_STAT_MONTHS; month++) {
-			buf.printf("%d ", statistics[month][type]);
+			buf.printf("%d ", statistic(month, type));
 		}
 	buf.append("\n");
 	}
@@ -732,15 +762,22 @@ void weg_t::check_diagonal()
 
 
 /**
- * new month
+ * new month: shifts the statistics of all ways by one month
  */
-void weg_t::new_month()
+void weg_t::new_month_all()
 {
-	for (int type=0; type<MAX_WAY_STATISTICS; type++) {
-		for (int month=MAX_WAY_STAT_MONTHS-1; month>0; month--) {
-			statistics[month][type] = statistics[month-1][type];
+	for(  uint8 i = 0;  i < MAX_WAY_LISTS;  i++  ) {
+		way_list_t &list = way_lists[i];
+		const uint32 count = list.ways.get_count();
+		if(  count == 0  ) {
+			continue;
+		}
+		for(  int type = 0;  type < MAX_WAY_STATISTICS;  type++  ) {
+			for(  int month = MAX_WAY_STAT_MONTHS-1;  month > 0;  month--  ) {
+				memcpy( list.statistics[month][type].begin(), list.statistics[month-1][type].begin(), count * sizeof(sint16) );
+			}
+			memset( list.statistics[0][type].begin(), 0, count * sizeof(sint16) );
 		}
-		statistics[0][type] = 0;
 	}
 }
 
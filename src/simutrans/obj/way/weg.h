@@ -12,12 +12,12 @@
 #include "../../obj/simobj.h"
 #include "../../descriptor/way_desc.h"
 #include "../../dataobj/koord3d.h"
+#include "../../tpl/vector_tpl.h"
 
 
 class karte_t;
 class way_desc_t;
 class cbuffer_t;
-template <class T> class slist_tpl;
 
 
 // maximum number of months to store information
@@ -32,6 +32,9 @@ enum way_statistics {
 	WAY_STAT_MAX
 };
 
+// number of way lists, one for each waytype a way can have (see weg_t::get_list_nr())
+#define MAX_WAY_LISTS 9
+
 
 /**
  * Ways is the base class for all traffic routes. (roads, track, runway etc.)
@@ -45,17 +48,42 @@ class weg_t : public obj_no_info_t
 {
 public:
 	/**
-	* Get list of all ways
+	* Get list of all ways of this waytype (tram tracks are track_wt)
 	*/
-	static const slist_tpl <weg_t *> & get_alle_wege();
+	static const vector_tpl<weg_t *> &get_alle_wege(waytype_t wt);
+
+	/// @return number of all ways
+	static uint32 get_alle_wege_count();
+
+	/**
+	* new month for the statistics of all ways
+	*/
+	static void new_month_all();
 
 private:
 	/**
-	* array for statistical values
-	* MAX_WAY_STAT_MONTHS: [0] = actual value; [1] = last month value
-	* MAX_WAY_STATISTICS: see #define at top of file
+	* All ways of one waytype, stored densely so the monthly update is a sweep over flat arrays.
+	* A way knows its index, removing a way moves the last one into its place.
 	*/
-	sint16 statistics[MAX_WAY_STAT_MONTHS][MAX_WAY_STATISTICS];
+	struct way_list_t
+	{
+		vector_tpl<weg_t *> ways;
+
+		/**
+		* statistical values of ways[i] are in statistics[month][type][i]
+		* MAX_WAY_STAT_MONTHS: [0] = actual value; [1] = last month value
+		* MAX_WAY_STATISTICS: see #define at top of file
+		*/
+		vector_tpl<sint16> statistics[MAX_WAY_STAT_MONTHS][MAX_WAY_STATISTICS];
+	};
+
+	static way_list_t way_lists[MAX_WAY_LISTS];
+
+	static uint8 get_list_nr(waytype_t wt) { return wt == air_wt ? 0 : wt == tram_wt ? (uint8)track_wt : (uint8)wt; }
+
+	/// position in way_lists[list_nr]
+	uint32 list_index;
+	uint8 list_nr;
 
 	static uint16 cityroad_speed;
 
@@ -97,19 +125,16 @@ private:
 
 	/**
 	* Initializes all member variables
+	* @param wt waytype of the derived class, get_waytype() cannot be called yet
 	*/
-	void init();
+	void init(waytype_t wt);
 
-	/**
-	* initializes statistic array
-	*/
-	void init_statistics();
+	sint16 &statistic(int month, int type) const { return way_lists[list_nr].statistics[month][type][list_index]; }
 
 protected:
+	explicit weg_t(waytype_t wt) : obj_no_info_t() { init(wt); }
 
 public:
-	weg_t(loadsave_t*) : obj_no_info_t() { init(); }
-	weg_t() : obj_no_info_t() { init(); }
 
 	virtual ~weg_t();
 
@@ -238,26 +263,23 @@ public:
 	/**
 	* book statistics - is called very often and therefore inline
 	*/
-	void book(int amount, way_statistics type) { statistics[0][type] += amount; }
+	void book(int amount, way_statistics type) { statistic(0, type) += amount; }
 
 	/**
 	* return statistics value
 	* always returns last month's value
 	*/
-	int get_statistics(int type) const { return statistics[1][type]; }
+	int get_statistics(int type) const { return statistic(1, type); }
 
-	sint64 get_stat(int month, int stat_type) const { assert(stat_type<WAY_STAT_MAX  &&  0<=month  &&  month<MAX_WAY_STAT_MONTHS); return statistics[month][stat_type]; }
-	/**
-	* new month
-	*/
-	void new_month();
+	sint64 get_stat(int month, int stat_type) const { assert(stat_type<WAY_STAT_MAX  &&  0<=month  &&  month<MAX_WAY_STAT_MONTHS); return statistic(month, stat_type); }
 
 	void check_diagonal();
 
 	void count_sign();
 
 	/* flag query routines */
-	void set_gehweg(const bool yesno) { sidewalk_flag = yesno; }
+	/// roads with sidewalk get the speed limit of city roads
+	void set_gehweg(const bool yesno);
 	inline bool hat_gehweg() const { return sidewalk_flag; }
 
 	void set_switched(const bool ne_se) { switch_state = 1+ ne_se; }
@@ -631,6 +631,10 @@ bool ai_goods_t::create_simple_rail_transport()
 	way_builder_t bauigel(this);
 	bauigel.init_builder( way_builder_t::schiene|way_builder_t::bot_flag, rail_weg, tunnel_builder_t::get_tunnel_desc(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()), bridge_builder_t::find_bridge(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()) );
 	bauigel.set_keep_existing_ways(false);
+	// long connections between factories easily exceed the node limit otherwise
+	bauigel.set_bidirectional(true);
+	bauigel.set_corridor(64);
+	bauigel.set_coarse_heuristic(true);
 	// for stations
 	way_builder_t bauigel1(this);
 	bauigel1.init_builder( way_builder_t::schiene|way_builder_t::bot_flag, rail_weg, tunnel_builder_t::get_tunnel_desc(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()), bridge_builder_t::find_bridge(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()) );
@@ -702,6 +706,8 @@ bool ai_goods_t::create_simple_rail_transport()
 	way_builder_t baumaulwurf(this);
 	baumaulwurf.init_builder( way_builder_t::schiene|way_builder_t::bot_flag|way_builder_t::terraform_flag, rail_weg, tunnel_builder_t::get_tunnel_desc(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()), bridge_builder_t::find_bridge(track_wt,rail_engine->get_topspeed(),welt->get_timeline_year_month()) );
 	baumaulwurf.set_keep_existing_ways(false);
+	baumaulwurf.set_corridor(64);
+	baumaulwurf.set_coarse_heuristic(true);
 	baumaulwurf.calc_route( starttiles, endtiles );
 
 	// build with terraforming if shorter and enough money is available
@@ -1398,8 +1404,9 @@ void ai_goods_t::rdwr(loadsave_t *file)
 		file->rdwr_str( s );
 	}
 	else {
-		// since steps in loaded game == 0
+		// steps in loaded game are 0 for old games, otherwise they are restored
 		file->rdwr_long(next_construction_steps);
+		next_construction_steps += welt->get_steps();
 		// reinit current pointers
 		koord3d k3d;
 		k3d.rdwr(file);
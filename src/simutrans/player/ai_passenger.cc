@@ -1432,7 +1432,7 @@ void ai_passenger_t::rdwr(loadsave_t *file)
 		k3d.rdwr(file);
 	}
 	else {
-		// since steps in loaded game == 0
+		// steps in loaded game are 0 for old games, otherwise they are restored
 		file->rdwr_long(next_construction_steps);
 		next_construction_steps += welt->get_steps();
 		// reinit current pointers
@@ -1453,6 +1453,15 @@ void ai_passenger_t::rdwr(loadsave_t *file)
 		file->rdwr_str(road_vehicle_name);
 		if (file->is_loading() && road_vehicle_name != "") {
 			road_vehicle = vehicle_builder_t::get_info(road_vehicle_name);
+			if (!road_vehicle) {
+				dbg->warning("ai_passenger_t::rdwr", "Road vehicle %s not found, searching for one...", road_vehicle_name.c_str());
+				road_vehicle = vehicle_search( road_wt, 50, 80, goods_manager_t::passengers, false);
+				if (road_vehicle == NULL) {
+					// reset state
+					end_stadt = NULL;
+					state = CHECK_CONVOI;
+				}
+			}
 		}
 	}
 }
@@ -1476,6 +1485,11 @@ void ai_passenger_t::report_vehicle_problem(convoihandle_t cnv,const koord3d zie
 
 void ai_passenger_t::finish_rd()
 {
+	// newer games save the vehicle, which is only chosen when a route is built, so none saved stays none
+	if (welt->load_version >= 122001) {
+		return;
+	}
+
 	if (!road_vehicle) {
 		dbg->warning("ai_passenger_t::finish_rd", "Default road vehicle could not be loaded, searching for one...");
 		road_vehicle = vehicle_search( road_wt, 50, 80, goods_manager_t::passengers, false);
@@ -126,6 +126,7 @@ void convoi_t::init(player_t *player)
 	steps_driven = -1;
 	withdraw = false;
 	has_obsolete = false;
+	month_pending = false;
 	no_load = false;
 	wait_lock = 0;
 	arrived_time = 0;
@@ -220,7 +221,8 @@ DBG_MESSAGE("convoi_t::~convoi_t()", "destroying %d, %p", self.get_id(), this);
 			destroy_win((ptrdiff_t)schedule);
 		}
 		if (!schedule->empty() && !line.is_bound()) {
-			welt->set_schedule_counter();
+			// only the stops of this convoi have changed
+			haltestelle_t::reconnect_changed();
 		}
 		delete schedule;
 	}
@@ -514,8 +516,10 @@ DBG_MESSAGE("convoi_t::finish_rd()","next_stop_index=%d", next_stop_index );
 		}
 	}
 	if(  state==LOADING  ) {
-		// the fully the shorter => register again as older convoi
-		wait_lock = max(0, 2000-loading_level*20);
+		if(  welt->load_version < 124007  ) {
+			// the fully the shorter => register again as older convoi
+			wait_lock = max(0, 2000-loading_level*20);
+		}
 		if (distance_since_last_stop > 0) {
 			calc_gewinn();
 		}
@@ -1190,6 +1194,7 @@ void convoi_t::suche_neue_route()
 void convoi_t::step()
 {
 	if(  wait_lock > 0  ) {
+		prepared_route.invalidate();
 		return;
 	}
 
@@ -1405,6 +1410,36 @@ void convoi_t::step()
 			break;
 		default: ;
 	}
+
+	// an unused search must not survive until the world may have changed
+	prepared_route.invalidate();
+}
+
+
+void convoi_t::prepare_step()
+{
+	prepared_route.invalidate();
+
+	if(  wait_lock > 0  ||  vehicle_count == 0  ||  line_update_pending.is_bound()  ) {
+		return;
+	}
+	if(  (state != ROUTING_1  &&  state != NO_ROUTE)  ||  schedule == NULL  ||  schedule->empty()  ) {
+		return;
+	}
+
+	vehicle_t *v = fahr[0];
+	if(  !v->can_prepare_route()  ) {
+		return;
+	}
+
+	// same start and target as drive_to() will use
+	const koord3d start = v->get_pos();
+	const koord3d ziel = schedule->get_current_entry().pos;
+	if(  start == ziel  ) {
+		// schedule will advance or target is moved inside the halt: leave this to step()
+		return;
+	}
+	route_t::prepare_route( welt, start, ziel, v, speed_to_kmh(min_top_speed), prepared_route );
 }
 
 
@@ -1414,12 +1449,10 @@ void convoi_t::new_year()
 }
 
 
-void convoi_t::new_month()
+void convoi_t::roll_statistics()
 {
-	// should not happen: leftover convoi without vehicles ...
 	if(vehicle_count==0) {
-		DBG_DEBUG("convoi_t::new_month()","no vehicles => self destruct!");
-		self_destruct();
+		// will self destruct in new_month()
 		return;
 	}
 	// update statistics of average speed
@@ -1434,6 +1467,18 @@ void convoi_t::new_month()
 		}
 		financial_history[0][j] = 0;
 	}
+}
+
+
+void convoi_t::new_month()
+{
+	month_pending = false;
+	// should not happen: leftover convoi without vehicles ...
+	if(vehicle_count==0) {
+		DBG_DEBUG("convoi_t::new_month()","no vehicles => self destruct!");
+		self_destruct();
+		return;
+	}
 	// remind every new month again
 	if(  state==NO_ROUTE  ) {
 		get_owner()->report_vehicle_problem( self, get_pos() );
@@ -1595,7 +1640,8 @@ void convoi_t::start()
 			line->recalc_catg_index();
 		}
 		else {
-			welt->set_schedule_counter();
+			haltestelle_t::mark_reconnect( schedule, owner );
+			haltestelle_t::reconnect_changed();
 		}
 		wait_lock = 0;
 
@@ -1888,7 +1934,7 @@ bool convoi_t::set_schedule(schedule_t * f)
 			// if line is unset or schedule is changed
 			// -> register stops from new schedule
 			register_stops();
-			welt->set_schedule_counter(); // must trigger refresh
+			haltestelle_t::reconnect_changed(); // must trigger refresh
 		}
 	}
 
@@ -2641,6 +2687,19 @@ void convoi_t::rdwr(loadsave_t *file)
 		file->rdwr_short( next_reservation_index );
 	}
 
+	if(  file->is_version_atleast(124, 6)  ) {
+		bool value = month_pending;
+		file->rdwr_bool(value);
+		month_pending = value;
+	}
+
+	if(  file->is_version_atleast(124, 7)  ) {
+		// the digits of the speed change below one, so the convoi accelerates the same after loading
+		uint16 delta_v = previous_delta_v;
+		file->rdwr_short(delta_v);
+		previous_delta_v = delta_v;
+	}
+
 	if(  file->is_loading()  ) {
 		reserve_route();
 		recalc_catg_index();
@@ -3194,6 +3253,14 @@ void convoi_t::calc_loading()
 }
 
 
+void convoi_t::reset_cached_data()
+{
+	calc_loading();
+	recalc_data_front = true;
+	recalc_speed_limit = true;
+}
+
+
 void convoi_t::calc_speedbonus_kmh()
 {
 	// init with default
@@ -3408,7 +3475,7 @@ void convoi_t::set_line(linehandle_t org_line)
 		unregister_stops();
 		// must trigger refresh if old schedule was not empty
 		if (schedule  &&  !schedule->empty()) {
-			welt->set_schedule_counter();
+			haltestelle_t::reconnect_changed();
 		}
 	}
 	line_update_pending = org_line;
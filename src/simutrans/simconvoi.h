@@ -112,8 +112,9 @@ private:
 	uint8 withdraw            : 1; ///< the convoi is being withdrawn from service
 	uint8 no_load             : 1; ///< nothing will be loaded onto this convoi
 	uint8 has_obsolete        : 1; ///< true, if at least one vehicle of a convoi is obsolete
+	uint8 month_pending       : 1; ///< roll_statistics() and new_month() still have to be called (see karte_t::step_month_spread())
 	bool  needs_electric      : 1; ///< true, if needs catenary
-	// 5 bits free
+	// 4 bits free
 
 	uint8 old_sort_mode;	///< the convoi caches its freight info; only recalculate after loading or resorting
 
@@ -262,6 +263,9 @@ private:
 	/// struct holds new financial history for convoi
 	sint64 financial_history[MAX_MONTHS][MAX_CONVOI_COST];
 
+	/// route searched by prepare_step(), only valid until the end of the next step()
+	prepared_route_t prepared_route;
+
 private:
 	/**
 	* Initialize all variables with default values.
@@ -542,6 +546,15 @@ public:
 	 */
 	void step();
 
+	/**
+	 * Does the parts of the next step() in advance, that only read the world
+	 * (currently the route search). Called for many convois in parallel,
+	 * so it must not change anything outside this convoi.
+	 */
+	void prepare_step();
+
+	prepared_route_t *get_prepared_route() { return prepared_route.is_valid() ? &prepared_route : NULL; }
+
 	/**
 	* sets a new convoi in route
 	*/
@@ -708,7 +721,12 @@ public:
 	sint64 get_stat_converted(int month, int cost_type) const;
 
 	/**
-	* only purpose currently is to roll financial history
+	* rolls the financial history, only changes this convoi so it may run for several convois in parallel
+	*/
+	void roll_statistics();
+
+	/**
+	* monthly checks and fixed costs, after roll_statistics()
 	*/
 	void new_month();
 
@@ -750,6 +768,10 @@ public:
 
 	bool has_obsolete_vehicles() const { return has_obsolete; }
 
+	bool is_month_pending() const { return month_pending; }
+
+	void set_month_pending() { month_pending = true; }
+
 	bool get_withdraw() const { return withdraw; }
 
 	void set_withdraw(bool new_withdraw);
@@ -762,6 +784,9 @@ public:
 	void must_recalc_data_front() { recalc_data_front = true; }
 	void must_recalc_speed_limit() { recalc_speed_limit = true; }
 
+	/// forgets the cached loading and driving data, like a loaded convoi has none
+	void reset_cached_data();
+
 	// calculates the speed used for the speedbonus base, and the max achievable speed at current power/weight for overtakers
 	void calc_speedbonus_kmh();
 	sint32 get_speedbonus_kmh() const;
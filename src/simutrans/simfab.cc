@@ -2654,13 +2654,30 @@ void fabrik_t::verteile_waren(const uint32 product)
 	// Auswertung der Ergebnisse
 	if(  !dist_list.empty()  ) {
 		distribute_ware_t *best = NULL;
-		for(distribute_ware_t & i : dist_list) {
-			// now search route
-			int const result = haltestelle_t::search_route(&i.halt, 1U, welt->get_settings().is_no_routing_over_overcrowding(), i.ware);
-			if(  result == haltestelle_t::ROUTE_OK  ||  result == haltestelle_t::ROUTE_WALK  ) {
-				// we can deliver to this destination
-				best = &i;
-				break;
+		// now search routes, one destination per thread at once; the first in the list with a route is taken
+		static vector_tpl<haltestelle_t::route_query_t> queries(16);
+		const uint32 batch = env_t::num_threads > 1 ? env_t::num_threads : 1;
+		for(  uint32 first = 0;  best == NULL  &&  first < dist_list.get_count();  first += batch  ) {
+			queries.clear();
+			for(  uint32 i = first;  i < dist_list.get_count()  &&  i < first + batch;  i++  ) {
+				haltestelle_t::route_query_t q;
+				q.start_halts = &dist_list[i].halt;
+				q.start_halt_count = 1;
+				q.no_routing_over_overcrowding = welt->get_settings().is_no_routing_over_overcrowding();
+				q.with_return_ware = false;
+				q.ware = dist_list[i].ware;
+				q.result = haltestelle_t::NO_ROUTE;
+				queries.append( q );
+			}
+			haltestelle_t::search_routes( queries );
+
+			for(  uint32 j = 0;  j < queries.get_count();  j++  ) {
+				if(  queries[j].result == haltestelle_t::ROUTE_OK  ||  queries[j].result == haltestelle_t::ROUTE_WALK  ) {
+					// we can deliver to this destination
+					best = &dist_list[first + j];
+					best->ware = queries[j].ware;
+					break;
+				}
 			}
 		}
 
@@ -2754,7 +2771,7 @@ void fabrik_t::verteile_waren(const uint32 product)
 }
 
 
-void fabrik_t::new_month()
+void fabrik_t::roll_statistics()
 {
 	// calculate weighted averages
 	if(  aggregate_weight > 0  ) {
@@ -2795,7 +2812,11 @@ void fabrik_t::new_month()
 	set_stat( prodfactor_pax, FAB_BOOST_PAX );
 	set_stat( prodfactor_mail, FAB_BOOST_MAIL );
 	set_stat( get_power(), FAB_POWER );
+}
+
 
+void fabrik_t::new_month()
+{
 	// since target cities' population may be increased -> re-apportion pax/mail demand
 	recalc_demands_at_target_cities();
 }
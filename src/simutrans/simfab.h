@@ -595,6 +595,14 @@ public:
 	sint32 get_jit2_power_boost() const;
 
 	void step(uint32 delta_t);                  // factory muss auch arbeiten
+
+	/**
+	 * First part of the monthly update: rolls the statistics.
+	 * Only this factory is changed, so it may run for several factories in parallel.
+	 */
+	void roll_statistics();
+
+	/// second part of the monthly update, after roll_statistics()
 	void new_month();
 
 	char const* get_name() const;
@@ -36,6 +36,7 @@
 
 #include "dataobj/settings.h"
 #include "dataobj/schedule.h"
+#include "dataobj/goods_storage.h"
 #include "dataobj/loadsave.h"
 #include "dataobj/translator.h"
 #include "dataobj/environment.h"
@@ -51,7 +52,8 @@
 #include "utils/simrandom.h"
 #include "utils/simstring.h"
 
-#include "tpl/binary_heap_tpl.h"
+#include "sys/simsys.h"
+
 
 #include "vehicle/vehicle.h"
 #include "vehicle/air_vehicle.h"
@@ -71,6 +73,14 @@ inthashtable_tpl<sint32,halthandle_t> *haltestelle_t::all_koords = NULL;
 
 uint8 haltestelle_t::status_step = 0;
 uint8 haltestelle_t::reconnect_counter = 0;
+vector_tpl<halthandle_t> haltestelle_t::dirty_halts;
+
+// the halts reconnected in the running reconnection, if not all halts are reconnected
+static vector_tpl<halthandle_t> reconnect_halts;
+static bool partial_reconnect = false;
+
+// next halt of the running reconnection or rerouting
+static uint32 next_halt_to_step = 0;
 
 
 static vector_tpl<convoihandle_t>stale_convois;
@@ -83,6 +93,74 @@ void haltestelle_t::reset_routing()
 }
 
 
+void haltestelle_t::restart_routing()
+{
+	stale_convois.clear();
+	stale_lines.clear();
+
+	status_step = 0;
+	next_halt_to_step = 0;
+	partial_reconnect = false;
+	reconnect_halts.clear();
+	for(halthandle_t halt : dirty_halts) {
+		if(  halt.is_bound()  ) {
+			halt->reconnect_pending = false;
+		}
+	}
+	dirty_halts.clear();
+
+	for(halthandle_t halt : alle_haltestellen) {
+		// convois request loading again in the order they step
+		halt->loading_here.clear();
+		halt->last_loading_step = -1;
+		for(  uint8 i=0;  i<goods_manager_t::get_max_catg_index();  i++  ) {
+			halt->halt_served_this_step[i].clear();
+		}
+	}
+
+	// no cached or resumed searches from before
+	invalidate_route_cache();
+	main_search.last_search_origin = halthandle_t();
+
+	reset_routing();
+	do {
+		step_all();
+	} while(  status_step == RECONNECTING  );
+}
+
+
+void haltestelle_t::reconnect_changed()
+{
+	// a complete reconnection pending => it stays pending
+	const bool complete_pending = reconnect_counter != welt->get_schedule_counter();
+	welt->set_schedule_counter();
+	if(  !complete_pending  ) {
+		reconnect_counter = welt->get_schedule_counter();
+	}
+}
+
+
+void haltestelle_t::mark_reconnect(const schedule_t *schedule, const player_t *owner)
+{
+	const bool water = schedule->get_waytype()==water_wt;
+	for(schedule_entry_t const& i : schedule->entries) {
+		halthandle_t const halt = get_halt(i.pos, owner, water);
+		if(  halt.is_bound()  ) {
+			halt->mark_reconnect();
+		}
+	}
+}
+
+
+void haltestelle_t::mark_reconnect()
+{
+	if(  !reconnect_pending  ) {
+		reconnect_pending = true;
+		dirty_halts.append(self);
+	}
+}
+
+
 void haltestelle_t::step_all()
 {
 	// tell all stale convois to reroute their goods
@@ -100,10 +178,12 @@ void haltestelle_t::step_all()
 		}
 	}
 
-	static uint32 next_halt_to_step=0;
 	if (alle_haltestellen.empty()) {
 		next_halt_to_step = 0;
 		status_step = 0;
+		partial_reconnect = false;
+		reconnect_halts.clear();
+		dirty_halts.clear();
 		return;
 	}
 
@@ -122,6 +202,24 @@ void haltestelle_t::step_all()
 			// start with reconnection, re-routing will happen after complete reconnection
 			status_step = RECONNECTING;
 			reconnect_counter = schedule_counter;
+			// all halts will be reconnected anyway
+			for(halthandle_t halt : dirty_halts) {
+				if(  halt.is_bound()  ) {
+					halt->reconnect_pending = false;
+				}
+			}
+			dirty_halts.clear();
+		}
+		else if (!dirty_halts.empty()) {
+			// only some schedules changed => reconnect only the halts served by them
+			status_step = RECONNECTING;
+			partial_reconnect = true;
+			swap( reconnect_halts, dirty_halts );
+			for(halthandle_t halt : reconnect_halts) {
+				if(  halt.is_bound()  ) {
+					halt->reconnect_pending = false;
+				}
+			}
 		}
 		else {
 			// nothing to step if there is no rerouting/reconnection
@@ -130,17 +228,22 @@ void haltestelle_t::step_all()
 	}
 
 	// we iterate in charges
+	const vector_tpl<halthandle_t> &halts = partial_reconnect ? reconnect_halts : alle_haltestellen;
 	sint16 units_remaining = 1024;
-	while (units_remaining > 0  &&  next_halt_to_step < alle_haltestellen.get_count()) {
-		halthandle_t halt = alle_haltestellen[next_halt_to_step++];
-		halt->step(status_step, units_remaining);
+	while (units_remaining > 0  &&  next_halt_to_step < halts.get_count()) {
+		halthandle_t halt = halts[next_halt_to_step++];
+		if(  halt.is_bound()  ) {
+			halt->step(status_step, units_remaining);
+		}
 	}
 
 	// finished iteration, so we can proceed to next step
-	if(next_halt_to_step >= alle_haltestellen.get_count()) {
+	if(next_halt_to_step >= halts.get_count()) {
 		next_halt_to_step = 0;
 
 		if(  status_step == RECONNECTING  ) {
+			partial_reconnect = false;
+			reconnect_halts.clear();
 			// reconnecting finished, compute connected components in one sweep
 			rebuild_connected_components();
 			// reroute in next call
@@ -476,6 +579,9 @@ void haltestelle_t::destroy(halthandle_t const halt, player_t* pl)
 }
 
 
+// working memory of the threads in haltestelle_t::search_routes(), freed by destroy_all()
+static haltestelle_t::route_search_t *thread_route_search[MAX_THREADS] = { NULL };
+
 
 /**
  * Station destruction method.
@@ -491,6 +597,14 @@ void haltestelle_t::destroy_all()
 	delete all_koords;
 	all_koords = NULL;
 	status_step = 0;
+	next_halt_to_step = 0;
+	partial_reconnect = false;
+	reconnect_halts.clear();
+	dirty_halts.clear();
+	for(  int i=0;  i<MAX_THREADS;  i++  ) {
+		delete thread_route_search[i];
+		thread_route_search[i] = NULL;
+	}
 }
 
 
@@ -498,7 +612,7 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 {
 	last_loading_step = welt->get_steps();
 
-	cargo = (vector_tpl<ware_t> **)calloc( goods_manager_t::get_max_catg_index(), sizeof(vector_tpl<ware_t> *) );
+	cargo = (goods_storage_t **)calloc( goods_manager_t::get_max_catg_index(), sizeof(goods_storage_t *) );
 	all_links = new link_t[ goods_manager_t::get_max_catg_index() ];
 	halt_served_this_step = new vector_tpl<halthandle_t>[goods_manager_t::get_max_catg_index()];
 
@@ -508,6 +622,8 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 	last_permissions = 0;
 
 	reconnect_counter = welt->get_schedule_counter()-1;
+	reconnect_pending = false;
+	month_pending = false;
 
 	enables = NOT_ENABLED;
 
@@ -516,7 +632,7 @@ haltestelle_t::haltestelle_t(loadsave_t* file)
 
 	rdwr(file);
 
-	markers[ self.get_id() ] = current_marker;
+	main_search.markers[ self.get_id() ] = main_search.current_marker;
 
 	alle_haltestellen.append(self);
 }
@@ -528,7 +644,7 @@ haltestelle_t::haltestelle_t(koord k, player_t* )
 	assert( !alle_haltestellen.is_contained(self) );
 	alle_haltestellen.append(self);
 
-	markers[ self.get_id() ] = current_marker;
+	main_search.markers[ self.get_id() ] = main_search.current_marker;
 
 	last_loading_step = welt->get_steps();
 
@@ -538,9 +654,11 @@ haltestelle_t::haltestelle_t(koord k, player_t* )
 	enables = NOT_ENABLED;
 	// force total re-routing
 	reconnect_counter = welt->get_schedule_counter()-1;
+	reconnect_pending = false;
+	month_pending = false;
 	last_catg_index = 255;
 
-	cargo = (vector_tpl<ware_t> **)calloc( goods_manager_t::get_max_catg_index(), sizeof(vector_tpl<ware_t> *) );
+	cargo = (goods_storage_t **)calloc( goods_manager_t::get_max_catg_index(), sizeof(goods_storage_t *) );
 	all_links = new link_t[ goods_manager_t::get_max_catg_index() ];
 	halt_served_this_step = new vector_tpl<halthandle_t>[goods_manager_t::get_max_catg_index()];
 
@@ -566,6 +684,10 @@ haltestelle_t::~haltestelle_t()
 	if (i != 1) {
 		dbg->error("haltestelle_t::~haltestelle_t()", "handle %i found %i times in haltlist!", self.get_id(), i );
 	}
+	if(  reconnect_pending  ) {
+		dirty_halts.remove(self);
+	}
+	invalidate_route_cache();
 
 	// free name
 	set_name(NULL);
@@ -629,15 +751,12 @@ void haltestelle_t::rotate90( const sint16 y_size )
 	// iterate over all different categories
 	for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
 		if(cargo[i]) {
-			vector_tpl<ware_t>& warray = *cargo[i];
-			for (size_t j = warray.get_count(); j-- != 0;) {
-				ware_t& ware = warray[j];
-				if(ware.amount>0) {
+			goods_storage_t &store = *cargo[i];
+			for(  uint32 j=0;  j<store.get_count();  j++  ) {
+				if(store[j].amount>0) {
+					ware_t ware = store[j];
 					ware.rotate90(y_size);
-				}
-				else {
-					// empty => remove
-					warray.remove_at(j);
+					store.set(j, ware);
 				}
 			}
 		}
@@ -1137,13 +1256,18 @@ bool haltestelle_t::step(uint8 what, sint16 &units_remaining)
  */
 void haltestelle_t::new_month()
 {
+	month_pending = false;
 	if(  ((1<<welt->get_active_player_nr())&owners)  &&  status_color==gfx->palette_lookup(COL_RED)  ) {
 		cbuffer_t buf;
 		buf.printf( translator::translate("%s\nis crowded."), get_name() );
 		welt->get_message()->add_message(buf, get_basis_pos3d(),message_t::full|message_t::EXPIRE_AFTER_ONE_MONTH_MSG, PLAYER_FLAG|welt->get_active_player_nr(), IMG_EMPTY );
 		enables &= (PAX|POST|WARE);
 	}
+}
+
 
+void haltestelle_t::roll_statistics()
+{
 	// roll financial history
 	for (int j = 0; j<MAX_HALT_COST; j++) {
 		for (int k = MAX_MONTHS-1; k>0; k--) {
@@ -1172,11 +1296,11 @@ void haltestelle_t::reroute_goods(sint16 &units_remaining)
 		if(cargo[last_catg_index]) {
 
 			// first: clean out the array
-			vector_tpl<ware_t> * warray = cargo[last_catg_index];
-			vector_tpl<ware_t> * new_warray = new vector_tpl<ware_t>(warray->get_count());
+			goods_storage_t * store = cargo[last_catg_index];
+			goods_storage_t * new_store = new goods_storage_t();
 
-			for (size_t j = warray->get_count(); j-- != 0;) {
-				ware_t & ware = (*warray)[j];
+			for (size_t j = store->get_count(); j-- != 0;) {
+				const ware_t & ware = (*store)[j];
 
 				if(ware.amount==0) {
 					continue;
@@ -1192,40 +1316,38 @@ void haltestelle_t::reroute_goods(sint16 &units_remaining)
 				}
 
 				// add to new array
-				new_warray->append( ware );
+				new_store->add( ware );
 			}
 
 			// delete, if nothing connects here
-			if(  new_warray->empty()  ) {
+			if(  new_store->empty()  ) {
 				if(  all_links[last_catg_index].connections.empty()  ) {
 					// no connections from here => delete
-					delete new_warray;
-					new_warray = NULL;
+					delete new_store;
+					new_store = NULL;
 				}
 			}
 
 			// replace the array
 			delete cargo[last_catg_index];
-			cargo[last_catg_index] = new_warray;
+			cargo[last_catg_index] = new_store;
 
 			// if something left
 			// re-route goods to adapt to changes in world layout,
 			// remove all goods whose destination was removed from the map
 			if (cargo[last_catg_index] && !cargo[last_catg_index]->empty()) {
 
-				vector_tpl<ware_t> &warray = *cargo[last_catg_index];
-				uint32 last_goods_index = 0;
-				units_remaining -= warray.get_count();
-				while(  last_goods_index<warray.get_count()  ) {
-					search_route_resumable(warray[last_goods_index]);
-					if(  warray[last_goods_index].get_target_halt()==halthandle_t()  ) {
+				goods_storage_t &new_cargo = *cargo[last_catg_index];
+				units_remaining -= new_cargo.get_count();
+				for(  uint32 j=0;  j<new_cargo.get_count();  j++  ) {
+					ware_t ware = new_cargo[j];
+					search_route_resumable(ware);
+					if(  ware.get_target_halt()==halthandle_t()  ) {
 						// remove invalid destinations
-						fabrik_t::update_transit( &warray[last_goods_index], false);
-						warray.remove_at(last_goods_index);
-					}
-					else {
-						++last_goods_index;
+						fabrik_t::update_transit( &ware, false);
+						ware.amount = 0;
 					}
+					new_cargo.set(j, ware);
 				}
 			}
 		}
@@ -1311,6 +1433,7 @@ sint32 haltestelle_t::rebuild_connections()
 		all_links[i].clear();
 		consecutive_halts[i].clear();
 	}
+	invalidate_route_cache();
 	old_sort_mode = 255; // might result in error in routing
 
 	last_catg_index = 255; // must reroute everything
@@ -1594,7 +1717,13 @@ void haltestelle_t::fill_connected_component(uint8 catg_idx, uint16 comp)
 
 void haltestelle_t::rebuild_connected_components()
 {
+	invalidate_route_cache();
 	for(uint8 catg_idx = 0; catg_idx<goods_manager_t::get_max_catg_index(); catg_idx++) {
+		// even after a partial reconnection all halts are swept again: a changed link can split or join
+		// components, and the ids must be the same as after a complete reconnection (e.g. on a joining client)
+		for(halthandle_t halt : alle_haltestellen) {
+			halt->all_links[catg_idx].catg_connected_component = UNDECIDED_CONNECTED_COMPONENT;
+		}
 		for(halthandle_t halt : alle_haltestellen) {
 			if (halt->all_links[catg_idx].catg_connected_component == UNDECIDED_CONNECTED_COMPONENT) {
 				// start recursion
@@ -1627,111 +1756,184 @@ sint8 haltestelle_t::is_connected(halthandle_t halt, uint8 catg_index) const
 
 
 /**
- * Helper class that combines a vector_tpl
- * with WEIGHT_HEAP elements and a binary_heap_tpl.
- * If inserted node has weight less than WEIGHT_HEAP,
- * then node is inserted in one of the vectors.
- * If weight is larger, then node goes into the heap.
- *
- * WEIGHT_HEAP = 200 should be safe for even the largest games.
+ * Data for route searching
  */
-template<class T> class bucket_heap_tpl
+haltestelle_t::route_search_t haltestelle_t::main_search;
+
+uint32 haltestelle_t::route_generation = 1;
+
+// see haltestelle_t::record_routes()
+static FILE *route_record_file = NULL;
+
+
+haltestelle_t::route_search_t::route_search_t() :
+	current_marker(0),
+	last_search_ware_catg_idx(255),
+	allocation_pointer(0),
+	end_halts(16),
+	end_conn_comp(16),
+	dest_indices(16),
+	route_cache(NULL)
 {
-#define WEIGHT_HEAP (200)
-	vector_tpl<T> *buckets;  ///< array of vectors
-	binary_heap_tpl<T> heap; ///< the heap
+	MEMZERO(markers);
+}
 
-	uint16 min_weight; ///< current min_weight of nodes in the buckets
-	uint32 node_count; ///< total count of nodes
-public:
-	bucket_heap_tpl() : heap(128)
-	{
-		min_weight = WEIGHT_HEAP;
-		node_count = 0;
-		buckets = new vector_tpl<T> [WEIGHT_HEAP];
-	}
 
-	~bucket_heap_tpl()
-	{
-		delete [] buckets;
+haltestelle_t::route_search_t::~route_search_t()
+{
+	delete [] route_cache;
+}
+
+
+uint8 haltestelle_t::route_search_t::next_marker()
+{
+	++current_marker;
+	if(  current_marker==0  ) {
+		MEMZERON(markers, halthandle_t::get_size());
+		current_marker = 1u;
 	}
+	return current_marker;
+}
 
-	void insert(const T item)
-	{
-		node_count++;
-		uint16 weight = *item;
 
-		if (weight < WEIGHT_HEAP) {
-			if (weight < min_weight) {
-				min_weight = weight;
-			}
-			buckets[weight].append(item);
-		}
-		else {
-			heap.insert(item);
-		}
+// runs search_route() for the queries first ... last-1, with the working memory of the thread
+static void search_routes_loop(void *data, int thread_num, uint32 first, uint32 last)
+{
+	if(  thread_route_search[thread_num] == NULL  ) {
+		thread_route_search[thread_num] = new haltestelle_t::route_search_t();
 	}
+	haltestelle_t::route_search_t &search = *thread_route_search[thread_num];
 
-	T pop()
-	{
-		assert(!empty());
-		node_count--;
+	vector_tpl<haltestelle_t::route_query_t> &queries = *(vector_tpl<haltestelle_t::route_query_t> *)data;
+	for(  uint32 i = first;  i < last;  i++  ) {
+		haltestelle_t::route_query_t &q = queries[i];
+		q.result = haltestelle_t::search_route( search, q.start_halts, q.start_halt_count, q.no_routing_over_overcrowding, q.ware, q.with_return_ware ? &q.return_ware : NULL );
+	}
+}
 
-		if (min_weight < WEIGHT_HEAP) {
-			T ret = buckets[min_weight].pop_back();
 
-			while(min_weight < WEIGHT_HEAP  &&  buckets[min_weight].empty()) {
-				min_weight++;
-			}
-			return ret;
-		}
-		else {
-			return heap.pop();
-		}
+void haltestelle_t::search_routes( vector_tpl<route_query_t> &queries )
+{
+	if(  !queries.empty()  ) {
+		welt->world_index_loop( search_routes_loop, &queries, queries.get_count() );
 	}
+}
 
-	void clear()
-	{
-		for(uint16 i=min_weight; i<WEIGHT_HEAP; i++) {
-			buckets[i].clear();
-		}
-		min_weight = WEIGHT_HEAP;
-		node_count = 0;
 
-		heap.clear();
+bool haltestelle_t::record_routes( const char *filename )
+{
+	if(  route_record_file  ) {
+		fclose( route_record_file );
+		route_record_file = NULL;
+	}
+	if(  filename  ) {
+		route_record_file = dr_fopen( filename, "a" );
+		if(  route_record_file == NULL  ) {
+			dbg->error( "haltestelle_t::record_routes()", "Cannot open \"%s\"", filename );
+			return false;
+		}
 	}
+	return true;
+}
 
-	uint32 get_count() const
-	{
-		return node_count;
+
+bool haltestelle_t::benchmark_routes( const char *filename )
+{
+	FILE *file = dr_fopen( filename, "r" );
+	if(  file == NULL  ) {
+		dbg->error( "haltestelle_t::benchmark_routes()", "Cannot open \"%s\"", filename );
+		return false;
 	}
 
-	const T& front()
-	{
-		assert(!empty());
-		if (min_weight < WEIGHT_HEAP) {
-			return buckets[min_weight].back();
+	// read all queries which are valid in the current game
+	vector_tpl<route_query_t> queries;
+	vector_tpl<halthandle_t> start_halts;
+	vector_tpl<uint32> first_start_halt;
+	uint32 skipped = 0;
+	unsigned goods_index, with_return, count;
+	int x, y;
+	while(  fscanf( file, "%u %i %i %u %u", &goods_index, &x, &y, &with_return, &count ) == 5  ) {
+		bool valid = goods_index < goods_manager_t::get_count()  &&  welt->is_within_limits( koord(x, y) )  &&  count > 0  &&  count < 256;
+		const uint32 first = start_halts.get_count();
+		for(  unsigned i=0;  i<count;  i++  ) {
+			unsigned id;
+			if(  fscanf( file, "%u", &id ) != 1  ) {
+				valid = false;
+				break;
+			}
+			halthandle_t halt;
+			if(  id < halthandle_t::get_size()  ) {
+				halt.set_id( id );
+			}
+			valid &= halt.is_bound();
+			start_halts.append( halt );
+		}
+		if(  !valid  ) {
+			while(  start_halts.get_count() > first  ) {
+				start_halts.pop_back();
+			}
+			skipped ++;
+			continue;
+		}
+		route_query_t q;
+		q.start_halt_count = count;
+		q.no_routing_over_overcrowding = welt->get_settings().is_no_routing_over_overcrowding();
+		q.with_return_ware = with_return != 0;
+		q.ware = ware_t( goods_manager_t::get_info( goods_index ) );
+		q.ware.set_target_pos( koord(x, y) );
+		q.result = NO_ROUTE;
+		queries.append( q );
+		first_start_halt.append( first );
+	}
+	fclose( file );
+	for(  uint32 i=0;  i<queries.get_count();  i++  ) {
+		queries[i].start_halts = &start_halts[ first_start_halt[i] ];
+	}
+	dbg->message( "haltestelle_t::benchmark_routes()", "%u queries, %u skipped (not valid in this game)", queries.get_count(), skipped );
+
+	// run them: without cache, with empty cache, a second time with filled cache and finally on all threads
+	const bool old_halt_route_cache = env_t::halt_route_cache;
+	const char *pass_name[4] = { "without cache", "empty cache", "filled cache", "all threads" };
+	vector_tpl<route_query_t> reference;
+	uint32 differences = 0;
+	for(  int pass=0;  pass<4;  pass++  ) {
+		env_t::halt_route_cache = pass > 0;
+		if(  pass == 1  ) {
+			invalidate_route_cache();
+		}
+		vector_tpl<route_query_t> results( queries );
+		const uint32 start = dr_time();
+		if(  pass == 3  ) {
+			search_routes( results );
 		}
 		else {
-			return heap.front();
+			for(route_query_t &q : results) {
+				q.result = search_route( q.start_halts, q.start_halt_count, q.no_routing_over_overcrowding, q.ware, q.with_return_ware ? &q.return_ware : NULL );
+			}
+		}
+		const uint32 ms = dr_time() - start;
+
+		uint32 pass_differences = 0;
+		if(  pass == 0  ) {
+			swap( reference, results );
+		}
+		else {
+			for(  uint32 i=0;  i<results.get_count();  i++  ) {
+				const route_query_t &a = reference[i], &b = results[i];
+				if(  a.result != b.result  ||  a.ware.get_target_halt() != b.ware.get_target_halt()  ||  a.ware.get_via_halt() != b.ware.get_via_halt()
+					||  (a.with_return_ware  &&  (a.return_ware.get_target_halt() != b.return_ware.get_target_halt()  ||  a.return_ware.get_via_halt() != b.return_ware.get_via_halt()))  ) {
+					pass_differences ++;
+				}
+			}
 		}
+		differences += pass_differences;
+		dbg->message( "haltestelle_t::benchmark_routes()", "%s: %u ms (%.2f us per query), %u different results", pass_name[pass], ms, queries.empty() ? 0.0 : (1000.0*ms)/queries.get_count(), pass_differences );
 	}
+	env_t::halt_route_cache = old_halt_route_cache;
 
-	bool empty() const { return node_count == 0; }
-};
+	return differences == 0;
+}
 
-/**
- * Data for route searching
- */
-haltestelle_t::halt_data_t haltestelle_t::halt_data[65536];
-bucket_heap_tpl<haltestelle_t::route_node_t> haltestelle_t::open_list;
-uint8 haltestelle_t::markers[65536];
-uint8 haltestelle_t::current_marker = 0;
-/**
- * Data for resumable route search
- */
-halthandle_t haltestelle_t::last_search_origin;
-uint8 haltestelle_t::last_search_ware_catg_idx = 255;
 /**
  * This routine tries to find a route for a good packet (ware)
  * it will be called for
@@ -1755,20 +1957,115 @@ uint8 haltestelle_t::last_search_ware_catg_idx = 255;
  * @param return_ware
  * @param[out] ware
  */
-int haltestelle_t::search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware )
+int haltestelle_t::search_route( route_search_t &search, const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware )
+{
+	if(  route_record_file  &&  &search == &main_search  ) {
+		fprintf( route_record_file, "%u %i %i %i %u", ware.get_desc()->get_index(), ware.get_target_pos().x, ware.get_target_pos().y, return_ware!=NULL, start_halt_count );
+		for(  uint16 s=0;  s<start_halt_count;  ++s  ) {
+			fprintf( route_record_file, " %u", start_halts[s].get_id() );
+		}
+		fprintf( route_record_file, "\n" );
+	}
+
+	typedef route_search_t::cached_route_t cached_route_t;
+
+	const planquadrat_t *const plan = welt->access( ware.get_target_pos() );
+	const uint8 end_count = plan->get_haltlist_count();
+
+	// with overcrowding the result changes with every waiting packet, so it is not worth caching
+	if(  !env_t::halt_route_cache  ||  no_routing_over_overcrowding  ||  start_halt_count > cached_route_t::max_halts  ||  end_count > cached_route_t::max_halts  ) {
+		return search_route_intern( search, start_halts, start_halt_count, no_routing_over_overcrowding, ware, return_ware );
+	}
+
+	// the result only depends on start halts, halts at the target position and the connections between them
+	const uint8 catg_idx = ware.get_desc()->get_catg_index();
+	const halthandle_t *const halt_list = plan->get_haltlist();
+	const uint16 max_transfers = welt->get_settings().get_max_transfers();
+	const uint16 max_hops      = welt->get_settings().get_max_hops();
+
+	uint32 hash = catg_idx;
+	for(  uint16 s=0;  s<start_halt_count;  ++s  ) {
+		hash = hash*31 + start_halts[s].get_id();
+	}
+	for(  uint8 h=0;  h<end_count;  ++h  ) {
+		hash = hash*37 + halt_list[h].get_id();
+	}
+
+	if(  search.route_cache == NULL  ) {
+		search.route_cache = new cached_route_t[ route_search_t::route_cache_size ];
+		for(  uint32 i=0;  i<route_search_t::route_cache_size;  i++  ) {
+			search.route_cache[i].generation = 0;
+		}
+	}
+	cached_route_t &cached = search.route_cache[ (hash ^ (hash >> 16)) & (route_search_t::route_cache_size-1) ];
+
+	bool found = cached.generation == route_generation  &&  cached.catg_idx == catg_idx
+		&&  cached.start_count == start_halt_count  &&  cached.end_count == end_count
+		&&  cached.max_transfers == max_transfers  &&  cached.max_hops == max_hops;
+	for(  uint16 s=0;  found  &&  s<start_halt_count;  ++s  ) {
+		found = cached.halt_ids[s] == start_halts[s].get_id();
+	}
+	for(  uint8 h=0;  found  &&  h<end_count;  ++h  ) {
+		found = cached.halt_ids[start_halt_count+h] == halt_list[h].get_id();
+	}
+
+	if(  found  ) {
+		// like search_route_intern(), the search history is invalid afterwards
+		search.last_search_origin = halthandle_t();
+		ware.set_target_halt( cached.target_halt );
+		ware.set_via_halt( cached.via_halt );
+		if(  return_ware  ) {
+			return_ware->set_target_halt( cached.return_target_halt );
+			return_ware->set_via_halt( cached.return_via_halt );
+		}
+		return cached.result;
+	}
+
+	// search with return route in any case, so the result can be reused for all queries
+	ware_t dummy_return;
+	ware_t *const ret = return_ware ? return_ware : &dummy_return;
+	const int result = search_route_intern( search, start_halts, start_halt_count, false, ware, ret );
+
+	cached.generation = route_generation;
+	cached.max_transfers = max_transfers;
+	cached.max_hops = max_hops;
+	cached.catg_idx = catg_idx;
+	cached.start_count = start_halt_count;
+	cached.end_count = end_count;
+	cached.result = result;
+	for(  uint16 s=0;  s<start_halt_count;  ++s  ) {
+		cached.halt_ids[s] = start_halts[s].get_id();
+	}
+	for(  uint8 h=0;  h<end_count;  ++h  ) {
+		cached.halt_ids[start_halt_count+h] = halt_list[h].get_id();
+	}
+	cached.target_halt = ware.get_target_halt();
+	cached.via_halt = ware.get_via_halt();
+	cached.return_target_halt = ret->get_target_halt();
+	cached.return_via_halt = ret->get_via_halt();
+
+	return result;
+}
+
+
+int haltestelle_t::search_route_intern( route_search_t &search, const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware )
 {
 	const uint8 ware_catg_idx = ware.get_desc()->get_catg_index();
 	const uint8 ware_idx = ware.get_desc()->get_index();
 
+	halt_data_t *const halt_data = search.halt_data;
+	uint8 *const markers = search.markers;
+	bucket_heap_tpl<route_node_t> &open_list = search.open_list;
+
 	// since also the factory halt list is added to the ground, we can use just this ...
 	const planquadrat_t *const plan = welt->access( ware.get_target_pos() );
 	const halthandle_t *const halt_list = plan->get_haltlist();
 	// but we can only use a subset of these
-	static vector_tpl<halthandle_t> end_halts(16);
+	vector_tpl<halthandle_t> &end_halts = search.end_halts;
 	end_halts.clear();
 	// target halts are in these connected components
 	// we start from halts only in the same components
-	static vector_tpl<uint16> end_conn_comp(16);
+	vector_tpl<uint16> &end_conn_comp = search.end_conn_comp;
 	end_conn_comp.clear();
 	// if one target halt is undefined, we have to start search from all halts
 	bool end_conn_comp_undefined = false;
@@ -1817,14 +2114,10 @@ int haltestelle_t::search_route( const halthandle_t *const start_halts, const ui
 		return NO_ROUTE;
 	}
 	// invalidate search history
-	last_search_origin = halthandle_t();
+	search.last_search_origin = halthandle_t();
 
 	// set current marker
-	++current_marker;
-	if(  current_marker==0  ) {
-		MEMZERON(markers, halthandle_t::get_size());
-		current_marker = 1u;
-	}
+	const uint8 current_marker = search.next_marker();
 
 	// initialisations for end halts => save some checking inside search loop
 	for(halthandle_t const e : end_halts) {
@@ -2025,23 +2318,25 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 {
 	const uint8 ware_catg_idx = ware.get_desc()->get_catg_index();
 
+	route_search_t &search = main_search;
+	halt_data_t *const halt_data = search.halt_data;
+	uint8 *const markers = search.markers;
+	bucket_heap_tpl<route_node_t> &open_list = search.open_list;
+
 	// continue search if start halt and good category did not change
-	const bool resume_search = last_search_origin == self  &&  ware_catg_idx == last_search_ware_catg_idx;
+	const bool resume_search = search.last_search_origin == self  &&  ware_catg_idx == search.last_search_ware_catg_idx;
 
 	if (!resume_search) {
-		last_search_origin = self;
-		last_search_ware_catg_idx = ware_catg_idx;
+		search.last_search_origin = self;
+		search.last_search_ware_catg_idx = ware_catg_idx;
 		open_list.clear();
 		// set current marker
-		++current_marker;
-		if(  current_marker==0  ) {
-			MEMZERON(markers, halthandle_t::get_size());
-			current_marker = 1u;
-		}
+		search.next_marker();
 	}
+	const uint8 current_marker = search.current_marker;
 
 	// remember destination nodes, to reset them before returning
-	static vector_tpl<uint16> dest_indices(16);
+	vector_tpl<uint16> &dest_indices = search.dest_indices;
 	dest_indices.clear();
 
 	uint16 best_destination_weight = 65535u;
@@ -2119,7 +2414,7 @@ void haltestelle_t::search_route_resumable(  ware_t &ware   )
 	uint16 const max_transfers = welt->get_settings().get_max_transfers();
 	uint16 const max_hops      = welt->get_settings().get_max_hops();
 
-	static uint16 allocation_pointer;
+	uint16 &allocation_pointer = search.allocation_pointer;
 	if (!resume_search) {
 		// initialise the origin node
 		allocation_pointer = 1u;
@@ -2296,9 +2591,10 @@ void haltestelle_t::liefere_an_fabrik(const ware_t& ware) const
 bool haltestelle_t::recall_ware( ware_t& w, uint32 menge )
 {
 	w.amount = 0;
-	vector_tpl<ware_t> *warray = cargo[w.get_desc()->get_catg_index()];
-	if(warray!=NULL) {
-		for(ware_t & tmp : *warray) {
+	goods_storage_t *store = cargo[w.get_desc()->get_catg_index()];
+	if(store!=NULL) {
+		for(  uint32 slot=0;  slot<store->get_count();  slot++  ) {
+			const ware_t &tmp = (*store)[slot];
 			// skip empty entries
 			if(tmp.amount==0  ||  w.get_index()!=tmp.get_index()  ||  w.get_target_pos()!=tmp.get_target_pos()) {
 				continue;
@@ -2307,13 +2603,12 @@ bool haltestelle_t::recall_ware( ware_t& w, uint32 menge )
 			// not too much?
 			if(tmp.amount > menge) {
 				// not all can be loaded
-				tmp.amount -= menge;
 				w.amount = menge;
+				store->set_amount(slot, tmp.amount - menge);
 			}
 			else {
-				// leave an empty entry => joining will more often work
 				w.amount = tmp.amount;
-				tmp.amount = 0;
+				store->set_amount(slot, 0);
 			}
 			book(w.amount, HALT_ARRIVED);
 			fabrik_t::update_transit( &w, false );
@@ -2332,73 +2627,82 @@ void haltestelle_t::fetch_goods( slist_tpl<ware_t> &load, const goods_desc_t *go
 	// first iterate over the next stop, then over the ware
 	// might be a little slower, but ensures that passengers to nearest stop are served first
 	// this allows for separate high speed and normal service
-	vector_tpl<ware_t> *warray = cargo[good_category->get_catg_index()];
+	goods_storage_t *store = cargo[good_category->get_catg_index()];
+
+	if(  store  &&  !store->empty()  ) {
+		vector_tpl<uint32> buf;
+
+		// goods without route -> returning passengers/mail
+		vector_tpl<uint32> unrouted( store->get_slots_via( halthandle_t(), buf ) );
+		for(uint32 const slot : unrouted) {
+			ware_t tmp = (*store)[slot];
+			search_route_resumable(tmp);
+			if (!tmp.get_target_halt().is_bound()) {
+				// no route anymore
+				tmp.amount = 0;
+			}
+			store->set(slot, tmp);
+		}
+
+		// emptied packets are only freed after the loop over their next stop
+		vector_tpl<uint32> emptied;
 
-	if(  warray  &&  !warray->empty()  ) {
 		for(  uint32 i=0; i < destination_halts.get_count();  i++  ) {
 			halthandle_t plan_halt = destination_halts[i];
 
 			// mark this stop as served, even if I do not load to avoid stealing transfer freight by later processed convois
 			halt_served_this_step[good_category->get_catg_index()].append_unique(plan_halt);
 
+			const vector_tpl<uint32> &slots = store->get_slots_via( plan_halt, buf );
+			if(  slots.empty()  ) {
+				// nothing there to load
+				continue;
+			}
+
 			// The random offset will ensure that all goods have an equal chance to be loaded.
-			uint32 offset = simrand(warray->get_count());
-			for(  uint32 i=0;  i<warray->get_count();  i++  ) {
-				ware_t &tmp = (*warray)[ i+offset ];
+			uint32 offset = simrand(slots.get_count());
+			for(  uint32 i=0;  i<slots.get_count()  &&  requested_amount>0;  i++  ) {
+				const uint32 slot = slots[ i+offset ];
 
 				// prevent overflow (faster than division)
-				if(  i+offset+1>=warray->get_count()  ) {
-					offset -= warray->get_count();
-				}
-
-				// skip empty entries
-				if(tmp.amount==0) {
-					continue;
+				if(  i+offset+1>=slots.get_count()  ) {
+					offset -= slots.get_count();
 				}
 
-				// goods without route -> returning passengers/mail
-				if(  !tmp.get_via_halt().is_bound()  ) {
-					search_route_resumable(tmp);
-					if (!tmp.get_target_halt().is_bound()) {
-						// no route anymore
-						tmp.amount = 0;
+				const ware_t &tmp = (*store)[slot];
+				if(  plan_halt->is_overcrowded( tmp.get_index() )  ) {
+					if (welt->get_settings().is_avoid_overcrowding() && tmp.get_target_halt() != plan_halt) {
+						// do not go for transfer to overcrowded transfer stop
 						continue;
 					}
 				}
 
-				// compatible car and right target stop?
-				if(  tmp.get_via_halt()==plan_halt  ) {
-					if(  plan_halt->is_overcrowded( tmp.get_index() )  ) {
-						if (welt->get_settings().is_avoid_overcrowding() && tmp.get_target_halt() != plan_halt) {
-							// do not go for transfer to overcrowded transfer stop
-							continue;
-						}
-					}
+				// not too much?
+				ware_t neu(tmp);
+				if(  tmp.amount > requested_amount  ) {
+					// not all can be loaded
+					neu.amount = requested_amount;
+					store->set_amount( slot, tmp.amount - requested_amount );
+					requested_amount = 0;
+				}
+				else {
+					requested_amount -= tmp.amount;
+					emptied.append( slot );
+				}
+				load.insert(neu);
 
-					// not too much?
-					ware_t neu(tmp);
-					if(  tmp.amount > requested_amount  ) {
-						// not all can be loaded
-						neu.amount = requested_amount;
-						tmp.amount -= requested_amount;
-						requested_amount = 0;
-					}
-					else {
-						requested_amount -= tmp.amount;
-						// leave an empty entry => joining will more often work
-						tmp.amount = 0;
-					}
-					load.insert(neu);
+				book(neu.amount, HALT_DEPARTED);
+				old_sort_mode = 255;
+			}
 
-					book(neu.amount, HALT_DEPARTED);
-					old_sort_mode = 255;
+			for(uint32 const slot : emptied) {
+				store->set_amount( slot, 0 );
+			}
+			emptied.clear();
 
-					if (requested_amount==0) {
-						return;
-					}
-				}
+			if (requested_amount==0) {
+				return;
 			}
-			// nothing there to load
 		}
 	}
 }
@@ -2408,9 +2712,9 @@ void haltestelle_t::fetch_goods( slist_tpl<ware_t> &load, const goods_desc_t *go
 uint32 haltestelle_t::get_ware_summe(const goods_desc_t *wtyp) const
 {
 	int sum = 0;
-	const vector_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		for(ware_t const& i : *warray) {
+	const goods_storage_t * store = cargo[wtyp->get_catg_index()];
+	if(store!=NULL) {
+		for(ware_t const& i : *store) {
 			if (wtyp->get_index() == i.get_index()) {
 				sum += i.amount;
 			}
@@ -2422,9 +2726,9 @@ uint32 haltestelle_t::get_ware_summe(const goods_desc_t *wtyp) const
 
 uint32 haltestelle_t::get_ware_fuer_zielpos(const goods_desc_t *wtyp, const koord zielpos) const
 {
-	const vector_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		for(ware_t const& ware : *warray) {
+	const goods_storage_t * store = cargo[wtyp->get_catg_index()];
+	if(store!=NULL) {
+		for(ware_t const& ware : *store) {
 			if(wtyp->get_index()==ware.get_index()  &&  ware.get_target_pos()==zielpos) {
 				return ware.amount;
 			}
@@ -2437,11 +2741,12 @@ uint32 haltestelle_t::get_ware_fuer_zielpos(const goods_desc_t *wtyp, const koor
 uint32 haltestelle_t::get_ware_fuer_zwischenziel(const goods_desc_t *wtyp, const halthandle_t zwischenziel) const
 {
 	uint32 sum = 0;
-	const vector_tpl<ware_t> * warray = cargo[wtyp->get_catg_index()];
-	if(warray!=NULL) {
-		for(unsigned i=0;  i<warray->get_count();  i++ ) {
-			const ware_t &ware = (*warray)[i];
-			if(wtyp->get_index()==ware.get_index()  &&  ware.get_via_halt()==zwischenziel) {
+	const goods_storage_t * store = cargo[wtyp->get_catg_index()];
+	if(store!=NULL) {
+		vector_tpl<uint32> buf;
+		for(uint32 const slot : store->get_slots_via(zwischenziel, buf)) {
+			const ware_t &ware = (*store)[slot];
+			if(wtyp->get_index()==ware.get_index()) {
 				sum += ware.amount;
 			}
 		}
@@ -2453,19 +2758,20 @@ uint32 haltestelle_t::get_ware_fuer_zwischenziel(const goods_desc_t *wtyp, const
 bool haltestelle_t::vereinige_waren(const ware_t &ware)
 {
 	// pruefen ob die ware mit bereits wartender ware vereinigt werden kann
-	vector_tpl<ware_t> * warray = cargo[ware.get_desc()->get_catg_index()];
-	if(warray!=NULL) {
-		for(ware_t & tmp : *warray) {
-			// join packets with same destination
-			if(ware.same_destination(tmp)) {
-				if(  ware.get_via_halt().is_bound()  &&  ware.get_via_halt()!=self  ) {
-					// update route if there is newer route
-					tmp.set_via_halt( ware.get_via_halt() );
-				}
-				tmp.amount += ware.amount;
-				old_sort_mode = 255;
-				return true;
+	goods_storage_t * store = cargo[ware.get_desc()->get_catg_index()];
+	if(store!=NULL) {
+		// join packets with same destination
+		const uint32 slot = store->find_same_destination(ware);
+		if(  slot != goods_storage_t::NO_SLOT  ) {
+			ware_t tmp = (*store)[slot];
+			if(  ware.get_via_halt().is_bound()  &&  ware.get_via_halt()!=self  ) {
+				// update route if there is newer route
+				tmp.set_via_halt( ware.get_via_halt() );
 			}
+			tmp.amount += ware.amount;
+			store->set(slot, tmp);
+			old_sort_mode = 255;
+			return true;
 		}
 	}
 	return false;
@@ -2478,22 +2784,15 @@ bool haltestelle_t::vereinige_waren(const ware_t &ware)
 void haltestelle_t::add_ware_to_halt(ware_t ware)
 {
 	// now we have to add the ware to the stop
-	vector_tpl<ware_t> * warray = cargo[ware.get_desc()->get_catg_index()];
-	if(warray==NULL) {
+	goods_storage_t * store = cargo[ware.get_desc()->get_catg_index()];
+	if(store==NULL) {
 		// this type was not stored here before ...
-		warray = new vector_tpl<ware_t>(4);
-		cargo[ware.get_desc()->get_catg_index()] = warray;
+		store = new goods_storage_t();
+		cargo[ware.get_desc()->get_catg_index()] = store;
 	}
-	// the ware will be put into the first entry with menge==0
+	// the ware will be put into an empty entry if possible
 	old_sort_mode = 255;
-	for(ware_t & i : *warray) {
-		if (i.amount == 0) {
-			i = ware;
-			return;
-		}
-	}
-	// here, if no free entries found
-	warray->append(ware);
+	store->add(ware);
 }
 
 
@@ -2605,9 +2904,9 @@ void haltestelle_t::get_freight_info(cbuffer_t & buf)
 		buf.clear();
 
 		for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
-			const vector_tpl<ware_t> * warray = cargo[i];
-			if(warray) {
-				freight_list_sorter_t::sort_freight(*warray, buf, (freight_list_sorter_t::sort_mode_t)env_t::default_sortmode, NULL, "waiting", this->self);
+			const goods_storage_t * store = cargo[i];
+			if(store) {
+				freight_list_sorter_t::sort_freight(store->get_packets(), buf, (freight_list_sorter_t::sort_mode_t)env_t::default_sortmode, NULL, "waiting", this->self);
 			}
 		}
 	}
@@ -2845,9 +3144,9 @@ void haltestelle_t::transfer_goods(halthandle_t halt)
 	}
 	// transfer goods to halt
 	for(uint8 i=0; i<goods_manager_t::get_max_catg_index(); i++) {
-		const vector_tpl<ware_t> * warray = cargo[i];
-		if (warray) {
-			for(ware_t const& j : *warray) {
+		const goods_storage_t * store = cargo[i];
+		if (store) {
+			for(ware_t const& j : *store) {
 				halt->add_ware_to_halt(j);
 			}
 			delete cargo[i];
@@ -2860,6 +3159,9 @@ void haltestelle_t::transfer_goods(halthandle_t halt)
 // private helper function for recalc_station_type()
 void haltestelle_t::add_to_station_type( grund_t *gr )
 {
+	// may change the accepted goods
+	invalidate_route_cache();
+
 	// init in any case ...
 	if(  tiles.empty()  ) {
 		capacity[0] = 0;
@@ -2974,6 +3276,9 @@ void haltestelle_t::add_to_station_type( grund_t *gr )
  */
 void haltestelle_t::recalc_station_type()
 {
+	// may change the accepted goods
+	invalidate_route_cache();
+
 	capacity[0] = 0;
 	capacity[1] = 0;
 	capacity[2] = 0;
@@ -3086,19 +3391,19 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	if(file->is_saving()) {
 		const char *s;
 		for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
-			vector_tpl<ware_t> *warray = cargo[i];
-			if(warray) {
+			goods_storage_t *store = cargo[i];
+			if(store) {
 				s = "y"; // needs to be non-empty
 				file->rdwr_str(s);
 				if(  file->is_version_less(112, 3)  ) {
-					uint16 count = warray->get_count();
+					uint16 count = store->get_count();
 					file->rdwr_short(count);
 				}
 				else {
-					uint32 count = warray->get_count();
+					uint32 count = store->get_count();
 					file->rdwr_long(count);
 				}
-				for(ware_t & ware : *warray) {
+				for(ware_t ware : *store) {
 					ware.rdwr(file);
 				}
 			}
@@ -3122,21 +3427,27 @@ void haltestelle_t::rdwr(loadsave_t *file)
 			}
 			if(count>0) {
 				for(  uint32 i = 0;  i < count;  i++  ) {
-					// add to internal storage (use this function, since the old categories were different)
+					// add to the storage of its category (the old categories were different)
 					ware_t ware(file);
-					if(  ware.get_desc()  &&  ware.amount>0  &&  welt->is_within_limits(ware.get_target_pos())  ) {
-						add_ware_to_halt(ware);
-						// restore in-transit information
-						fabrik_t::update_transit( &ware, true );
-					}
-					else if(  ware.amount>0  ) {
-						if(  ware.get_desc()  ) {
+					if(  ware.get_desc()  ) {
+						if(  ware.amount>0  &&  !welt->is_within_limits(ware.get_target_pos())  ) {
 							dbg->error( "haltestelle_t::rdwr()", "%i of %s to %s ignored!", ware.amount, ware.get_name(), ware.get_target_pos().get_str() );
+							ware.amount = 0;
+						}
+						// empty packets are kept too, so the slots are the same as before saving
+						goods_storage_t *&store = cargo[ware.get_desc()->get_catg_index()];
+						if(  store==NULL  ) {
+							store = new goods_storage_t();
 						}
-						else {
-							dbg->error( "haltestelle_t::rdwr()", "%i of unknown to %s ignored!", ware.amount, ware.get_target_pos().get_str() );
+						store->append(ware);
+						if(  ware.amount>0  ) {
+							// restore in-transit information
+							fabrik_t::update_transit( &ware, true );
 						}
 					}
+					else if(  ware.amount>0  ) {
+						dbg->error( "haltestelle_t::rdwr()", "%i of unknown to %s ignored!", ware.amount, ware.get_target_pos().get_str() );
+					}
 				}
 			}
 			file->rdwr_str(s, lengthof(s));
@@ -3176,6 +3487,10 @@ void haltestelle_t::rdwr(loadsave_t *file)
 	if (file->is_version_atleast(124, 5)) {
 		file->rdwr_short(permissions);
 	}
+
+	if (file->is_version_atleast(124, 6)) {
+		file->rdwr_bool(month_pending);
+	}
 }
 
 
@@ -3191,20 +3506,26 @@ void haltestelle_t::finish_rd()
 	// fix good destination coordinates
 	for(unsigned i=0; i<goods_manager_t::get_max_catg_index(); i++) {
 		if(cargo[i]) {
-			vector_tpl<ware_t> * warray = cargo[i];
-			for(ware_t & j : *warray) {
-				j.finish_rd(welt);
+			goods_storage_t &store = *cargo[i];
+			for(  uint32 j=0;  j<store.get_count();  j++  ) {
+				if(  store[j].amount>0  ) {
+					ware_t ware = store[j];
+					ware.finish_rd(welt);
+					store.set(j, ware);
+				}
 			}
 			// merge identical entries (should only happen with old games)
-			for(unsigned j=0; j<warray->get_count(); j++) {
-				if(  (*warray)[j].amount==0  ) {
+			// newer games keep them, since the game must run on the same after loading
+			for(  uint32 j=0;  welt->load_version < 124006  &&  j<store.get_count();  j++  ) {
+				if(  store[j].amount==0  ) {
 					continue;
 				}
-				for(unsigned k=j+1; k<warray->get_count(); k++) {
-					if(  (*warray)[k].amount>0  &&  (*warray)[j].same_destination( (*warray)[k] )  ) {
-						(*warray)[j].amount += (*warray)[k].amount;
-						(*warray)[k].amount = 0;
-					}
+				const uint32 first = store.find_same_destination( store[j] );
+				if(  first != j  &&  first != goods_storage_t::NO_SLOT  ) {
+					ware_t ware = store[first];
+					ware.amount += store[j].amount;
+					store.set(first, ware);
+					store.set_amount(j, 0);
 				}
 			}
 		}
@@ -3262,7 +3583,7 @@ void haltestelle_t::finish_rd()
 	recalc_basis_pos();
 
 	reconnect_counter = welt->get_schedule_counter()-1;
-	last_search_origin = halthandle_t();
+	main_search.last_search_origin = halthandle_t();
 }
 
 
@@ -10,6 +10,7 @@
 #include "convoihandle.h"
 #include "linehandle.h"
 #include "halthandle.h"
+#include "simware.h"
 
 #include "obj/simobj.h"
 #include "display/simgraph.h"
@@ -28,6 +29,7 @@
 #include "tpl/slist_tpl.h"
 #include "tpl/vector_tpl.h"
 #include "tpl/array_tpl.h"
+#include "tpl/bucket_heap_tpl.h"
 
 
 #define RECONNECTING (1)
@@ -48,6 +50,7 @@
 class cbuffer_t;
 class grund_t;
 class fabrik_t;
+class goods_storage_t;
 class karte_t;
 class karte_ptr_t;
 class koord3d;
@@ -167,6 +170,23 @@ public:
 	 */
 	static void reset_routing();
 
+	/**
+	 * Forgets all unsaved routing and loading state and reconnects all halts,
+	 * so the game continues like after loading. See karte_t::reset_unsaved_state().
+	 */
+	static void restart_routing();
+
+	/**
+	 * Tells the world that schedules have changed (like karte_t::set_schedule_counter()),
+	 * but only the halts marked with mark_reconnect() will rebuild their connections.
+	 */
+	static void reconnect_changed();
+
+	/**
+	 * Marks all halts served by @p schedule of @p owner for reconnection.
+	 */
+	static void mark_reconnect(const schedule_t *schedule, const player_t *owner);
+
 	/**
 	 * Returns an index to a halt at koord k
 	 * by default create a new halt if none found
@@ -303,7 +323,7 @@ private:
 
 
 	// Array with different categories that contains all waiting goods at this stop
-	vector_tpl<ware_t> **cargo;
+	goods_storage_t **cargo;
 
 	/**
 	 * Liste der angeschlossenen Fabriken
@@ -335,6 +355,15 @@ private:
 	 * Reconnect and reroute if counter different from welt->get_schedule_counter()
 	 */
 	static uint8 reconnect_counter;
+
+	/// halts which have to rebuild their connections during the next reconnection
+	static vector_tpl<halthandle_t> dirty_halts;
+
+	/// true, if this halt is in dirty_halts
+	bool reconnect_pending;
+
+	/// new_month() and roll_statistics() still have to be called (see karte_t::step_month_spread())
+	bool month_pending;
 	// since we do partial routing, we remember the last offset
 	uint8 last_catg_index;
 
@@ -421,6 +450,12 @@ public:
 
 	static uint8 get_reconnect_counter() { return reconnect_counter; }
 
+	/**
+	 * The registered lines or convoys (or their schedules) have changed:
+	 * rebuild the connections during the next reconnection.
+	 */
+	void mark_reconnect();
+
 	void rotate90( const sint16 y_size );
 
 	// just for info so far
@@ -462,6 +497,16 @@ public:
 	 */
 	void new_month();
 
+	/**
+	 * Rolls the financial history, after new_month().
+	 * Only this halt is changed, so it may run for several halts in parallel.
+	 */
+	void roll_statistics();
+
+	bool is_month_pending() const { return month_pending; }
+
+	void set_month_pending() { month_pending = true; }
+
 private:
 	/* Node used during route search */
 	struct route_node_t
@@ -492,23 +537,91 @@ private:
 		bool overcrowded:1;
 	};
 
-	// store the best weight so far for a halt, and indicate whether it is a destination
-	static halt_data_t halt_data[65536];
+public:
+	/**
+	 * The working memory of a route search.
+	 * Searches with different instances can run at the same time (as long as the halts do not change).
+	 */
+	class route_search_t
+	{
+		friend class haltestelle_t;
+
+		// store the best weight so far for a halt, and indicate whether it is a destination
+		halt_data_t halt_data[65536];
 
-	// for efficient retrieval of the node with the smallest weight
-	static bucket_heap_tpl<route_node_t> open_list;
+		// for efficient retrieval of the node with the smallest weight
+		bucket_heap_tpl<route_node_t> open_list;
+
+		/**
+		 * Markers used in route searching to avoid processing the same halt more than once
+		 */
+		uint8 markers[65536];
+		uint8 current_marker;
+
+		/**
+		 * Remember last route search start and catg to resume search
+		 */
+		halthandle_t last_search_origin;
+		uint8        last_search_ware_catg_idx;
+		uint16       allocation_pointer;
+
+		// target halts of the current search and their connected components
+		vector_tpl<halthandle_t> end_halts;
+		vector_tpl<uint16> end_conn_comp;
+
+		// destinations of the resumable search, to reset them before returning
+		vector_tpl<uint16> dest_indices;
+
+		/// result of an earlier search_route()
+		struct cached_route_t
+		{
+			enum { max_halts = 8 };
+
+			uint32 generation; ///< route_generation at the time of the search, 0 if unused
+			uint16 max_transfers;
+			uint16 max_hops;
+			uint8 catg_idx;
+			uint8 start_count;
+			uint8 end_count;
+			uint8 result;
+			uint16 halt_ids[2*max_halts]; ///< start halts, followed by the halts at the target position
+			halthandle_t target_halt, via_halt;
+			halthandle_t return_target_halt, return_via_halt;
+		};
+
+		enum { route_cache_size = 4096 };
+
+		/// allocated on first use
+		cached_route_t *route_cache;
+
+		/// @returns the new marker
+		uint8 next_marker();
+
+		route_search_t(const route_search_t&);
+		route_search_t& operator=(const route_search_t&);
+
+	public:
+		route_search_t();
+		~route_search_t();
+	};
+
+private:
+	/// used by search_route() without explicit search and by search_route_resumable()
+	static route_search_t main_search;
 
 	/**
-	 * Markers used in route searching to avoid processing the same halt more than once
+	 * Changes whenever connections, connected components or accepted goods of any halt change.
+	 * Cached routes from another generation are not used.
 	 */
-	static uint8 markers[65536];
-	static uint8 current_marker;
+	static uint32 route_generation;
+
+	static void invalidate_route_cache() { route_generation++; }
 
 	/**
-	 * Remember last route search start and catg to resume search
+	 * The actual search of search_route().
 	 */
-	static halthandle_t last_search_origin;
-	static uint8        last_search_ware_catg_idx;
+	static int search_route_intern( route_search_t &search, const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware );
+
 public:
 	enum routing_result_flags {
 		NO_ROUTE          = 0,
@@ -517,6 +630,22 @@ public:
 		ROUTE_OVERCROWDED = 8
 	};
 
+	/**
+	 * A ware packet to route with search_routes().
+	 */
+	struct route_query_t
+	{
+		const halthandle_t *start_halts;
+		uint16 start_halt_count;
+		bool no_routing_over_overcrowding;
+		/// if set, return_ware is filled like the return_ware of search_route()
+		bool with_return_ware;
+		ware_t ware;
+		ware_t return_ware;
+		/// routing_result_flags
+		int result;
+	};
+
 	/**
 	 * Kann die Ware nicht zum Ziel geroutet werden (keine Route), dann werden
 	 * Ziel und Zwischenziel auf koord::invalid gesetzt.
@@ -527,7 +656,36 @@ public:
 	 *
 	 * if avoid_overcrowding is set, a valid route in only found when there is no overflowing stop in between
 	 */
-	static int search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware=NULL );
+	static int search_route( const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware=NULL )
+	{
+		return search_route( main_search, start_halts, start_halt_count, no_routing_over_overcrowding, ware, return_ware );
+	}
+
+	/**
+	 * Same as above, with the working memory in @p search.
+	 */
+	static int search_route( route_search_t &search, const halthandle_t *const start_halts, const uint16 start_halt_count, const bool no_routing_over_overcrowding, ware_t &ware, ware_t *const return_ware=NULL );
+
+	/**
+	 * Routes all @p queries (like search_route()) on all threads.
+	 * The results are stored in each query, so they do not depend on the order of the threads.
+	 * Must not be called while other threads change halts or connections.
+	 */
+	static void search_routes( vector_tpl<route_query_t> &queries );
+
+	/**
+	 * Appends all following queries of search_route() to @p filename (NULL stops recording).
+	 * Each line is: goods index, target x, target y, number of start halts, start halt ids.
+	 */
+	static bool record_routes( const char *filename );
+
+	/**
+	 * Runs search_route() for all queries in @p filename (see record_routes()), without and with route cache,
+	 * and search_routes() on all threads.
+	 * The timings and the number of different results are written to the log.
+	 * @returns false if any result differs
+	 */
+	static bool benchmark_routes( const char *filename );
 
 	/**
 	 * A separate version of route searching code for re-calculating routes
@@ -774,12 +932,12 @@ public:
 	/**
 	 * called, if a line serves this stop
 	 */
-	void add_line(linehandle_t line) { registered_lines.append_unique(line); }
+	void add_line(linehandle_t line) { registered_lines.append_unique(line); mark_reconnect(); }
 
 	/**
 	 * called, if a line removes this stop from it's schedule
 	 */
-	void remove_line(linehandle_t line) { registered_lines.remove(line); }
+	void remove_line(linehandle_t line) { registered_lines.remove(line); mark_reconnect(); }
 
 	/**
 	 * list of line ids that serve this stop
@@ -789,12 +947,12 @@ public:
 	/**
 	 * Register a lineless convoy which serves this stop
 	 */
-	void add_convoy(convoihandle_t convoy) { registered_convoys.append_unique(convoy); }
+	void add_convoy(convoihandle_t convoy) { registered_convoys.append_unique(convoy); mark_reconnect(); }
 
 	/**
 	 * Unregister a lineless convoy
 	 */
-	void remove_convoy(convoihandle_t convoy) { registered_convoys.remove(convoy); }
+	void remove_convoy(convoihandle_t convoy) { registered_convoys.remove(convoy); mark_reconnect(); }
 
 	/**
 	 * A list of lineless convoys serving this stop
@@ -32,6 +32,7 @@ void intr_set_last_time(uint32 time);
 
 void intr_enable();
 void intr_disable();
+bool intr_is_enabled();
 
 
 void interrupt_check(const char* caller_info = "0");
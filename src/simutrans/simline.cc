@@ -198,7 +198,8 @@ void simline_t::add_convoy(convoihandle_t cnv)
 
 	// do we need to tell the world about our new schedule?
 	if(  update_schedules  ) {
-		welt->set_schedule_counter();
+		haltestelle_t::mark_reconnect( schedule, player );
+		haltestelle_t::reconnect_changed();
 	}
 }
 
@@ -476,20 +477,22 @@ void simline_t::recalc_catg_index()
 		}
 	}
 	// if different => schedule need recalculation
-	if(  goods_catg_index.get_count()!=old_goods_catg_index.get_count()  ) {
-		// surely changed
-		welt->set_schedule_counter();
-	}
-	else {
+	bool changed = goods_catg_index.get_count()!=old_goods_catg_index.get_count();
+	if(  !changed  ) {
 		// maybe changed => must test all entries
 		for(uint8 const i : goods_catg_index) {
 			if (!old_goods_catg_index.is_contained(i)) {
 				// different => recalc
-				welt->set_schedule_counter();
+				changed = true;
 				break;
 			}
 		}
 	}
+	if(  changed  ) {
+		// only the stops of this line need new connections
+		haltestelle_t::mark_reconnect( schedule, player );
+		haltestelle_t::reconnect_changed();
+	}
 }
 
 
@@ -7,6 +7,7 @@
 #include "simlinemgmt.h"
 #include "simline.h"
 #include "simconvoi.h"
+#include "simhalt.h"
 #include "gui/simwin.h"
 #include "world/simworld.h"
 #include "simtypes.h"
@@ -65,7 +66,8 @@ void simlinemgmt_t::update_line(linehandle_t line)
 	// finally de/register all stops
 	line->renew_stops();
 	if(  count>0  ) {
-		world()->set_schedule_counter();
+		// old and new stops of the line have been marked by (un)registering
+		haltestelle_t::reconnect_changed();
 	}
 }
 
@@ -34,6 +34,8 @@
 #include "ground/boden.h"
 #include "ground/wasser.h"
 #include "world/simcity.h"
+#include "world/step_profiler.h"
+#include "builder/wegbauer.h"
 #include "player/simplay.h"
 #include "simsound.h"
 #include "simintr.h"
@@ -215,13 +217,17 @@ static void show_times(karte_t *welt, main_view_t *view)
 	dbg->message("show_times()", "view->display(true) and flush %i iterations took %li ms", i, dr_time() - ms );
 
 	ms = dr_time();
-	for (i = 0; i < 40000000/(int)weg_t::get_alle_wege().get_count(); i++) {
-		for(weg_t * const w : weg_t::get_alle_wege() ) {
-			grund_t *dummy;
-			welt->lookup( w->get_pos() )->get_neighbour( dummy, invalid_wt, ribi_t::north );
+	const waytype_t way_types[] = { road_wt, track_wt, water_wt, monorail_wt, maglev_wt, narrowgauge_wt, air_wt };
+	const uint32 way_count = weg_t::get_alle_wege_count();
+	for (i = 0; way_count > 0  &&  i < 40000000/(int)way_count; i++) {
+		for(  waytype_t wt : way_types  ) {
+			for(weg_t * const w : weg_t::get_alle_wege(wt) ) {
+				grund_t *dummy;
+				welt->lookup( w->get_pos() )->get_neighbour( dummy, invalid_wt, ribi_t::north );
+			}
 		}
 	}
-	dbg->message("show_times()", "grund_t::get_neighbour() %i iterations took %li ms", i*weg_t::get_alle_wege().get_count(), dr_time() - ms );
+	dbg->message("show_times()", "grund_t::get_neighbour() %i iterations took %li ms", i*way_count, dr_time() - ms );
 
 	ms = dr_time();
 	for (i = 0; i < 1000; i++) {
@@ -251,6 +257,52 @@ static void show_times(karte_t *welt, main_view_t *view)
 #endif
 
 
+#ifdef MULTI_THREAD
+/**
+ * Runs the same savegame twice for some steps, once with serial and once with
+ * parallel convoi stepping. Both must end with the same game state.
+ */
+static bool verify_parallel_step(karte_t *welt, const char *filename, int steps)
+{
+	const bool old_parallel_convoi_step = env_t::parallel_convoi_step;
+	uint32 hash[2];
+
+	for(  int parallel = 0;  parallel < 2;  parallel++  ) {
+		if(  !welt->load( filename )  ) {
+			dbg->error( "verify_parallel_step()", "Cannot load \"%s\"", filename );
+			return false;
+		}
+		// older savegames do not contain the state of the random generator
+		setsimrand( welt->get_settings().get_map_number(), welt->get_settings().get_map_number() );
+
+		env_t::parallel_convoi_step = parallel != 0;
+		welt->set_fast_forward( true );
+		intr_disable();
+
+		const uint32 ms = dr_time();
+		for(  int i = 0;  i < steps;  i++  ) {
+			for(  int j = 0;  j < 10;  j++  ) {
+				welt->sync_step( 100 );
+			}
+			welt->step();
+		}
+		hash[parallel] = welt->get_gamestate_hash();
+		dbg->message( "verify_parallel_step()", "%s: %i steps took %u ms, game state hash %08x", parallel ? "parallel" : "serial", steps, dr_time() - ms, hash[parallel] );
+	}
+
+	env_t::parallel_convoi_step = old_parallel_convoi_step;
+	welt->set_fast_forward( false );
+
+	if(  hash[0] != hash[1]  ) {
+		dbg->error( "verify_parallel_step()", "Parallel convoi step differs from serial step!" );
+		return false;
+	}
+	dbg->message( "verify_parallel_step()", "Parallel and serial convoi step are identical" );
+	return true;
+}
+#endif
+
+
 // some routines for the modal display
 static bool never_quit() { return false; }
 static bool no_language() { return translator::get_language()!=-1; }
@@ -384,6 +436,17 @@ void print_help()
 		"command line parameters available: \n"
 		" -addons             loads also addons (with -objects)\n"
 		" -async              asynchronous images, only for SDL\n"
+		" -benchmark_halt_routes FILE  replays the route searches in FILE (see\n"
+		"                     -record_halt_routes) with the game given by -load\n"
+		" -benchmark_months N runs the game given by -load for N months as fast\n"
+		"                     as possible and reports the time per step phase\n"
+		" -benchmark_report FILE  writes that report to FILE (CSV, or JSON if FILE\n"
+		"                     ends with .json) instead of printing it\n"
+		" -benchmark_way_builder SIZE  creates a map of SIZE x SIZE tiles and times\n"
+		"                     the way builder route search on it\n"
+		" -benchmark_blitters times drawing the pakset images with each pixel loop\n"
+		"                     (scalar, SSE2, AVX2) the CPU supports\n"
+		" -image_memory       prints the memory used by the pakset images\n"
 		" -borderless         emulate fullscreen as borderless window\n"
 		" -use_hw             hardware double buffering, only for SDL\n"
 		" -debug NUM          enables debugging (1..5) Append p to show pak details\n"
@@ -408,6 +471,8 @@ void print_help()
 		" -set_pakdir DIR     loads the pakset in specified directory\n"
 		" -pause              starts game with paused after loading\n"
 		"                     a server will pause if there are no clients\n"
+		" -record_halt_routes FILE  appends all passenger and goods route\n"
+		"                     searches to FILE\n"
 		" -res N              starts in specified resolution: \n"
 		"                      1=640x480, 2=800x600, 3=1024x768, 4=1280x1024\n"
 		" -scenario NAME      Load scenario NAME\n"
@@ -422,6 +487,9 @@ void print_help()
 		" -server_name NAME   Name of server for announcements\n"
 		" -server_admin_pw PW password for server administration\n"
 		" -heavy NUM          enables heavy-mode debugging for network games. VERY SLOW!\n"
+		"                     1=full game state hash, 2=full hash and saves each step\n"
+		"                     3=game state digest (faster, finds tile desyncs later)\n"
+		"                     4=digest checked against the full hash\n"
 		" -set_basedir WD     Use WD as directory containing all constant data.\n"
 		" -set_installdir WD  Use WD as directory for pakset download.\n"
 		" -set_userdir WD     Use WD as directory for local user data.\n"
@@ -439,6 +507,10 @@ void print_help()
 		" -times              does some simple profiling\n"
 #endif
 		" -until YEAR.MONTH   quits when MONTH of YEAR starts\n"
+#ifdef MULTI_THREAD
+		" -verify_parallel_step N  runs N steps of the game given by -load serial\n"
+		"                     and with parallel convoi step and compares both\n"
+#endif
 	);
 }
 
@@ -807,7 +879,7 @@ int simu_main(int argc, char** argv)
 	env_t::network_heavy_mode = 0;
 	if(  args.has_arg("-heavy")  ) {
 		int heavy = atoi(args.gimme_arg("-heavy", 1));
-		env_t::network_heavy_mode = clamp(heavy, 0, 2);
+		env_t::network_heavy_mode = clamp(heavy, 0, 4);
 	}
 
 	DBG_MESSAGE("simu_main()", "Version:     " VERSION_NUMBER "  Date: " VERSION_DATE);
@@ -1618,6 +1690,66 @@ int simu_main(int argc, char** argv)
 	}
 #endif
 
+#ifdef MULTI_THREAD
+	// check that parallel convoi stepping gives the same result as the serial one
+	if(  const char *steps = args.gimme_arg("-verify_parallel_step", 1)  ) {
+		if(  args.has_arg("-load")  &&  !strstart(args.gimme_arg("-load", 1), "net:")  ) {
+			cbuffer_t buf;
+			dr_chdir( env_t::user_dir );
+			buf.printf( SAVE_PATH_X "%s", searchfolder_t::complete(args.gimme_arg("-load", 1), "sve").c_str() );
+			const bool ok = verify_parallel_step( welt, buf, atoi(steps) );
+			printf( "verify_parallel_step: %s\n", ok ? "identical" : "DIFFERENT" );
+		}
+		else {
+			dbg->error( "simu_main()", "-verify_parallel_step needs a savegame given by -load" );
+		}
+		env_t::quit_simutrans = true;
+	}
+#endif
+
+	// time the halt route search with queries recorded before
+	if(  const char *queries = args.gimme_arg("-benchmark_halt_routes", 1)  ) {
+		if(  args.has_arg("-load")  ) {
+			const bool ok = haltestelle_t::benchmark_routes( queries );
+			printf( "benchmark_halt_routes: %s\n", ok ? "identical" : "DIFFERENT" );
+		}
+		else {
+			dbg->error( "simu_main()", "-benchmark_halt_routes needs a savegame given by -load" );
+		}
+		env_t::quit_simutrans = true;
+	}
+
+	// memory used by the images of the pakset
+	if(  args.has_arg("-image_memory")  ) {
+		gfx->print_image_memory();
+		env_t::quit_simutrans = true;
+	}
+
+	// time the pixel loops for drawing images
+	if(  args.has_arg("-benchmark_blitters")  ) {
+		gfx->benchmark_blitters();
+		env_t::quit_simutrans = true;
+	}
+
+	// time the way builder on a new map, which is the same every time
+	if(  const char *size = args.gimme_arg("-benchmark_way_builder", 1)  ) {
+		settings_t sets;
+		sets.copy_city_road( env_t::default_settings );
+		sets.set_default_climates();
+		sets.set_use_timeline( 0 );
+		sets.set_size( clamp( atoi(size), 64, 4096 ), clamp( atoi(size), 64, 4096 ) );
+		sets.set_city_count( 0 );
+		sets.set_factory_count( 0 );
+		sets.set_tourist_attractions( 0 );
+		welt->init( &sets, 0 );
+		way_builder_t::benchmark_routes( welt->get_active_player() );
+		env_t::quit_simutrans = true;
+	}
+
+	if(  const char *queries = args.gimme_arg("-record_halt_routes", 1)  ) {
+		haltestelle_t::record_routes( queries );
+	}
+
 	// finish after a certain month? (must be entered decimal, i.e. 12*year+month
 	if(  args.has_arg("-until")  ) {
 		const char *until = args.gimme_arg("-until", 1);
@@ -1631,6 +1763,21 @@ int simu_main(int argc, char** argv)
 		welt->set_fast_forward(true);
 	}
 
+	// run some months as fast as possible and time the parts of each step
+	const sint16 old_max_acceleration = env_t::max_acceleration;
+	if(  const char *months = args.gimme_arg("-benchmark_months", 1)  ) {
+		if(  args.has_arg("-load")  ) {
+			quit_month = welt->get_current_month() + max( 1, atoi(months) );
+			welt->set_fast_forward(true);
+			env_t::max_acceleration = 0x7FFF;
+			step_profiler_t::start( welt->get_current_month() );
+		}
+		else {
+			dbg->error( "simu_main()", "-benchmark_months needs a savegame given by -load" );
+			env_t::quit_simutrans = true;
+		}
+	}
+
 	welt->reset_timer();
 	if(  !env_t::networkmode  &&  !env_t::server  ) {
 #ifdef display_in_main
@@ -1720,6 +1867,11 @@ int simu_main(int argc, char** argv)
 
 	intr_disable();
 
+	if(  step_profiler_t::is_active()  ) {
+		step_profiler_t::write_report( args.gimme_arg("-benchmark_report", 1), welt, args.gimme_arg("-load", 1) );
+		env_t::max_acceleration = old_max_acceleration;
+	}
+
 	// save settings
 	{
 		dr_chdir( env_t::user_dir );
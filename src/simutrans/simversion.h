@@ -22,8 +22,8 @@
 
 // Beware: SAVEGAME minor is often ahead of version minor when there were patches.
 // ==> These have no direct connection at all!
-#define SIM_SAVE_MINOR      5
-#define SIM_SERVER_MINOR    5
+#define SIM_SAVE_MINOR      7
+#define SIM_SERVER_MINOR    7
 // NOTE: increment before next release to enable save/load of new features
 
 /* for next release after 124.5 */
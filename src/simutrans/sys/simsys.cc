@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <chrono>
 
 #ifdef __HAIKU__
 #include <Message.h>
@@ -177,6 +178,12 @@ uint8 dr_get_max_threads()
 }
 
 
+uint64 dr_time_us()
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+
 // create a directory with all subdirectories needed
 int dr_mkdir(char const* const path)
 {
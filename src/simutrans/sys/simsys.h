@@ -214,6 +214,8 @@ void GetEvents();
 uint8 dr_get_max_threads();
 
 uint32 dr_time();
+/// monotonic time in microseconds, for profiling
+uint64 dr_time_us();
 void dr_sleep(uint32 millisec);
 
 // error message in case of fatal events
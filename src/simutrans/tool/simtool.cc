@@ -1710,15 +1710,13 @@ const char *tool_clear_reservation_t::work( player_t *, koord3d pos )
 					// reset driving state
 					cnv->suche_neue_route();
 				}
-				for(weg_t* const w : weg_t::get_alle_wege()) {
-					if (w->get_waytype() == waytype) {
-						schiene_t* const sch = obj_cast<schiene_t>(w);
-						if (sch->get_reserved_convoi() == cnv) {
-							vehicle_t& v = *cnv->front();
-							if (!gr->suche_obj(v.get_typ())) {
-								// force free
-								sch->unreserve(&v);
-							}
+				for(weg_t* const w : weg_t::get_alle_wege(waytype)) {
+					schiene_t* const sch = obj_cast<schiene_t>(w);
+					if (sch->get_reserved_convoi() == cnv) {
+						vehicle_t& v = *cnv->front();
+						if (!gr->suche_obj(v.get_typ())) {
+							// force free
+							sch->unreserve(&v);
 						}
 					}
 				}
@@ -2820,6 +2818,10 @@ const char *tool_build_way_t::calc_route( way_builder_t &bauigel, const koord3d
 	if (is_shift_pressed()  &&  desc->get_styp() == type_flat  &&  desc->get_wtyp() == road_wt) {
 		bauigel.set_keep_city_roads(true);
 	}
+	// faster for long ways; if nothing is found this way, the usual search follows
+	bauigel.set_bidirectional(true);
+	bauigel.set_corridor(64);
+	bauigel.set_coarse_heuristic(true);
 
 
 	koord3d my_end = end;
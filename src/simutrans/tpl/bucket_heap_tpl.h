@@ -0,0 +1,109 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef TPL_BUCKET_HEAP_TPL_H
+#define TPL_BUCKET_HEAP_TPL_H
+
+
+#include "binary_heap_tpl.h"
+#include "vector_tpl.h"
+
+
+/**
+ * Helper class that combines a vector_tpl
+ * with WEIGHT_HEAP elements and a binary_heap_tpl.
+ * If inserted node has weight less than WEIGHT_HEAP,
+ * then node is inserted in one of the vectors.
+ * If weight is larger, then node goes into the heap.
+ *
+ * WEIGHT_HEAP = 200 should be safe for even the largest games.
+ */
+template<class T> class bucket_heap_tpl
+{
+#define WEIGHT_HEAP (200)
+	vector_tpl<T> *buckets;  ///< array of vectors
+	binary_heap_tpl<T> heap; ///< the heap
+
+	uint16 min_weight; ///< current min_weight of nodes in the buckets
+	uint32 node_count; ///< total count of nodes
+public:
+	bucket_heap_tpl() : heap(128)
+	{
+		min_weight = WEIGHT_HEAP;
+		node_count = 0;
+		buckets = new vector_tpl<T> [WEIGHT_HEAP];
+	}
+
+	~bucket_heap_tpl()
+	{
+		delete [] buckets;
+	}
+
+	void insert(const T item)
+	{
+		node_count++;
+		uint16 weight = *item;
+
+		if (weight < WEIGHT_HEAP) {
+			if (weight < min_weight) {
+				min_weight = weight;
+			}
+			buckets[weight].append(item);
+		}
+		else {
+			heap.insert(item);
+		}
+	}
+
+	T pop()
+	{
+		assert(!empty());
+		node_count--;
+
+		if (min_weight < WEIGHT_HEAP) {
+			T ret = buckets[min_weight].pop_back();
+
+			while(min_weight < WEIGHT_HEAP  &&  buckets[min_weight].empty()) {
+				min_weight++;
+			}
+			return ret;
+		}
+		else {
+			return heap.pop();
+		}
+	}
+
+	void clear()
+	{
+		for(uint16 i=min_weight; i<WEIGHT_HEAP; i++) {
+			buckets[i].clear();
+		}
+		min_weight = WEIGHT_HEAP;
+		node_count = 0;
+
+		heap.clear();
+	}
+
+	uint32 get_count() const
+	{
+		return node_count;
+	}
+
+	const T& front()
+	{
+		assert(!empty());
+		if (min_weight < WEIGHT_HEAP) {
+			return buckets[min_weight].back();
+		}
+		else {
+			return heap.front();
+		}
+	}
+
+	bool empty() const { return node_count == 0; }
+};
+
+
+#endif
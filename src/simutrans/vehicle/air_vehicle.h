@@ -89,6 +89,9 @@ public:
 
 	bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route) OVERRIDE;
 
+	// the route is assembled from several searches around the runways
+	bool can_prepare_route() const OVERRIDE { return false; }
+
 	bool clear_route_to_runway(bool reserve);
 
 	typ get_typ() const OVERRIDE { return air_vehicle; }
@@ -13,6 +13,7 @@
 
 class grund_t;
 class weg_t;
+class prepared_route_t;
 
 
 /**
@@ -48,6 +49,13 @@ public:
 
 	// return the cost of a single step upwards
 	virtual uint32 get_cost_upslope() const { return 0; }
+
+	// route searched in advance for the next calc_route (if any)
+	virtual prepared_route_t *get_prepared_route() const { return NULL; }
+
+	// everything besides the speed that limits where this driver may go (owner, electrification, ...)
+	// a prepared route is only used by the same driver with the same restrictions
+	virtual uint32 get_route_restrictions() const { return 0; }
 };
 
 #endif
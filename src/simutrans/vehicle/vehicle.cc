@@ -408,6 +408,26 @@ bool vehicle_t::calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_
 }
 
 
+prepared_route_t *vehicle_t::get_prepared_route() const
+{
+	return leading  &&  cnv ? cnv->get_prepared_route() : NULL;
+}
+
+
+uint32 vehicle_t::get_route_restrictions() const
+{
+	// all that check_next_tile() looks at besides the ways: private ways, electrification, minimum speed signs, free stop search
+	uint32 restrictions = (uint8)get_owner_nr();
+	if(  cnv  &&  cnv->needs_electrification()  ) {
+		restrictions |= 1 << 8;
+	}
+	if(  target_halt.is_bound()  ) {
+		restrictions |= 1 << 9;
+	}
+	return restrictions | ((uint32)desc->get_topspeed() << 16);
+}
+
+
 grund_t* vehicle_t::hop_check()
 {
 	// the leading vehicle will do all the checks
@@ -1055,6 +1075,10 @@ DBG_MESSAGE("vehicle_t::rdwr_from_convoi()","bought at %i/%i.",(purchase_time%12
 			// full weight after loading
 			sum_weight =  get_cargo_weight() + desc->get_weight();
 		}
+		// friction is not saved, but direction and position are
+		if(  const grund_t *gr = welt->lookup(get_pos())  ) {
+			calc_friction(gr);
+		}
 		// recalc total freight
 		total_freight = 0;
 		for(ware_t const& c : fracht) {
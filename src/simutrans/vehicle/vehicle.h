@@ -125,6 +125,16 @@ public:
 	virtual bool calc_route(koord3d start, koord3d ziel, sint32 max_speed, route_t* route);
 	route_t::index_t get_route_index() const { return route_index; }
 
+	/**
+	 * True, if the search of the next calc_route() depends only on the ways
+	 * and thus can be done in advance by convoi_t::prepare_step().
+	 */
+	virtual bool can_prepare_route() const { return !target_halt.is_bound(); }
+
+	prepared_route_t *get_prepared_route() const OVERRIDE;
+
+	uint32 get_route_restrictions() const OVERRIDE;
+
 	/**
 	* Get the base image.
 	*/
@@ -0,0 +1,210 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "city_index.h"
+#include "simcity.h"
+
+
+/// @return true if city a at distance dist_a comes before city b at distance dist_b
+static inline bool is_nearer(uint32 dist_a, const stadt_t *a, uint32 dist_b, const stadt_t *b)
+{
+	if(  dist_a != dist_b  ) {
+		return dist_a < dist_b;
+	}
+	const koord pos_a = a->get_pos();
+	const koord pos_b = b->get_pos();
+	return pos_a.y < pos_b.y  ||  (pos_a.y == pos_b.y  &&  pos_a.x < pos_b.x);
+}
+
+
+void city_index_t::reset(koord map_size)
+{
+	delete [] cells;
+	registered.clear();
+	size.x = max( 1, (map_size.x + CELL_SIZE - 1) / CELL_SIZE );
+	size.y = max( 1, (map_size.y + CELL_SIZE - 1) / CELL_SIZE );
+	cells = new vector_tpl<stadt_t *>[ size.x * size.y ];
+}
+
+
+koord city_index_t::get_cell(koord k) const
+{
+	koord cell( k.x / CELL_SIZE, k.y / CELL_SIZE );
+	cell.clip_min( koord(0, 0) );
+	cell.clip_max( size - koord(1, 1) );
+	return cell;
+}
+
+
+city_index_t::cell_area_t city_index_t::get_cell_area(const stadt_t *city) const
+{
+	koord lo = city->get_linksoben();
+	koord ur = city->get_rechtsunten();
+	lo.clip_max( city->get_pos() );
+	ur.clip_min( city->get_pos() );
+
+	cell_area_t area;
+	area.lo = get_cell(lo);
+	area.ur = get_cell(ur);
+	return area;
+}
+
+
+void city_index_t::add_to_cells(stadt_t *city, const cell_area_t &area)
+{
+	for(  sint16 y = area.lo.y;  y <= area.ur.y;  y++  ) {
+		for(  sint16 x = area.lo.x;  x <= area.ur.x;  x++  ) {
+			cells[y * size.x + x].append( city );
+		}
+	}
+}
+
+
+void city_index_t::remove_from_cells(stadt_t *city, const cell_area_t &area)
+{
+	for(  sint16 y = area.lo.y;  y <= area.ur.y;  y++  ) {
+		for(  sint16 x = area.lo.x;  x <= area.ur.x;  x++  ) {
+			cells[y * size.x + x].remove( city );
+		}
+	}
+}
+
+
+void city_index_t::add(stadt_t *city)
+{
+	assert( cells  &&  registered.access(city) == NULL );
+	const cell_area_t area = get_cell_area( city );
+	add_to_cells( city, area );
+	registered.put( city, area );
+}
+
+
+void city_index_t::remove(stadt_t *city)
+{
+	if(  const cell_area_t *area = registered.access(city)  ) {
+		remove_from_cells( city, *area );
+		registered.remove( city );
+	}
+}
+
+
+void city_index_t::update(stadt_t *city)
+{
+	cell_area_t *area = registered.access( city );
+	if(  area == NULL  ) {
+		return;
+	}
+	const cell_area_t new_area = get_cell_area( city );
+	if(  new_area.lo != area->lo  ||  new_area.ur != area->ur  ) {
+		remove_from_cells( city, *area );
+		add_to_cells( city, new_area );
+		*area = new_area;
+	}
+}
+
+
+stadt_t *city_index_t::find_nearest_city(koord k) const
+{
+	if(  cells == NULL  ) {
+		return NULL;
+	}
+
+	// all cities containing k are registered in its cell
+	stadt_t *best = NULL;
+	uint32 best_dist = 0;
+	const koord cell = get_cell(k);
+	for(stadt_t *const s : cells[cell.y * size.x + cell.x]) {
+		if(  k.x >= s->get_linksoben().x  &&  k.y >= s->get_linksoben().y  &&  k.x < s->get_rechtsunten().x  &&  k.y < s->get_rechtsunten().y  ) {
+			const uint32 dist = koord_distance( k, s->get_center() );
+			if(  best == NULL  ||  is_nearer( dist, s, best_dist, best )  ) {
+				best = s;
+				best_dist = dist;
+			}
+		}
+	}
+
+	if(  best == NULL  ) {
+		vector_tpl<stadt_t *> result(1);
+		find_nearest( k, 1, true, result );
+		if(  !result.empty()  ) {
+			best = result[0];
+		}
+	}
+	return best;
+}
+
+
+void city_index_t::find_nearest_cities(koord k, uint32 count, vector_tpl<stadt_t *> &result) const
+{
+	find_nearest( k, count, false, result );
+}
+
+
+void city_index_t::find_nearest(koord k, uint32 count, bool by_center, vector_tpl<stadt_t *> &result) const
+{
+	result.clear();
+	if(  cells == NULL  ||  count == 0  ) {
+		return;
+	}
+
+	vector_tpl<uint32> dists(count + 1);
+	const koord c = get_cell(k);
+	const sint16 max_r = max( max( c.x, size.x - 1 - c.x ), max( c.y, size.y - 1 - c.y ) );
+
+	for(  sint16 r = 0;  r <= max_r;  r++  ) {
+		// cells at distance r from c
+		for(  sint16 y = c.y - r;  y <= c.y + r;  y++  ) {
+			if(  y < 0  ||  y >= size.y  ) {
+				continue;
+			}
+			const sint16 step = (y == c.y - r  ||  y == c.y + r) ? 1 : 2 * r;
+			for(  sint16 x = c.x - r;  x <= c.x + r;  x += step  ) {
+				if(  x < 0  ||  x >= size.x  ) {
+					continue;
+				}
+				for(stadt_t *const s : cells[y * size.x + x]) {
+					const uint32 dist = koord_distance( k, by_center ? s->get_center() : s->get_pos() );
+					if(  result.get_count() == count  &&  !is_nearer( dist, s, dists.back(), result.back() )  ) {
+						continue;
+					}
+					if(  result.is_contained(s)  ) {
+						// large cities are found in several cells
+						continue;
+					}
+					uint32 i = result.get_count();
+					while(  i > 0  &&  is_nearer( dist, s, dists[i - 1], result[i - 1] )  ) {
+						i--;
+					}
+					result.insert_at( i, s );
+					dists.insert_at( i, dist );
+					if(  result.get_count() > count  ) {
+						result.pop_back();
+						dists.pop_back();
+					}
+				}
+			}
+		}
+
+		if(  result.get_count() == count  ) {
+			// cities not found yet are outside the cells searched so far
+			sint32 bound = 0x7FFFFFFF;
+			if(  c.x - r > 0  ) {
+				bound = min( bound, k.x - (c.x - r) * CELL_SIZE + 1 );
+			}
+			if(  c.x + r < size.x - 1  ) {
+				bound = min( bound, (c.x + r + 1) * CELL_SIZE - k.x );
+			}
+			if(  c.y - r > 0  ) {
+				bound = min( bound, k.y - (c.y - r) * CELL_SIZE + 1 );
+			}
+			if(  c.y + r < size.y - 1  ) {
+				bound = min( bound, (c.y + r + 1) * CELL_SIZE - k.y );
+			}
+			if(  (sint32)dists.back() < bound  ) {
+				break;
+			}
+		}
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef WORLD_CITY_INDEX_H
+#define WORLD_CITY_INDEX_H
+
+
+#include "../dataobj/koord.h"
+#include "../tpl/vector_tpl.h"
+#include "../tpl/ptrhashtable_tpl.h"
+
+
+class stadt_t;
+
+
+/**
+ * Finds the cities near a position without looking at all cities.
+ * The map is divided into cells, each cell knows the cities whose
+ * area (city limits and townhall) overlaps it.
+ * Ties in distance are decided by the townhall position, so results
+ * do not depend on the order cities were added.
+ */
+class city_index_t
+{
+	/// a cell covers CELL_SIZE x CELL_SIZE tiles
+	enum { CELL_SIZE = 32 };
+
+	/// cells covered by a city, both corners inclusive
+	struct cell_area_t
+	{
+		koord lo, ur;
+	};
+
+	vector_tpl<stadt_t *> *cells;
+	koord size;
+
+	/// where each city was registered, needed to remove it again after its area changed
+	ptrhashtable_tpl<stadt_t *, cell_area_t> registered;
+
+	koord get_cell(koord k) const;
+	cell_area_t get_cell_area(const stadt_t *city) const;
+
+	void add_to_cells(stadt_t *city, const cell_area_t &area);
+	void remove_from_cells(stadt_t *city, const cell_area_t &area);
+
+	/**
+	 * Ring search around the cell of k
+	 * @param by_center if true distances are measured to the city center, otherwise to the townhall
+	 */
+	void find_nearest(koord k, uint32 count, bool by_center, vector_tpl<stadt_t *> &result) const;
+
+	city_index_t(const city_index_t &);
+	city_index_t &operator=(const city_index_t &);
+
+public:
+	city_index_t() : cells(NULL), size(0, 0) {}
+	~city_index_t() { delete [] cells; }
+
+	/// removes all cities and sets up cells for a map of this size
+	void reset(koord map_size);
+
+	void add(stadt_t *city);
+	void remove(stadt_t *city);
+
+	/// to be called when the city limits or the townhall moved, cities not added are ignored
+	void update(stadt_t *city);
+
+	/**
+	 * @return the city with the nearest center among those whose limits contain k,
+	 * if there is none the city with the nearest center
+	 */
+	stadt_t *find_nearest_city(koord k) const;
+
+	/**
+	 * @param[out] result at most count cities with their townhall nearest to k, nearest first
+	 */
+	void find_nearest_cities(koord k, uint32 count, vector_tpl<stadt_t *> &result) const;
+};
+
+#endif
@@ -659,6 +659,20 @@ void stadt_t::update_gebaeude_from_stadt(gebaeude_t* gb)
 }
 
 
+// the list is otherwise in the order the houses were built or renovated
+void stadt_t::sort_gebaeude()
+{
+	vector_tpl<gebaeude_t *> houses( buildings.get_count() );
+	for(  gebaeude_t *gb : buildings  ) {
+		houses.append( gb );
+	}
+	buildings.clear();
+	for(  gebaeude_t *gb : houses  ) {
+		buildings.insert_ordered( gb, gb->get_tile()->get_desc()->get_level()+1, compare_gebaeude_pos );
+	}
+}
+
+
 // returns true, if there is a halt serving at least one building of the town.
 bool stadt_t::is_within_players_network(const player_t* player) const
 {
@@ -711,6 +725,8 @@ void stadt_t::recalc_city_size()
 
 	lo.clip_min(koord(0,0));
 	ur.clip_max(koord(welt->get_size().x-1,welt->get_size().y-1));
+
+	welt->update_city_index(this);
 }
 
 
@@ -1657,7 +1673,7 @@ void stadt_t::city_growth_monthly(uint32 const month)
 }
 
 
-void stadt_t::new_month( bool recalc_destinations )
+void stadt_t::roll_statistics()
 {
 	swap<pax_dest_status_t>( pax_destinations_old, pax_destinations_new );
 	pax_destinations_new.clear();
@@ -1672,6 +1688,11 @@ void stadt_t::new_month( bool recalc_destinations )
 //	settings_t const& s = welt->get_settings();
 	target_factories_pax.recalc_generation_ratio( factory_worker_percentage, *city_history_month, MAX_CITY_HISTORY, HIST_PAS_GENERATED);
 	target_factories_mail.recalc_generation_ratio( factory_worker_percentage, *city_history_month, MAX_CITY_HISTORY, HIST_MAIL_GENERATED);
+}
+
+
+void stadt_t::new_month( bool recalc_destinations )
+{
 	recalc_target_cities();
 
 	// center has moved => change attraction weights
@@ -1833,6 +1854,13 @@ void stadt_t::step_grow_city( bool new_town )
 }
 
 
+vector_tpl<stadt_t::pax_packet_t> stadt_t::pending_pax;
+
+// the route queries and start halts of stadt_t::pending_pax, same order
+static vector_tpl<haltestelle_t::route_query_t> pending_queries;
+static vector_tpl<halthandle_t> pending_start_halts;
+
+
 /* this creates passengers and mail for everything. It is therefore one of the CPU hogs of the machine
  * think trice, before adding here ...
  */
@@ -1887,6 +1915,12 @@ void stadt_t::step_passagiere()
 
 	// only continue, if this is a good start halt
 	if(  !start_halts.empty()  ) {
+		// shared by all packets of this building
+		const uint32 first_start_halt = pending_start_halts.get_count();
+		for(halthandle_t halt : start_halts) {
+			pending_start_halts.append( halt );
+		}
+
 		// Find passenger destination
 		for(  uint32 pax_routed=0, pax_left_to_do=0;  pax_routed < num_pax;  pax_routed += pax_left_to_do  ) {
 			// number of passengers that want to travel
@@ -1913,171 +1947,30 @@ void stadt_t::step_passagiere()
 				factory_entry->factory->book_stat(pax_left_to_do, ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED);
 			}
 
-			ware_t pax(wtyp);
-			pax.set_target_pos(dest_pos);
-			pax.amount = pax_left_to_do;
-			pax.to_factory = ( factory_entry ? 1 : 0 );
-
-			ware_t return_pax(wtyp);
-
-			// now, finally search a route; this consumes most of the time
-			int const route_result = haltestelle_t::search_route( &start_halts[0], start_halts.get_count(), welt->get_settings().is_no_routing_over_overcrowding(), pax, &return_pax);
-			halthandle_t start_halt = return_pax.get_target_halt();
-
-			if(  route_result==haltestelle_t::ROUTE_OK  ) {
-				// so we have happy traveling passengers
-				start_halt->starte_mit_route(pax);
-				start_halt->add_pax_happy(pax.amount);
-
-				// people were transported so are logged
-				city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
-				city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
-
-				// destination logged
-				merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_REACHABLE);
-			}
-			else if(  route_result==haltestelle_t::ROUTE_WALK  ) {
-				if(  factory_entry  ) {
-					// workers and mail delivered instantly to factory
-					factory_entry->factory->liefere_an(wtyp, pax_left_to_do);
-				}
-
-				// log walked at stop
-				start_halt->add_pax_walked(pax_left_to_do);
-
-				// people who walk or deliver by hand logged as walking
-				city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
-				city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
-
-				// probably not a good idea to mark them as player only cares about remote traffic
-				//merke_passagier_ziel(dest_pos, gfx->palette_lookup(COL_YELLOW));
-			}
-			else if(  route_result==haltestelle_t::ROUTE_OVERCROWDED  ) {
-				// overcrowded routes cause unhappiness to be logged
-
-				if(  start_halt.is_bound()  ) {
-					start_halt->add_pax_unhappy(pax_left_to_do);
-				}
-				else {
-					// all routes to goal are overcrowded -> register at first stop (closest)
-					if (!start_halts.empty()) {
-						start_halts[0]->add_pax_unhappy(pax_left_to_do);
-					}
-				}
-
-				// destination logged
-				merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_ROUTE_OVERCROWDED);
-			}
-			else if (  route_result == haltestelle_t::NO_ROUTE  ) {
-				// since there is no route from any start halt -> register no route at first halts (closest)
-				if (!start_halts.empty()) {
-					start_halts[0]->add_pax_no_route(pax_left_to_do);
-				}
-				merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_NO_ROUTE);
-#ifdef DESTINATION_CITYCARS
-				//citycars with destination
-				generate_private_cars( origin_pos, dest_pos );
-#endif
-			}
-
-			// return passenger traffic
-			if(  will_return != no_return  ) {
-				// compute return amount
-				uint32 pax_return = pax_left_to_do;
-
-				// apply return modifiers
-				if(  will_return != city_return  &&  wtyp == goods_manager_t::mail  ) {
-					// attractions and factories return more mail than they receive
-					pax_return *= MAIL_RETURN_MULTIPLIER_PRODUCERS;
-				}
-
-				// log potential return passengers at destination city
-				dest_city->city_history_year[0][history_type + HIST_OFFSET_GENERATED] += pax_return;
-				dest_city->city_history_month[0][history_type + HIST_OFFSET_GENERATED] += pax_return;
-
-				// factories generate return traffic
-				if (  factory_entry  ) {
-					factory_entry->factory->book_stat(pax_return, (ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED));
-				}
-
-				// route type specific logic
-				if(  route_result == haltestelle_t::ROUTE_OK  ) {
-					// send return packet
-					halthandle_t return_halt = pax.get_target_halt();
-					if(  !return_halt->is_overcrowded(wtyp->get_index())  ) {
-						// stop can receive passengers
-
-						// register departed pax/mail at factory
-						if (factory_entry) {
-							factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
-						}
-
-						// setup ware packet
-						return_pax.amount = pax_return;
-						return_pax.set_target_pos(origin_pos);
-						return_halt->starte_mit_route(return_pax);
-
-						// log departed at stop
-						return_halt->add_pax_happy(pax_return);
-
-						// log departed at destination city
-						dest_city->city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
-						dest_city->city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
-					}
-					else {
-						// stop is crowded
-						return_halt->add_pax_unhappy(pax_return);
-					}
-
-				}
-				else if(  route_result == haltestelle_t::ROUTE_WALK  ) {
-					// walking can produce return flow as a result of commuters to industry, monuments or stupidly big stops
-
-					// register departed pax/mail at factory
-					if (  factory_entry  ) {
-						factory_entry->factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
-					}
-
-					// log walked at stop (source and destination stops are the same)
-					start_halt->add_pax_walked(pax_return);
-
-					// log people who walk or deliver by hand
-					dest_city->city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_return;
-					dest_city->city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_return;
-				}
-				else if(  route_result == haltestelle_t::ROUTE_OVERCROWDED  ) {
-					// overcrowded routes cause unhappiness to be logged
-
-					if (pax.get_target_halt().is_bound()) {
-						pax.get_target_halt()->add_pax_unhappy(pax_return);
-					}
-					else {
-						// the unhappy passengers will be added to the first stops near destination (might be none)
-						const planquadrat_t *const dest_plan = welt->access(dest_pos);
-						const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
-						for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
-							halthandle_t halt = dest_halt_list[h];
-							if (halt->is_enabled(wtyp)) {
-								halt->add_pax_unhappy(pax_return);
-								break;
-							}
-						}
-					}
-				}
-				else if (route_result == haltestelle_t::NO_ROUTE) {
-					// passengers who cannot find a route will be added to the first stops near destination (might be none)
-					const planquadrat_t *const dest_plan = welt->access(dest_pos);
-					const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
-					for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
-						halthandle_t halt = dest_halt_list[h];
-						if (halt->is_enabled(wtyp)) {
-							halt->add_pax_no_route(pax_return);
-							break;
-						}
-					}
-				}
-			}
-			INT_CHECK( "simcity 1579" );
+			// the route is searched later for the packets of all cities at once, see route_passagiere()
+			pax_packet_t packet;
+			packet.city = this;
+			packet.dest_city = dest_city;
+			packet.factory = factory_entry ? factory_entry->factory : NULL;
+			packet.origin_pos = origin_pos;
+			packet.first_start_halt = first_start_halt;
+			packet.start_halt_count = start_halts.get_count();
+			packet.will_return = will_return;
+			packet.ispass = ispass;
+			pending_pax.append( packet );
+
+			haltestelle_t::route_query_t query;
+			query.start_halts = NULL; // set by route_passagiere(), since pending_start_halts may still grow
+			query.start_halt_count = start_halts.get_count();
+			query.no_routing_over_overcrowding = welt->get_settings().is_no_routing_over_overcrowding();
+			query.with_return_ware = true;
+			query.ware = ware_t(wtyp);
+			query.ware.set_target_pos(dest_pos);
+			query.ware.amount = pax_left_to_do;
+			query.ware.to_factory = ( factory_entry ? 1 : 0 );
+			query.return_ware = ware_t(wtyp);
+			query.result = haltestelle_t::NO_ROUTE;
+			pending_queries.append( query );
 		}
 	}
 	else {
@@ -2170,6 +2063,196 @@ void stadt_t::step_passagiere()
 }
 
 
+void stadt_t::route_passagiere()
+{
+	if(  pending_pax.empty()  ) {
+		return;
+	}
+
+	for(  uint32 i = 0;  i < pending_queries.get_count();  i++  ) {
+		pending_queries[i].start_halts = &pending_start_halts[ pending_pax[i].first_start_halt ];
+	}
+
+	// now, finally search the routes; this consumes most of the time
+	haltestelle_t::search_routes( pending_queries );
+
+	// book them in the order they were generated, so the result does not depend on the threads
+	for(  uint32 i = 0;  i < pending_pax.get_count();  i++  ) {
+		haltestelle_t::route_query_t &query = pending_queries[i];
+		pending_pax[i].city->book_pax_packet( pending_pax[i], query.ware, query.return_ware, query.result );
+		if(  (i & 15) == 15  ) {
+			INT_CHECK( "simcity 1579" );
+		}
+	}
+
+	pending_pax.clear();
+	pending_queries.clear();
+	pending_start_halts.clear();
+}
+
+
+void stadt_t::book_pax_packet(const pax_packet_t &packet, ware_t &pax, ware_t &return_pax, int route_result)
+{
+	const bool ispass = packet.ispass;
+	const goods_desc_t *const wtyp = ispass ? goods_manager_t::passengers : goods_manager_t::mail;
+	const uint32 history_type = ispass ? HIST_BASE_PASS : HIST_BASE_MAIL;
+	const uint32 pax_left_to_do = pax.amount;
+	const koord dest_pos = pax.get_target_pos();
+
+	halthandle_t start_halt = return_pax.get_target_halt();
+
+	if(  route_result==haltestelle_t::ROUTE_OK  ) {
+		// so we have happy traveling passengers
+		start_halt->starte_mit_route(pax);
+		start_halt->add_pax_happy(pax.amount);
+
+		// people were transported so are logged
+		city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
+		city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_left_to_do;
+
+		// destination logged
+		merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_REACHABLE);
+	}
+	else if(  route_result==haltestelle_t::ROUTE_WALK  ) {
+		if(  packet.factory  ) {
+			// workers and mail delivered instantly to factory
+			packet.factory->liefere_an(wtyp, pax_left_to_do);
+		}
+
+		// log walked at stop
+		start_halt->add_pax_walked(pax_left_to_do);
+
+		// people who walk or deliver by hand logged as walking
+		city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
+		city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_left_to_do;
+
+		// probably not a good idea to mark them as player only cares about remote traffic
+		//merke_passagier_ziel(dest_pos, gfx->palette_lookup(COL_YELLOW));
+	}
+	else if(  route_result==haltestelle_t::ROUTE_OVERCROWDED  ) {
+		// overcrowded routes cause unhappiness to be logged
+
+		if(  start_halt.is_bound()  ) {
+			start_halt->add_pax_unhappy(pax_left_to_do);
+		}
+		else {
+			// all routes to goal are overcrowded -> register at first stop (closest)
+			pending_start_halts[packet.first_start_halt]->add_pax_unhappy(pax_left_to_do);
+		}
+
+		// destination logged
+		merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_ROUTE_OVERCROWDED);
+	}
+	else if (  route_result == haltestelle_t::NO_ROUTE  ) {
+		// since there is no route from any start halt -> register no route at first halts (closest)
+		pending_start_halts[packet.first_start_halt]->add_pax_no_route(pax_left_to_do);
+		merke_passagier_ziel(dest_pos, PAX_DEST_STATUS_NO_ROUTE);
+#ifdef DESTINATION_CITYCARS
+		//citycars with destination
+		generate_private_cars( packet.origin_pos, dest_pos );
+#endif
+	}
+
+	// return passenger traffic
+	if(  packet.will_return != no_return  ) {
+		// compute return amount
+		uint32 pax_return = pax_left_to_do;
+
+		// apply return modifiers
+		if(  packet.will_return != city_return  &&  wtyp == goods_manager_t::mail  ) {
+			// attractions and factories return more mail than they receive
+			pax_return *= MAIL_RETURN_MULTIPLIER_PRODUCERS;
+		}
+
+		// log potential return passengers at destination city
+		packet.dest_city->city_history_year[0][history_type + HIST_OFFSET_GENERATED] += pax_return;
+		packet.dest_city->city_history_month[0][history_type + HIST_OFFSET_GENERATED] += pax_return;
+
+		// factories generate return traffic
+		if(  packet.factory  ) {
+			packet.factory->book_stat(pax_return, (ispass ? FAB_PAX_GENERATED : FAB_MAIL_GENERATED));
+		}
+
+		// route type specific logic
+		if(  route_result == haltestelle_t::ROUTE_OK  ) {
+			// send return packet
+			halthandle_t return_halt = pax.get_target_halt();
+			if(  !return_halt->is_overcrowded(wtyp->get_index())  ) {
+				// stop can receive passengers
+
+				// register departed pax/mail at factory
+				if(  packet.factory  ) {
+					packet.factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
+				}
+
+				// setup ware packet
+				return_pax.amount = pax_return;
+				return_pax.set_target_pos(packet.origin_pos);
+				return_halt->starte_mit_route(return_pax);
+
+				// log departed at stop
+				return_halt->add_pax_happy(pax_return);
+
+				// log departed at destination city
+				packet.dest_city->city_history_year[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
+				packet.dest_city->city_history_month[0][history_type + HIST_OFFSET_TRANSPORTED] += pax_return;
+			}
+			else {
+				// stop is crowded
+				return_halt->add_pax_unhappy(pax_return);
+			}
+
+		}
+		else if(  route_result == haltestelle_t::ROUTE_WALK  ) {
+			// walking can produce return flow as a result of commuters to industry, monuments or stupidly big stops
+
+			// register departed pax/mail at factory
+			if(  packet.factory  ) {
+				packet.factory->book_stat(pax_return, ispass ? FAB_PAX_DEPARTED : FAB_MAIL_DEPARTED);
+			}
+
+			// log walked at stop (source and destination stops are the same)
+			start_halt->add_pax_walked(pax_return);
+
+			// log people who walk or deliver by hand
+			packet.dest_city->city_history_year[0][history_type + HIST_OFFSET_WALKED] += pax_return;
+			packet.dest_city->city_history_month[0][history_type + HIST_OFFSET_WALKED] += pax_return;
+		}
+		else if(  route_result == haltestelle_t::ROUTE_OVERCROWDED  ) {
+			// overcrowded routes cause unhappiness to be logged
+
+			if (pax.get_target_halt().is_bound()) {
+				pax.get_target_halt()->add_pax_unhappy(pax_return);
+			}
+			else {
+				// the unhappy passengers will be added to the first stops near destination (might be none)
+				const planquadrat_t *const dest_plan = welt->access(dest_pos);
+				const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
+				for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
+					halthandle_t halt = dest_halt_list[h];
+					if (halt->is_enabled(wtyp)) {
+						halt->add_pax_unhappy(pax_return);
+						break;
+					}
+				}
+			}
+		}
+		else if (route_result == haltestelle_t::NO_ROUTE) {
+			// passengers who cannot find a route will be added to the first stops near destination (might be none)
+			const planquadrat_t *const dest_plan = welt->access(dest_pos);
+			const halthandle_t *const dest_halt_list = dest_plan->get_haltlist();
+			for (uint h = 0; h < dest_plan->get_haltlist_count(); h++) {
+				halthandle_t halt = dest_halt_list[h];
+				if (halt->is_enabled(wtyp)) {
+					halt->add_pax_no_route(pax_return);
+					break;
+				}
+			}
+		}
+	}
+}
+
+
 koord stadt_t::get_zufallspunkt() const
 {
 	if(!buildings.empty()) {
@@ -2699,6 +2782,7 @@ void stadt_t::check_bau_townhall(bool new_town, const building_desc_t* desc, sin
 			pos = new_pos;
 			welt->lookup_kartenboden(pos)->set_text( name );
 		}
+		welt->update_city_index(this);
 	}
 }
 
@@ -21,6 +21,7 @@ class building_desc_t;
 class karte_ptr_t;
 class player_t;
 class rule_t;
+class ware_t;
 class way_desc_t;
 
 
@@ -368,6 +369,23 @@ private:
 	 */
 	void step_passagiere();
 
+	/// a packet generated by step_passagiere(), which is routed by route_passagiere()
+	struct pax_packet_t
+	{
+		stadt_t *city;
+		stadt_t *dest_city;
+		fabrik_t *factory;
+		koord origin_pos;
+		uint32 first_start_halt; ///< index in the start halts of all packets
+		uint16 start_halt_count;
+		uint8 will_return;       ///< pax_return_type
+		bool ispass;
+	};
+	static vector_tpl<pax_packet_t> pending_pax;
+
+	/// books the route found for @p packet, and starts the passengers and their return trip
+	void book_pax_packet(const pax_packet_t &packet, ware_t &pax, ware_t &return_pax, int route_result);
+
 	/**
 	 * ein Passagierziel in die Zielkarte eintragen
 	 */
@@ -473,6 +491,9 @@ public:
 	// changes the weight; must be called if there is a new definition (tile) for that house
 	void update_gebaeude_from_stadt(gebaeude_t *gb);
 
+	// sorts the house list by position, as loading does
+	void sort_gebaeude();
+
 	/**
 	* Returns the finance history for cities
 	*/
@@ -565,6 +586,19 @@ public:
 
 	void step(uint32 delta_t);
 
+	/**
+	 * Routes the passengers and mail generated by step() of all cities at once (see haltestelle_t::search_routes()).
+	 * Must be called after the cities are stepped, before anything else changes the halts.
+	 */
+	static void route_passagiere();
+
+	/**
+	 * First part of the monthly update: rolls history, growth and factory statistics.
+	 * Only this city is changed, so it may run for several cities in parallel.
+	 */
+	void roll_statistics();
+
+	/// second part of the monthly update, after roll_statistics() of all cities
 	void new_month( bool recalc_destinations );
 
 private:
@@ -13,6 +13,7 @@
 #include <sys/stat.h>
 
 #include "simcity.h"
+#include "step_profiler.h"
 #include "../simcolor.h"
 #include "../simconvoi.h"
 #include "../simdebug.h"
@@ -77,6 +78,7 @@
 #include "../network/network_file_transfer.h"
 #include "../network/network_socket_list.h"
 #include "../network/network_cmd_ingame.h"
+#include "../network/network_packet.h"
 
 #include "../dataobj/height_map_loader.h"
 #include "../dataobj/ribi.h"
@@ -157,6 +159,10 @@ typedef struct{
 	sem_t* wait_for_previous;
 	sem_t* signal_to_next;
 	xy_loop_func function;
+	index_loop_func index_function;
+	void *index_data;
+	uint32 index_min;
+	uint32 index_max;
 	bool keep_running;
 } world_thread_param_t;
 
@@ -172,22 +178,27 @@ void *karte_t::world_xy_loop_thread(void *ptr)
 	do {
 		simthread_barrier_wait( &world_barrier_start ); // wait for all to start
 
-		sint16 x_min = 0;
-		sint16 x_max = param->x_step;
+		if(  param->index_function  ) {
+			param->index_function(param->index_data, param->thread_num, param->index_min, param->index_max);
+		}
+		else {
+			sint16 x_min = 0;
+			sint16 x_max = param->x_step;
 
-		while(  x_min < param->x_world_max  ) {
-			// wait for predecessor to finish its block
-			if(  param->wait_for_previous  ) {
-				sem_wait( param->wait_for_previous );
-			}
-			(param->welt->*(param->function))(x_min, x_max, param->y_min, param->y_max);
+			while(  x_min < param->x_world_max  ) {
+				// wait for predecessor to finish its block
+				if(  param->wait_for_previous  ) {
+					sem_wait( param->wait_for_previous );
+				}
+				(param->welt->*(param->function))(x_min, x_max, param->y_min, param->y_max);
 
-			// signal to next thread that we finished one block
-			if(  param->signal_to_next  ) {
-				sem_post( param->signal_to_next );
+				// signal to next thread that we finished one block
+				if(  param->signal_to_next  ) {
+					sem_post( param->signal_to_next );
+				}
+				x_min = x_max;
+				x_max = min(x_max + param->x_step, param->x_world_max);
 			}
-			x_min = x_max;
-			x_max = min(x_max + param->x_step, param->x_world_max);
 		}
 
 		// the main thread writes to param->keep_running between world_barrier_end and world_barrier_start
@@ -199,6 +210,30 @@ void *karte_t::world_xy_loop_thread(void *ptr)
 
 	return NULL;
 }
+
+
+void karte_t::spawn_world_threads()
+{
+	if(  !spawned_world_threads  ) {
+		// we can do the parallel display using posix threads ...
+		pthread_t thread[MAX_THREADS];
+		/* Initialize and set thread detached attribute */
+		pthread_attr_t attr;
+		pthread_attr_init( &attr );
+		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+		// init barrier
+		simthread_barrier_init( &world_barrier_start, NULL, env_t::num_threads );
+		simthread_barrier_init( &world_barrier_end, NULL, env_t::num_threads );
+
+		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
+			if(  pthread_create( &thread[t], &attr, world_xy_loop_thread, (void *)&world_thread_param[t] )  ) {
+				dbg->fatal( "karte_t::world_xy_loop()", "cannot multithread, error at thread #%i", t+1 );
+			}
+		}
+		spawned_world_threads = true;
+		pthread_attr_destroy( &attr );
+	}
+}
 #endif
 
 
@@ -227,6 +262,7 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 		world_thread_param[t].y_min = (t * max_y) / env_t::num_threads;
 		world_thread_param[t].y_max = ((t + 1) * max_y) / env_t::num_threads;
 		world_thread_param[t].function = function;
+		world_thread_param[t].index_function = NULL;
 
 		world_thread_param[t].wait_for_previous = sync_x_steps  &&  t > 0 ? &sems[t-1] : NULL;
 		world_thread_param[t].signal_to_next    = sync_x_steps  &&  t < env_t::num_threads - 1 ? &sems[t] : NULL;
@@ -234,25 +270,7 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 		world_thread_param[t].keep_running = t < env_t::num_threads - 1;
 	}
 
-	if(  !spawned_world_threads  ) {
-		// we can do the parallel display using posix threads ...
-		pthread_t thread[MAX_THREADS];
-		/* Initialize and set thread detached attribute */
-		pthread_attr_t attr;
-		pthread_attr_init( &attr );
-		pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
-		// init barrier
-		simthread_barrier_init( &world_barrier_start, NULL, env_t::num_threads );
-		simthread_barrier_init( &world_barrier_end, NULL, env_t::num_threads );
-
-		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
-			if(  pthread_create( &thread[t], &attr, world_xy_loop_thread, (void *)&world_thread_param[t] )  ) {
-				dbg->fatal( "karte_t::world_xy_loop()", "cannot multithread, error at thread #%i", t+1 );
-			}
-		}
-		spawned_world_threads = true;
-		pthread_attr_destroy( &attr );
-	}
+	spawn_world_threads();
 
 	// and start processing; the last we can run ourselves
 	world_xy_loop_thread(&world_thread_param[env_t::num_threads-1]);
@@ -273,6 +291,67 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 }
 
 
+void karte_t::world_index_loop(index_loop_func function, void *data, uint32 count)
+{
+	// interrupt_check() would call sync_step() and display in the middle of this
+	const bool old_intr = intr_is_enabled();
+	intr_disable();
+
+#ifdef MULTI_THREAD
+	set_random_mode( INTERACTIVE_RANDOM ); // do not allow simrand() here!
+
+	for(  int t = 0;  t < env_t::num_threads;  t++  ) {
+		world_thread_param[t].welt = this;
+		world_thread_param[t].thread_num = t;
+		world_thread_param[t].function = NULL;
+		world_thread_param[t].index_function = function;
+		world_thread_param[t].index_data = data;
+		world_thread_param[t].index_min = (uint32)(((uint64)t * count) / env_t::num_threads);
+		world_thread_param[t].index_max = (uint32)(((uint64)(t + 1) * count) / env_t::num_threads);
+		world_thread_param[t].wait_for_previous = NULL;
+		world_thread_param[t].signal_to_next = NULL;
+		world_thread_param[t].keep_running = t < env_t::num_threads - 1;
+	}
+
+	spawn_world_threads();
+
+	// and start processing; the last we can run ourselves
+	world_xy_loop_thread(&world_thread_param[env_t::num_threads-1]);
+
+	clear_random_mode( INTERACTIVE_RANDOM );
+#else
+	function( data, 0, 0, count );
+#endif
+
+	if(  old_intr  ) {
+		intr_enable();
+	}
+}
+
+
+void karte_t::prepare_convois_loop(void *welt, int, uint32 first, uint32 last)
+{
+	const vector_tpl<convoihandle_t> &convoi_array = ((karte_t *)welt)->convoi_array;
+	for(  uint32 i = first;  i < last;  i++  ) {
+		convoi_array[i]->prepare_step();
+	}
+}
+
+
+/**
+ * Monthly roll of the statistics for a list of factories, cities, convois or halts (multithreaded).
+ * roll_statistics() only changes its own object and must not use simrand(),
+ * so the result is the same as in a serial loop.
+ */
+template<class list_t> static void roll_statistics_loop(void *list, int, uint32 first, uint32 last)
+{
+	const list_t &objects = *(const list_t *)list;
+	for(  uint32 i = first;  i < last;  i++  ) {
+		objects[i]->roll_statistics();
+	}
+}
+
+
 void karte_t::recalc_season_snowline(bool set_pending)
 {
 	static const sint8 mfactor[12] = { 99, 95, 80, 50, 25, 10, 0, 5, 20, 35, 65, 85 };
@@ -565,6 +644,7 @@ stadt_t *karte_t::create_city(const koord pos, sint32 citizens, const building_d
 
 	settings.set_city_count(settings.get_city_count() + 1);
 	cities.append(new_city, new_city->get_einwohner());
+	city_index.add(new_city);
 
 	// add links between this city and other cities as well as attractions
 	for(stadt_t *city : cities) {
@@ -589,6 +669,7 @@ bool karte_t::remove_city(stadt_t *s)
 		DBG_MESSAGE("karte_t::remove_city()", "%s", s->get_name());
 	}
 	cities.remove(s);
+	city_index.remove(s);
 	DBG_DEBUG4("karte_t::remove_city()", "reduce city to %i", settings.get_city_count() - 1);
 	settings.set_city_count(settings.get_city_count() - 1);
 
@@ -668,6 +749,10 @@ void karte_t::init_tiles()
 
 	tile_counter = 0;
 
+	month_spread_steps_left = 0;
+	month_spread_convoi = 0;
+	month_spread_halt = 0;
+
 	convoihandle_t::init( 1024 );
 	linehandle_t::init( 1024 );
 
@@ -1691,6 +1776,7 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 	cached_size_max = max(cached_grid_size.x,cached_grid_size.y);
 	cached_size.x = cached_grid_size.x-1;
 	cached_size.y = cached_grid_size.y-1;
+	rebuild_city_index();
 
 	intr_disable();
 
@@ -2022,6 +2108,9 @@ karte_t::karte_t() :
 	network_frame_count = 0;
 	sync_steps = 0;
 	sync_steps_barrier = sync_steps;
+	digest_tiles_sum = 0;
+	digest_next_row = 0;
+	digest_check_full = digest_check_fresh = 0;
 
 	for(  uint i=0;  i<MAX_PLAYER_COUNT;  i++  ) {
 		selected_tool[i] = tool_t::general_tool[TOOL_QUERY];
@@ -2072,6 +2161,8 @@ karte_t::~karte_t()
 {
 	is_sound = false;
 
+	loadsave_t::finish_background_save();
+
 	destroy();
 
 	// not deleting the tools of this map ...
@@ -2426,6 +2517,7 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	for (stadt_t* const i : cities) {
 		i->rotate90(cached_size.x);
 	}
+	rebuild_city_index();
 
 	// fixed order factory, halts, convois
 	for (fabrik_t* const f : all_factories) {
@@ -2605,36 +2697,19 @@ void karte_t::remove_label(koord k)
 
 stadt_t *karte_t::find_nearest_city(const koord k) const
 {
-	uint32 min_dist = 99999999;
-	bool contains = false;
-	stadt_t *best = NULL; // within city limits
-
-	if(  is_within_limits(k)  ) {
-		for(stadt_t* const s :  cities  ) {
-			if(  k.x >= s->get_linksoben().x  &&  k.y >= s->get_linksoben().y  &&  k.x < s->get_rechtsunten().x  &&  k.y < s->get_rechtsunten().y  ) {
-				const uint32 dist = koord_distance( k, s->get_center() );
-				if(  !contains  ) {
-					// no city within limits => this is best
-					best = s;
-					min_dist = dist;
-				}
-				else if(  dist < min_dist  ) {
-					best = s;
-					min_dist = dist;
-				}
-				contains = true;
-			}
-			else if(  !contains  ) {
-				// so far no cities found within its city limit
-				const uint32 dist = koord_distance( k, s->get_center() );
-				if(  dist < min_dist  ) {
-					best = s;
-					min_dist = dist;
-				}
-			}
-		}
+	if(  !is_within_limits(k)  ) {
+		return NULL;
+	}
+	return city_index.find_nearest_city(k);
+}
+
+
+void karte_t::rebuild_city_index()
+{
+	city_index.reset( get_size() );
+	for(stadt_t* const s : cities) {
+		city_index.add(s);
 	}
-	return best;
 }
 
 
@@ -2647,6 +2722,8 @@ stadt_t *karte_t::find_nearest_city(const koord k) const
 void karte_t::sync_step(uint32 delta_t)
 {
 	set_random_mode( SYNC_STEP_RANDOM );
+	step_profiler_t::count_sync_step();
+	step_profiler_t::timer_t timer;
 
 	// only omitted, when called to display a new frame during fast forward
 
@@ -2677,6 +2754,8 @@ void karte_t::sync_step(uint32 delta_t)
 
 	sync.sync_step( delta_t );
 
+	timer.lap( step_profiler_t::SYNC_STEP );
+
 	ticker::update();
 
 	clear_random_mode( SYNC_STEP_RANDOM );
@@ -2878,10 +2957,82 @@ inline sint32 get_population(stadt_t const* const c)
 }
 
 
+void karte_t::step_month_spread()
+{
+	if(  month_spread_steps_left == 0  ) {
+		return;
+	}
+	if(  month_spread_steps_left == 1  ) {
+		finish_month_spread();
+		return;
+	}
+
+	// an equal share of the remaining objects in each step, in list order like without spreading
+	const uint32 convoi_count = convoi_array.get_count();
+	if(  month_spread_convoi < convoi_count  ) {
+		const uint32 end = month_spread_convoi + (convoi_count - month_spread_convoi + month_spread_steps_left - 1) / month_spread_steps_left;
+		for(  ;  month_spread_convoi < end  &&  month_spread_convoi < convoi_array.get_count();  month_spread_convoi++  ) {
+			convoihandle_t const cnv = convoi_array[month_spread_convoi];
+			if(  cnv->is_month_pending()  ) {
+				cnv->roll_statistics();
+				cnv->new_month();
+			}
+		}
+	}
+
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	if(  month_spread_halt < halts.get_count()  ) {
+		const uint32 end = month_spread_halt + (halts.get_count() - month_spread_halt + month_spread_steps_left - 1) / month_spread_steps_left;
+		for(  ;  month_spread_halt < end;  month_spread_halt++  ) {
+			halthandle_t const halt = halts[month_spread_halt];
+			if(  halt->is_month_pending()  ) {
+				halt->new_month();
+				halt->roll_statistics();
+			}
+		}
+	}
+
+	month_spread_steps_left--;
+}
+
+
+void karte_t::finish_month_spread()
+{
+	if(  month_spread_steps_left == 0  ) {
+		return;
+	}
+
+	// backwards, since objects may have moved to lower indices after a removal
+	for(  uint32 i = convoi_array.get_count();  i-- > 0;  ) {
+		convoihandle_t const cnv = convoi_array[i];
+		if(  cnv->is_month_pending()  ) {
+			cnv->roll_statistics();
+			cnv->new_month();
+		}
+	}
+
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	for(  uint32 i = halts.get_count();  i-- > 0;  ) {
+		halthandle_t const halt = halts[i];
+		if(  halt->is_month_pending()  ) {
+			halt->new_month();
+			halt->roll_statistics();
+		}
+	}
+
+	month_spread_steps_left = 0;
+	month_spread_convoi = 0;
+	month_spread_halt = 0;
+}
+
+
 void karte_t::new_month()
 {
 	bool need_locality_update = false;
 
+	// the last month must be complete before its statistics are rolled again
+	finish_month_spread();
+
 	update_history();
 
 	// advance history ...
@@ -2910,16 +3061,18 @@ void karte_t::new_month()
 	DBG_MESSAGE( "karte_t::new_month()", "Month (%d/%d) has started", (last_month % 12) + 1, last_month / 12 );
 
 	// this should be done before a map update, since the map may want an update of the way usage
-	for(weg_t* const w : weg_t::get_alle_wege() ) {
-		w->new_month();
-	}
+	weg_t::new_month_all();
 
 	// recalc old settings (and maybe update the stops with the current values)
 	minimap_t::get_instance()->set_dirty();
 
 	INT_CHECK( "simworld 1701" );
 
+	// each step below first rolls the statistics of all objects in parallel,
+	// then does everything touching other objects or the random generator in the old order
+
 //	DBG_MESSAGE("karte_t::new_month()","factories");
+	world_index_loop( roll_statistics_loop< vector_tpl<fabrik_t *> >, &all_factories, all_factories.get_count() );
 	for(fabrik_t* const fab : all_factories) {
 		fab->new_month();
 	}
@@ -2928,6 +3081,7 @@ void karte_t::new_month()
 
 //	DBG_MESSAGE("karte_t::new_month()","cities");
 	cities.update_weights(get_population);
+	world_index_loop( roll_statistics_loop< weighted_vector_tpl<stadt_t *> >, &cities, cities.get_count() );
 	for(stadt_t* const i : cities) {
 		i->new_month(need_locality_update);
 	}
@@ -2954,8 +3108,18 @@ void karte_t::new_month()
 
 	//	DBG_MESSAGE("karte_t::new_month()","convois");
 	// call new month for convois, must be after player, because fixed costs are booked here and to connected lines
-	for(convoihandle_t const cnv : convoi_array) {
-		cnv->new_month();
+	// with month_spread_steps this is done during the next steps instead (see step_month_spread())
+	const uint16 spread_steps = settings.get_month_spread_steps();
+	if(  spread_steps == 0  ) {
+		world_index_loop( roll_statistics_loop< vector_tpl<convoihandle_t> >, &convoi_array, convoi_array.get_count() );
+		for(convoihandle_t const cnv : convoi_array) {
+			cnv->new_month();
+		}
+	}
+	else {
+		for(convoihandle_t const cnv : convoi_array) {
+			cnv->set_month_pending();
+		}
 	}
 
 	INT_CHECK("simworld 1701");
@@ -2967,9 +3131,21 @@ void karte_t::new_month()
 	INT_CHECK("simworld 1289");
 
 //	DBG_MESSAGE("karte_t::new_month()","halts");
-	for(halthandle_t const s : haltestelle_t::get_alle_haltestellen()) {
-		s->new_month();
-		INT_CHECK("simworld 1877");
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	if(  spread_steps == 0  ) {
+		for(halthandle_t const s : halts) {
+			s->new_month();
+			INT_CHECK("simworld 1877");
+		}
+		world_index_loop( roll_statistics_loop< vector_tpl<halthandle_t> >, const_cast<vector_tpl<halthandle_t> *>(&halts), halts.get_count() );
+	}
+	else {
+		for(halthandle_t const s : halts) {
+			s->set_month_pending();
+		}
+		month_spread_steps_left = spread_steps;
+		month_spread_convoi = 0;
+		month_spread_halt = 0;
 	}
 
 	INT_CHECK("simworld 2522");
@@ -2997,7 +3173,7 @@ void karte_t::new_month()
 		cbuffer_t buf;
 		dr_chdir(env_t::user_dir); // make sure we are in the right directory
 		buf.printf( SAVE_PATH_X "autosave%02i.sve", last_month+1 );
-		save( buf, true, env_t::savegame_version_str, true );
+		save( buf, true, env_t::savegame_version_str, true, env_t::background_autosave );
 	}
 }
 
@@ -3155,6 +3331,8 @@ void karte_t::step()
 {
 	DBG_DEBUG4("karte_t::step", "start step");
 	uint32 step_start_time = dr_time();
+	step_profiler_t::count_step();
+	step_profiler_t::timer_t timer;
 
 	// calculate delta_t before handling overflow in ticks
 	uint32 delta_t = ticks - last_step_ticks;
@@ -3171,7 +3349,9 @@ void karte_t::step()
 		next_month_ticks += karte_t::ticks_per_world_month;
 
 		DBG_DEBUG4("karte_t::step", "calling new_month");
+		step_profiler_t::end_month( current_month+1 );
 		new_month();
+		timer.lap( step_profiler_t::NEW_MONTH );
 	}
 
 	DBG_DEBUG4("karte_t::step", "time calculations");
@@ -3255,10 +3435,18 @@ void karte_t::step()
 		}
 	}
 
+	// monthly update of convois and halts left over from new_month()
+	step_month_spread();
+
 	// to make sure the tick counter will be updated
 	INT_CHECK("karte_t::step");
+	timer.lap( step_profiler_t::MISC );
 
 	DBG_DEBUG4("karte_t::step", "step convois");
+	if(  env_t::parallel_convoi_step  &&  env_t::num_threads > 1  ) {
+		// route searches in parallel; convoi_t::step() uses the results below in the same order as without
+		world_index_loop( prepare_convois_loop, this, convoi_array.get_count() );
+	}
 	// since convois will be deleted during stepping, we need to step backwards
 	for (sint32 i = (sint32)convoi_array.get_count(); i-- > 0; ) {
 		convoihandle_t cnv = convoi_array[i];
@@ -3267,6 +3455,7 @@ void karte_t::step()
 			INT_CHECK("simworld 1947");
 		}
 	}
+	timer.lap( step_profiler_t::CONVOIS );
 
 	// now step all towns (to generate passengers)
 	DBG_DEBUG4("karte_t::step", "step cities");
@@ -3276,21 +3465,25 @@ void karte_t::step()
 		c->step(delta_t);
 		bev += c->get_finance_history_month(0, HIST_CITIZENS);
 	}
+	stadt_t::route_passagiere();
 
 	// the inhabitants stuff
 	finance_history_month[0][WORLD_CITIZENS] = bev;
+	timer.lap( step_profiler_t::CITIES );
 
 	DBG_DEBUG4("karte_t::step", "step factories");
 	for (uint32 i = 0; i < all_factories.get_count(); i++) {
 		all_factories[i]->step(delta_t);
 	}
 	finance_history_year[0][WORLD_FACTORIES] = finance_history_month[0][WORLD_FACTORIES] = all_factories.get_count();
+	timer.lap( step_profiler_t::FACTORIES );
 
 	// step powerlines - required order: powernet, pumpe then senke
 	DBG_DEBUG4("karte_t::step", "step poweline stuff");
 	powernet_t::step_all(delta_t);
 	pumpe_t::sync_handler(delta_t);
 //	senke_t::step_all(delta_t); // not needed, handeld by sunc_step already
+	timer.lap( step_profiler_t::POWERNET );
 
 	DBG_DEBUG4("karte_t::step", "step players");
 	// then step all players
@@ -3299,9 +3492,11 @@ void karte_t::step()
 			players[i]->step();
 		}
 	}
+	timer.lap( step_profiler_t::PLAYERS );
 
 	DBG_DEBUG4("karte_t::step", "step halts");
 	haltestelle_t::step_all();
+	timer.lap( step_profiler_t::HALTS );
 
 	// ok, next step
 	INT_CHECK("simworld 1975");
@@ -3336,6 +3531,8 @@ void karte_t::step()
 		delete tmp_tool;
 	}
 
+	timer.lap( step_profiler_t::MISC );
+
 	if(  get_scenario()->is_scripted() ) {
 		get_scenario()->step();
 	}
@@ -3345,6 +3542,7 @@ void karte_t::step()
 			esb->step(get_active_player());
 		}
 	}
+	timer.lap( step_profiler_t::SCENARIO );
 
 	DBG_DEBUG4("karte_t::step", "end");
 }
@@ -3561,10 +3759,17 @@ bool karte_t::play_sound_area_clipped(koord const k, uint16 const idx, sound_typ
 }
 
 
-void karte_t::save(const char *filename, bool autosave, const char *version_str, bool silent )
+void karte_t::save(const char *filename, bool autosave, const char *version_str, bool silent, bool background )
 {
 	dbg->message("karte_t::save", "%s game to '%s', version=%s, ticks=%u", autosave ? "Auto-saving" : "Saving", filename, version_str, ticks);
 
+	// the last background save may still write to the same file
+	if(  const char *prev_err = loadsave_t::finish_background_save()  ) {
+		static char err_str[512];
+		sprintf( err_str, translator::translate("Error during saving:\n%s"), prev_err );
+		create_win( new news_img(err_str), w_time_delete, magic_none);
+	}
+
 	loadsave_t  file;
 	std::string savename = filename;
 	savename[savename.length()-1] = '_';
@@ -3573,7 +3778,11 @@ void karte_t::save(const char *filename, bool autosave, const char *version_str,
 	const loadsave_t::mode_t mode = autosave ? loadsave_t::autosave_mode : loadsave_t::save_mode;
 	const int save_level = autosave ? loadsave_t::autosave_level : loadsave_t::save_level;
 
-	if(  file.wr_open( savename.c_str(), mode, save_level, env_t::pak_name.c_str(), version_str ) != loadsave_t::FILE_STATUS_OK  ) {
+	const loadsave_t::file_status_t status = background ?
+		file.wr_open_background( savename.c_str(), filename, mode, save_level, env_t::pak_name.c_str(), version_str ) :
+		file.wr_open( savename.c_str(), mode, save_level, env_t::pak_name.c_str(), version_str );
+
+	if(  status != loadsave_t::FILE_STATUS_OK  ) {
 		create_win(new news_img("Kann Spielstand\nnicht speichern.\n"), w_info, magic_none);
 		dbg->error("karte_t::save", "Cannot open file '%s' for writing! Check permissions!", savename.c_str());
 	}
@@ -3586,7 +3795,10 @@ void karte_t::save(const char *filename, bool autosave, const char *version_str,
 			create_win( new news_img(err_str), w_time_delete, magic_none);
 		}
 		else {
-			dr_rename( savename.c_str(), filename );
+			if(  !background  ) {
+				// else renamed by the background thread when written
+				dr_rename( savename.c_str(), filename );
+			}
 			if(!silent) {
 				create_win( new news_img("Spielstand wurde\ngespeichert!\n"), w_time_delete, magic_none);
 				// update the filename, if no autosave
@@ -3717,6 +3929,12 @@ DBG_MESSAGE("karte_t::save(loadsave_t *file)", "saved messages");
 		records->rdwr(file);
 	}
 
+	if (file->is_version_atleast(124, 6)) {
+		file->rdwr_short( month_spread_steps_left );
+		file->rdwr_long( month_spread_convoi );
+		file->rdwr_long( month_spread_halt );
+	}
+
 	file->rdwr_byte( active_player_nr );
 
 	// save all open windows (upon request)
@@ -3818,6 +4036,11 @@ bool karte_t::load(const char *filename)
 
 	dbg->message("karte_t::load", "Loading game from '%s'", filename);
 
+	// it may be still written in the background
+	if(  const char *save_err = loadsave_t::finish_background_save()  ) {
+		dbg->warning( "karte_t::load", "Last background save failed: %s", save_err );
+	}
+
 	// reloading same game? Remember pos
 	const koord oldpos = settings.get_filename()[0]>0  &&  strncmp(filename,settings.get_filename(),strlen(settings.get_filename()))==0 ? viewport->get_world_position() : koord::invalid;
 
@@ -4102,7 +4325,7 @@ DBG_MESSAGE("karte_t::load()", "messages loaded");
 	// right season for recalculations
 	recalc_season_snowline(false);
 
-DBG_MESSAGE("karte_t::load()", "%d ways loaded",weg_t::get_alle_wege().get_count());
+DBG_MESSAGE("karte_t::load()", "%d ways loaded",weg_t::get_alle_wege_count());
 
 	ls.set_progress( (get_size().y*3)/2+256 );
 
@@ -4194,18 +4417,6 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", all_factories.get_count())
 		}
 	}
 
-#ifdef DEBUG
-	uint32 dt = dr_time();
-#endif
-	// recalculate halt connections
-	haltestelle_t::reset_routing();
-	do {
-		haltestelle_t::step_all();
-	} while (  haltestelle_t::get_rerouting_status()==RECONNECTING  );
-#ifdef DEBUG
-	dbg->message("karte_t::load()", "for all haltstellen_t took %ld ms", dr_time()-dt );
-#endif
-
 #if 0
 	// reroute goods for benchmarking
 	dt = dr_time();
@@ -4310,6 +4521,17 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", all_factories.get_count())
 		records->rdwr(file);
 	}
 
+	if (file->is_version_atleast(124, 6)) {
+		file->rdwr_short( month_spread_steps_left );
+		file->rdwr_long( month_spread_convoi );
+		file->rdwr_long( month_spread_halt );
+	}
+	else {
+		month_spread_steps_left = 0;
+		month_spread_convoi = 0;
+		month_spread_halt = 0;
+	}
+
 	if(  file->is_version_atleast(102, 4)  ) {
 		if(  env_t::restore_UI  ) {
 			file->rdwr_byte( active_player_nr );
@@ -4322,6 +4544,9 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", all_factories.get_count())
 		}
 	}
 
+	// recalculate halt connections and such
+	reset_unsaved_state();
+
 	file->set_buffered(false);
 	clear_random_mode(LOAD_RANDOM);
 
@@ -4332,6 +4557,66 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", all_factories.get_count())
 }
 
 
+static bool compare_tile_order(const gebaeude_t *a, const gebaeude_t *b)
+{
+	const koord pos_a = a->get_pos().get_2d();
+	const koord pos_b = b->get_pos().get_2d();
+	return pos_a.y < pos_b.y  ||  (pos_a.y == pos_b.y  &&  pos_a.x < pos_b.x);
+}
+
+
+void karte_t::reset_unsaved_state()
+{
+#ifdef DEBUG
+	uint32 dt = dr_time();
+#endif
+	// convois step in the order they were loaded and recalculate their driving data
+	sync.clear();
+	for(  convoihandle_t const cnv : convoi_array  ) {
+		cnv->reset_cached_data();
+		if(  !cnv->in_depot()  ) {
+			sync.add( cnv.get_rep() );
+		}
+	}
+
+	// attractions are listed in the order of the tiles, like loading finds them
+	vector_tpl<gebaeude_t *> sorted_attractions( attractions.get_count() );
+	for(  gebaeude_t *const gb : attractions  ) {
+		sorted_attractions.append( gb );
+	}
+	std::sort( sorted_attractions.begin(), sorted_attractions.end(), compare_tile_order );
+	attractions.clear();
+	for(  gebaeude_t *const gb : sorted_attractions  ) {
+		attractions.append( gb, gb->get_tile()->get_desc()->get_level() );
+	}
+
+	// cities are weighted by their current population, houses generate passengers in the order of their position
+	cities.update_weights( get_population );
+	for(  stadt_t *const c : cities  ) {
+		c->sort_gebaeude();
+		c->recalc_target_cities();
+		c->recalc_target_attractions();
+	}
+
+	// update all production related numbers, this also shares the demand among the current cities
+	for(  fabrik_t *const fab : all_factories  ) {
+		fab->set_base_production( fab->get_base_production() );
+	}
+
+	// update power nets with correct power
+	powernet_t::step_all(1);
+
+	// recalculate halt connections
+	haltestelle_t::restart_routing();
+#ifdef DEBUG
+	dbg->message("karte_t::reset_unsaved_state()", "for all haltstellen_t took %ld ms", dr_time()-dt );
+#endif
+
+	// all rows are hashed again with the next digest
+	digest_row_hash.clear();
+}
+
+
 void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 {
 	if (file->is_loading()) {
@@ -4448,6 +4733,10 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 	file->rdwr_long(ticks);
 	file->rdwr_long(last_month);
 	file->rdwr_long(last_year);
+	if(  file->is_version_atleast(124, 7)  ) {
+		// times counted in steps (like the next construction of an AI) stay the same after loading
+		file->rdwr_long(steps);
+	}
 
 	if (file->is_loading()) {
 		if(file->is_version_less(86, 6)) {
@@ -4467,7 +4756,9 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 		season = (2+last_month/3)&3; // summer always zero
 		next_month_ticks = ( (ticks >> karte_t::ticks_per_world_month_shift) + 1 ) << karte_t::ticks_per_world_month_shift;
 		last_step_ticks = ticks;
-		steps = 0;
+		if(  file->is_version_less(124, 7)  ) {
+			steps = 0;
+		}
 		network_frame_count = 0;
 		sync_steps = 0;
 		sync_steps_barrier = sync_steps;
@@ -4533,6 +4824,7 @@ void karte_t::rdwr_gamestate(loadsave_t *file, loadingscreen_t *ls)
 			stadt_t *s = new stadt_t(file);
 			cities.append(s, s->get_einwohner());
 		}
+		rebuild_city_index();
 	}
 	else {
 		for(stadt_t* const i : cities) {
@@ -5876,6 +6168,24 @@ void karte_t::clear_command_queue() const
 }
 
 
+void karte_t::send_command_queue(uint32 client_id) const
+{
+	const SOCKET sock = socket_list_t::get_socket(client_id);
+	for(network_world_command_t* const nwc : command_queue) {
+		if(  sock == INVALID_SOCKET  ) {
+			return;
+		}
+		if(  packet_t *p = nwc->copy_packet()  ) {
+			p->send(sock, true);
+			if(  !p->is_ready()  ) {
+				dbg->warning("karte_t::send_command_queue", "send of %s to client %u failed", nwc->get_name(), client_id);
+			}
+			delete p;
+		}
+	}
+}
+
+
 static void encode_URI(cbuffer_t& buf, char const* const text)
 {
 	for (char const* i = text; *i != '\0'; ++i) {
@@ -6303,11 +6613,16 @@ bool karte_t::interactive(uint32 quit_month)
 						default:
 							LCHKLST(sync_steps) = checklist_t(get_random_seed(), halthandle_t::get_next_check(), linehandle_t::get_next_check(), convoihandle_t::get_next_check());
 							break;
+						case 1:
+							LCHKLST(sync_steps) = checklist_t(get_gamestate_hash());
+							break;
 						case 2:
 							heavy_rotate_saves(env_t::server ? "server" : "client", sync_steps, 10);
-							// fall-through
-						case 1:
 							LCHKLST(sync_steps) = checklist_t(get_gamestate_hash());
+							break;
+						case 3:
+						case 4:
+							LCHKLST(sync_steps) = checklist_t(get_gamestate_digest());
 					}
 					// some server side tasks
 					if(  env_t::networkmode  &&  env_t::server  ) {
@@ -6657,3 +6972,120 @@ uint32 karte_t::get_gamestate_hash()
 	rdwr_gamestate(&ls, NULL);
 	return stream->get_hash();
 }
+
+
+uint32 karte_t::get_gamestate_digest_base(loadsave_t *file, adler32_stream_t *stream)
+{
+	// same order as rdwr_gamestate(), but without the tiles
+	settings.rdwr(file);
+	simrand_rdwr(file);
+	file->rdwr_long(ticks);
+	file->rdwr_long(last_month);
+	file->rdwr_long(last_year);
+	senke_t::static_rdwr(file);
+	for(stadt_t* const i : cities) {
+		i->rdwr(file);
+	}
+	for(fabrik_t* const f : all_factories) {
+		f->rdwr(file);
+	}
+	for(halthandle_t const s : haltestelle_t::get_alle_haltestellen()) {
+		s->rdwr(file);
+	}
+	for(convoihandle_t const cnv : convoi_array) {
+		cnv->rdwr(file);
+	}
+	return stream->get_hash();
+}
+
+
+uint32 karte_t::get_tile_row_hash(loadsave_t *file, adler32_stream_t *stream, sint16 y)
+{
+	for(  sint16 x=0;  x<get_size().x;  x++  ) {
+		plan[x+y*cached_grid_size.x].rdwr(file, koord(x,y) );
+		file->rdwr_byte( climate_map.at(x,y) );
+	}
+	return stream->get_hash();
+}
+
+
+uint32 karte_t::digest_rows_per_call() const
+{
+	// about 16k tiles per call; must not depend on local settings
+	return max( 1, 16384 / get_size().x );
+}
+
+
+uint32 karte_t::get_gamestate_digest()
+{
+	adler32_stream_t *stream = new adler32_stream_t;
+	stream_loadsave_t ls(stream);
+
+	if(  digest_row_hash.get_count() != (uint32)get_size().y  ) {
+		// after loading: hash all rows once
+		digest_row_hash.clear();
+		digest_row_hash.reserve( get_size().y );
+		digest_tiles_sum = 0;
+		for(  sint16 y=0;  y<get_size().y;  y++  ) {
+			const uint32 h = get_tile_row_hash( &ls, stream, y );
+			digest_row_hash.append( h );
+			digest_tiles_sum += h * (2*(uint32)y+1);
+		}
+		digest_next_row = 0;
+	}
+	else {
+		for(  uint32 i=digest_rows_per_call();  i>0;  i--  ) {
+			const sint16 y = digest_next_row;
+			const uint32 h = get_tile_row_hash( &ls, stream, y );
+			digest_tiles_sum += (h - digest_row_hash[y]) * (2*(uint32)y+1);
+			digest_row_hash[y] = h;
+			digest_next_row = y+1 < get_size().y ? y+1 : 0;
+		}
+	}
+
+	uint32 base = get_gamestate_digest_base( &ls, stream );
+	ls.rdwr_long( base );
+	ls.rdwr_long( digest_tiles_sum );
+	const uint32 digest = stream->get_hash();
+
+	if(  env_t::network_heavy_mode == 4  ) {
+		cross_check_gamestate_digest( digest );
+	}
+	return digest;
+}
+
+
+void karte_t::cross_check_gamestate_digest(uint32 digest)
+{
+	adler32_stream_t *stream = new adler32_stream_t;
+	stream_loadsave_t ls(stream);
+
+	// what the digest would be with all rows freshly hashed
+	uint32 tiles_sum = 0;
+	uint32 stale_rows = 0;
+	for(  sint16 y=0;  y<get_size().y;  y++  ) {
+		const uint32 h = get_tile_row_hash( &ls, stream, y );
+		tiles_sum += h * (2*(uint32)y+1);
+		stale_rows += h != digest_row_hash[y];
+	}
+	uint32 base = get_gamestate_digest_base( &ls, stream );
+	ls.rdwr_long( base );
+	ls.rdwr_long( tiles_sum );
+	const uint32 fresh = stream->get_hash();
+
+	const uint32 full = get_gamestate_hash();
+	if(  full != digest_check_full  &&  fresh == digest_check_fresh  ) {
+		// the digest would not notice a desync in this part
+		dbg->warning( "karte_t::cross_check_gamestate_digest()", "sync_step=%u: full hash changed, digest did not", sync_steps );
+	}
+	else if(  full == digest_check_full  &&  fresh != digest_check_fresh  ) {
+		// the digest depends on something outside the game state
+		dbg->warning( "karte_t::cross_check_gamestate_digest()", "sync_step=%u: digest changed, full hash did not", sync_steps );
+	}
+	if(  stale_rows == 0  &&  fresh != digest  ) {
+		dbg->warning( "karte_t::cross_check_gamestate_digest()", "sync_step=%u: incremental digest %08X differs from recalculated %08X", sync_steps, digest, fresh );
+	}
+	DBG_DEBUG4( "karte_t::cross_check_gamestate_digest()", "sync_step=%u: %u of %i rows not up to date", sync_steps, stale_rows, get_size().y );
+	digest_check_full = full;
+	digest_check_fresh = fresh;
+}
@@ -28,6 +28,7 @@
 
 #include "simplan.h"
 #include "surface.h"
+#include "city_index.h"
 
 #include "../simdebug.h"
 
@@ -52,6 +53,7 @@ class memory_rw_t;
 class viewport_t;
 class records_t;
 class loadingscreen_t;
+class adler32_stream_t;
 class terraformer_t;
 class building_desc_t;
 
@@ -60,6 +62,12 @@ class building_desc_t;
  */
 typedef void (karte_t::*xy_loop_func)(sint16, sint16, sint16, sint16);
 
+/**
+ * Threaded function caller for index ranges [first, last).
+ * @p thread_num is unique among the threads working at the same time.
+ */
+typedef void (*index_loop_func)(void *data, int thread_num, uint32 first, uint32 last);
+
 
 /**
  * The map is the central part of the simulation. It stores all data and objects.
@@ -199,6 +207,16 @@ private:
 	 */
 	void recalc_season_snowline(bool set_pending);
 
+	/**
+	 * Monthly update of the share of pending convois and halts for this step
+	 */
+	void step_month_spread();
+
+	/**
+	 * Monthly update of all convois and halts still pending
+	 */
+	void finish_month_spread();
+
 	/**
 	 * >0 means a season change is needed
 	 */
@@ -234,6 +252,14 @@ private:
 	 */
 	weighted_vector_tpl<stadt_t*> cities;
 
+	/**
+	 * Finds cities near a position, see find_nearest_city().
+	 */
+	city_index_t city_index;
+
+	/// sets up city_index again for all cities, after the map size or orientation changed
+	void rebuild_city_index();
+
 	sint64 last_month_bev;
 
 	/**
@@ -344,6 +370,19 @@ private:
 	/// @note variable used in interactive()
 	checklist_t last_checklists[LAST_CHECKLISTS_COUNT];
 #define LCHKLST(x) (last_checklists[(x) % LAST_CHECKLISTS_COUNT])
+
+	/**
+	 * Hash of every tile row for get_gamestate_digest(). A few rows are
+	 * rehashed per call in a fixed order, so all peers keep identical values.
+	 * Empty after loading, then all rows are hashed with the next call.
+	 */
+	vector_tpl<uint32> digest_row_hash;
+	/// sum of digest_row_hash[y]*(2y+1)
+	uint32 digest_tiles_sum;
+	/// next row to rehash
+	sint16 digest_next_row;
+	/// last results for the cross-check in heavy mode 4
+	uint32 digest_check_full, digest_check_fresh;
 	/// @note variable used in interactive()
 	uint8  network_frame_count;
 	/**
@@ -448,6 +487,14 @@ private:
 	 */
 	uint32 tile_counter;
 
+	/**
+	 * Used to distribute the monthly update of convois and halts to several steps:
+	 * steps left and the next index into convoi_array and the list of halts.
+	 */
+	uint16 month_spread_steps_left;
+	uint32 month_spread_convoi;
+	uint32 month_spread_halt;
+
 	/**
 	 * To identify different stages of the same game.
 	 */
@@ -532,6 +579,12 @@ private:
 
 	void world_xy_loop(xy_loop_func func, uint8 flags);
 	static void *world_xy_loop_thread(void *);
+	static void spawn_world_threads();
+
+	/**
+	 * Prepares the step of convois (multithreaded).
+	 */
+	static void prepare_convois_loop(void *welt, int, uint32, uint32);
 
 	/**
 	 * Loops over plans after load.
@@ -548,6 +601,12 @@ private:
 	void flood_to_depth(sint8 new_water_height, sint8 *stage);
 
 public:
+	/**
+	 * Calls @p func for the indices 0 ... count-1 split among the threads of world_xy_loop().
+	 * Interrupts are off meanwhile, so nothing may change the world.
+	 */
+	void world_index_loop(index_loop_func func, void *data, uint32 count);
+
 	enum server_announce_type_t
 	{
 		SERVER_ANNOUNCE_HELLO     = 0, ///< my server is now up
@@ -1017,6 +1076,17 @@ public:
 	 */
 	stadt_t *find_nearest_city(koord k) const;
 
+	/**
+	 * Searches the count cities with their townhall closest to @p k.
+	 * @param[out] result nearest city first
+	 */
+	void find_nearest_cities(koord k, uint32 count, vector_tpl<stadt_t *> &result) const { city_index.find_nearest_cities(k, count, result); }
+
+	/**
+	 * Must be called after the city limits or the townhall position of a city changed.
+	 */
+	void update_city_index(stadt_t *city) { city_index.update(city); }
+
 	bool cannot_save() const { return nosave; }
 	void set_nosave() { nosave = true; nosave_warning = true; }
 	void set_nosave_warning() { nosave_warning = true; }
@@ -1173,8 +1243,9 @@ public:
 	 * @param autosave
 	 * @param version
 	 * @param silent
+	 * @param background compress and write the file in the background, see loadsave_t::wr_open_background()
 	 */
-	void save(const char *filename, bool autosave, const char *version, bool silent);
+	void save(const char *filename, bool autosave, const char *version, bool silent, bool background = false);
 
 	/**
 	 * Loads a map from a file.
@@ -1182,6 +1253,13 @@ public:
 	 */
 	bool load(const char *filename);
 
+	/**
+	 * Sets what is not saved as loading does, so a game continues the same after
+	 * saving it and after loading it. Called at the end of loading and by the network
+	 * games that do not reload when a client joins (see env_t::server_join_sync_all).
+	 */
+	void reset_unsaved_state();
+
 	/**
 	 * Creates a map from a heightfield.
 	 * @param sets game settings.
@@ -1216,6 +1294,9 @@ public:
 
 	void clear_command_queue() const;
 
+	/// sends the queued commands to client @p client_id, which just got the game while the others did not reload it
+	void send_command_queue(uint32 client_id) const;
+
 	void network_disconnect();
 
 	/**
@@ -1233,7 +1314,25 @@ public:
 	 */
 	uint32 get_gamestate_hash();
 
+	/**
+	 * Cheaper alternative to get_gamestate_hash() for network checklists (heavy mode 3).
+	 * Everything except the tiles is hashed completely each call; of the tiles,
+	 * only digest_rows_per_call() rows are rehashed, the others use their
+	 * cached hashes. A desync of the tiles is thus found within one rotation
+	 * through the map instead of immediately.
+	 * Must be called at the same sync steps on all peers.
+	 */
+	uint32 get_gamestate_digest();
+
 private:
+	/// @returns hash of the state outside the tiles, the same parts rdwr_gamestate() writes
+	uint32 get_gamestate_digest_base(loadsave_t *file, adler32_stream_t *stream);
+	uint32 get_tile_row_hash(loadsave_t *file, adler32_stream_t *stream, sint16 y);
+	uint32 digest_rows_per_call() const;
+
+	/// heavy mode 4: check the digest against the full hash and against rehashing all rows
+	void cross_check_gamestate_digest(uint32 digest);
+
 	void process_network_commands(sint32* ms_difference);
 	void do_network_world_command(network_world_command_t *nwc);
 	uint32 get_next_command_step();
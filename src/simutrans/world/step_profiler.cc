@@ -0,0 +1,202 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include <string.h>
+
+#include "step_profiler.h"
+#include "simworld.h"
+
+#include "../simdebug.h"
+#include "../simhalt.h"
+#include "../dataobj/environment.h"
+#include "../sys/simsys.h"
+#include "../utils/simstring.h"
+
+
+bool step_profiler_t::active = false;
+step_profiler_t::month_t step_profiler_t::current;
+vector_tpl<step_profiler_t::month_t> step_profiler_t::months;
+uint64 step_profiler_t::start_us = 0;
+uint64 step_profiler_t::month_start_us = 0;
+
+
+static const char *const phase_names[step_profiler_t::MAX_PHASES] = {
+	"sync_step",
+	"new_month",
+	"convois",
+	"cities",
+	"factories",
+	"powernet",
+	"players",
+	"halts",
+	"scenario",
+	"misc"
+};
+
+
+// writes @p str as a quoted JSON string
+static void fprint_json_string(FILE *f, const char *str)
+{
+	fputc( '"', f );
+	for(  const char *c = str;  *c;  c++  ) {
+		if(  *c == '"'  ||  *c == '\\'  ) {
+			fprintf( f, "\\%c", *c );
+		}
+		else if(  (unsigned char)*c < 0x20  ) {
+			fprintf( f, "\\u%04x", (unsigned char)*c );
+		}
+		else {
+			fputc( *c, f );
+		}
+	}
+	fputc( '"', f );
+}
+
+
+step_profiler_t::timer_t::timer_t()
+{
+	last = active ? dr_time_us() : 0;
+}
+
+
+void step_profiler_t::timer_t::lap(phase_t phase)
+{
+	if(  active  ) {
+		const uint64 now = dr_time_us();
+		current.us[phase] += now - last;
+		last = now;
+	}
+}
+
+
+const char *step_profiler_t::get_phase_name(phase_t phase)
+{
+	return phase < MAX_PHASES ? phase_names[phase] : "";
+}
+
+
+void step_profiler_t::start(uint32 current_month)
+{
+	months.clear();
+	memset( &current, 0, sizeof(current) );
+	current.month = current_month;
+	start_us = dr_time_us();
+	month_start_us = start_us;
+	active = true;
+}
+
+
+void step_profiler_t::end_month(uint32 next_month)
+{
+	if(  active  ) {
+		const uint64 now = dr_time_us();
+		current.wall_us = now - month_start_us;
+		month_start_us = now;
+		months.append( current );
+		memset( &current, 0, sizeof(current) );
+		current.month = next_month;
+	}
+}
+
+
+bool step_profiler_t::write_report(const char *filename, const karte_t *welt, const char *savegame)
+{
+	if(  !active  ) {
+		return false;
+	}
+	active = false;
+	const uint64 now = dr_time_us();
+	const uint64 wall_us = now - start_us;
+	if(  current.steps > 0  ||  current.sync_steps > 0  ) {
+		// the last month was not finished
+		current.wall_us = now - month_start_us;
+		months.append( current );
+	}
+
+	FILE *f = stdout;
+	if(  filename  ) {
+		f = dr_fopen( filename, "w" );
+		if(  f == NULL  ) {
+			dbg->error( "step_profiler_t::write_report()", "Cannot write \"%s\"", filename );
+			return false;
+		}
+	}
+
+	month_t total;
+	memset( &total, 0, sizeof(total) );
+	total.wall_us = wall_us;
+	for(month_t const& m : months) {
+		total.steps += m.steps;
+		total.sync_steps += m.sync_steps;
+		for(  int p=0;  p<MAX_PHASES;  p++  ) {
+			total.us[p] += m.us[p];
+		}
+	}
+
+	const size_t len = filename ? strlen( filename ) : 0;
+	if(  len > 5  &&  STRICMP( filename + len - 5, ".json" ) == 0  ) {
+		fprintf( f, "{\n" );
+		fprintf( f, "\t\"savegame\": " );
+		fprint_json_string( f, savegame ? savegame : "" );
+		fprintf( f, ",\n\t\"version\": " );
+		fprint_json_string( f, get_version() );
+		fprintf( f, ",\n" );
+		fprintf( f, "\t\"threads\": %d,\n", env_t::num_threads );
+		fprintf( f, "\t\"size_x\": %d,\n", welt->get_size().x );
+		fprintf( f, "\t\"size_y\": %d,\n", welt->get_size().y );
+		fprintf( f, "\t\"convois\": %u,\n", welt->convoys().get_count() );
+		fprintf( f, "\t\"halts\": %u,\n", haltestelle_t::get_alle_haltestellen().get_count() );
+		fprintf( f, "\t\"cities\": %u,\n", welt->get_cities().get_count() );
+		fprintf( f, "\t\"factories\": %u,\n", welt->get_fab_list().get_count() );
+		fprintf( f, "\t\"wall_us\": %llu,\n", (unsigned long long)wall_us );
+		fprintf( f, "\t\"steps\": %u,\n", total.steps );
+		fprintf( f, "\t\"sync_steps\": %u,\n", total.sync_steps );
+		fprintf( f, "\t\"phases_us\": {" );
+		for(  int p=0;  p<MAX_PHASES;  p++  ) {
+			fprintf( f, "%s \"%s\": %llu", p ? "," : "", phase_names[p], (unsigned long long)total.us[p] );
+		}
+		fprintf( f, " },\n" );
+		fprintf( f, "\t\"months\": [\n" );
+		for(  uint32 i=0;  i<months.get_count();  i++  ) {
+			month_t const& m = months[i];
+			fprintf( f, "\t\t{ \"year\": %u, \"month\": %u, \"wall_us\": %llu, \"steps\": %u, \"sync_steps\": %u", m.month/12, (m.month%12)+1, (unsigned long long)m.wall_us, m.steps, m.sync_steps );
+			for(  int p=0;  p<MAX_PHASES;  p++  ) {
+				fprintf( f, ", \"%s\": %llu", phase_names[p], (unsigned long long)m.us[p] );
+			}
+			fprintf( f, " }%s\n", i+1 < months.get_count() ? "," : "" );
+		}
+		fprintf( f, "\t]\n" );
+		fprintf( f, "}\n" );
+	}
+	else {
+		// one row per month, times in microseconds; the last row holds the totals
+		fprintf( f, "year,month,wall_us,steps,sync_steps" );
+		for(  int p=0;  p<MAX_PHASES;  p++  ) {
+			fprintf( f, ",%s", phase_names[p] );
+		}
+		fprintf( f, "\n" );
+		for(month_t const& m : months) {
+			fprintf( f, "%u,%u,%llu,%u,%u", m.month/12, (m.month%12)+1, (unsigned long long)m.wall_us, m.steps, m.sync_steps );
+			for(  int p=0;  p<MAX_PHASES;  p++  ) {
+				fprintf( f, ",%llu", (unsigned long long)m.us[p] );
+			}
+			fprintf( f, "\n" );
+		}
+		fprintf( f, "total,,%llu,%u,%u", (unsigned long long)total.wall_us, total.steps, total.sync_steps );
+		for(  int p=0;  p<MAX_PHASES;  p++  ) {
+			fprintf( f, ",%llu", (unsigned long long)total.us[p] );
+		}
+		fprintf( f, "\n" );
+	}
+
+	if(  f != stdout  ) {
+		fclose( f );
+	}
+	else {
+		fflush( f );
+	}
+	dbg->message( "step_profiler_t::write_report()", "%u months, %u steps in %llu ms", months.get_count(), total.steps, (unsigned long long)(wall_us/1000) );
+	return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of the Simutrans project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef WORLD_STEP_PROFILER_H
+#define WORLD_STEP_PROFILER_H
+
+
+#include "../simtypes.h"
+#include "../tpl/vector_tpl.h"
+
+class karte_t;
+
+
+/**
+ * Collects the wall time spent in the phases of karte_t::step() and
+ * karte_t::sync_step(), one row per game month.
+ * Used by the -benchmark_months command line option; when not active,
+ * the timers only test a flag.
+ */
+class step_profiler_t
+{
+public:
+	enum phase_t {
+		SYNC_STEP = 0,
+		NEW_MONTH,
+		CONVOIS,
+		CITIES,
+		FACTORIES,
+		POWERNET,
+		PLAYERS,
+		HALTS,
+		SCENARIO,
+		MISC,        ///< seasons, network housekeeping and the rest of step()
+		MAX_PHASES
+	};
+
+	/// measures the time between consecutive laps
+	class timer_t
+	{
+		uint64 last;
+	public:
+		timer_t();
+
+		/// adds the time since the last lap (or construction) to @p phase
+		void lap(phase_t phase);
+	};
+
+private:
+	struct month_t
+	{
+		uint32 month;  ///< as in karte_t::get_current_month()
+		uint64 wall_us;
+		uint32 steps;
+		uint32 sync_steps;
+		uint64 us[MAX_PHASES];
+	};
+
+	static bool active;
+	static month_t current;
+	static vector_tpl<month_t> months;
+	static uint64 start_us;
+	static uint64 month_start_us;
+
+public:
+	static bool is_active() { return active; }
+
+	/// starts recording, discarding everything recorded before
+	static void start(uint32 current_month);
+
+	/// called at the start of every karte_t::step()
+	static void count_step() { current.steps++; }
+
+	/// called at the start of every karte_t::sync_step()
+	static void count_sync_step() { current.sync_steps++; }
+
+	/// called when a new month starts
+	static void end_month(uint32 next_month);
+
+	/**
+	 * Stops recording and writes the report. A filename ending in ".json" gives
+	 * JSON, anything else CSV; NULL prints CSV to stdout.
+	 */
+	static bool write_report(const char *filename, const karte_t *welt, const char *savegame);
+
+	static const char *get_phase_name(phase_t phase);
+};
+
+#endif